@@ -35,6 +35,7 @@
 
 #include "Application.h"
 #include "Client.h"
+#include "FrameProfiler.h"
 #include "Log.h"
 #include "ScriptSystem.h"
 #include "Settings.h"
@@ -67,6 +68,40 @@ struct ClientAppData
 };
 GLOBAL_DATA(ClientAppData, Data);
 
+#if FO_ENABLE_PROFILER && !FO_TESTING
+// Allocations counting for frame profiler, replaced only in client executable
+auto operator new(size_t size) -> void*
+{
+    FrameProfiler::CountAllocation();
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    while (true) {
+        if (auto* ptr = std::malloc(size); ptr != nullptr) {
+            return ptr;
+        }
+
+        auto* handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
 #if FO_SINGLEPLAYER
 void ClientScriptSystem::InitNativeScripting()
 {
@@ -140,14 +175,25 @@ static void MainEntry(void*)
 
     // Main loop
     try {
+        FrameProfiler::SetEnabled(App->Settings.ProfilerEnabled);
+        FrameProfiler::BeginFrame();
+
         App->BeginFrame();
 
 #if FO_SINGLEPLAYER
-        Data->Server->MainLoop();
+        {
+            PROFILER_ZONE("Server");
+            Data->Server->MainLoop();
+        }
 #endif
         Data->Client->MainLoop();
 
-        App->EndFrame();
+        {
+            PROFILER_ZONE("Present");
+            App->EndFrame();
+        }
+
+        FrameProfiler::EndFrame();
     }
     catch (const std::exception& ex) {
         ReportExceptionAndContinue(ex);
@@ -0,0 +1,83 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "Common.h"
+
+#include "Application.h"
+#include "DiskFileSystem.h"
+#include "LoadTest.h"
+#include "Log.h"
+#include "Settings.h"
+
+#if !FO_TESTING
+extern "C" int main(int argc, char** argv)
+#else
+[[maybe_unused]] static auto LoadTestApp(int argc, char** argv) -> int
+#endif
+{
+    try {
+        InitApp(argc, argv, "LoadTest");
+
+        auto* swarm = new LoadTestSwarm(App->Settings);
+
+        while (!App->Settings.Quit && !swarm->IsFinished()) {
+            try {
+                swarm->Process();
+            }
+            catch (const std::exception& ex) {
+                ReportExceptionAndContinue(ex);
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        swarm->Stop();
+
+        const auto report = swarm->MakeReport();
+        WriteLog("{}", report);
+
+        if (!App->Settings.LoadTestReport.empty()) {
+            auto file = DiskFileSystem::OpenFile(App->Settings.LoadTestReport, true);
+            if (!file || !file.Write(report)) {
+                WriteLog("Can't write load test report {}", App->Settings.LoadTestReport);
+            }
+        }
+
+        delete swarm;
+
+        ExitApp(true);
+    }
+    catch (const std::exception& ex) {
+        ReportExceptionAndExit(ex);
+    }
+}
@@ -80,6 +80,7 @@ int main(int argc, char** argv)
         while (!App->Settings.Quit) {
             try {
                 server->MainLoop();
+                server->WaitTick();
             }
             catch (const std::exception& ex) {
                 ReportExceptionAndContinue(ex);
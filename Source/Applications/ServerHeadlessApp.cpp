@@ -51,6 +51,7 @@ extern "C" int main(int argc, char** argv)
         while (!App->Settings.Quit) {
             try {
                 server->MainLoop();
+                server->WaitTick();
             }
             catch (const std::exception& ex) {
                 ReportExceptionAndContinue(ex);
@@ -73,6 +73,7 @@ static void ServerEntry()
         while (!App->Settings.Quit) {
             try {
                 Data->Server->MainLoop();
+                Data->Server->WaitTick();
             }
             catch (const GenericException& ex) {
                 ReportExceptionAndContinue(ex);
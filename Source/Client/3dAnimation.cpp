@@ -36,6 +36,48 @@
 #if FO_ENABLE_3D
 
 #include "GenericUtils.h"
+#include "ThreadPool.h"
+
+// Batched blend helpers, work on separate component arrays without branches in lerp loops
+static void LerpComponents(size_t count, const uchar* valid0, const uchar* valid1, float* x0, const float* x1, float factor)
+{
+    for (size_t b = 0; b < count; b++) {
+        const auto blended = x0[b] + (x1[b] - x0[b]) * factor;
+        x0[b] = (valid0[b] & valid1[b]) != 0 ? blended : x0[b];
+    }
+}
+
+static void SlerpComponents(size_t count, const uchar* valid0, const uchar* valid1, float* x0, float* y0, float* z0, float* w0, const float* x1, const float* y1, const float* z1, const float* w1, float factor)
+{
+    // Same math as quaternion::Interpolate
+    for (size_t b = 0; b < count; b++) {
+        if ((valid0[b] & valid1[b]) == 0) {
+            continue;
+        }
+
+        auto cosom = x0[b] * x1[b] + y0[b] * y1[b] + z0[b] * z1[b] + w0[b] * w1[b];
+        const auto sign = cosom < 0.0f ? -1.0f : 1.0f;
+        cosom *= sign;
+
+        float sclp;
+        float sclq;
+        if (1.0f - cosom > 0.0001f) {
+            const auto omega = std::acos(cosom);
+            const auto sinom = std::sin(omega);
+            sclp = std::sin((1.0f - factor) * omega) / sinom;
+            sclq = std::sin(factor * omega) / sinom;
+        }
+        else {
+            sclp = 1.0f - factor;
+            sclq = factor;
+        }
+
+        x0[b] = sclp * x0[b] + sclq * (sign * x1[b]);
+        y0[b] = sclp * y0[b] + sclq * (sign * y1[b]);
+        z0[b] = sclp * z0[b] + sclq * (sign * z1[b]);
+        w0[b] = sclp * w0[b] + sclq * (sign * w1[b]);
+    }
+}
 
 void ModelAnimation::Load(DataReader& reader, NameResolver& name_resolver)
 {
@@ -138,6 +180,7 @@ ModelAnimationController::ModelAnimationController(uint track_count)
     if (track_count != 0u) {
         _sets = new vector<ModelAnimation*>();
         _outputs = new vector<Output>();
+        _samples = new vector<TrackSamples>(track_count);
         _tracks.resize(track_count);
     }
 }
@@ -147,6 +190,7 @@ ModelAnimationController::~ModelAnimationController()
     if (!_cloned) {
         delete _sets;
         delete _outputs;
+        delete _samples;
     }
 }
 
@@ -156,9 +200,12 @@ auto ModelAnimationController::Clone() const -> ModelAnimationController*
     clone->_cloned = true;
     clone->_sets = _sets;
     clone->_outputs = _outputs;
+    clone->_samples = _samples;
     clone->_tracks = _tracks;
     clone->_curTime = 0.0f;
     clone->_interpolationDisabled = _interpolationDisabled;
+    clone->_keyCursorsDisabled = _keyCursorsDisabled;
+    clone->_threadPool = _threadPool;
     return clone;
 }
 
@@ -169,11 +216,11 @@ void ModelAnimationController::RegisterAnimationOutput(hstring bone_name, mat44&
     auto& o = _outputs->emplace_back();
     o.BoneName = bone_name;
     o.Matrix = &output_matrix;
-    o.Valid.resize(_tracks.size());
-    o.Factor.resize(_tracks.size());
-    o.Scale.resize(_tracks.size());
-    o.Rotation.resize(_tracks.size());
-    o.Translation.resize(_tracks.size());
+    o.Index = static_cast<uint>(_outputs->size() - 1);
+
+    for (auto& samples : *_samples) {
+        samples.Resize(_outputs->size());
+    }
 }
 
 void ModelAnimationController::RegisterAnimationSet(ModelAnimation* animation)
@@ -216,6 +263,7 @@ void ModelAnimationController::SetTrackAnimationSet(uint track, const ModelAnima
     _tracks[track].Anim = anim;
     const auto count = anim->GetBoneOutputCount();
     _tracks[track].AnimOutput.resize(count);
+    _tracks[track].Cursors.assign(count, KeyCursor());
     for (uint i = 0; i < count; i++) {
         const auto link_name = anim->_boneOutputs[i].BoneName;
         Output* output = nullptr;
@@ -240,7 +288,7 @@ void ModelAnimationController::ResetBonesTransition(uint skip_track, const vecto
 
             for (uint k = 0, l = static_cast<uint>(_tracks[i].AnimOutput.size()); k < l; k++) {
                 if (_tracks[i].AnimOutput[k] != nullptr && _tracks[i].AnimOutput[k]->BoneName == bone_name) {
-                    _tracks[i].AnimOutput[k]->Valid[i] = false;
+                    (*_samples)[i].Valid[_tracks[i].AnimOutput[k]->Index] = 0;
                     _tracks[i].AnimOutput[k] = nullptr;
                 }
             }
@@ -292,6 +340,16 @@ void ModelAnimationController::SetInterpolation(bool enabled)
     _interpolationDisabled = !enabled;
 }
 
+void ModelAnimationController::SetKeyCursors(bool enabled)
+{
+    _keyCursorsDisabled = !enabled;
+}
+
+void ModelAnimationController::SetThreadPool(ThreadPool* thread_pool)
+{
+    _threadPool = thread_pool;
+}
+
 void ModelAnimationController::AdvanceTime(float time)
 {
     // Animation time
@@ -354,64 +412,145 @@ void ModelAnimationController::AdvanceTime(float time)
     // Track animation
     for (uint i = 0, j = static_cast<uint>(_tracks.size()); i < j; i++) {
         auto& track = _tracks[i];
+        auto& samples = (*_samples)[i];
 
-        for (auto& o : *_outputs) {
-            o.Valid[i] = false;
-        }
+        std::fill(samples.Valid.begin(), samples.Valid.end(), static_cast<uchar>(0));
 
         if (!track.Enabled || track.Weight <= 0.0f || track.Anim == nullptr) {
             continue;
         }
 
-        for (uint k = 0, l = static_cast<uint>(track.Anim->_boneOutputs.size()); k < l; k++) {
-            if (track.AnimOutput[k] == nullptr) {
-                continue;
+        // Bones of one track are written to different outputs so may be sampled in parallel
+        const auto bones_count = track.Anim->_boneOutputs.size();
+        if (_threadPool != nullptr && bones_count >= PARALLEL_SAMPLING_MIN_BONES) {
+            _threadPool->ParallelFor(bones_count, [this, i](size_t k) { SampleTrack(i, static_cast<uint>(k)); });
+        }
+        else {
+            for (uint k = 0; k < static_cast<uint>(bones_count); k++) {
+                SampleTrack(i, k);
+            }
+        }
+    }
+
+    // Blend tracks
+    // Todo: add interpolation for tracks more than two
+    if (_tracks.size() >= 2) {
+        BlendTracks((*_samples)[0], (*_samples)[1], _tracks[1].Weight);
+    }
+
+    // Blended value is stored in first track so take first valid
+    for (auto& o : *_outputs) {
+        for (const auto& samples : *_samples) {
+            if (samples.Valid[o.Index] != 0) {
+                const auto index = o.Index;
+                mat44 ms;
+                mat44 mr;
+                mat44 mt;
+                mat44::Scaling(vec3(samples.ScaleX[index], samples.ScaleY[index], samples.ScaleZ[index]), ms);
+                mr = mat44(quaternion(samples.RotationW[index], samples.RotationX[index], samples.RotationY[index], samples.RotationZ[index]).GetMatrix());
+                mat44::Translation(vec3(samples.TranslationX[index], samples.TranslationY[index], samples.TranslationZ[index]), mt);
+                *o.Matrix = mt * mr * ms;
+                break;
             }
+        }
+    }
+}
 
-            auto& o = track.Anim->_boneOutputs[k];
+void ModelAnimationController::SampleTrack(uint track_index, uint bone_output)
+{
+    auto& track = _tracks[track_index];
+    const auto* output = track.AnimOutput[bone_output];
+    if (output == nullptr) {
+        return;
+    }
 
-            auto t = fmod(track.Position * track.Anim->_ticksPerSecond, track.Anim->_durationTicks);
+    const auto& o = track.Anim->_boneOutputs[bone_output];
+    auto& samples = (*_samples)[track_index];
+    const auto index = output->Index;
 
-            FindSrtValue<vec3>(t, o.ScaleTime, o.ScaleValue, track.AnimOutput[k]->Scale[i]);
-            FindSrtValue<quaternion>(t, o.RotationTime, o.RotationValue, track.AnimOutput[k]->Rotation[i]);
-            FindSrtValue<vec3>(t, o.TranslationTime, o.TranslationValue, track.AnimOutput[k]->Translation[i]);
+    const auto t = fmod(track.Position * track.Anim->_ticksPerSecond, track.Anim->_durationTicks);
 
-            track.AnimOutput[k]->Valid[i] = true;
-            track.AnimOutput[k]->Factor[i] = track.Weight;
-        }
+    // Values without keys keep previous result
+    vec3 scale(samples.ScaleX[index], samples.ScaleY[index], samples.ScaleZ[index]);
+    quaternion rotation(samples.RotationW[index], samples.RotationX[index], samples.RotationY[index], samples.RotationZ[index]);
+    vec3 translation(samples.TranslationX[index], samples.TranslationY[index], samples.TranslationZ[index]);
+
+    if (!_keyCursorsDisabled) {
+        auto& cursor = track.Cursors[bone_output];
+        FindSrtValueCached<vec3>(t, o.ScaleTime, o.ScaleValue, cursor.Scale, scale);
+        FindSrtValueCached<quaternion>(t, o.RotationTime, o.RotationValue, cursor.Rotation, rotation);
+        FindSrtValueCached<vec3>(t, o.TranslationTime, o.TranslationValue, cursor.Translation, translation);
+    }
+    else {
+        FindSrtValue<vec3>(t, o.ScaleTime, o.ScaleValue, scale);
+        FindSrtValue<quaternion>(t, o.RotationTime, o.RotationValue, rotation);
+        FindSrtValue<vec3>(t, o.TranslationTime, o.TranslationValue, translation);
     }
 
-    // Blend tracks
-    for (auto& o : *_outputs) {
-        // Todo: add interpolation for tracks more than two
-        if (_tracks.size() >= 2 && o.Valid[0] && o.Valid[1]) {
-            auto factor = o.Factor[1];
-            Interpolate(o.Scale[0], o.Scale[1], factor);
-            Interpolate(o.Rotation[0], o.Rotation[1], factor);
-            Interpolate(o.Translation[0], o.Translation[1], factor);
-            mat44 ms;
-            mat44 mr;
-            mat44 mt;
-            mat44::Scaling(o.Scale[0], ms);
-            mr = mat44(o.Rotation[0].GetMatrix());
-            mat44::Translation(o.Translation[0], mt);
-            *o.Matrix = mt * mr * ms;
+    samples.ScaleX[index] = scale.x;
+    samples.ScaleY[index] = scale.y;
+    samples.ScaleZ[index] = scale.z;
+    samples.RotationX[index] = rotation.x;
+    samples.RotationY[index] = rotation.y;
+    samples.RotationZ[index] = rotation.z;
+    samples.RotationW[index] = rotation.w;
+    samples.TranslationX[index] = translation.x;
+    samples.TranslationY[index] = translation.y;
+    samples.TranslationZ[index] = translation.z;
+    samples.Valid[index] = 1;
+}
+
+void ModelAnimationController::BlendTracks(TrackSamples& samples0, const TrackSamples& samples1, float factor) const
+{
+    const auto count = samples0.Valid.size();
+    const auto* valid0 = samples0.Valid.data();
+    const auto* valid1 = samples1.Valid.data();
+
+    if (_interpolationDisabled) {
+        if (factor < 0.5f) {
+            return;
         }
-        else {
-            for (uint k = 0, l = static_cast<uint>(_tracks.size()); k < l; k++) {
-                if (o.Valid[k]) {
-                    mat44 ms;
-                    mat44 mr;
-                    mat44 mt;
-                    mat44::Scaling(o.Scale[k], ms);
-                    mr = mat44(o.Rotation[k].GetMatrix());
-                    mat44::Translation(o.Translation[k], mt);
-                    *o.Matrix = mt * mr * ms;
-                    break;
-                }
+
+        for (size_t b = 0; b < count; b++) {
+            if ((valid0[b] & valid1[b]) != 0) {
+                samples0.ScaleX[b] = samples1.ScaleX[b];
+                samples0.ScaleY[b] = samples1.ScaleY[b];
+                samples0.ScaleZ[b] = samples1.ScaleZ[b];
+                samples0.RotationX[b] = samples1.RotationX[b];
+                samples0.RotationY[b] = samples1.RotationY[b];
+                samples0.RotationZ[b] = samples1.RotationZ[b];
+                samples0.RotationW[b] = samples1.RotationW[b];
+                samples0.TranslationX[b] = samples1.TranslationX[b];
+                samples0.TranslationY[b] = samples1.TranslationY[b];
+                samples0.TranslationZ[b] = samples1.TranslationZ[b];
             }
         }
+        return;
     }
+
+    LerpComponents(count, valid0, valid1, samples0.ScaleX.data(), samples1.ScaleX.data(), factor);
+    LerpComponents(count, valid0, valid1, samples0.ScaleY.data(), samples1.ScaleY.data(), factor);
+    LerpComponents(count, valid0, valid1, samples0.ScaleZ.data(), samples1.ScaleZ.data(), factor);
+    SlerpComponents(count, valid0, valid1, samples0.RotationX.data(), samples0.RotationY.data(), samples0.RotationZ.data(), samples0.RotationW.data(), //
+        samples1.RotationX.data(), samples1.RotationY.data(), samples1.RotationZ.data(), samples1.RotationW.data(), factor);
+    LerpComponents(count, valid0, valid1, samples0.TranslationX.data(), samples1.TranslationX.data(), factor);
+    LerpComponents(count, valid0, valid1, samples0.TranslationY.data(), samples1.TranslationY.data(), factor);
+    LerpComponents(count, valid0, valid1, samples0.TranslationZ.data(), samples1.TranslationZ.data(), factor);
+}
+
+void ModelAnimationController::TrackSamples::Resize(size_t count)
+{
+    Valid.resize(count);
+    ScaleX.resize(count);
+    ScaleY.resize(count);
+    ScaleZ.resize(count);
+    RotationX.resize(count);
+    RotationY.resize(count);
+    RotationZ.resize(count);
+    RotationW.resize(count, 1.0f);
+    TranslationX.resize(count);
+    TranslationY.resize(count);
+    TranslationZ.resize(count);
 }
 
 void ModelAnimationController::Interpolate(quaternion& q1, const quaternion& q2, float factor) const
@@ -37,6 +37,8 @@
 
 #if FO_ENABLE_3D
 
+class ThreadPool;
+
 class ModelAnimation final
 {
     friend class ModelAnimationController;
@@ -82,6 +84,9 @@ class ModelAnimation final
 class ModelAnimationController final
 {
 public:
+    static constexpr uint KEY_CURSOR_SCAN = 4;
+    static constexpr uint PARALLEL_SAMPLING_MIN_BONES = 64;
+
     explicit ModelAnimationController(uint track_count);
     ModelAnimationController(const ModelAnimationController&) = delete;
     ModelAnimationController(ModelAnimationController&&) noexcept = default;
@@ -107,6 +112,8 @@ class ModelAnimationController final
     void SetTrackEnable(uint track, bool enable);
     void SetTrackPosition(uint track, float position);
     void SetInterpolation(bool enabled);
+    void SetKeyCursors(bool enabled);
+    void SetThreadPool(ThreadPool* thread_pool);
     void AdvanceTime(float time);
 
 private:
@@ -114,11 +121,33 @@ class ModelAnimationController final
     {
         hstring BoneName {};
         mat44* Matrix {};
-        vector<bool> Valid {};
-        vector<float> Factor {};
-        vector<vec3> Scale {};
-        vector<quaternion> Rotation {};
-        vector<vec3> Translation {};
+        uint Index {};
+    };
+
+    // Sampled bone values of one track, components are kept in separate arrays for batched blending
+    struct TrackSamples
+    {
+        void Resize(size_t count);
+
+        vector<uchar> Valid {};
+        vector<float> ScaleX {};
+        vector<float> ScaleY {};
+        vector<float> ScaleZ {};
+        vector<float> RotationX {};
+        vector<float> RotationY {};
+        vector<float> RotationZ {};
+        vector<float> RotationW {};
+        vector<float> TranslationX {};
+        vector<float> TranslationY {};
+        vector<float> TranslationZ {};
+    };
+
+    // Last found key indices, playback mostly moves forward so next key is found in few steps
+    struct KeyCursor
+    {
+        uint Scale {};
+        uint Rotation {};
+        uint Translation {};
     };
 
     struct Track
@@ -145,11 +174,14 @@ class ModelAnimationController final
         float Position {};
         const ModelAnimation* Anim {};
         vector<Output*> AnimOutput {};
+        vector<KeyCursor> Cursors {};
         vector<Event> Events {};
     };
 
     void Interpolate(quaternion& q1, const quaternion& q2, float factor) const;
     void Interpolate(vec3& v1, const vec3& v2, float factor) const;
+    void SampleTrack(uint track_index, uint bone_output);
+    void BlendTracks(TrackSamples& samples0, const TrackSamples& samples1, float factor) const;
 
     template<class T>
     void FindSrtValue(float time, const vector<float>& times, const vector<T>& values, T& result)
@@ -170,12 +202,47 @@ class ModelAnimationController final
         }
     }
 
+    // Same result as FindSrtValue but search starts from last found key
+    template<class T>
+    void FindSrtValueCached(float time, const vector<float>& times, const vector<T>& values, uint& cursor, T& result) const
+    {
+        const auto count = times.size();
+        if (count == 0) {
+            return;
+        }
+        if (count == 1 || time < times.front() || time >= times.back()) {
+            result = values.back();
+            return;
+        }
+
+        auto n = static_cast<size_t>(cursor);
+        if (n + 1 >= count || time < times[n]) {
+            n = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+        }
+        else if (time >= times[n + 1]) {
+            for (uint step = 0; step < KEY_CURSOR_SCAN && time >= times[n + 1]; step++) {
+                n++;
+            }
+            if (time >= times[n + 1]) {
+                n = static_cast<size_t>(std::upper_bound(times.begin() + static_cast<std::ptrdiff_t>(n + 1), times.end(), time) - times.begin()) - 1;
+            }
+        }
+        cursor = static_cast<uint>(n);
+
+        result = values[n];
+        const auto factor = (time - times[n]) / (times[n + 1] - times[n]);
+        Interpolate(result, values[n + 1], factor);
+    }
+
     bool _cloned {};
     vector<ModelAnimation*>* _sets {};
     vector<Output>* _outputs {};
+    vector<TrackSamples>* _samples {};
     vector<Track> _tracks {};
     float _curTime {};
     bool _interpolationDisabled {};
+    bool _keyCursorsDisabled {};
+    ThreadPool* _threadPool {};
     bool _nonConstHelper {};
 };
 
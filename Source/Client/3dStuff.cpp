@@ -141,6 +141,11 @@ ModelManager::ModelManager(RenderSettings& settings, FileSystem& file_sys, Effec
     if (_settings.Animation3dFPS != 0u) {
         _animDelay = 1000 / _settings.Animation3dFPS;
     }
+
+    // Bones sampling of heavy models
+    if (_settings.Animation3dThreads != 0u) {
+        _animThreadPool = std::make_unique<ThreadPool>(_settings.Animation3dThreads);
+    }
 }
 
 auto ModelManager::GetBoneHashedString(string_view name) const -> hstring
@@ -2179,6 +2184,7 @@ auto ModelInformation::Load(string_view name) -> bool
         // Create animation controller
         if (!anims.empty()) {
             _animController = std::make_unique<ModelAnimationController>(2);
+            _animController->SetThreadPool(_modelMngr._animThreadPool.get());
         }
 
         // Parse animations
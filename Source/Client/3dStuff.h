@@ -42,6 +42,7 @@
 #include "EffectManager.h"
 #include "FileSystem.h"
 #include "Settings.h"
+#include "ThreadPool.h"
 #include "Timer.h"
 
 constexpr uint ANIMATION_STAY = 0x01;
@@ -205,6 +206,7 @@ class ModelManager final
     vector<unique_ptr<MeshTexture>> _loadedMeshTextures {};
     vector<unique_ptr<ModelInformation>> _allModelInfos {};
     vector<unique_ptr<ModelHierarchy>> _xFiles {};
+    unique_ptr<ThreadPool> _animThreadPool {};
     int _modeWidth {};
     int _modeHeight {};
     float _modeWidthF {};
@@ -0,0 +1,204 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "AtlasPacker.h"
+
+AtlasPacker::AtlasPacker(uint width, uint height) : _width {width}, _height {height}
+{
+    RUNTIME_ASSERT(width > 0);
+    RUNTIME_ASSERT(height > 0);
+
+    Reset();
+}
+
+auto AtlasPacker::GetOccupancy() const -> float
+{
+    return static_cast<float>(static_cast<double>(_usedArea) / (static_cast<double>(_width) * static_cast<double>(_height)));
+}
+
+void AtlasPacker::Reset()
+{
+    _freeRects.clear();
+    _freeRects.push_back({0, 0, static_cast<int>(_width), static_cast<int>(_height)});
+    _usedArea = 0;
+}
+
+auto AtlasPacker::Insert(uint w, uint h, int& x, int& y) -> bool
+{
+    RUNTIME_ASSERT(w > 0);
+    RUNTIME_ASSERT(h > 0);
+
+    const auto iw = static_cast<int>(w);
+    const auto ih = static_cast<int>(h);
+
+    // Best short side fit, long side as tie breaker
+    const Rect* best = nullptr;
+    auto best_short = std::numeric_limits<int>::max();
+    auto best_long = std::numeric_limits<int>::max();
+
+    for (const auto& free_rect : _freeRects) {
+        if (free_rect.W < iw || free_rect.H < ih) {
+            continue;
+        }
+
+        const auto leftover_w = free_rect.W - iw;
+        const auto leftover_h = free_rect.H - ih;
+        const auto short_side = std::min(leftover_w, leftover_h);
+        const auto long_side = std::max(leftover_w, leftover_h);
+
+        if (short_side < best_short || (short_side == best_short && long_side < best_long)) {
+            best = &free_rect;
+            best_short = short_side;
+            best_long = long_side;
+        }
+    }
+
+    if (best == nullptr) {
+        return false;
+    }
+
+    x = best->X;
+    y = best->Y;
+
+    SplitFreeRects({x, y, iw, ih});
+    PruneFreeRects();
+
+    _usedArea += static_cast<size_t>(w) * h;
+    return true;
+}
+
+void AtlasPacker::Free(int x, int y, uint w, uint h)
+{
+    RUNTIME_ASSERT(x >= 0 && x + static_cast<int>(w) <= static_cast<int>(_width));
+    RUNTIME_ASSERT(y >= 0 && y + static_cast<int>(h) <= static_cast<int>(_height));
+    RUNTIME_ASSERT(_usedArea >= static_cast<size_t>(w) * h);
+
+    _usedArea -= static_cast<size_t>(w) * h;
+
+    if (_usedArea == 0) {
+        Reset();
+        return;
+    }
+
+    _freeRects.push_back({x, y, static_cast<int>(w), static_cast<int>(h)});
+    MergeFreeRects();
+    PruneFreeRects();
+}
+
+void AtlasPacker::SplitFreeRects(const Rect& used)
+{
+    _newFreeRects.clear();
+
+    for (auto it = _freeRects.begin(); it != _freeRects.end();) {
+        const auto r = *it;
+        if (used.X >= r.X + r.W || used.X + used.W <= r.X || used.Y >= r.Y + r.H || used.Y + used.H <= r.Y) {
+            ++it;
+            continue;
+        }
+
+        // Up to four maximal rectangles around used one
+        if (used.X > r.X) {
+            _newFreeRects.push_back({r.X, r.Y, used.X - r.X, r.H});
+        }
+        if (used.X + used.W < r.X + r.W) {
+            _newFreeRects.push_back({used.X + used.W, r.Y, r.X + r.W - used.X - used.W, r.H});
+        }
+        if (used.Y > r.Y) {
+            _newFreeRects.push_back({r.X, r.Y, r.W, used.Y - r.Y});
+        }
+        if (used.Y + used.H < r.Y + r.H) {
+            _newFreeRects.push_back({r.X, used.Y + used.H, r.W, r.Y + r.H - used.Y - used.H});
+        }
+
+        *it = _freeRects.back();
+        _freeRects.pop_back();
+    }
+
+    _freeRects.insert(_freeRects.end(), _newFreeRects.begin(), _newFreeRects.end());
+}
+
+void AtlasPacker::MergeFreeRects()
+{
+    // Join rectangles with common full edge, repeat until nothing changes
+    auto merged = true;
+    while (merged) {
+        merged = false;
+
+        for (size_t i = 0; i < _freeRects.size() && !merged; i++) {
+            for (size_t j = i + 1; j < _freeRects.size(); j++) {
+                auto& a = _freeRects[i];
+                const auto& b = _freeRects[j];
+
+                if (a.X == b.X && a.W == b.W && (a.Y + a.H == b.Y || b.Y + b.H == a.Y)) {
+                    a.Y = std::min(a.Y, b.Y);
+                    a.H += b.H;
+                }
+                else if (a.Y == b.Y && a.H == b.H && (a.X + a.W == b.X || b.X + b.W == a.X)) {
+                    a.X = std::min(a.X, b.X);
+                    a.W += b.W;
+                }
+                else {
+                    continue;
+                }
+
+                _freeRects[j] = _freeRects.back();
+                _freeRects.pop_back();
+                merged = true;
+                break;
+            }
+        }
+    }
+}
+
+void AtlasPacker::PruneFreeRects()
+{
+    const auto contains = [](const Rect& a, const Rect& b) { return b.X >= a.X && b.Y >= a.Y && b.X + b.W <= a.X + a.W && b.Y + b.H <= a.Y + a.H; };
+
+    for (size_t i = 0; i < _freeRects.size(); i++) {
+        for (size_t j = i + 1; j < _freeRects.size();) {
+            if (contains(_freeRects[i], _freeRects[j])) {
+                _freeRects[j] = _freeRects.back();
+                _freeRects.pop_back();
+            }
+            else if (contains(_freeRects[j], _freeRects[i])) {
+                _freeRects[i] = _freeRects[j];
+                _freeRects[j] = _freeRects.back();
+                _freeRects.pop_back();
+                j = i + 1;
+            }
+            else {
+                j++;
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// MaxRects bin packer, keeps list of maximal free rectangles and places by best short side fit
+// Freed rectangles are returned to free list and merged with neighbors, so space can be reused without rebuild
+class AtlasPacker final
+{
+public:
+    AtlasPacker() = delete;
+    AtlasPacker(uint width, uint height);
+    AtlasPacker(const AtlasPacker&) = delete;
+    AtlasPacker(AtlasPacker&&) noexcept = default;
+    auto operator=(const AtlasPacker&) = delete;
+    auto operator=(AtlasPacker&&) noexcept -> AtlasPacker& = default;
+    ~AtlasPacker() = default;
+
+    [[nodiscard]] auto GetWidth() const -> uint { return _width; }
+    [[nodiscard]] auto GetHeight() const -> uint { return _height; }
+    [[nodiscard]] auto GetUsedArea() const -> size_t { return _usedArea; }
+    [[nodiscard]] auto GetOccupancy() const -> float;
+    [[nodiscard]] auto GetFreeRectsCount() const -> size_t { return _freeRects.size(); }
+    [[nodiscard]] auto IsEmpty() const -> bool { return _usedArea == 0; }
+
+    auto Insert(uint w, uint h, int& x, int& y) -> bool;
+    void Free(int x, int y, uint w, uint h);
+    void Reset();
+
+private:
+    struct Rect
+    {
+        int X {};
+        int Y {};
+        int W {};
+        int H {};
+    };
+
+    void SplitFreeRects(const Rect& used);
+    void MergeFreeRects();
+    void PruneFreeRects();
+
+    uint _width;
+    uint _height;
+    vector<Rect> _freeRects {};
+    vector<Rect> _newFreeRects {};
+    size_t _usedArea {};
+};
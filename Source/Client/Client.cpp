@@ -34,12 +34,15 @@
 #include "Client.h"
 
 #include "ClientScripting.h"
+#include "FrameProfiler.h"
 #include "GenericUtils.h"
 #include "Log.h"
 #include "NetCommand.h"
 #include "StringUtils.h"
 #include "Version-Include.h"
 
+#include "imgui.h"
+
 // clang-format off
 FOClient::FOClient(GlobalSettings& settings, ScriptSystem* script_sys) :
     FOEngineBase(false),
@@ -50,7 +53,7 @@ FOClient::FOClient(GlobalSettings& settings, ScriptSystem* script_sys) :
     ProtoMngr(this),
     EffectMngr(Settings, FileSys),
     SprMngr(Settings, FileSys, EffectMngr),
-    ResMngr(FileSys, SprMngr, *this, *this),
+    ResMngr(Settings, FileSys, SprMngr, *this, *this),
     SndMngr(Settings, FileSys),
     Keyb(Settings, SprMngr),
     Cache("Data/Cache.fobin"),
@@ -250,12 +253,39 @@ FOClient::FOClient(GlobalSettings& settings, ScriptSystem* script_sys) :
 
     ScreenFadeOut();
 
+    // Map rendering benchmark
+    if (!Settings.RenderSessionReplay.empty()) {
+        auto file = DiskFileSystem::OpenFile(Settings.RenderSessionReplay, false);
+        if (!file) {
+            throw RenderSessionException("Can't open render session file", Settings.RenderSessionReplay);
+        }
+
+        string data(file.GetSize(), ' ');
+        if (!data.empty() && !file.Read(data.data(), data.size())) {
+            throw RenderSessionException("Can't read render session file", Settings.RenderSessionReplay);
+        }
+
+        _renderSession = std::make_unique<RenderSession>();
+        _renderSession->Load(data);
+        _renderSessionReplay = true;
+    }
+    else if (!Settings.RenderSessionRecord.empty()) {
+        _renderSession = std::make_unique<RenderSession>();
+    }
+
     // Auto login
     ProcessAutoLogin();
 }
 
 FOClient::~FOClient()
 {
+    if (_renderSession && !_renderSessionReplay && !_renderSession->GetFrames().empty()) {
+        auto file = DiskFileSystem::OpenFile(Settings.RenderSessionRecord, true);
+        if (!file || !file.Write(_renderSession->Save())) {
+            WriteLog("Can't write render session file {}", Settings.RenderSessionRecord);
+        }
+    }
+
     delete ScriptSys;
 }
 
@@ -460,6 +490,8 @@ void FOClient::MainLoop()
     }
 
     // Input events
+    PROFILER_ZONE("ClientLoop");
+
     InputEvent event;
     while (App->Input.PollEvent(event)) {
         if (event.Type == InputEvent::EventType::MouseMoveEvent) {
@@ -476,7 +508,10 @@ void FOClient::MainLoop()
         _conn.Connect();
     }
 
-    _conn.Process();
+    {
+        PROFILER_ZONE("Network");
+        _conn.Process();
+    }
 
     // Exit in Login screen if net disconnect
     if (!_conn.IsConnected() && !IsMainScreen(SCREEN_LOGIN)) {
@@ -484,10 +519,18 @@ void FOClient::MainLoop()
     }
 
     // Input
-    ProcessInputEvents();
+    {
+        PROFILER_ZONE("Input");
+        ProcessInputEvents();
+    }
 
     // Process
-    AnimProcess();
+    ResMngr.ProcessLoading();
+
+    {
+        PROFILER_ZONE("Animations");
+        AnimProcess();
+    }
 
     // Game time
     if (time_changed) {
@@ -517,7 +560,10 @@ void FOClient::MainLoop()
 
 #if !FO_SINGLEPLAYER
     // Script loop
-    OnLoop.Fire();
+    {
+        PROFILER_ZONE("ScriptLoop");
+        OnLoop.Fire();
+    }
 #endif
 
     // Quake effect
@@ -525,10 +571,21 @@ void FOClient::MainLoop()
 
     // Render
     if (GetMainScreen() == SCREEN_GAME && CurMap != nullptr) {
+        PROFILER_ZONE("GameDraw");
         GameDraw();
     }
 
-    DrawIface();
+    {
+        PROFILER_ZONE("Interface");
+        DrawIface();
+    }
+
+    if (Settings.ShowDebugOverlay) {
+        DrawDebugOverlay();
+    }
+    if (FrameProfiler::IsEnabled()) {
+        FrameProfiler::DrawOverlay();
+    }
 
     ProcessScreenEffectFading();
 
@@ -548,6 +605,52 @@ void FOClient::DrawIface()
     CanDrawInScripts = false;
 }
 
+void FOClient::DrawDebugOverlay()
+{
+    string buf;
+
+    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::SetNextItemOpen(true, ImGuiCond_FirstUseEver);
+        if (ImGui::TreeNode("Render")) {
+            const auto render_stats = App->Render.GetStatistics();
+            buf = _str("FPS: {}\n", Settings.FPS);
+            buf += _str("Draw calls: {}, vertices: {}\n", render_stats.DrawCalls, render_stats.Vertices);
+            buf += _str("Effect switches: {}, texture switches: {}, state changes: {}\n", render_stats.EffectSwitches, render_stats.TextureSwitches, render_stats.StateChanges);
+            buf += _str("Uploaded: {} KB", render_stats.BytesUploaded / 1024);
+            ImGui::TextUnformatted(buf.c_str(), buf.c_str() + buf.size());
+            ImGui::TreePop();
+        }
+
+        ImGui::SetNextItemOpen(true, ImGuiCond_FirstUseEver);
+        if (ImGui::TreeNode("Atlases")) {
+            buf = "";
+            for (const auto atlas_type : {AtlasType::Static, AtlasType::Dynamic}) {
+                const auto atlas_stats = SprMngr.GetAtlasStatistics(atlas_type);
+                const auto occupancy = atlas_stats.TotalArea != 0 ? static_cast<double>(atlas_stats.UsedArea) * 100.0 / static_cast<double>(atlas_stats.TotalArea) : 0.0;
+                buf += _str("{}: {} atlases, {} sprites, occupancy {:.1f}%\n", atlas_type, atlas_stats.AtlasesCount, atlas_stats.SpritesCount, occupancy);
+            }
+            const auto dynamic_stats = SprMngr.GetAtlasStatistics(AtlasType::Dynamic);
+            buf += _str("Evicted sprites: {}, evictions: {}, refills: {}\n", dynamic_stats.EvictedSprites, dynamic_stats.Evictions, dynamic_stats.Refills);
+            buf += _str("Compaction moves: {}, released atlases: {}", dynamic_stats.CompactionMoves, dynamic_stats.AtlasesReleased);
+            ImGui::TextUnformatted(buf.c_str(), buf.c_str() + buf.size());
+            ImGui::TreePop();
+        }
+
+        if (const auto* loader_stats = ResMngr.GetLoaderStatistics(); loader_stats != nullptr) {
+            ImGui::SetNextItemOpen(true, ImGuiCond_FirstUseEver);
+            if (ImGui::TreeNode("Resource loading")) {
+                buf = _str("Requests: {}, completed: {}, canceled: {}, failed: {}\n", loader_stats->Requests, loader_stats->Completed, loader_stats->Canceled, loader_stats->Failed);
+                buf += _str("Pending: {}, in flight: {}\n", loader_stats->Pending, loader_stats->InFlight);
+                buf += _str("Upload time: {:.2f} ms (max {:.2f} ms)", loader_stats->LastProcessTime, loader_stats->MaxProcessTime);
+                ImGui::TextUnformatted(buf.c_str(), buf.c_str() + buf.size());
+                ImGui::TreePop();
+            }
+        }
+    }
+    ImGui::End();
+}
+
 void FOClient::ScreenFade(uint time, uint from_color, uint to_color, bool push_back)
 {
     if (!push_back || _screenEffects.empty()) {
@@ -3284,7 +3387,83 @@ void FOClient::GameDraw()
     }
 
     // Map
+    if (_renderSession) {
+        RenderSessionDraw();
+    }
+    else {
+        CurMap->DrawMap();
+    }
+}
+
+void FOClient::RenderSessionDraw()
+{
+    // Record view states of first shown map
+    if (!_renderSessionReplay) {
+        CurMap->DrawMap();
+
+        if (_renderSession->GetMapPid().empty()) {
+            _renderSession->SetMapPid(CurMapPid);
+        }
+
+        if (_renderSession->GetMapPid() == CurMapPid.as_str()) {
+            int hx;
+            int hy;
+            CurMap->GetScreenHexes(hx, hy);
+            _renderSession->AddFrame({hx, hy, Settings.ScrOx, Settings.ScrOy, Settings.SpritesZoom});
+        }
+        return;
+    }
+
+    // Replay begins when recorded map is shown
+    const auto& frames = _renderSession->GetFrames();
+    if (_renderSession->GetMapPid() != CurMapPid.as_str()) {
+        CurMap->DrawMap();
+        return;
+    }
+
+    // Render statistics available only for completed frame
+    if (!_renderSessionResults.empty()) {
+        _renderSessionResults.back().Stats = App->Render.GetStatistics();
+    }
+
+    if (_renderSessionResults.size() == frames.size()) {
+        const auto report = _renderSession->MakeReport(_renderSessionResults);
+        WriteLog("{}", report);
+
+        if (!Settings.RenderSessionReport.empty()) {
+            auto file = DiskFileSystem::OpenFile(Settings.RenderSessionReport, true);
+            if (!file || !file.Write(report)) {
+                WriteLog("Can't write render session report {}", Settings.RenderSessionReport);
+            }
+        }
+
+        _renderSession.reset();
+        _renderSessionResults.clear();
+        Settings.Quit = true;
+
+        CurMap->DrawMap();
+        return;
+    }
+
+    const auto& frame = frames[_renderSessionResults.size()];
+
+    if (frame.Zoom != Settings.SpritesZoom) {
+        CurMap->SetZoom(frame.Zoom);
+    }
+
+    int hx;
+    int hy;
+    CurMap->GetScreenHexes(hx, hy);
+    if (hx != frame.ScreenHexX || hy != frame.ScreenHexY) {
+        CurMap->RebuildMap(frame.ScreenHexX, frame.ScreenHexY);
+    }
+
+    Settings.ScrOx = frame.ScrOx;
+    Settings.ScrOy = frame.ScrOy;
+
+    const auto start_time = Timer::RealtimeTick();
     CurMap->DrawMap();
+    _renderSessionResults.push_back({Timer::RealtimeTick() - start_time, {}});
 }
 
 void FOClient::AddMess(uchar mess_type, string_view msg)
@@ -56,6 +56,7 @@
 #include "NetBuffer.h"
 #include "PlayerView.h"
 #include "ProtoManager.h"
+#include "RenderSession.h"
 #include "ResourceManager.h"
 #include "ScriptSystem.h"
 #include "ServerConnection.h"
@@ -296,7 +297,9 @@ class FOClient : public FOEngineBase, public AnimationResolver
     void TryExit();
     void FlashGameWindow();
     void DrawIface();
+    void DrawDebugOverlay();
     void GameDraw();
+    void RenderSessionDraw();
     void WaitDraw();
 
     void SetDayTime(bool refresh);
@@ -398,6 +401,9 @@ class FOClient : public FOEngineBase, public AnimationResolver
     LocationView* _curLocation {};
     uint _fpsTick {};
     uint _fpsCounter {};
+    unique_ptr<RenderSession> _renderSession {};
+    bool _renderSessionReplay {};
+    vector<RenderSession::FrameResult> _renderSessionResults {};
     int _screenModeMain {SCREEN_WAIT};
     ItemView* _someItem {};
     bool _initNetBegin {};
@@ -518,6 +518,15 @@ void CritterHexView::AnimateStay()
     ChangeOffs(ox, oy, false);
 }
 
+void CritterHexView::RefreshStayAnim()
+{
+    _stayAnim.Anim = nullptr;
+
+    if (!IsAnim()) {
+        AnimateStay();
+    }
+}
+
 auto CritterHexView::IsWalkAnim() const -> bool
 {
     if (!_animSequence.empty()) {
@@ -72,6 +72,7 @@ class CritterHexView final : public CritterView
     [[nodiscard]] auto IsFinished() const -> bool;
     [[nodiscard]] auto GetTextRect() const -> IRect;
     [[nodiscard]] auto GetAttackDist() -> uint;
+    [[nodiscard]] auto GetStayAnim() const -> const AnyFrames* { return _stayAnim.Anim; }
 #if FO_ENABLE_3D
     [[nodiscard]] auto IsModel() const -> bool { return _model != nullptr; }
     [[nodiscard]] auto GetModel() -> ModelInstance* { NON_CONST_METHOD_HINT_ONELINE() return _model; }
@@ -87,6 +88,7 @@ class CritterHexView final : public CritterView
     void ChangeDir(uchar dir, bool animate);
     void Animate(uint anim1, uint anim2, ItemView* item);
     void AnimateStay();
+    void RefreshStayAnim();
     void Action(int action, int action_ext, ItemView* item, bool local_call);
     void Process();
     void Move(uchar dir);
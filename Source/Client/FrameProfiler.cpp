@@ -0,0 +1,417 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "FrameProfiler.h"
+#include "DiskFileSystem.h"
+#include "Log.h"
+#include "StringUtils.h"
+#include "Timer.h"
+
+#include "imgui.h"
+
+static void SaveExport(string_view ext, string_view content);
+static void DrawFramesSummary(const vector<const FrameProfiler::Frame*>& frames);
+
+#if FO_ENABLE_PROFILER
+// Trivial type, safe to touch from allocations made during thread start and exit
+static thread_local size_t ThreadAllocations;
+#endif
+
+struct FrameProfilerData
+{
+    FrameProfilerData() { ZoneNames.reserve(FrameProfiler::MAX_ZONES); }
+
+    std::mutex ZonesLocker {};
+    vector<string> ZoneNames {};
+    bool Enabled {};
+    bool Paused {};
+    bool InFrame {};
+    std::thread::id FrameThread {};
+    double StartTime {};
+    size_t FrameStartAllocations {};
+    ushort Depth {};
+    array<FrameProfiler::Frame, FrameProfiler::HISTORY_FRAMES> Frames {};
+    size_t FramesCount {};
+    FrameProfiler::Frame* CurFrame {};
+};
+GLOBAL_DATA(FrameProfilerData, Data);
+
+FrameProfiler::Zone::Zone(uint zone_id) : _zoneId {zone_id}
+{
+    if (!Data->InFrame || std::this_thread::get_id() != Data->FrameThread) {
+        return;
+    }
+
+    _active = true;
+    _start = Timer::RealtimeTick();
+    _allocations = GetAllocationsCount();
+
+    auto& events = Data->CurFrame->Events;
+    if (events.size() < MAX_FRAME_EVENTS) {
+        _eventIndex = events.size();
+        events.push_back({static_cast<ushort>(_zoneId), Data->Depth, _start - Data->StartTime, 0.0, 0});
+    }
+    else {
+        _eventIndex = MAX_FRAME_EVENTS;
+        Data->CurFrame->DroppedEvents++;
+    }
+
+    Data->Depth++;
+}
+
+FrameProfiler::Zone::~Zone()
+{
+    // Frame may be finished by exception unwinding
+    if (!_active || !Data->InFrame) {
+        return;
+    }
+
+    Data->Depth--;
+
+    const auto duration = Timer::RealtimeTick() - _start;
+    const auto allocations = GetAllocationsCount() - _allocations;
+
+    auto& zone = Data->CurFrame->Zones[_zoneId];
+    zone.Time += duration;
+    zone.Calls++;
+    zone.Allocations += allocations;
+
+    if (_eventIndex < Data->CurFrame->Events.size()) {
+        auto& event = Data->CurFrame->Events[_eventIndex];
+        event.Duration = duration;
+        event.Allocations = allocations;
+    }
+}
+
+auto FrameProfiler::IsEnabled() -> bool
+{
+    return Data->Enabled;
+}
+
+void FrameProfiler::CountAllocation() noexcept
+{
+#if FO_ENABLE_PROFILER
+    ThreadAllocations++;
+#endif
+}
+
+auto FrameProfiler::GetAllocationsCount() -> size_t
+{
+#if FO_ENABLE_PROFILER
+    return ThreadAllocations;
+#else
+    return 0;
+#endif
+}
+
+auto FrameProfiler::RegisterZone(string_view name) -> uint
+{
+    std::lock_guard locker(Data->ZonesLocker);
+
+    const auto it = std::find(Data->ZoneNames.begin(), Data->ZoneNames.end(), name);
+    if (it != Data->ZoneNames.end()) {
+        return static_cast<uint>(it - Data->ZoneNames.begin());
+    }
+
+    // Last slot collects all zones above limit
+    if (Data->ZoneNames.size() == MAX_ZONES - 1) {
+        Data->ZoneNames.emplace_back("Other");
+    }
+    if (Data->ZoneNames.size() == MAX_ZONES) {
+        return static_cast<uint>(MAX_ZONES - 1);
+    }
+
+    Data->ZoneNames.emplace_back(name);
+    return static_cast<uint>(Data->ZoneNames.size() - 1);
+}
+
+auto FrameProfiler::GetZonesCount() -> size_t
+{
+    std::lock_guard locker(Data->ZonesLocker);
+
+    return Data->ZoneNames.size();
+}
+
+auto FrameProfiler::GetZoneName(uint zone_id) -> string_view
+{
+    std::lock_guard locker(Data->ZonesLocker);
+
+    RUNTIME_ASSERT(zone_id < Data->ZoneNames.size());
+    return Data->ZoneNames[zone_id];
+}
+
+void FrameProfiler::SetEnabled(bool enabled)
+{
+    if (Data->Enabled == enabled) {
+        return;
+    }
+
+    if (Data->InFrame) {
+        EndFrame();
+    }
+
+    Data->Enabled = enabled;
+}
+
+void FrameProfiler::BeginFrame()
+{
+    // Previous frame interrupted by exception
+    if (Data->InFrame) {
+        EndFrame();
+    }
+
+    if (!Data->Enabled || Data->Paused) {
+        return;
+    }
+
+    // Timer data may be not created yet at profiler data creation
+    if (Data->StartTime == 0.0) {
+        Data->StartTime = Timer::RealtimeTick();
+    }
+
+    auto& frame = Data->Frames[Data->FramesCount % HISTORY_FRAMES];
+    frame.Index = Data->FramesCount;
+    frame.Start = Timer::RealtimeTick() - Data->StartTime;
+    frame.Duration = 0.0;
+    frame.Allocations = 0;
+    frame.DroppedEvents = 0;
+    frame.Zones.assign(MAX_ZONES, ZoneStats());
+    // Capacity is kept, so ring frames stop allocating after first pass
+    frame.Events.clear();
+
+    Data->CurFrame = &frame;
+    Data->FrameThread = std::this_thread::get_id();
+    Data->FrameStartAllocations = GetAllocationsCount();
+    Data->Depth = 0;
+    Data->InFrame = true;
+}
+
+void FrameProfiler::EndFrame()
+{
+    if (!Data->InFrame) {
+        return;
+    }
+
+    auto& frame = *Data->CurFrame;
+    frame.Duration = Timer::RealtimeTick() - Data->StartTime - frame.Start;
+    frame.Allocations = GetAllocationsCount() - Data->FrameStartAllocations;
+
+    Data->InFrame = false;
+    Data->CurFrame = nullptr;
+    Data->FramesCount++;
+}
+
+void FrameProfiler::Clear()
+{
+    if (Data->InFrame) {
+        EndFrame();
+    }
+
+    Data->FramesCount = 0;
+}
+
+auto FrameProfiler::GetFrames() -> vector<const Frame*>
+{
+    vector<const Frame*> frames;
+
+    const auto count = std::min(Data->FramesCount, HISTORY_FRAMES);
+    frames.reserve(count);
+
+    for (auto i = Data->FramesCount - count; i < Data->FramesCount; i++) {
+        frames.push_back(&Data->Frames[i % HISTORY_FRAMES]);
+    }
+
+    return frames;
+}
+
+auto FrameProfiler::ExportCsv() -> string
+{
+    string result = "Frame,Zone,Time,Calls,Allocations\n";
+
+    for (const auto* frame : GetFrames()) {
+        result += _str("{},Frame,{:.4f},1,{}\n", frame->Index, frame->Duration, frame->Allocations);
+
+        for (size_t i = 0; i < frame->Zones.size(); i++) {
+            const auto& zone = frame->Zones[i];
+            if (zone.Calls != 0) {
+                result += _str("{},{},{:.4f},{},{}\n", frame->Index, GetZoneName(static_cast<uint>(i)), zone.Time, zone.Calls, zone.Allocations);
+            }
+        }
+    }
+
+    return result;
+}
+
+auto FrameProfiler::ExportChromeTrace() -> string
+{
+    // Trace event format, complete events with microsecond timestamps
+    string result = "{\"traceEvents\":[\n";
+    auto first = true;
+
+    const auto add_event = [&result, &first](string_view name, double start, double duration, size_t allocations) {
+        if (!first) {
+            result += ",\n";
+        }
+        first = false;
+
+        result += _str("{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"allocations\":{}}}}}", name, start * 1000.0, duration * 1000.0, allocations);
+    };
+
+    for (const auto* frame : GetFrames()) {
+        add_event(_str("Frame {}", frame->Index), frame->Start, frame->Duration, frame->Allocations);
+
+        for (const auto& event : frame->Events) {
+            add_event(GetZoneName(event.ZoneId), event.Start, event.Duration, event.Allocations);
+        }
+    }
+
+    result += "\n]}\n";
+    return result;
+}
+
+void FrameProfiler::DrawOverlay()
+{
+    const auto frames = GetFrames();
+
+    ImGui::SetNextWindowPos(ImVec2(10, 300), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::Checkbox("Pause", &Data->Paused);
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) {
+            Clear();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export CSV")) {
+            SaveExport("csv", ExportCsv());
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export trace")) {
+            SaveExport("json", ExportChromeTrace());
+        }
+
+        if (!frames.empty()) {
+            DrawFramesSummary(frames);
+        }
+        else {
+            ImGui::TextUnformatted("No frames recorded");
+        }
+    }
+    ImGui::End();
+}
+
+static void SaveExport(string_view ext, string_view content)
+{
+    const auto dt = Timer::GetCurrentDateTime();
+    const string fname = _str("Profiler_{:04}.{:02}.{:02}_{:02}-{:02}-{:02}.{}", dt.Year, dt.Month, dt.Day, dt.Hour, dt.Minute, dt.Second, ext);
+
+    if (DiskFileSystem::OpenFile(fname, true).Write(content)) {
+        WriteLog("Profiler data saved to '{}'", fname);
+    }
+    else {
+        WriteLog(LogType::Warning, "Can't write profiler data to '{}'", fname);
+    }
+}
+
+static void DrawFramesSummary(const vector<const FrameProfiler::Frame*>& frames)
+{
+    vector<float> frame_times;
+    frame_times.reserve(frames.size());
+    auto max_frame_time = 0.0;
+    auto total_frame_time = 0.0;
+    size_t total_allocations = 0;
+    for (const auto* frame : frames) {
+        frame_times.push_back(static_cast<float>(frame->Duration));
+        max_frame_time = std::max(max_frame_time, frame->Duration);
+        total_frame_time += frame->Duration;
+        total_allocations += frame->Allocations;
+    }
+
+    const auto frames_count = static_cast<double>(frames.size());
+    const string summary = _str("Frame avg {:.2f} ms, max {:.2f} ms, allocations {:.1f}", total_frame_time / frames_count, max_frame_time, static_cast<double>(total_allocations) / frames_count);
+    ImGui::TextUnformatted(summary.c_str());
+    ImGui::PlotLines("##FrameTimes", frame_times.data(), static_cast<int>(frame_times.size()), 0, nullptr, 0.0f, static_cast<float>(max_frame_time), ImVec2(400.0f, 60.0f));
+
+    struct ZoneSummary
+    {
+        uint ZoneId;
+        double TotalTime;
+        double MaxTime;
+        size_t Calls;
+        size_t Allocations;
+    };
+
+    vector<ZoneSummary> zones;
+    const auto zones_count = FrameProfiler::GetZonesCount();
+    for (uint i = 0; i < zones_count; i++) {
+        ZoneSummary summary_zone {i, 0.0, 0.0, 0, 0};
+        for (const auto* frame : frames) {
+            const auto& zone = frame->Zones[i];
+            summary_zone.TotalTime += zone.Time;
+            summary_zone.MaxTime = std::max(summary_zone.MaxTime, zone.Time);
+            summary_zone.Calls += zone.Calls;
+            summary_zone.Allocations += zone.Allocations;
+        }
+        if (summary_zone.Calls != 0) {
+            zones.push_back(summary_zone);
+        }
+    }
+
+    std::sort(zones.begin(), zones.end(), [](const ZoneSummary& z1, const ZoneSummary& z2) { return z1.TotalTime > z2.TotalTime; });
+
+    // Times are inclusive of nested zones
+    if (ImGui::BeginTable("Zones", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Avg ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Allocs");
+        ImGui::TableHeadersRow();
+
+        for (const auto& zone : zones) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            const auto name = FrameProfiler::GetZoneName(zone.ZoneId);
+            ImGui::TextUnformatted(name.data(), name.data() + name.size());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(_str("{:.3f}", zone.TotalTime / frames_count).c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(_str("{:.3f}", zone.MaxTime).c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(_str("{:.1f}", static_cast<double>(zone.Calls) / frames_count).c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(_str("{:.1f}", static_cast<double>(zone.Allocations) / frames_count).c_str());
+        }
+
+        ImGui::EndTable();
+    }
+}
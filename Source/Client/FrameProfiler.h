@@ -0,0 +1,122 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Scoped zones of client frame with rolling timeline of last frames
+// Zones are measured on thread that begins frames, collection is switched at runtime by SetEnabled
+// Build with FO_ENABLE_PROFILER=0 removes zones and allocation counting completely
+#if FO_ENABLE_PROFILER
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+#define PROFILER_ZONE(name) \
+    static const auto PROFILER_CONCAT(profiler_zone_id_, __LINE__) = FrameProfiler::RegisterZone(name); \
+    const FrameProfiler::Zone PROFILER_CONCAT(profiler_zone_, __LINE__)(PROFILER_CONCAT(profiler_zone_id_, __LINE__))
+#else
+#define PROFILER_ZONE(name)
+#endif
+
+class FrameProfiler final
+{
+public:
+    static constexpr size_t MAX_ZONES = 256;
+    static constexpr size_t HISTORY_FRAMES = 300;
+    static constexpr size_t MAX_FRAME_EVENTS = 4096;
+
+    struct ZoneStats
+    {
+        double Time {};
+        uint Calls {};
+        size_t Allocations {};
+    };
+
+    struct Event
+    {
+        ushort ZoneId {};
+        ushort Depth {};
+        double Start {};
+        double Duration {};
+        size_t Allocations {};
+    };
+
+    struct Frame
+    {
+        size_t Index {};
+        double Start {};
+        double Duration {};
+        size_t Allocations {};
+        size_t DroppedEvents {};
+        vector<ZoneStats> Zones {};
+        vector<Event> Events {};
+    };
+
+    class Zone final
+    {
+    public:
+        explicit Zone(uint zone_id);
+        Zone(const Zone&) = delete;
+        Zone(Zone&&) noexcept = delete;
+        auto operator=(const Zone&) = delete;
+        auto operator=(Zone&&) noexcept = delete;
+        ~Zone();
+
+    private:
+        uint _zoneId;
+        bool _active {};
+        size_t _eventIndex {};
+        double _start {};
+        size_t _allocations {};
+    };
+
+    FrameProfiler() = delete;
+
+    [[nodiscard]] static auto IsEnabled() -> bool;
+    [[nodiscard]] static auto GetZonesCount() -> size_t;
+    [[nodiscard]] static auto GetZoneName(uint zone_id) -> string_view;
+    // Oldest first
+    [[nodiscard]] static auto GetFrames() -> vector<const Frame*>;
+    // Counted for current thread by client application allocation hook, zero in other applications
+    [[nodiscard]] static auto GetAllocationsCount() -> size_t;
+    [[nodiscard]] static auto ExportCsv() -> string;
+    [[nodiscard]] static auto ExportChromeTrace() -> string;
+
+    static auto RegisterZone(string_view name) -> uint;
+    static void CountAllocation() noexcept;
+    static void SetEnabled(bool enabled);
+    static void BeginFrame();
+    static void EndFrame();
+    static void Clear();
+    static void DrawOverlay();
+};
@@ -33,6 +33,7 @@
 
 #include "MapView.h"
 #include "Client.h"
+#include "FrameProfiler.h"
 #include "GenericUtils.h"
 #include "LineTracer.h"
 #include "Log.h"
@@ -373,6 +374,8 @@ void MapView::EnableMapperMode()
 
 void MapView::Process()
 {
+    PROFILER_ZONE("MapProcess");
+
     if (_mapperMode) {
         for (auto* cr : copy(_critters)) {
             cr->Process();
@@ -415,6 +418,91 @@ void MapView::Process()
     }
 
     ProcessItems();
+
+    if (_engine->ResMngr.GetLoadingAnimsCount() != 0u || !_engine->ResMngr.GetFinishedAnims().empty()) {
+        ProcessResourcesLoading();
+    }
+}
+
+auto MapView::GetLoadingPriority(ushort hx, ushort hy) const -> int
+{
+    return static_cast<int>(_engine->GeomHelper.DistGame(_screenHexX, _screenHexY, hx, hy));
+}
+
+void MapView::ProcessResourcesLoading()
+{
+    auto& res_mngr = _engine->ResMngr;
+
+    // Closer to screen center are loaded first
+    if (res_mngr.GetLoadingAnimsCount() != 0u) {
+        for (const auto* item : _items) {
+            res_mngr.SetLoadingPriority(item->Anim, GetLoadingPriority(item->GetHexX(), item->GetHexY()));
+        }
+        for (const auto* cr : _critters) {
+            res_mngr.SetLoadingPriority(cr->GetStayAnim(), GetLoadingPriority(cr->GetHexX(), cr->GetHexY()));
+        }
+        for (const auto& tile : _loadingTiles) {
+            res_mngr.SetLoadingPriority(tile.Anim, GetLoadingPriority(tile.HexX, tile.HexY));
+        }
+    }
+
+    const auto& finished_anims = res_mngr.GetFinishedAnims();
+    if (finished_anims.empty()) {
+        return;
+    }
+
+    // Replace placeholders with real frames
+    const unordered_set<const AnyFrames*> finished(finished_anims.begin(), finished_anims.end());
+    auto resized = false;
+    auto tiles_changed = false;
+
+    for (auto* item : _items) {
+        if (finished.count(item->Anim) != 0u) {
+            item->RefreshAnim();
+            resized |= ProcessHexBorders(item->Anim->GetSprId(0), item->GetOffsetX(), item->GetOffsetY(), false);
+        }
+    }
+
+    for (auto* cr : _critters) {
+        if (finished.count(cr->GetStayAnim()) != 0u) {
+            cr->RefreshStayAnim();
+        }
+    }
+
+    for (auto it = _loadingTiles.begin(); it != _loadingTiles.end();) {
+        if (finished.count(it->Anim) != 0u) {
+            resized |= ProcessHexBorders(it->Anim->GetSprId(0), it->OffsX, it->OffsY, false);
+            tiles_changed = true;
+            it = _loadingTiles.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    if (resized) {
+        ResizeView();
+        RefreshMap();
+    }
+    else if (tiles_changed) {
+        RebuildTiles();
+        RebuildRoof();
+    }
+}
+
+void MapView::PrefetchCritterAnims(CritterHexView* cr)
+{
+#if FO_ENABLE_3D
+    if (cr->IsModel()) {
+        return;
+    }
+#endif
+
+    // Movement is usually next after map entering
+    const auto priority = PREFETCH_LOADING_PRIORITY + GetLoadingPriority(cr->GetHexX(), cr->GetHexY());
+    for (const auto anim2 : {ANIM2_WALK, ANIM2_RUN}) {
+        _engine->ResMngr.PrefetchCritterAnim(cr->GetModelName(), cr->GetAnim1(), anim2, priority);
+    }
 }
 
 void MapView::AddTile(const MapTile& tile)
@@ -434,6 +522,13 @@ void MapView::AddTile(const MapTile& tile)
         Field& field = GetField(tile.HexX, tile.HexY);
         Field::Tile& ftile = field.AddTile(anim, tile.OffsX, tile.OffsY, tile.Layer, tile.IsRoof);
         ProcessTileBorder(ftile, tile.IsRoof);
+
+        // Borders and sprites are evaluated again when placeholder is replaced
+        if (_engine->ResMngr.IsAnimLoading(anim)) {
+            const auto ox = (tile.IsRoof ? _engine->Settings.MapRoofOffsX : _engine->Settings.MapTileOffsX) + tile.OffsX;
+            const auto oy = (tile.IsRoof ? _engine->Settings.MapRoofOffsY : _engine->Settings.MapTileOffsY) + tile.OffsY;
+            _loadingTiles.push_back({anim, tile.HexX, tile.HexY, ox, oy});
+        }
     }
 }
 
@@ -633,6 +728,8 @@ void MapView::DestroyItem(ItemHexView* item)
 
 void MapView::ProcessItems()
 {
+    PROFILER_ZONE("MapItems");
+
     for (auto* item : copy(_items)) {
         item->Process();
 
@@ -885,6 +982,8 @@ void MapView::DrawCursor(string_view text)
 
 void MapView::RebuildMap(int rx, int ry)
 {
+    PROFILER_ZONE("RebuildMap");
+
     RUNTIME_ASSERT(_viewField);
 
     for (auto i = 0, j = _hVisible * _wVisible; i < j; i++) {
@@ -1043,6 +1142,10 @@ void MapView::RebuildMapOffset(int ox, int oy)
     RUNTIME_ASSERT(ox == 0 || ox == -1 || ox == 1);
     RUNTIME_ASSERT(oy == 0 || oy == -2 || oy == 2);
 
+    // Screen positions of all hexes are shifted
+    _tilesCache.Invalidate();
+    _roofCache.Invalidate();
+
     auto hide_hex = [this](ViewField& vf) {
         const auto nxi = vf.HexX;
         const auto nyi = vf.HexY;
@@ -1320,6 +1423,8 @@ void MapView::ClearHexLight()
 
 void MapView::PrepareLightToDraw()
 {
+    PROFILER_ZONE("PrepareLight");
+
     if (_rtLight == nullptr) {
         return;
     }
@@ -1719,6 +1824,8 @@ void MapView::ParseLightTriangleFan(LightSource& ls)
 
 void MapView::RealRebuildLight()
 {
+    PROFILER_ZONE("RebuildLight");
+
     RUNTIME_ASSERT(_viewField);
 
     _lightPointsCount = 0;
@@ -1792,6 +1899,7 @@ auto MapView::ProcessTileBorder(Field::Tile& tile, bool is_roof) -> bool
 void MapView::RebuildTiles()
 {
     _tilesTree.Unvalidate();
+    _tilesCache.Invalidate();
 
     if (!_engine->Settings.ShowTile) {
         return;
@@ -1845,6 +1953,7 @@ void MapView::RebuildTiles()
 void MapView::RebuildRoof()
 {
     _roofTree.Unvalidate();
+    _roofCache.Invalidate();
 
     if (!_engine->Settings.ShowRoof) {
         return;
@@ -2212,6 +2321,9 @@ void MapView::ChangeZoom(int zoom)
         _engine->Settings.SpritesZoom = 1.0f;
     }
 
+    _tilesCache.Invalidate();
+    _roofCache.Invalidate();
+
     ResizeView();
     RefreshMap();
 
@@ -2220,6 +2332,17 @@ void MapView::ChangeZoom(int zoom)
     }
 }
 
+void MapView::SetZoom(float zoom)
+{
+    _engine->Settings.SpritesZoom = std::clamp(zoom, std::max(_engine->Settings.SpritesZoomMin, MIN_ZOOM), std::min(_engine->Settings.SpritesZoomMax, MAX_ZOOM));
+
+    _tilesCache.Invalidate();
+    _roofCache.Invalidate();
+
+    ResizeView();
+    RefreshMap();
+}
+
 void MapView::GetScreenHexes(int& sx, int& sy) const
 {
     sx = _screenHexX;
@@ -2241,6 +2364,8 @@ void MapView::GetHexCurrentPosition(ushort hx, ushort hy, int& x, int& y) const
 
 void MapView::DrawMap()
 {
+    PROFILER_ZONE("DrawMap");
+
     // Prepare light
     PrepareLightToDraw();
 
@@ -2260,7 +2385,7 @@ void MapView::DrawMap()
 
     // Tiles
     if (_engine->Settings.ShowTile) {
-        _engine->SprMngr.DrawSprites(_tilesTree, false, false, DRAW_ORDER_TILE, DRAW_ORDER_TILE_END, false, 0, 0);
+        _engine->SprMngr.DrawCachedSprites(_tilesTree, _tilesCache, false, DRAW_ORDER_TILE, DRAW_ORDER_TILE_END);
     }
 
     // Flat sprites
@@ -2279,7 +2404,7 @@ void MapView::DrawMap()
 
     // Roof
     if (_engine->Settings.ShowRoof) {
-        _engine->SprMngr.DrawSprites(_roofTree, false, true, DRAW_ORDER_TILE, DRAW_ORDER_TILE_END, false, 0, 0);
+        _engine->SprMngr.DrawCachedSprites(_roofTree, _roofCache, true, DRAW_ORDER_TILE, DRAW_ORDER_TILE_END);
     }
 
     // Contours
@@ -2897,6 +3022,8 @@ void MapView::AddCritter(CritterHexView* cr)
 
     cr->Init();
 
+    PrefetchCritterAnims(cr);
+
     const auto game_tick = _engine->GameTime.GameTick();
     cr->FadingTick = game_tick + FADING_PERIOD - (fading_tick > game_tick ? fading_tick - game_tick : 0);
 }
@@ -200,6 +200,7 @@ class MapView final : public ClientEntity, public MapProperties
     void OnResolutionChanged();
 
     void ChangeZoom(int zoom); // < 0 in, > 0 out, 0 normalize
+    void SetZoom(float zoom);
 
     void GetScreenHexes(int& sx, int& sy) const;
     void GetHexCurrentPosition(ushort hx, ushort hy, int& x, int& y) const;
@@ -302,13 +303,27 @@ class MapView final : public ClientEntity, public MapProperties
         IRect EndPos {};
     };
 
+    struct LoadingTile
+    {
+        const AnyFrames* Anim {};
+        ushort HexX {};
+        ushort HexY {};
+        int OffsX {};
+        int OffsY {};
+    };
+
+    static constexpr int PREFETCH_LOADING_PRIORITY = 1000;
+
     [[nodiscard]] auto IsVisible(uint spr_id, int ox, int oy) const -> bool;
+    [[nodiscard]] auto GetLoadingPriority(ushort hx, ushort hy) const -> int;
     [[nodiscard]] auto GetViewWidth() const -> int;
     [[nodiscard]] auto GetViewHeight() const -> int;
     [[nodiscard]] auto ScrollCheckPos(int (&positions)[4], int dir1, int dir2) -> bool;
     [[nodiscard]] auto ScrollCheck(int xmod, int ymod) -> bool;
 
     void ProcessItems();
+    void ProcessResourcesLoading();
+    void PrefetchCritterAnims(CritterHexView* cr);
 
     void AddCritter(CritterHexView* cr);
     void AddCritterToField(CritterHexView* cr);
@@ -347,6 +362,8 @@ class MapView final : public ClientEntity, public MapProperties
     Sprites _mainTree;
     Sprites _tilesTree;
     Sprites _roofTree;
+    SpriteChunkCache _tilesCache {};
+    SpriteChunkCache _roofCache {};
     ushort _maxHexX {};
     ushort _maxHexY {};
     Field* _hexField {};
@@ -371,6 +388,7 @@ class MapView final : public ClientEntity, public MapProperties
     ViewField* _viewField {};
     int _screenHexX {};
     int _screenHexY {};
+    vector<LoadingTile> _loadingTiles {};
     int _hTop {};
     int _hBottom {};
     int _wLeft {};
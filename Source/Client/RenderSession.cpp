@@ -0,0 +1,118 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "RenderSession.h"
+#include "StringUtils.h"
+
+auto RenderSession::Save() const -> string
+{
+    std::ostringstream str;
+
+    str << "map " << _mapPid << "\n";
+    for (const auto& frame : _frames) {
+        str << frame.ScreenHexX << " " << frame.ScreenHexY << " " << frame.ScrOx << " " << frame.ScrOy << " " << frame.Zoom << "\n";
+    }
+
+    return str.str();
+}
+
+void RenderSession::Load(string_view data)
+{
+    _mapPid.clear();
+    _frames.clear();
+
+    std::istringstream str {string(data)};
+    string token;
+    if (!(str >> token) || token != "map" || !(str >> _mapPid)) {
+        throw RenderSessionException("Invalid render session header");
+    }
+
+    Frame frame;
+    while (str >> frame.ScreenHexX >> frame.ScreenHexY >> frame.ScrOx >> frame.ScrOy >> frame.Zoom) {
+        _frames.emplace_back(frame);
+    }
+
+    if (!str.eof()) {
+        throw RenderSessionException("Invalid render session frame", _frames.size());
+    }
+}
+
+void RenderSession::SetMapPid(string_view map_pid)
+{
+    _mapPid = map_pid;
+}
+
+void RenderSession::AddFrame(const Frame& frame)
+{
+    _frames.emplace_back(frame);
+}
+
+auto RenderSession::MakeReport(const vector<FrameResult>& results) const -> string
+{
+    if (results.empty()) {
+        return _str("Render session on map {}: no frames drawn", _mapPid);
+    }
+
+    vector<double> times;
+    times.reserve(results.size());
+    RenderStatistics total;
+    for (const auto& result : results) {
+        times.emplace_back(result.DrawMapTime);
+        total.DrawCalls += result.Stats.DrawCalls;
+        total.Vertices += result.Stats.Vertices;
+        total.EffectSwitches += result.Stats.EffectSwitches;
+        total.TextureSwitches += result.Stats.TextureSwitches;
+        total.StateChanges += result.Stats.StateChanges;
+        total.BytesUploaded += result.Stats.BytesUploaded;
+    }
+
+    std::sort(times.begin(), times.end());
+    const auto count = results.size();
+    const auto avg_time = std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(count);
+    const auto percentile = [&times](double p) { return times[std::min(times.size() - 1, static_cast<size_t>(static_cast<double>(times.size()) * p))]; };
+
+    std::ostringstream str;
+    str << _str("Render session on map {}, {} frames\n", _mapPid, count).str();
+    str << _str("DrawMap time ms: avg {:.3f}, min {:.3f}, p50 {:.3f}, p95 {:.3f}, max {:.3f}\n", avg_time, times.front(), percentile(0.5), percentile(0.95), times.back()).str();
+    str << _str("Per frame: draw calls {}, vertices {}, effect switches {}, texture switches {}, state changes {}, bytes uploaded {}\n", //
+        total.DrawCalls / count, total.Vertices / count, total.EffectSwitches / count, total.TextureSwitches / count, total.StateChanges / count, total.BytesUploaded / count)
+               .str();
+
+    str << "frame,drawmap_ms,draw_calls,vertices,effect_switches,texture_switches,state_changes,bytes_uploaded\n";
+    for (size_t i = 0; i < count; i++) {
+        const auto& r = results[i];
+        str << _str("{},{:.3f},{},{},{},{},{},{}\n", i, r.DrawMapTime, r.Stats.DrawCalls, r.Stats.Vertices, r.Stats.EffectSwitches, r.Stats.TextureSwitches, r.Stats.StateChanges, r.Stats.BytesUploaded).str();
+    }
+
+    return str.str();
+}
@@ -0,0 +1,80 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "Rendering.h"
+
+DECLARE_EXCEPTION(RenderSessionException);
+
+// Map view states recorded by client and replayed through MapView::DrawMap to benchmark map rendering
+class RenderSession final
+{
+public:
+    struct Frame
+    {
+        int ScreenHexX {};
+        int ScreenHexY {};
+        int ScrOx {};
+        int ScrOy {};
+        float Zoom {};
+    };
+
+    struct FrameResult
+    {
+        double DrawMapTime {}; // Milliseconds
+        RenderStatistics Stats {}; // Whole frame
+    };
+
+    RenderSession() = default;
+    RenderSession(const RenderSession&) = delete;
+    RenderSession(RenderSession&&) noexcept = default;
+    auto operator=(const RenderSession&) = delete;
+    auto operator=(RenderSession&&) noexcept -> RenderSession& = default;
+    ~RenderSession() = default;
+
+    [[nodiscard]] auto GetMapPid() const -> const string& { return _mapPid; }
+    [[nodiscard]] auto GetFrames() const -> const vector<Frame>& { return _frames; }
+    [[nodiscard]] auto Save() const -> string;
+    [[nodiscard]] auto MakeReport(const vector<FrameResult>& results) const -> string;
+
+    void Load(string_view data);
+    void SetMapPid(string_view map_pid);
+    void AddFrame(const Frame& frame);
+
+private:
+    string _mapPid {};
+    vector<Frame> _frames {};
+};
@@ -0,0 +1,208 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "ResourceLoader.h"
+#include "Log.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+ResourceLoader::ResourceLoader(size_t threads_count, size_t max_in_flight) : _maxInFlight {max_in_flight}
+{
+    RUNTIME_ASSERT(_maxInFlight > 0);
+
+    _threadPool = std::make_unique<ThreadPool>(threads_count);
+}
+
+ResourceLoader::~ResourceLoader()
+{
+    // Let workers finish with requests before they are released
+    _threadPool.reset();
+}
+
+auto ResourceLoader::IsPending(uint request_id) const -> bool
+{
+    return _requests.count(request_id) != 0u;
+}
+
+auto ResourceLoader::AddRequest(int priority, LoadJob load, CompleteJob complete) -> uint
+{
+    auto request = std::make_shared<Request>();
+    request->Id = ++_lastRequestId;
+    request->Priority = priority;
+    request->Load = std::move(load);
+    request->Complete = std::move(complete);
+
+    _requests.emplace(request->Id, request);
+    _stats.Requests++;
+
+    // Dispatched on next Process call, so priority still may be adjusted
+    return request->Id;
+}
+
+void ResourceLoader::SetPriority(uint request_id, int priority)
+{
+    if (const auto it = _requests.find(request_id); it != _requests.end()) {
+        it->second->Priority = priority;
+    }
+}
+
+void ResourceLoader::Cancel(uint request_id)
+{
+    const auto it = _requests.find(request_id);
+    if (it == _requests.end()) {
+        return;
+    }
+
+    // Worker may still use request data
+    if (it->second->Dispatched) {
+        _canceledInFlight.emplace_back(std::move(it->second));
+    }
+
+    _requests.erase(it);
+    _stats.Canceled++;
+}
+
+auto ResourceLoader::Process(uint time_budget) -> size_t
+{
+    const auto start_time = Timer::RealtimeTick();
+
+    _readyBuf.clear();
+    for (auto&& [id, request] : _requests) {
+        if (request->Done) {
+            _readyBuf.emplace_back(request);
+        }
+    }
+
+    std::sort(_readyBuf.begin(), _readyBuf.end(), [](const shared_ptr<Request>& r1, const shared_ptr<Request>& r2) { return r1->Priority != r2->Priority ? r1->Priority < r2->Priority : r1->Id < r2->Id; });
+
+    size_t completed = 0;
+    // Completion jobs may add new requests, ready list is kept separately from dispatch list
+    for (auto&& request : _readyBuf) {
+        if (completed != 0 && Timer::RealtimeTick() - start_time >= static_cast<double>(time_budget)) {
+            break;
+        }
+
+        // Previous completions may cancel other requests
+        if (_requests.erase(request->Id) == 0u) {
+            continue;
+        }
+
+        RUNTIME_ASSERT(_inFlight > 0);
+        _inFlight--;
+
+        if (request->Error) {
+            _stats.Failed++;
+
+            try {
+                std::rethrow_exception(request->Error);
+            }
+            catch (const std::exception& ex) {
+                ReportExceptionAndContinue(ex);
+            }
+        }
+
+        request->Complete();
+
+        _stats.Completed++;
+        completed++;
+    }
+
+    _readyBuf.clear();
+
+    Dispatch();
+
+    _stats.LastProcessTime = Timer::RealtimeTick() - start_time;
+    _stats.MaxProcessTime = std::max(_stats.MaxProcessTime, _stats.LastProcessTime);
+
+    return completed;
+}
+
+void ResourceLoader::WaitAll()
+{
+    while (!_requests.empty()) {
+        _threadPool->Wait();
+        Process(std::numeric_limits<uint>::max());
+    }
+}
+
+void ResourceLoader::Dispatch()
+{
+    for (auto it = _canceledInFlight.begin(); it != _canceledInFlight.end();) {
+        if ((*it)->Done) {
+            RUNTIME_ASSERT(_inFlight > 0);
+            _inFlight--;
+            it = _canceledInFlight.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    _stats.Pending = _requests.size();
+    _stats.InFlight = _inFlight;
+
+    if (_inFlight >= _maxInFlight) {
+        return;
+    }
+
+    _sortBuf.clear();
+    for (auto&& [id, request] : _requests) {
+        if (!request->Dispatched) {
+            _sortBuf.emplace_back(request);
+        }
+    }
+
+    const auto dispatch_count = std::min(_maxInFlight - _inFlight, _sortBuf.size());
+    std::partial_sort(_sortBuf.begin(), _sortBuf.begin() + static_cast<ptrdiff_t>(dispatch_count), _sortBuf.end(), [](const shared_ptr<Request>& r1, const shared_ptr<Request>& r2) { return r1->Priority != r2->Priority ? r1->Priority < r2->Priority : r1->Id < r2->Id; });
+
+    for (size_t i = 0; i < dispatch_count; i++) {
+        auto&& request = _sortBuf[i];
+        request->Dispatched = true;
+        _inFlight++;
+
+        _threadPool->AddJob([request] {
+            try {
+                request->Load();
+            }
+            catch (...) {
+                request->Error = std::current_exception();
+            }
+
+            request->Done = true;
+        });
+    }
+
+    _sortBuf.clear();
+
+    _stats.InFlight = _inFlight;
+}
@@ -0,0 +1,103 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+class ThreadPool;
+
+// Reads and decodes resources on worker threads, results are handed back to main thread in Process
+// Requests with lower priority value are dispatched and completed first
+class ResourceLoader final
+{
+public:
+    using LoadJob = std::function<void()>;
+    using CompleteJob = std::function<void()>;
+
+    struct Statistics
+    {
+        size_t Requests {};
+        size_t Completed {};
+        size_t Canceled {};
+        size_t Failed {};
+        size_t Pending {};
+        size_t InFlight {};
+        double LastProcessTime {};
+        double MaxProcessTime {};
+    };
+
+    ResourceLoader() = delete;
+    ResourceLoader(size_t threads_count, size_t max_in_flight);
+    ResourceLoader(const ResourceLoader&) = delete;
+    ResourceLoader(ResourceLoader&&) noexcept = delete;
+    auto operator=(const ResourceLoader&) = delete;
+    auto operator=(ResourceLoader&&) noexcept = delete;
+    ~ResourceLoader();
+
+    [[nodiscard]] auto IsPending(uint request_id) const -> bool;
+    [[nodiscard]] auto GetPendingCount() const -> size_t { return _requests.size(); }
+    [[nodiscard]] auto GetStatistics() const -> const Statistics& { return _stats; }
+
+    // Load job is called on worker thread, complete job on main thread within Process or WaitAll
+    auto AddRequest(int priority, LoadJob load, CompleteJob complete) -> uint;
+    void SetPriority(uint request_id, int priority);
+    void Cancel(uint request_id);
+    // Time budget in milliseconds, at least one finished request is completed per call
+    auto Process(uint time_budget) -> size_t;
+    void WaitAll();
+
+private:
+    struct Request
+    {
+        uint Id {};
+        int Priority {};
+        LoadJob Load {};
+        CompleteJob Complete {};
+        bool Dispatched {};
+        std::exception_ptr Error {};
+        std::atomic_bool Done {};
+    };
+
+    void Dispatch();
+
+    size_t _maxInFlight;
+    uint _lastRequestId {};
+    unordered_map<uint, shared_ptr<Request>> _requests {};
+    vector<shared_ptr<Request>> _canceledInFlight {};
+    size_t _inFlight {};
+    vector<shared_ptr<Request>> _sortBuf {};
+    vector<shared_ptr<Request>> _readyBuf {};
+    Statistics _stats {};
+    unique_ptr<ThreadPool> _threadPool {};
+};
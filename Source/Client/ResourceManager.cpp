@@ -35,14 +35,21 @@
 #include "3dStuff.h"
 #include "DataSource.h"
 #include "FileSystem.h"
+#include "FrameProfiler.h"
 #include "GenericUtils.h"
 #include "StringUtils.h"
+#include "ThreadPool.h"
 
 static constexpr uint ANIM_FLAG_FIRST_FRAME = 0x01;
 static constexpr uint ANIM_FLAG_LAST_FRAME = 0x02;
 
-ResourceManager::ResourceManager(FileSystem& file_sys, SpriteManager& spr_mngr, AnimationResolver& anim_name_resolver, NameResolver& name_resolver) : _fileSys {file_sys}, _sprMngr {spr_mngr}, _animNameResolver {anim_name_resolver}, _nameResolver {name_resolver}
+ResourceManager::ResourceManager(RenderSettings& settings, FileSystem& file_sys, SpriteManager& spr_mngr, AnimationResolver& anim_name_resolver, NameResolver& name_resolver) : _settings {settings}, _fileSys {file_sys}, _sprMngr {spr_mngr}, _animNameResolver {anim_name_resolver}, _nameResolver {name_resolver}
 {
+    if (_settings.AsyncResourceLoading) {
+        const auto threads_count = _settings.ResourceLoadingThreads != 0u ? static_cast<size_t>(_settings.ResourceLoadingThreads) : ThreadPool::GetDefaultThreadsCount();
+        _loader = std::make_unique<ResourceLoader>(threads_count, threads_count * 2);
+    }
+
     {
         auto allFiles = _fileSys.FilterFiles("", "", true);
         while (allFiles.MoveNext()) {
@@ -77,6 +84,28 @@ void ResourceManager::FreeResources(AtlasType atlas_type)
 {
     RUNTIME_ASSERT(atlas_type == AtlasType::Static || atlas_type == AtlasType::Dynamic);
 
+    // Placeholders are destroyed below, drop their requests
+    for (auto it = _loadingAnims.begin(); it != _loadingAnims.end();) {
+        if (it->second.ResType == atlas_type) {
+            _loader->Cancel(it->second.RequestId);
+            it = _loadingAnims.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    _finishedAnims.clear();
+
+    if (atlas_type == AtlasType::Dynamic) {
+        for (auto&& [anim, evictable] : _evictableAnims) {
+            if (evictable.ReloadRequestId != 0u) {
+                _loader->Cancel(evictable.ReloadRequestId);
+            }
+        }
+        _evictableAnims.clear();
+        _evictedAnims.clear();
+    }
+
     _sprMngr.DestroyAtlases(atlas_type);
 
     for (auto it = _loadedAnims.begin(); it != _loadedAnims.end();) {
@@ -103,6 +132,11 @@ void ResourceManager::FreeResources(AtlasType atlas_type)
 
 void ResourceManager::ReinitializeDynamicAtlas()
 {
+    // Atlases are kept between maps and cold animations are evicted on demand
+    if (_loader && _settings.DynamicAtlasBudget != 0u && CritterDefaultAnim != nullptr && ItemHexDefaultAnim != nullptr) {
+        return;
+    }
+
     FreeResources(AtlasType::Dynamic);
     _sprMngr.PushAtlasType(AtlasType::Dynamic);
     _sprMngr.InitializeEgg("TransparentEgg.png");
@@ -121,16 +155,210 @@ auto ResourceManager::GetAnim(hstring name, AtlasType atlas_type) -> AnyFrames*
         return it->second.Anim;
     }
 
-    _sprMngr.PushAtlasType(atlas_type);
-    auto* anim = _sprMngr.LoadAnimation(name, false, true);
-    _sprMngr.PopAtlasType();
-
-    anim->Name = name;
+    auto* anim = LoadAnim(name, atlas_type, ItemHexDefaultAnim, nullptr);
+    if (anim != nullptr) {
+        anim->Name = name;
+    }
 
     _loadedAnims.insert(std::make_pair(name, LoadedAnim {atlas_type, anim}));
     return anim;
 }
 
+auto ResourceManager::LoadAnim(string_view fname, AtlasType atlas_type, const AnyFrames* placeholder, const std::function<void(AnyFrames*)>& on_loaded) -> AnyFrames*
+{
+    const string ext = _str(fname).getFileExtension();
+    const auto is_model = ext == "fo3d" || ext == "fbx" || ext == "dae" || ext == "obj";
+
+    // Interface layout may depend on sprite sizes and models render to sprites at load, keep them synchronous
+    if (!_loader || atlas_type != AtlasType::Dynamic || ext.empty() || is_model) {
+        _sprMngr.PushAtlasType(atlas_type);
+        auto* anim = _sprMngr.LoadAnimation(fname, false, true);
+        _sprMngr.PopAtlasType();
+
+        if (anim != nullptr && on_loaded) {
+            on_loaded(anim);
+        }
+        return anim;
+    }
+
+    if (!_fileSys.ReadFileHeader(fname)) {
+        return nullptr;
+    }
+
+    // Placeholder frame is filled in place when file is read, so pointer stays valid for holders
+    auto* anim = _sprMngr.CreateAnyFrames(1, 100);
+    anim->DirCount = 1;
+    anim->Ind[0] = placeholder != nullptr ? placeholder->GetSprId(0) : 0u;
+
+    auto data = std::make_shared<unique_ptr<Animation2dData>>();
+    const auto request_id = _loader->AddRequest(
+        0, [data, spr_mngr = &_sprMngr, fname_ = string(fname)] { *data = spr_mngr->Read2dAnimation(fname_); },
+        [this, data, anim, atlas_type, on_loaded, fname_ = string(fname)] {
+            _loadingAnims.erase(anim);
+
+            if (*data) {
+                _sprMngr.PushAtlasType(atlas_type);
+                _sprMngr.Fill2dAnimation(anim, **data);
+                _sprMngr.PopAtlasType();
+
+                _evictableAnims.emplace(anim, EvictableAnim {fname_});
+
+                if (on_loaded) {
+                    on_loaded(anim);
+                }
+            }
+
+            _finishedAnims.emplace_back(anim);
+        });
+
+    _loadingAnims.emplace(anim, LoadingAnim {atlas_type, request_id});
+    return anim;
+}
+
+void ResourceManager::PrefetchAnim(hstring name, AtlasType atlas_type, int priority)
+{
+    if (!_loader) {
+        return;
+    }
+
+    SetLoadingPriority(GetAnim(name, atlas_type), priority);
+}
+
+void ResourceManager::PrefetchCritterAnim(hstring model_name, uint anim1, uint anim2, int priority)
+{
+    if (!_loader) {
+        return;
+    }
+
+    SetLoadingPriority(GetCritterAnim(model_name, anim1, anim2, 0), priority);
+}
+
+void ResourceManager::SetLoadingPriority(const AnyFrames* anim, int priority)
+{
+    if (const auto it = _loadingAnims.find(anim); it != _loadingAnims.end()) {
+        _loader->SetPriority(it->second.RequestId, priority);
+    }
+}
+
+void ResourceManager::ProcessLoading()
+{
+    PROFILER_ZONE("ResourceLoading");
+
+    _finishedAnims.clear();
+
+    if (!_loader) {
+        return;
+    }
+
+    // Animations finished in one frame are placed to atlases in one batch
+    const auto accumulate = !_sprMngr.IsAccumulateAtlasActive();
+    if (accumulate) {
+        _sprMngr.AccumulateAtlasData();
+    }
+
+    _loader->Process(_settings.ResourceUploadTimeBudget);
+
+    ProcessAtlasEviction();
+
+    if (accumulate) {
+        _sprMngr.FlushAccumulatedAtlasData();
+    }
+}
+
+auto ResourceManager::GetAnimUsedFrame(AnyFrames* anim) const -> uint
+{
+    uint used_frame = 0;
+
+    for (auto dir = 0; dir < anim->DirCount; dir++) {
+        const auto* dir_anim = anim->GetDir(dir);
+        for (uint i = 0; i < dir_anim->CntFrm; i++) {
+            if (const auto* si = _sprMngr.GetSpriteInfo(dir_anim->Ind[i]); si != nullptr) {
+                used_frame = std::max(used_frame, si->UsedFrame);
+            }
+        }
+    }
+
+    return used_frame;
+}
+
+void ResourceManager::ProcessAtlasEviction()
+{
+    if (_settings.DynamicAtlasBudget == 0u) {
+        return;
+    }
+
+    const auto frame_index = _sprMngr.GetFrameIndex();
+
+    // Evicted animations touched by drawing are read again and placed back to their sprites
+    for (auto it = _evictedAnims.begin(); it != _evictedAnims.end();) {
+        auto* anim = *it;
+        auto& evictable = _evictableAnims.at(anim);
+
+        if (GetAnimUsedFrame(anim) <= evictable.EvictFrame) {
+            ++it;
+            continue;
+        }
+
+        auto data = std::make_shared<unique_ptr<Animation2dData>>();
+        evictable.ReloadRequestId = _loader->AddRequest(
+            0, [data, spr_mngr = &_sprMngr, fname = evictable.FileName] { *data = spr_mngr->Read2dAnimation(fname); },
+            [this, data, anim] {
+                auto& reloaded = _evictableAnims.at(anim);
+                reloaded.Evicted = false;
+                reloaded.ReloadRequestId = 0;
+
+                if (*data) {
+                    _sprMngr.RefillAnyFrames(anim, **data);
+                }
+            });
+
+        it = _evictedAnims.erase(it);
+    }
+
+    // Budget check is not needed every frame
+    if (frame_index % 30u != 0u) {
+        return;
+    }
+
+    const auto stats = _sprMngr.GetAtlasStatistics(AtlasType::Dynamic);
+    if (stats.AtlasesCount < _settings.DynamicAtlasBudget) {
+        return;
+    }
+
+    // Least recently drawn first
+    vector<pair<uint, AnyFrames*>> cold_anims;
+    for (auto&& [anim, evictable] : _evictableAnims) {
+        if (evictable.Evicted) {
+            continue;
+        }
+
+        const auto used_frame = GetAnimUsedFrame(anim);
+        if (frame_index - used_frame >= _settings.AtlasEvictionFrames) {
+            cold_anims.emplace_back(used_frame, anim);
+        }
+    }
+
+    const auto evict_count = std::min(cold_anims.size(), static_cast<size_t>(_settings.AtlasEvictionsPerFrame));
+    std::partial_sort(cold_anims.begin(), cold_anims.begin() + static_cast<ptrdiff_t>(evict_count), cold_anims.end());
+
+    for (size_t i = 0; i < evict_count; i++) {
+        auto* anim = cold_anims[i].second;
+        auto& evictable = _evictableAnims.at(anim);
+
+        _sprMngr.EvictAnyFrames(anim);
+        evictable.Evicted = true;
+        evictable.EvictFrame = frame_index;
+        _evictedAnims.emplace_back(anim);
+    }
+
+    _sprMngr.CompactAtlases(AtlasType::Dynamic, _settings.AtlasCompactionOccupancy, _settings.AtlasCompactionMovesPerFrame);
+}
+
+auto ResourceManager::GetLoaderStatistics() const -> const ResourceLoader::Statistics*
+{
+    return _loader ? &_loader->GetStatistics() : nullptr;
+}
+
 static auto AnimMapId(hstring model_name, uint anim1, uint anim2, bool is_fallout) -> uint
 {
     uint dw[4] = {model_name.as_uint(), anim1, anim2, is_fallout ? static_cast<uint>(-1) : 1};
@@ -168,55 +396,14 @@ auto ResourceManager::GetCritterAnim(hstring model_name, uint anim1, uint anim2,
                 string str;
                 if (_animNameResolver.ResolveCritterAnimation(model_name, anim1, anim2, pass, flags, ox, oy, str)) {
                     if (!str.empty()) {
-                        _sprMngr.PushAtlasType(AtlasType::Dynamic);
-                        anim = _sprMngr.LoadAnimation(str, false, true);
-                        _sprMngr.PopAtlasType();
-
-                        // Fix by dirs
-                        for (auto d = 0; anim != nullptr && d < anim->DirCount; d++) {
-                            auto* dir_anim = anim->GetDir(d);
-
-                            // Process flags
-                            if (flags != 0u) {
-                                if (IsBitSet(flags, ANIM_FLAG_FIRST_FRAME) || IsBitSet(flags, ANIM_FLAG_LAST_FRAME)) {
-                                    const auto first = IsBitSet(flags, ANIM_FLAG_FIRST_FRAME);
-
-                                    // Append offsets
-                                    if (!first) {
-                                        for (uint i = 0; i < dir_anim->CntFrm - 1; i++) {
-                                            dir_anim->NextX[dir_anim->CntFrm - 1] = static_cast<short>(dir_anim->NextX[dir_anim->CntFrm - 1] + dir_anim->NextX[i]);
-                                            dir_anim->NextY[dir_anim->CntFrm - 1] = static_cast<short>(dir_anim->NextY[dir_anim->CntFrm - 1] + dir_anim->NextY[i]);
-                                        }
-                                    }
-
-                                    // Change size
-                                    dir_anim->Ind[0] = first ? dir_anim->Ind[0] : dir_anim->Ind[dir_anim->CntFrm - 1];
-                                    dir_anim->NextX[0] = first ? dir_anim->NextX[0] : dir_anim->NextX[dir_anim->CntFrm - 1];
-                                    dir_anim->NextY[0] = first ? dir_anim->NextY[0] : dir_anim->NextY[dir_anim->CntFrm - 1];
-                                    dir_anim->CntFrm = 1;
-                                }
-                            }
+                        anim = LoadAnim(str, AtlasType::Dynamic, CritterDefaultAnim, [this, flags, ox, oy, anim1, anim2](AnyFrames* loaded_anim) {
+                            FixCritterAnim(loaded_anim, flags, ox, oy);
 
-                            // Add offsets
-                            ox = oy = 0; // Todo: why I disable offset adding?
-                            if (ox != 0 || oy != 0) {
-                                for (uint i = 0; i < dir_anim->CntFrm; i++) {
-                                    const auto spr_id = dir_anim->Ind[i];
-                                    auto fixed = false;
-                                    for (uint j = 0; j < i; j++) {
-                                        if (dir_anim->Ind[j] == spr_id) {
-                                            fixed = true;
-                                            break;
-                                        }
-                                    }
-                                    if (!fixed) {
-                                        auto* si = _sprMngr.GetSpriteInfoForEditing(spr_id);
-                                        si->OffsX += ox;
-                                        si->OffsY += oy;
-                                    }
-                                }
+                            for (auto d = 0; d < loaded_anim->DirCount; d++) {
+                                loaded_anim->GetDir(d)->Anim1 = anim1;
+                                loaded_anim->GetDir(d)->Anim2 = anim2;
                             }
-                        }
+                        });
                     }
 
                     // If pass changed and animation not loaded than try again
@@ -259,6 +446,55 @@ auto ResourceManager::GetCritterAnim(hstring model_name, uint anim1, uint anim2,
     return anim != nullptr ? anim->GetDir(dir) : nullptr;
 }
 
+void ResourceManager::FixCritterAnim(AnyFrames* anim, uint flags, int ox, int oy)
+{
+    // Fix by dirs
+    for (auto d = 0; d < anim->DirCount; d++) {
+        auto* dir_anim = anim->GetDir(d);
+
+        // Process flags
+        if (flags != 0u) {
+            if (IsBitSet(flags, ANIM_FLAG_FIRST_FRAME) || IsBitSet(flags, ANIM_FLAG_LAST_FRAME)) {
+                const auto first = IsBitSet(flags, ANIM_FLAG_FIRST_FRAME);
+
+                // Append offsets
+                if (!first) {
+                    for (uint i = 0; i < dir_anim->CntFrm - 1; i++) {
+                        dir_anim->NextX[dir_anim->CntFrm - 1] = static_cast<short>(dir_anim->NextX[dir_anim->CntFrm - 1] + dir_anim->NextX[i]);
+                        dir_anim->NextY[dir_anim->CntFrm - 1] = static_cast<short>(dir_anim->NextY[dir_anim->CntFrm - 1] + dir_anim->NextY[i]);
+                    }
+                }
+
+                // Change size
+                dir_anim->Ind[0] = first ? dir_anim->Ind[0] : dir_anim->Ind[dir_anim->CntFrm - 1];
+                dir_anim->NextX[0] = first ? dir_anim->NextX[0] : dir_anim->NextX[dir_anim->CntFrm - 1];
+                dir_anim->NextY[0] = first ? dir_anim->NextY[0] : dir_anim->NextY[dir_anim->CntFrm - 1];
+                dir_anim->CntFrm = 1;
+            }
+        }
+
+        // Add offsets
+        ox = oy = 0; // Todo: why I disable offset adding?
+        if (ox != 0 || oy != 0) {
+            for (uint i = 0; i < dir_anim->CntFrm; i++) {
+                const auto spr_id = dir_anim->Ind[i];
+                auto fixed = false;
+                for (uint j = 0; j < i; j++) {
+                    if (dir_anim->Ind[j] == spr_id) {
+                        fixed = true;
+                        break;
+                    }
+                }
+                if (!fixed) {
+                    auto* si = _sprMngr.GetSpriteInfoForEditing(spr_id);
+                    si->OffsX += ox;
+                    si->OffsY += oy;
+                }
+            }
+        }
+    }
+}
+
 auto ResourceManager::LoadFalloutAnim(hstring model_name, uint anim1, uint anim2) -> AnyFrames*
 {
     // Convert from common to fallout specific
@@ -36,13 +36,14 @@
 #include "Common.h"
 
 #include "3dStuff.h"
+#include "ResourceLoader.h"
 #include "SpriteManager.h"
 
 class ResourceManager final
 {
 public:
     ResourceManager() = delete;
-    ResourceManager(FileSystem& file_sys, SpriteManager& spr_mngr, AnimationResolver& anim_name_resolver, NameResolver& name_resolver);
+    ResourceManager(RenderSettings& settings, FileSystem& file_sys, SpriteManager& spr_mngr, AnimationResolver& anim_name_resolver, NameResolver& name_resolver);
     ResourceManager(const ResourceManager&) = delete;
     ResourceManager(ResourceManager&&) noexcept = delete;
     auto operator=(const ResourceManager&) = delete;
@@ -61,9 +62,17 @@ class ResourceManager final
 #if FO_ENABLE_3D
     [[nodiscard]] auto GetCritterModel(hstring model_name, uint anim1, uint anim2, uchar dir, int* layers3d) -> ModelInstance*;
 #endif
+    [[nodiscard]] auto IsAnimLoading(const AnyFrames* anim) const -> bool { return _loadingAnims.count(anim) != 0u; }
+    [[nodiscard]] auto GetLoadingAnimsCount() const -> size_t { return _loadingAnims.size(); }
+    [[nodiscard]] auto GetFinishedAnims() const -> const vector<AnyFrames*>& { return _finishedAnims; }
+    [[nodiscard]] auto GetLoaderStatistics() const -> const ResourceLoader::Statistics*;
 
     void FreeResources(AtlasType atlas_type);
     void ReinitializeDynamicAtlas();
+    void PrefetchAnim(hstring name, AtlasType atlas_type, int priority);
+    void PrefetchCritterAnim(hstring model_name, uint anim1, uint anim2, int priority);
+    void SetLoadingPriority(const AnyFrames* anim, int priority);
+    void ProcessLoading();
 
     AnyFrames* ItemHexDefaultAnim {};
     AnyFrames* CritterDefaultAnim {};
@@ -75,12 +84,32 @@ class ResourceManager final
         AnyFrames* Anim {};
     };
 
+    struct LoadingAnim
+    {
+        AtlasType ResType {};
+        uint RequestId {};
+    };
+
+    struct EvictableAnim
+    {
+        string FileName {};
+        bool Evicted {};
+        uint EvictFrame {};
+        uint ReloadRequestId {};
+    };
+
+    [[nodiscard]] auto LoadAnim(string_view fname, AtlasType atlas_type, const AnyFrames* placeholder, const std::function<void(AnyFrames*)>& on_loaded) -> AnyFrames*;
     [[nodiscard]] auto LoadFalloutAnim(hstring model_name, uint anim1, uint anim2) -> AnyFrames*;
     [[nodiscard]] auto LoadFalloutAnimSpr(hstring model_name, uint anim1, uint anim2) -> AnyFrames*;
 
+    [[nodiscard]] auto GetAnimUsedFrame(AnyFrames* anim) const -> uint;
+
+    void ProcessAtlasEviction();
+    void FixCritterAnim(AnyFrames* anim, uint flags, int ox, int oy);
     void FixAnimOffs(AnyFrames* frames_base, AnyFrames* stay_frm_base);
     void FixAnimOffsNext(AnyFrames* frames_base, AnyFrames* stay_frm_base);
 
+    RenderSettings& _settings;
     FileSystem& _fileSys;
     SpriteManager& _sprMngr;
     AnimationResolver& _animNameResolver;
@@ -91,6 +120,11 @@ class ResourceManager final
     vector<string> _splashNames {};
     map<string, string> _soundNames {};
     AnyFrames* _splash {};
+    unique_ptr<ResourceLoader> _loader {};
+    unordered_map<const AnyFrames*, LoadingAnim> _loadingAnims {};
+    vector<AnyFrames*> _finishedAnims {};
+    unordered_map<AnyFrames*, EvictableAnim> _evictableAnims {};
+    vector<AnyFrames*> _evictedAnims {};
     bool _nonConstHelper {};
 #if FO_ENABLE_3D
     map<hstring, ModelInstance*> _critterModels {};
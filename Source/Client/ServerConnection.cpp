@@ -34,12 +34,12 @@
 #include "ServerConnection.h"
 #include "ClientScripting.h"
 #include "Log.h"
+#include "NetCodec.h"
 #include "NetCommand.h"
 #include "StringUtils.h"
 #include "Timer.h"
 #include "WinApi-Include.h"
 
-#include "zlib.h"
 #if !FO_WINDOWS
 #include <arpa/inet.h>
 #include <fcntl.h>
@@ -63,7 +63,10 @@ struct ServerConnection::Impl
     auto GetLastSocketError() -> string;
     auto FillSockAddr(sockaddr_in& saddr, string_view host, ushort port) -> bool;
 
-    z_stream* ZStream {};
+    unique_ptr<NetCodec> Codec {};
+    vector<uchar> CodecDictionary {};
+    uint AcceptableCodecs {};
+    vector<uchar> DecodeBuf {};
     sockaddr_in SockAddr {};
     sockaddr_in ProxyAddr {};
     SOCKET NetSock {INVALID_SOCKET};
@@ -74,7 +77,10 @@ ServerConnection::ServerConnection(ClientNetworkSettings& settings) : _settings
 {
     _incomeBuf.resize(NetBuffer::DEFAULT_BUF_SIZE);
 
+    _impl->CodecDictionary = NetCodec::LoadDictionary(_settings.NetCodecDictionary);
+
     AddMessageHandler(NETMSG_DISCONNECT, [this] { Disconnect(); });
+    AddMessageHandler(NETMSG_HANDSHAKE, std::bind(&ServerConnection::Net_OnHandshake, this));
     AddMessageHandler(NETMSG_PING, std::bind(&ServerConnection::Net_OnPing, this));
 }
 
@@ -83,9 +89,6 @@ ServerConnection::~ServerConnection()
     if (_impl->NetSock != INVALID_SOCKET) {
         ::closesocket(_impl->NetSock);
     }
-    if (_impl->ZStream != nullptr) {
-        ::inflateEnd(_impl->ZStream);
-    }
     delete _impl;
 }
 
@@ -182,6 +185,8 @@ auto ServerConnection::CheckSocketStatus(bool for_write) -> bool
             _isConnecting = false;
             _isConnected = true;
 
+            SendHandshake();
+
             if (_connectCallback) {
                 _connectCallback(true);
             }
@@ -236,14 +241,8 @@ auto ServerConnection::ConnectToHost(string_view host, ushort port) -> bool
     WriteLog("Connecting to server '{}:{}'", host, port);
 #endif
 
-    if (_impl->ZStream == nullptr) {
-        _impl->ZStream = new z_stream();
-        _impl->ZStream->zalloc = [](voidpf, uInt items, uInt size) { return calloc(items, size); };
-        _impl->ZStream->zfree = [](voidpf, voidpf address) { free(address); };
-        _impl->ZStream->opaque = nullptr;
-        const auto inf_init = ::inflateInit(_impl->ZStream);
-        RUNTIME_ASSERT(inf_init == Z_OK);
-    }
+    // Raw input until handshake answer
+    _impl->Codec = NetCodec::Create(NetCodecType::None, {});
 
 #if FO_WINDOWS
     WSADATA wsa;
@@ -507,10 +506,7 @@ void ServerConnection::Disconnect()
         _impl->NetSock = INVALID_SOCKET;
     }
 
-    if (_impl->ZStream != nullptr) {
-        ::inflateEnd(_impl->ZStream);
-        _impl->ZStream = nullptr;
-    }
+    _impl->Codec.reset();
 
     if (_isConnecting) {
         _isConnecting = false;
@@ -527,6 +523,8 @@ void ServerConnection::Disconnect()
 
         _netIn.ResetBuf();
         _netOut.ResetBuf();
+        _netIn.SetEncryptDisabled(false);
+        _netOut.SetEncryptDisabled(false);
         _netIn.SetEncryptKey(0);
         _netOut.SetEncryptKey(0);
         _netIn.SetError(false);
@@ -640,30 +638,14 @@ auto ServerConnection::ReceiveData(bool unpack) -> int
 
     const auto old_pos = _netIn.GetEndPos();
 
-    if (unpack && !_settings.DisableZlibCompression) {
-        _impl->ZStream->next_in = _incomeBuf.data();
-        _impl->ZStream->avail_in = whole_len;
-        _impl->ZStream->next_out = _netIn.GetData() + _netIn.GetEndPos();
-        _impl->ZStream->avail_out = _netIn.GetAvailLen();
-
-        const auto first_inflate = ::inflate(_impl->ZStream, Z_SYNC_FLUSH);
-        RUNTIME_ASSERT(first_inflate == Z_OK);
-
-        auto uncompr = static_cast<uint>(reinterpret_cast<size_t>(_impl->ZStream->next_out) - reinterpret_cast<size_t>(_netIn.GetData()));
-        _netIn.SetEndPos(uncompr);
-
-        while (_impl->ZStream->avail_in != 0u) {
-            _netIn.GrowBuf(NetBuffer::DEFAULT_BUF_SIZE);
-
-            _impl->ZStream->next_out = _netIn.GetData() + _netIn.GetEndPos();
-            _impl->ZStream->avail_out = _netIn.GetAvailLen();
-
-            const auto next_inflate = ::inflate(_impl->ZStream, Z_SYNC_FLUSH);
-            RUNTIME_ASSERT(next_inflate == Z_OK);
-
-            uncompr = static_cast<uint>(reinterpret_cast<size_t>(_impl->ZStream->next_out) - reinterpret_cast<size_t>(_netIn.GetData()));
-            _netIn.SetEndPos(uncompr);
+    if (unpack) {
+        _impl->DecodeBuf.clear();
+        if (!_impl->Codec->Decode(_incomeBuf.data(), whole_len, _impl->DecodeBuf)) {
+            WriteLog("Can't decode data from server");
+            return -1;
         }
+
+        _netIn.AddData(_impl->DecodeBuf.data(), static_cast<uint>(_impl->DecodeBuf.size()));
     }
     else {
         _netIn.AddData(_incomeBuf.data(), whole_len);
@@ -705,6 +687,66 @@ auto ServerConnection::Impl::GetLastSocketError() -> string
 #endif
 }
 
+void ServerConnection::SendHandshake()
+{
+    const auto codec = NetCodec::ParseType(_settings.NetCodec);
+
+    // Plain zlib is fallback for server with other dictionary
+    _impl->AcceptableCodecs = 1u << static_cast<uint>(NetCodecType::None);
+    if (codec != NetCodecType::None) {
+        _impl->AcceptableCodecs |= 1u << static_cast<uint>(NetCodecType::Zlib);
+    }
+    if (codec == NetCodecType::ZlibDictionary && !_impl->CodecDictionary.empty()) {
+        _impl->AcceptableCodecs |= 1u << static_cast<uint>(NetCodecType::ZlibDictionary);
+    }
+
+    // Server output has no key yet, so input switches here too
+    _netIn.SetEncryptDisabled(!_settings.NetKeyStream);
+    _netOut.SetEncryptDisabled(!_settings.NetKeyStream);
+
+    _netOut << NETMSG_HANDSHAKE;
+    _netOut << static_cast<uchar>(_impl->AcceptableCodecs);
+    _netOut << NetCodec::GetDictionaryHash(_impl->CodecDictionary);
+    _netOut << _settings.NetKeyStream;
+}
+
+void ServerConnection::Net_OnHandshake()
+{
+    uchar codec = 0;
+    uint dictionary_hash = 0;
+    bool key_stream = false;
+    _netIn >> codec;
+    _netIn >> dictionary_hash;
+    _netIn >> key_stream;
+
+    CHECK_SERVER_IN_BUF_ERROR(*this);
+
+    const auto is_asked_codec = codec < static_cast<uchar>(NetCodecType::Count) && (_impl->AcceptableCodecs & (1u << codec)) != 0u;
+    const auto is_same_dictionary = static_cast<NetCodecType>(codec) != NetCodecType::ZlibDictionary || dictionary_hash == NetCodec::GetDictionaryHash(_impl->CodecDictionary);
+    if (!is_asked_codec || !is_same_dictionary || key_stream != _settings.NetKeyStream) {
+        WriteLog("Wrong handshake answer from server");
+        Disconnect();
+        return;
+    }
+
+    _impl->Codec = NetCodec::Create(static_cast<NetCodecType>(codec), _impl->CodecDictionary);
+
+    // Rest of already received data is encoded with new codec
+    const auto read_pos = _netIn.GetReadPos();
+    const vector<uchar> encoded(_netIn.GetData() + read_pos, _netIn.GetData() + _netIn.GetEndPos());
+    _netIn.SetEndPos(read_pos);
+
+    _impl->DecodeBuf.clear();
+    if (!_impl->Codec->Decode(encoded.data(), static_cast<uint>(encoded.size()), _impl->DecodeBuf)) {
+        WriteLog("Can't decode data from server");
+        Disconnect();
+        return;
+    }
+
+    _netIn.AddData(_impl->DecodeBuf.data(), static_cast<uint>(_impl->DecodeBuf.size()));
+    _bytesRealReceive += static_cast<uint>(_impl->DecodeBuf.size()) - static_cast<uint>(encoded.size());
+}
+
 void ServerConnection::Net_OnPing()
 {
     uchar ping;
@@ -93,6 +93,8 @@ class ServerConnection final
     auto DispatchData() -> bool;
     auto CheckSocketStatus(bool for_write) -> bool;
 
+    void SendHandshake();
+    void Net_OnHandshake();
     void Net_OnPing();
 
     ClientNetworkSettings& _settings;
@@ -32,6 +32,7 @@
 //
 
 #include "SpriteManager.h"
+#include "FrameProfiler.h"
 #include "GenericUtils.h"
 #include "Log.h"
 #include "StringUtils.h"
@@ -39,40 +40,13 @@
 constexpr int SPRITES_BUFFER_SIZE = 10000;
 constexpr int ATLAS_SPRITES_PADDING = 1;
 
-TextureAtlas::SpaceNode::SpaceNode(int x, int y, uint w, uint h) : PosX {x}, PosY {y}, Width {w}, Height {h}
+static void SetSpriteAtlasPlace(SpriteInfo* si, TextureAtlas* atlas, int x, int y)
 {
-}
-
-auto TextureAtlas::SpaceNode::FindPosition(uint w, uint h, int& x, int& y) -> bool
-{
-    auto result = false;
-
-    if (Child1) {
-        result = Child1->FindPosition(w, h, x, y);
-    }
-    if (!result && Child2) {
-        result = Child2->FindPosition(w, h, x, y);
-    }
-
-    if (!result && !Busy && Width >= w && Height >= h) {
-        result = true;
-        Busy = true;
-
-        x = PosX;
-        y = PosY;
-
-        if (Width == w && Height > h) {
-            Child1 = std::make_unique<SpaceNode>(PosX, PosY + h, Width, Height - h);
-        }
-        else if (Height == h && Width > w) {
-            Child1 = std::make_unique<SpaceNode>(PosX + w, PosY, Width - w, Height);
-        }
-        else if (Width > w && Height > h) {
-            Child1 = std::make_unique<SpaceNode>(PosX + w, PosY, Width - w, h);
-            Child2 = std::make_unique<SpaceNode>(PosX, PosY + h, Width, Height - h);
-        }
-    }
-    return result;
+    si->Atlas = atlas;
+    si->SprRect.Left = static_cast<float>(x) / static_cast<float>(atlas->Width);
+    si->SprRect.Top = static_cast<float>(y) / static_cast<float>(atlas->Height);
+    si->SprRect.Right = static_cast<float>(x + si->Width) / static_cast<float>(atlas->Width);
+    si->SprRect.Bottom = static_cast<float>(y + si->Height) / static_cast<float>(atlas->Height);
 }
 
 auto AnyFrames::GetSprId(uint num_frm) const -> uint
@@ -105,6 +79,18 @@ auto AnyFrames::GetDir(int dir) -> AnyFrames*
     return dir == 0 || DirCount == 1 ? this : Dirs[dir - 1];
 }
 
+SpriteChunkCache::~SpriteChunkCache()
+{
+    for (auto& chunk : _chunks) {
+        delete chunk.DrawBuf;
+    }
+}
+
+void SpriteChunkCache::Invalidate()
+{
+    _valid = false;
+}
+
 SpriteManager::SpriteManager(RenderSettings& settings, FileSystem& file_sys, EffectManager& effect_mngr) : _settings {settings}, _fileSys {file_sys}, _effectMngr {effect_mngr}
 {
     _baseColor = COLOR_RGBA(255, 128, 128, 128);
@@ -207,6 +193,8 @@ void SpriteManager::SetAlwaysOnTop(bool enable)
 
 void SpriteManager::BeginScene(uint clear_color)
 {
+    _frameIndex++;
+
     if (_rtMain != nullptr) {
         PushRenderTarget(_rtMain);
     }
@@ -272,6 +260,17 @@ auto SpriteManager::CreateRenderTarget(bool with_depth, bool screen_sized, uint
     return _rtAll.back().get();
 }
 
+void SpriteManager::DestroyRenderTarget(RenderTarget* rt)
+{
+    Flush();
+
+    RUNTIME_ASSERT(std::find(_rtStack.begin(), _rtStack.end(), rt) == _rtStack.end());
+
+    const auto it = std::find_if(_rtAll.begin(), _rtAll.end(), [rt](auto&& r) { return r.get() == rt; });
+    RUNTIME_ASSERT(it != _rtAll.end());
+    _rtAll.erase(it);
+}
+
 void SpriteManager::PushRenderTarget(RenderTarget* rt)
 {
     Flush();
@@ -503,8 +502,12 @@ void SpriteManager::FlushAccumulatedAtlasData()
         return;
     }
 
-    // Sort by size
-    std::sort(_accumulatorSprInfo.begin(), _accumulatorSprInfo.end(), [](SpriteInfo* si1, SpriteInfo* si2) { return si1->Width * si1->Height > si2->Width * si2->Height; });
+    // Longest side first gives better packing than area
+    std::sort(_accumulatorSprInfo.begin(), _accumulatorSprInfo.end(), [](const SpriteInfo* si1, const SpriteInfo* si2) {
+        const auto max1 = std::max(si1->Width, si1->Height);
+        const auto max2 = std::max(si2->Width, si2->Height);
+        return max1 != max2 ? max1 > max2 : std::min(si1->Width, si1->Height) > std::min(si2->Width, si2->Height);
+    });
 
     for (auto& it : _accumulatorSprInfo) {
         FillAtlas(it);
@@ -532,7 +535,7 @@ auto SpriteManager::CreateAtlas(uint w, uint h) -> TextureAtlas*
     atlas->MainTex = atlas->RT->MainTex.get();
     atlas->Width = w;
     atlas->Height = h;
-    atlas->RootNode = _accumulatorActive ? std::make_unique<TextureAtlas::SpaceNode>(0, 0, w, h) : nullptr;
+    atlas->Packer = std::make_unique<AtlasPacker>(w, h);
 
     _allAtlases.push_back(std::move(atlas));
     return _allAtlases.back().get();
@@ -547,44 +550,8 @@ auto SpriteManager::FindAtlasPlace(SpriteInfo* si, int& x, int& y) -> TextureAtl
     const auto h = static_cast<uint>(si->Height + ATLAS_SPRITES_PADDING * 2);
 
     for (auto& a : _allAtlases) {
-        if (a->Type != atlas_type) {
-            continue;
-        }
-
-        if (a->RootNode) {
-            if (a->RootNode->FindPosition(w, h, x, y)) {
-                atlas = a.get();
-            }
-        }
-        else {
-            if (w <= a->LineW && a->LineCurH + h <= a->LineMaxH) {
-                x = a->CurX - static_cast<int>(a->LineW);
-                y = a->CurY + static_cast<int>(a->LineCurH);
-                a->LineCurH += h;
-                atlas = a.get();
-            }
-            else if (a->Width - a->CurX >= w && a->Height - a->CurY >= h) {
-                x = a->CurX;
-                y = a->CurY;
-                a->CurX += w;
-                a->LineW = w;
-                a->LineCurH = h;
-                a->LineMaxH = std::max(a->LineMaxH, h);
-                atlas = a.get();
-            }
-            else if (a->Width >= w && a->Height - a->CurY - a->LineMaxH >= h) {
-                x = 0;
-                y = a->CurY + static_cast<int>(a->LineMaxH);
-                a->CurX = w;
-                a->CurY = y;
-                a->LineW = w;
-                a->LineCurH = h;
-                a->LineMaxH = h;
-                atlas = a.get();
-            }
-        }
-
-        if (atlas != nullptr) {
+        if (a->Type == atlas_type && a->Packer->Insert(w, h, x, y)) {
+            atlas = a.get();
             break;
         }
     }
@@ -592,19 +559,14 @@ auto SpriteManager::FindAtlasPlace(SpriteInfo* si, int& x, int& y) -> TextureAtl
     // Create new
     if (atlas == nullptr) {
         atlas = CreateAtlas(w, h);
-        if (atlas->RootNode) {
-            atlas->RootNode->FindPosition(w, h, x, y);
-        }
-        else {
-            x = atlas->CurX;
-            y = atlas->CurY;
-            atlas->CurX += w;
-            atlas->LineMaxH = h;
-            atlas->LineCurH = h;
-            atlas->LineW = w;
-        }
+        const auto inserted = atlas->Packer->Insert(w, h, x, y);
+        RUNTIME_ASSERT(inserted);
     }
 
+    si->AtlasX = x;
+    si->AtlasY = y;
+    atlas->SpritesCount++;
+
     // Return parameters
     x += ATLAS_SPRITES_PADDING;
     y += ATLAS_SPRITES_PADDING;
@@ -630,6 +592,7 @@ void SpriteManager::DestroyAtlases(AtlasType atlas_type)
                 }
             }
 
+            DestroyRenderTarget(atlas->RT);
             it = _allAtlases.erase(it);
         }
         else {
@@ -746,16 +709,191 @@ void SpriteManager::FillAtlas(SpriteInfo* si)
     }
 
     // Set parameters
-    si->Atlas = atlas;
-    si->SprRect.Left = static_cast<float>(x) / static_cast<float>(atlas->Width);
-    si->SprRect.Top = static_cast<float>(y) / static_cast<float>(atlas->Height);
-    si->SprRect.Right = static_cast<float>(x + w) / static_cast<float>(atlas->Width);
-    si->SprRect.Bottom = static_cast<float>(y + h) / static_cast<float>(atlas->Height);
+    SetSpriteAtlasPlace(si, atlas, x, y);
+    si->Evicted = false;
 
     // Delete data
     delete[] data;
 }
 
+void SpriteManager::FreeAtlasPlace(SpriteInfo* si)
+{
+    auto* atlas = si->Atlas;
+    RUNTIME_ASSERT(atlas);
+    RUNTIME_ASSERT(atlas->SpritesCount > 0);
+
+    atlas->Packer->Free(si->AtlasX, si->AtlasY, si->Width + ATLAS_SPRITES_PADDING * 2, si->Height + ATLAS_SPRITES_PADDING * 2);
+    atlas->SpritesCount--;
+    atlas->RT->LastPixelPicks.clear();
+    si->Atlas = nullptr;
+}
+
+auto SpriteManager::GetAtlasStatistics(AtlasType atlas_type) const -> AtlasStatistics
+{
+    auto stats = _atlasStats;
+
+    for (const auto& atlas : _allAtlases) {
+        if (atlas->Type == atlas_type) {
+            stats.AtlasesCount++;
+            stats.TotalArea += static_cast<size_t>(atlas->Width) * atlas->Height;
+            stats.UsedArea += atlas->Packer->GetUsedArea();
+            stats.SpritesCount += atlas->SpritesCount;
+        }
+    }
+
+    for (const auto* si : _sprData) {
+        if (si != nullptr && si->Evicted && si->DataAtlasType == atlas_type) {
+            stats.EvictedSprites++;
+        }
+    }
+
+    return stats;
+}
+
+void SpriteManager::EvictAnyFrames(AnyFrames* anim)
+{
+    for (auto dir = 0; dir < anim->DirCount; dir++) {
+        const auto* dir_anim = anim->GetDir(dir);
+
+        for (uint i = 0; i < dir_anim->CntFrm; i++) {
+            auto* si = _sprData[dir_anim->Ind[i]];
+            if (si == nullptr || si->Atlas == nullptr || si->Atlas->Type != AtlasType::Dynamic || si == _sprEgg) {
+                continue;
+            }
+
+            FreeAtlasPlace(si);
+            si->Evicted = true;
+            _atlasStats.Evictions++;
+            _atlasVersion++;
+        }
+    }
+}
+
+void SpriteManager::RefillAnyFrames(AnyFrames* anim, Animation2dData& data)
+{
+    // Same frames order as in Fill2dAnimation
+    for (size_t dir = 0; dir < data.Dirs.size() && static_cast<int>(dir) < anim->DirCount; dir++) {
+        const auto* dir_anim = anim->GetDir(static_cast<int>(dir));
+        auto& dir_data = data.Dirs[dir];
+
+        for (size_t i = 0; i < dir_data.Frames.size() && i < dir_anim->CntFrm; i++) {
+            auto& frame = dir_data.Frames[i];
+            if (frame.IsCopy) {
+                continue;
+            }
+
+            auto* si = _sprData[dir_anim->Ind[i]];
+            if (si == nullptr || !si->Evicted || si->Atlas != nullptr || si->Data != nullptr) {
+                continue;
+            }
+
+            RUNTIME_ASSERT(si->Width == frame.Width);
+            RUNTIME_ASSERT(si->Height == frame.Height);
+
+            si->Data = frame.Data.release();
+            if (_accumulatorActive) {
+                _accumulatorSprInfo.push_back(si);
+            }
+            else {
+                FillAtlas(si);
+            }
+
+            _atlasStats.Refills++;
+            _atlasVersion++;
+        }
+    }
+}
+
+void SpriteManager::CompactAtlases(AtlasType atlas_type, float max_occupancy, size_t max_moves)
+{
+    // Most sparse atlas without pinned sprites
+    TextureAtlas* src_atlas = nullptr;
+    size_t atlases_count = 0;
+    for (auto& atlas : _allAtlases) {
+        if (atlas->Type != atlas_type) {
+            continue;
+        }
+
+        atlases_count++;
+
+        if (atlas->Packer->GetOccupancy() >= max_occupancy || (src_atlas != nullptr && atlas->Packer->GetOccupancy() >= src_atlas->Packer->GetOccupancy())) {
+            continue;
+        }
+        if (_sprEgg != nullptr && _sprEgg->Atlas == atlas.get()) {
+            continue;
+        }
+
+        src_atlas = atlas.get();
+    }
+
+    if (src_atlas == nullptr || atlases_count < 2) {
+        return;
+    }
+
+    vector<SpriteInfo*> sprites;
+    for (auto* si : _sprData) {
+        if (si != nullptr && si->Atlas == src_atlas) {
+#if FO_ENABLE_3D
+            if (si->UsedForModel) {
+                return;
+            }
+#endif
+            sprites.push_back(si);
+        }
+    }
+
+    Flush();
+
+    size_t moves = 0;
+    for (auto* si : sprites) {
+        if (moves == max_moves) {
+            break;
+        }
+
+        const auto w = static_cast<uint>(si->Width + ATLAS_SPRITES_PADDING * 2);
+        const auto h = static_cast<uint>(si->Height + ATLAS_SPRITES_PADDING * 2);
+
+        TextureAtlas* dest_atlas = nullptr;
+        auto x = 0;
+        auto y = 0;
+        for (auto& atlas : _allAtlases) {
+            if (atlas->Type == atlas_type && atlas.get() != src_atlas && atlas->Packer->Insert(w, h, x, y)) {
+                dest_atlas = atlas.get();
+                break;
+            }
+        }
+
+        // Other atlases are full, new atlas will not make things better
+        if (dest_atlas == nullptr) {
+            break;
+        }
+
+        // Copy with border through memory
+        const auto pixels = src_atlas->MainTex->GetTextureRegion(si->AtlasX, si->AtlasY, w, h);
+        dest_atlas->MainTex->UpdateTextureRegion(IRect(x, y, x + static_cast<int>(w) - 1, y + static_cast<int>(h) - 1), pixels.data());
+        dest_atlas->RT->LastPixelPicks.clear();
+
+        FreeAtlasPlace(si);
+        si->AtlasX = x;
+        si->AtlasY = y;
+        dest_atlas->SpritesCount++;
+        SetSpriteAtlasPlace(si, dest_atlas, x + ATLAS_SPRITES_PADDING, y + ATLAS_SPRITES_PADDING);
+
+        moves++;
+    }
+
+    if (moves != 0) {
+        _atlasStats.CompactionMoves += moves;
+        _atlasVersion++;
+    }
+
+    if (src_atlas->SpritesCount == 0) {
+        DestroyRenderTarget(src_atlas->RT);
+        _allAtlases.erase(std::find_if(_allAtlases.begin(), _allAtlases.end(), [src_atlas](auto&& a) { return a.get() == src_atlas; }));
+        _atlasStats.AtlasesReleased++;
+    }
+}
+
 auto SpriteManager::LoadAnimation(string_view fname, bool use_dummy, bool /*frm_anim_pix*/) -> AnyFrames*
 {
     auto* dummy = use_dummy ? DummyAnimation : nullptr;
@@ -786,48 +924,87 @@ auto SpriteManager::LoadAnimation(string_view fname, bool use_dummy, bool /*frm_
 }
 
 auto SpriteManager::Load2dAnimation(string_view fname) -> AnyFrames*
+{
+    const auto data = Read2dAnimation(fname);
+    if (!data) {
+        return nullptr;
+    }
+
+    auto* anim = CreateAnyFrames(data->FramesCount, data->Ticks);
+    Fill2dAnimation(anim, *data);
+    return anim;
+}
+
+auto SpriteManager::Read2dAnimation(string_view fname) const -> unique_ptr<Animation2dData>
 {
     auto file = _fileSys.ReadFile(fname);
     if (!file) {
         return nullptr;
     }
 
+    auto data = std::make_unique<Animation2dData>();
+
     RUNTIME_ASSERT(file.GetUChar() == 42);
-    const auto frames_count = file.GetBEUShort();
-    const auto ticks = file.GetBEUInt();
-    const auto dirs = file.GetBEUShort();
+    data->FramesCount = file.GetBEUShort();
+    data->Ticks = file.GetBEUInt();
+    data->Dirs.resize(file.GetBEUShort());
 
-    auto* anim = CreateAnyFrames(frames_count, ticks);
-    if (dirs > 1) {
-        CreateAnyFramesDirAnims(anim, dirs);
-    }
+    for (auto& dir : data->Dirs) {
+        dir.OffsX = file.GetBEShort();
+        dir.OffsY = file.GetBEShort();
+        dir.Frames.resize(data->FramesCount);
 
-    for (ushort dir = 0; dir < dirs; dir++) {
-        auto* dir_anim = anim->GetDir(dir);
-        const auto ox = file.GetBEShort();
-        const auto oy = file.GetBEShort();
-        for (ushort i = 0; i < frames_count; i++) {
+        for (auto& frame : dir.Frames) {
             if (file.GetUChar() == 0u) {
-                auto* si = new SpriteInfo();
-                si->OffsX = ox;
-                si->OffsY = oy;
-                const auto w = file.GetBEUShort();
-                const auto h = file.GetBEUShort();
-                dir_anim->NextX[i] = file.GetBEShort();
-                dir_anim->NextY[i] = file.GetBEShort();
-                const auto* data = file.GetCurBuf();
-                dir_anim->Ind[i] = RequestFillAtlas(si, w, h, const_cast<uchar*>(data));
-                file.GoForward(w * h * 4);
+                frame.Width = file.GetBEUShort();
+                frame.Height = file.GetBEUShort();
+                frame.NextX = file.GetBEShort();
+                frame.NextY = file.GetBEShort();
+
+                const auto size = static_cast<size_t>(frame.Width) * frame.Height * 4;
+                frame.Data = std::make_unique<uchar[]>(size);
+                std::memcpy(frame.Data.get(), file.GetCurBuf(), size);
+                file.GoForward(size);
             }
             else {
-                const auto index = file.GetBEUShort();
-                dir_anim->Ind[i] = dir_anim->Ind[index];
+                frame.IsCopy = true;
+                frame.CopyIndex = file.GetBEUShort();
             }
         }
     }
 
     RUNTIME_ASSERT(file.GetUChar() == 42);
-    return anim;
+    return data;
+}
+
+void SpriteManager::Fill2dAnimation(AnyFrames* anim, Animation2dData& data)
+{
+    anim->CntFrm = std::min(static_cast<uint>(data.FramesCount), static_cast<uint>(MAX_FRAMES));
+    anim->Ticks = data.Ticks != 0u ? data.Ticks : data.FramesCount * 100;
+    if (data.Dirs.size() > 1) {
+        CreateAnyFramesDirAnims(anim, static_cast<uint>(data.Dirs.size()));
+    }
+
+    for (size_t dir = 0; dir < data.Dirs.size(); dir++) {
+        auto* dir_anim = anim->GetDir(static_cast<int>(dir));
+        auto& dir_data = data.Dirs[dir];
+
+        for (size_t i = 0; i < dir_data.Frames.size(); i++) {
+            auto& frame = dir_data.Frames[i];
+            if (!frame.IsCopy) {
+                auto* si = new SpriteInfo();
+                si->OffsX = dir_data.OffsX;
+                si->OffsY = dir_data.OffsY;
+                dir_anim->NextX[i] = frame.NextX;
+                dir_anim->NextY[i] = frame.NextY;
+                // Atlas filling takes ownership on pixels
+                dir_anim->Ind[i] = RequestFillAtlas(si, frame.Width, frame.Height, frame.Data.release());
+            }
+            else {
+                dir_anim->Ind[i] = dir_anim->Ind[frame.CopyIndex];
+            }
+        }
+    }
 }
 
 auto SpriteManager::ReloadAnimation(AnyFrames* anim, string_view fname) -> AnyFrames*
@@ -1110,6 +1287,8 @@ void SpriteManager::DestroyAnyFrames(AnyFrames* anim)
 
 void SpriteManager::Flush()
 {
+    PROFILER_ZONE("SpritesFlush");
+
     if (_curDrawQuad == 0) {
         return;
     }
@@ -1124,13 +1303,25 @@ void SpriteManager::Flush()
     _curDrawQuad = 0;
 }
 
+auto SpriteManager::UseSpriteInfo(uint id) -> SpriteInfo*
+{
+    auto* si = _sprData[id];
+    if (si == nullptr) {
+        return nullptr;
+    }
+
+    // Evicted sprites are marked too, it's a signal for refill
+    si->UsedFrame = _frameIndex;
+    return si->Atlas != nullptr ? si : nullptr;
+}
+
 void SpriteManager::DrawSprite(uint id, int x, int y, uint color)
 {
     if (id == 0u) {
         return;
     }
 
-    const auto* si = _sprData[id];
+    const auto* si = UseSpriteInfo(id);
     if (si == nullptr) {
         return;
     }
@@ -1191,7 +1382,7 @@ void SpriteManager::DrawSpriteSizeExt(uint id, int x, int y, int w, int h, bool
         return;
     }
 
-    const auto* si = _sprData[id];
+    const auto* si = UseSpriteInfo(id);
     if (si == nullptr) {
         return;
     }
@@ -1279,7 +1470,7 @@ void SpriteManager::DrawSpritePattern(uint id, int x, int y, int w, int h, int s
         return;
     }
 
-    const auto* si = _sprData[id];
+    const auto* si = UseSpriteInfo(id);
     if (si == nullptr) {
         return;
     }
@@ -1487,6 +1678,8 @@ void SpriteManager::SetEgg(ushort hx, ushort hy, Sprite* spr)
 
 void SpriteManager::DrawSprites(Sprites& dtree, bool collect_contours, bool use_egg, int draw_oder_from, int draw_oder_to, bool prerender, int prerender_ox, int prerender_oy)
 {
+    PROFILER_ZONE("DrawSprites");
+
     if (dtree.Size() == 0u) {
         return;
     }
@@ -1532,48 +1725,8 @@ void SpriteManager::DrawSprites(Sprites& dtree, bool collect_contours, bool use_
 
         const auto zoom = _settings.SpritesZoom;
 
-        // Base color
-        uint color_r = 0;
-        uint color_l = 0;
-        if (spr->Color != 0u) {
-            color_r = color_l = spr->Color | 0xFF000000;
-        }
-        else {
-            color_r = color_l = _baseColor;
-        }
-
-        // Light
-        if (spr->Light != nullptr) {
-            static auto light_func = [](uint& c, const uchar* l, const uchar* l2) {
-                const int lr = *l;
-                const int lg = *(l + 1);
-                const int lb = *(l + 2);
-                const int lr2 = *l2;
-                const int lg2 = *(l2 + 1);
-                const int lb2 = *(l2 + 2);
-                auto& r = reinterpret_cast<uchar*>(&c)[2];
-                auto& g = reinterpret_cast<uchar*>(&c)[1];
-                auto& b = reinterpret_cast<uchar*>(&c)[0];
-                const auto ir = static_cast<int>(r) + (lr + lr2) / 2;
-                const auto ig = static_cast<int>(g) + (lg + lg2) / 2;
-                const auto ib = static_cast<int>(b) + (lb + lb2) / 2;
-                r = static_cast<uchar>(std::min(ir, 255));
-                g = static_cast<uchar>(std::min(ig, 255));
-                b = static_cast<uchar>(std::min(ib, 255));
-            };
-            light_func(color_r, spr->Light, spr->LightRight);
-            light_func(color_l, spr->Light, spr->LightLeft);
-        }
-
-        // Alpha
-        if (spr->Alpha != nullptr) {
-            reinterpret_cast<uchar*>(&color_r)[3] = *spr->Alpha;
-            reinterpret_cast<uchar*>(&color_l)[3] = *spr->Alpha;
-        }
-
-        // Fix color
-        color_r = COLOR_SWAP_RB(color_r);
-        color_l = COLOR_SWAP_RB(color_l);
+        // Color
+        const auto [color_l, color_r] = GetSpriteColors(spr);
 
         // Check borders
         if (!prerender) {
@@ -1582,39 +1735,16 @@ void SpriteManager::DrawSprites(Sprites& dtree, bool collect_contours, bool use_
             }
         }
 
+        // Marked after visibility check, see UseSpriteInfo
+        si->UsedFrame = _frameIndex;
+        if (si->Atlas == nullptr) {
+            continue;
+        }
+
         // Egg process
         auto egg_added = false;
         if (use_egg && spr->EggType != 0 && CompareHexEgg(spr->HexX, spr->HexY, spr->EggType)) {
-            auto x1 = x - ex;
-            auto y1 = y - ey;
-            auto x2 = x1 + si->Width;
-            auto y2 = y1 + si->Height;
-
-            if (!(x1 >= _eggSprWidth || y1 >= _eggSprHeight || x2 < 0 || y2 < 0)) {
-                x1 = std::max(x1, 0);
-                y1 = std::max(y1, 0);
-                x2 = std::min(x2, _eggSprWidth);
-                y2 = std::min(y2, _eggSprHeight);
-
-                const auto x1_f = static_cast<float>(x1 + ATLAS_SPRITES_PADDING);
-                const auto x2_f = static_cast<float>(x2 + ATLAS_SPRITES_PADDING);
-                const auto y1_f = static_cast<float>(y1 + ATLAS_SPRITES_PADDING);
-                const auto y2_f = static_cast<float>(y2 + ATLAS_SPRITES_PADDING);
-
-                auto& vbuf = _spritesDrawBuf->Vertices2D;
-                const auto pos = _curDrawQuad * 4;
-
-                vbuf[pos + 0].TUEgg = x1_f / _eggAtlasWidth;
-                vbuf[pos + 0].TVEgg = y2_f / _eggAtlasHeight;
-                vbuf[pos + 1].TUEgg = x1_f / _eggAtlasWidth;
-                vbuf[pos + 1].TVEgg = y1_f / _eggAtlasHeight;
-                vbuf[pos + 2].TUEgg = x2_f / _eggAtlasWidth;
-                vbuf[pos + 2].TVEgg = y1_f / _eggAtlasHeight;
-                vbuf[pos + 3].TUEgg = x2_f / _eggAtlasWidth;
-                vbuf[pos + 3].TVEgg = y2_f / _eggAtlasHeight;
-
-                egg_added = true;
-            }
+            egg_added = FillEggCoords(&_spritesDrawBuf->Vertices2D[_curDrawQuad * 4], si, x - ex, y - ey);
         }
 
         // Choose effect
@@ -1639,31 +1769,9 @@ void SpriteManager::DrawSprites(Sprites& dtree, bool collect_contours, bool use_
 
         // Fill buffer
         auto& vbuf = _spritesDrawBuf->Vertices2D;
-        auto pos = _curDrawQuad * 4;
-
-        vbuf[pos].X = xf;
-        vbuf[pos].Y = yf + hf;
-        vbuf[pos].TU = si->SprRect.Left;
-        vbuf[pos].TV = si->SprRect.Bottom;
-        vbuf[pos++].Diffuse = color_l;
-
-        vbuf[pos].X = xf;
-        vbuf[pos].Y = yf;
-        vbuf[pos].TU = si->SprRect.Left;
-        vbuf[pos].TV = si->SprRect.Top;
-        vbuf[pos++].Diffuse = color_l;
-
-        vbuf[pos].X = xf + wf;
-        vbuf[pos].Y = yf;
-        vbuf[pos].TU = si->SprRect.Right;
-        vbuf[pos].TV = si->SprRect.Top;
-        vbuf[pos++].Diffuse = color_r;
-
-        vbuf[pos].X = xf + wf;
-        vbuf[pos].Y = yf + hf;
-        vbuf[pos].TU = si->SprRect.Right;
-        vbuf[pos].TV = si->SprRect.Bottom;
-        vbuf[pos++].Diffuse = color_r;
+        const auto pos = _curDrawQuad * 4 + 4;
+
+        FillSpriteVertices(&vbuf[pos - 4], si, xf, yf, wf, hf, color_l, color_r);
 
         // Set default texture coordinates for egg texture
         if (!egg_added && vbuf[pos - 1].TUEgg != -1.0f) {
@@ -1732,6 +1840,359 @@ void SpriteManager::DrawSprites(Sprites& dtree, bool collect_contours, bool use_
     }
 }
 
+void SpriteManager::DrawCachedSprites(Sprites& dtree, SpriteChunkCache& cache, bool use_egg, int draw_oder_from, int draw_oder_to)
+{
+    PROFILER_ZONE("DrawCachedSprites");
+
+    if (!_eggValid) {
+        use_egg = false;
+    }
+
+    const auto zoom = _settings.SpritesZoom;
+
+    // Debug drawing is done per sprite
+    if (!_settings.ShowCorners && !_settings.ShowDrawOrder && !_settings.ShowSpriteBorders) {
+        if (!cache._valid || cache._treeVersion != dtree.GetVersion() || cache._drawOrderFrom != draw_oder_from || cache._drawOrderTo != draw_oder_to || !Math::FloatCompare(cache._zoom, zoom) || cache._baseColor != _baseColor) {
+            PrepareChunkCache(dtree, cache, draw_oder_from, draw_oder_to);
+        }
+    }
+    else {
+        cache._valid = false;
+    }
+
+    // Fallback if static buffers are not supported
+    if (!cache._valid) {
+        DrawSprites(dtree, false, use_egg, draw_oder_from, draw_oder_to, false, 0, 0);
+        return;
+    }
+
+    // Alpha values are referenced by pointers and may be changed at any time
+    for (auto& [alpha, value] : cache._alphaValues) {
+        if (*alpha != value) {
+            value = *alpha;
+            for (size_t i = 0; i < cache._chunksCount; i++) {
+                cache._chunks[i].NeedBake = true;
+            }
+        }
+    }
+
+    // Sprites moved or evicted from atlases
+    if (cache._atlasVersion != _atlasVersion) {
+        cache._atlasVersion = _atlasVersion;
+        for (size_t i = 0; i < cache._chunksCount; i++) {
+            cache._chunks[i].NeedBake = true;
+        }
+    }
+
+    // Rebake only chunks around old and new egg positions
+    if (use_egg != cache._useEgg || (use_egg && (cache._eggHx != _eggHx || cache._eggHy != _eggHy || cache._eggX != _eggX || cache._eggY != _eggY || cache._sprEgg != _sprEgg))) {
+        const auto egg_rect = FRect(static_cast<float>(_eggX) / zoom, static_cast<float>(_eggY) / zoom, static_cast<float>(_eggX + _eggSprWidth) / zoom, static_cast<float>(_eggY + _eggSprHeight) / zoom);
+
+        for (size_t i = 0; i < cache._chunksCount; i++) {
+            auto& chunk = cache._chunks[i];
+            const auto& b = chunk.Bounds;
+            if (chunk.EggAffected || (use_egg && !(egg_rect.Left > b.Right || egg_rect.Right < b.Left || egg_rect.Top > b.Bottom || egg_rect.Bottom < b.Top))) {
+                chunk.NeedBake = true;
+            }
+        }
+
+        cache._useEgg = use_egg;
+        cache._eggHx = _eggHx;
+        cache._eggHy = _eggHy;
+        cache._eggX = _eggX;
+        cache._eggY = _eggY;
+        cache._sprEgg = _sprEgg;
+    }
+
+    // Keep order with already queued sprites
+    Flush();
+
+    const auto ox = static_cast<float>(_settings.ScrOx) / zoom;
+    const auto oy = static_cast<float>(_settings.ScrOy) / zoom;
+    const auto screen_width = static_cast<float>(_settings.ScreenWidth);
+    const auto screen_height = static_cast<float>(_settings.ScreenHeight);
+
+    for (size_t i = 0; i < cache._chunksCount; i++) {
+        auto& chunk = cache._chunks[i];
+        if (chunk.NeedBake) {
+            BakeChunk(cache, chunk, use_egg);
+        }
+
+        const auto& b = chunk.Bounds;
+        if (chunk.UsedSprites.empty() || b.Left + ox > screen_width || b.Right + ox < 0.0f || b.Top + oy > screen_height || b.Bottom + oy < 0.0f) {
+            continue;
+        }
+
+        for (auto* si : chunk.UsedSprites) {
+            si->UsedFrame = _frameIndex;
+        }
+        if (chunk.Dips.empty()) {
+            continue;
+        }
+
+        // Baked without screen scroll, apply it as projection offset
+        size_t pos = 0;
+        for (const auto& dip : chunk.Dips) {
+            auto* effect = dip.SourceEffect;
+            const auto proj_buf = effect->ProjBuf;
+            auto* m = effect->ProjBuf.ProjMatrix;
+            for (auto r = 0; r < 4; r++) {
+                m[12 + r] += m[r] * ox + m[4 + r] * oy;
+            }
+
+            effect->DrawBuffer(chunk.DrawBuf, pos, dip.SpritesCount * 6, dip.MainTex);
+            effect->ProjBuf = proj_buf;
+            pos += dip.SpritesCount * 6;
+        }
+    }
+}
+
+void SpriteManager::PrepareChunkCache(Sprites& dtree, SpriteChunkCache& cache, int draw_oder_from, int draw_oder_to)
+{
+    cache._valid = false;
+    cache._chunksCount = 0;
+    cache._alphaValues.clear();
+
+    for (auto* spr = dtree.RootSprite(); spr != nullptr; spr = spr->ChainChild) {
+        if (spr->DrawOrderType < draw_oder_from) {
+            continue;
+        }
+        if (spr->DrawOrderType > draw_oder_to) {
+            break;
+        }
+
+        if (cache._chunksCount == 0 || cache._chunks[cache._chunksCount - 1].SpritesCount == SpriteChunkCache::CHUNK_SPRITES) {
+            if (cache._chunksCount == cache._chunks.size()) {
+                auto* draw_buf = App->Render.CreateDrawBuffer(true);
+                if (draw_buf == nullptr) {
+                    return;
+                }
+                cache._chunks.emplace_back().DrawBuf = draw_buf;
+            }
+
+            auto& chunk = cache._chunks[cache._chunksCount++];
+            chunk.FirstSprite = spr;
+            chunk.SpritesCount = 0;
+            chunk.NeedBake = true;
+            chunk.EggAffected = false;
+        }
+
+        cache._chunks[cache._chunksCount - 1].SpritesCount++;
+
+        if (spr->Alpha != nullptr && std::find_if(cache._alphaValues.begin(), cache._alphaValues.end(), [spr](auto&& a) { return a.first == spr->Alpha; }) == cache._alphaValues.end()) {
+            cache._alphaValues.emplace_back(spr->Alpha, *spr->Alpha);
+        }
+    }
+
+    cache._valid = true;
+    cache._treeVersion = dtree.GetVersion();
+    cache._drawOrderFrom = draw_oder_from;
+    cache._drawOrderTo = draw_oder_to;
+    cache._zoom = _settings.SpritesZoom;
+    cache._baseColor = _baseColor;
+    cache._atlasVersion = _atlasVersion;
+    cache._useEgg = false;
+}
+
+void SpriteManager::BakeChunk(SpriteChunkCache& cache, SpriteChunkCache::Chunk& chunk, bool use_egg)
+{
+    chunk.NeedBake = false;
+    chunk.EggAffected = false;
+    chunk.Dips.clear();
+    chunk.UsedSprites.clear();
+    chunk.Bounds = FRect();
+
+    const auto zoom = _settings.SpritesZoom;
+    auto& vbuf = chunk.DrawBuf->Vertices2D;
+    vbuf.resize(chunk.SpritesCount * 4);
+    size_t quads = 0;
+
+    auto* spr = chunk.FirstSprite;
+    for (size_t i = 0; i < chunk.SpritesCount; i++, spr = spr->ChainChild) {
+        RUNTIME_ASSERT(spr->Valid);
+
+        const auto id = spr->PSprId != nullptr ? *spr->PSprId : spr->SprId;
+        auto* si = _sprData[id];
+        if (si == nullptr) {
+            continue;
+        }
+
+        // Same as in DrawSprites but without screen scroll
+        auto x = spr->ScrX - si->Width / 2 + si->OffsX + *spr->PScrX;
+        auto y = spr->ScrY - si->Height + si->OffsY + *spr->PScrY;
+        if (spr->OffsX != nullptr) {
+            x += *spr->OffsX;
+        }
+        if (spr->OffsY != nullptr) {
+            y += *spr->OffsY;
+        }
+
+        const auto xf = static_cast<float>(x) / zoom;
+        const auto yf = static_cast<float>(y) / zoom;
+        const auto wf = static_cast<float>(si->Width) / zoom;
+        const auto hf = static_cast<float>(si->Height) / zoom;
+
+        if (chunk.UsedSprites.empty()) {
+            chunk.Bounds = FRect(xf, yf, xf + wf, yf + hf);
+        }
+        else {
+            chunk.Bounds.Left = std::min(chunk.Bounds.Left, xf);
+            chunk.Bounds.Top = std::min(chunk.Bounds.Top, yf);
+            chunk.Bounds.Right = std::max(chunk.Bounds.Right, xf + wf);
+            chunk.Bounds.Bottom = std::max(chunk.Bounds.Bottom, yf + hf);
+        }
+
+        // Evicted sprites are kept for usage marking and baked after refill
+        chunk.UsedSprites.push_back(si);
+        if (si->Atlas == nullptr) {
+            continue;
+        }
+
+        const auto [color_l, color_r] = GetSpriteColors(spr);
+        auto* v = &vbuf[quads * 4];
+
+        auto egg_added = false;
+        if (use_egg && spr->EggType != 0 && CompareHexEgg(spr->HexX, spr->HexY, spr->EggType)) {
+            egg_added = FillEggCoords(v, si, x - _eggX, y - _eggY);
+            chunk.EggAffected |= egg_added;
+        }
+
+        auto* effect = spr->DrawEffect != nullptr ? *spr->DrawEffect : nullptr;
+        if (effect == nullptr) {
+            effect = si->DrawEffect != nullptr ? si->DrawEffect : _effectMngr.Effects.Generic;
+        }
+
+        if (chunk.Dips.empty() || chunk.Dips.back().MainTex != si->Atlas->MainTex || chunk.Dips.back().SourceEffect != effect) {
+            chunk.Dips.push_back(DipData {si->Atlas->MainTex, effect, 1});
+        }
+        else {
+            chunk.Dips.back().SpritesCount++;
+        }
+
+        FillSpriteVertices(v, si, xf, yf, wf, hf, color_l, color_r);
+
+        if (!egg_added) {
+            for (auto k = 0; k < 4; k++) {
+                v[k].TUEgg = -1.0f;
+            }
+        }
+
+        quads++;
+    }
+
+    vbuf.resize(quads * 4);
+    chunk.DrawBuf->DataChanged = true;
+    cache._bakesCount++;
+}
+
+auto SpriteManager::GetSpriteColors(const Sprite* spr) const -> pair<uint, uint>
+{
+    // Base color
+    uint color_r = 0;
+    uint color_l = 0;
+    if (spr->Color != 0u) {
+        color_r = color_l = spr->Color | 0xFF000000;
+    }
+    else {
+        color_r = color_l = _baseColor;
+    }
+
+    // Light
+    if (spr->Light != nullptr) {
+        static auto light_func = [](uint& c, const uchar* l, const uchar* l2) {
+            const int lr = *l;
+            const int lg = *(l + 1);
+            const int lb = *(l + 2);
+            const int lr2 = *l2;
+            const int lg2 = *(l2 + 1);
+            const int lb2 = *(l2 + 2);
+            auto& r = reinterpret_cast<uchar*>(&c)[2];
+            auto& g = reinterpret_cast<uchar*>(&c)[1];
+            auto& b = reinterpret_cast<uchar*>(&c)[0];
+            const auto ir = static_cast<int>(r) + (lr + lr2) / 2;
+            const auto ig = static_cast<int>(g) + (lg + lg2) / 2;
+            const auto ib = static_cast<int>(b) + (lb + lb2) / 2;
+            r = static_cast<uchar>(std::min(ir, 255));
+            g = static_cast<uchar>(std::min(ig, 255));
+            b = static_cast<uchar>(std::min(ib, 255));
+        };
+        light_func(color_r, spr->Light, spr->LightRight);
+        light_func(color_l, spr->Light, spr->LightLeft);
+    }
+
+    // Alpha
+    if (spr->Alpha != nullptr) {
+        reinterpret_cast<uchar*>(&color_r)[3] = *spr->Alpha;
+        reinterpret_cast<uchar*>(&color_l)[3] = *spr->Alpha;
+    }
+
+    // Fix color
+    color_r = COLOR_SWAP_RB(color_r);
+    color_l = COLOR_SWAP_RB(color_l);
+
+    return {color_l, color_r};
+}
+
+auto SpriteManager::FillEggCoords(Vertex2D* vbuf, const SpriteInfo* si, int egg_x, int egg_y) const -> bool
+{
+    auto x1 = egg_x;
+    auto y1 = egg_y;
+    auto x2 = x1 + si->Width;
+    auto y2 = y1 + si->Height;
+
+    if (x1 >= _eggSprWidth || y1 >= _eggSprHeight || x2 < 0 || y2 < 0) {
+        return false;
+    }
+
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, _eggSprWidth);
+    y2 = std::min(y2, _eggSprHeight);
+
+    const auto x1_f = static_cast<float>(x1 + ATLAS_SPRITES_PADDING);
+    const auto x2_f = static_cast<float>(x2 + ATLAS_SPRITES_PADDING);
+    const auto y1_f = static_cast<float>(y1 + ATLAS_SPRITES_PADDING);
+    const auto y2_f = static_cast<float>(y2 + ATLAS_SPRITES_PADDING);
+
+    vbuf[0].TUEgg = x1_f / _eggAtlasWidth;
+    vbuf[0].TVEgg = y2_f / _eggAtlasHeight;
+    vbuf[1].TUEgg = x1_f / _eggAtlasWidth;
+    vbuf[1].TVEgg = y1_f / _eggAtlasHeight;
+    vbuf[2].TUEgg = x2_f / _eggAtlasWidth;
+    vbuf[2].TVEgg = y1_f / _eggAtlasHeight;
+    vbuf[3].TUEgg = x2_f / _eggAtlasWidth;
+    vbuf[3].TVEgg = y2_f / _eggAtlasHeight;
+
+    return true;
+}
+
+void SpriteManager::FillSpriteVertices(Vertex2D* vbuf, const SpriteInfo* si, float xf, float yf, float wf, float hf, uint color_l, uint color_r) const
+{
+    vbuf[0].X = xf;
+    vbuf[0].Y = yf + hf;
+    vbuf[0].TU = si->SprRect.Left;
+    vbuf[0].TV = si->SprRect.Bottom;
+    vbuf[0].Diffuse = color_l;
+
+    vbuf[1].X = xf;
+    vbuf[1].Y = yf;
+    vbuf[1].TU = si->SprRect.Left;
+    vbuf[1].TV = si->SprRect.Top;
+    vbuf[1].Diffuse = color_l;
+
+    vbuf[2].X = xf + wf;
+    vbuf[2].Y = yf;
+    vbuf[2].TU = si->SprRect.Right;
+    vbuf[2].TV = si->SprRect.Top;
+    vbuf[2].Diffuse = color_r;
+
+    vbuf[3].X = xf + wf;
+    vbuf[3].Y = yf + hf;
+    vbuf[3].TU = si->SprRect.Right;
+    vbuf[3].TV = si->SprRect.Bottom;
+    vbuf[3].Diffuse = color_r;
+}
+
 auto SpriteManager::IsPixNoTransp(uint spr_id, int offs_x, int offs_y, bool with_zoom) const -> bool
 {
     const auto color = GetPixColor(spr_id, offs_x, offs_y, with_zoom);
@@ -1745,7 +2206,7 @@ auto SpriteManager::GetPixColor(uint spr_id, int offs_x, int offs_y, bool with_z
     }
 
     const auto* si = _sprData[spr_id];
-    if (si == nullptr) {
+    if (si == nullptr || si->Atlas == nullptr) {
         return 0;
     }
 
@@ -41,6 +41,7 @@
 
 #include "3dStuff.h"
 #include "Application.h"
+#include "AtlasPacker.h"
 #include "EffectManager.h"
 #include "FileSystem.h"
 #include "Settings.h"
@@ -145,31 +146,13 @@ struct RenderTarget
 
 struct TextureAtlas
 {
-    struct SpaceNode
-    {
-        SpaceNode(int x, int y, uint w, uint h);
-        auto FindPosition(uint w, uint h, int& x, int& y) -> bool;
-
-        int PosX {};
-        int PosY {};
-        uint Width {};
-        uint Height {};
-        bool Busy {};
-        unique_ptr<SpaceNode> Child1 {};
-        unique_ptr<SpaceNode> Child2 {};
-    };
-
     AtlasType Type {};
     RenderTarget* RT {};
     RenderTexture* MainTex {};
     uint Width {};
     uint Height {};
-    unique_ptr<SpaceNode> RootNode {};
-    int CurX {};
-    int CurY {};
-    uint LineMaxH {};
-    uint LineCurH {};
-    uint LineW {};
+    unique_ptr<AtlasPacker> Packer {};
+    size_t SpritesCount {};
 };
 
 struct SpriteInfo
@@ -184,6 +167,10 @@ struct SpriteInfo
     uchar* Data {};
     AtlasType DataAtlasType {};
     bool DataAtlasOneImage {};
+    int AtlasX {}; // Top left corner of padded place in atlas
+    int AtlasY {};
+    uint UsedFrame {}; // Last scene index where sprite was drawn
+    bool Evicted {}; // Pixels removed from atlas, sprite is skipped until refill
 #if FO_ENABLE_3D
     bool UsedForModel {};
     ModelInstance* Model {};
@@ -212,6 +199,45 @@ struct AnyFrames
 };
 static_assert(std::is_standard_layout_v<AnyFrames>);
 
+// Content of 2d animation file, read on any thread and placed to atlas later
+struct Animation2dData
+{
+    struct Frame
+    {
+        bool IsCopy {};
+        ushort CopyIndex {};
+        ushort Width {};
+        ushort Height {};
+        short NextX {};
+        short NextY {};
+        unique_ptr<uchar[]> Data {};
+    };
+
+    struct Dir
+    {
+        short OffsX {};
+        short OffsY {};
+        vector<Frame> Frames {};
+    };
+
+    ushort FramesCount {};
+    uint Ticks {};
+    vector<Dir> Dirs {};
+};
+
+struct AtlasStatistics
+{
+    size_t AtlasesCount {};
+    size_t TotalArea {};
+    size_t UsedArea {};
+    size_t SpritesCount {};
+    size_t EvictedSprites {};
+    size_t Evictions {};
+    size_t Refills {};
+    size_t CompactionMoves {};
+    size_t AtlasesReleased {};
+};
+
 struct PrimitivePoint
 {
     int PointX {};
@@ -229,6 +255,60 @@ struct DipData
     size_t SpritesCount {};
 };
 
+// Sprites baked to static draw buffers by chunks of sequential sprites in draw order
+// Intended for rarely changed trees (map tiles and roofs), screen scroll is applied by projection offset
+// Rebuilt automatically on tree changes, zoom, base color and alpha changes, other changes require Invalidate call
+class SpriteChunkCache final
+{
+    friend class SpriteManager;
+
+public:
+    static constexpr uint CHUNK_SPRITES = 1024;
+
+    SpriteChunkCache() = default;
+    SpriteChunkCache(const SpriteChunkCache&) = delete;
+    SpriteChunkCache(SpriteChunkCache&&) noexcept = delete;
+    auto operator=(const SpriteChunkCache&) = delete;
+    auto operator=(SpriteChunkCache&&) noexcept = delete;
+    ~SpriteChunkCache();
+
+    [[nodiscard]] auto GetChunksCount() const -> size_t { return _chunksCount; }
+    [[nodiscard]] auto GetBakesCount() const -> size_t { return _bakesCount; }
+
+    void Invalidate();
+
+private:
+    struct Chunk
+    {
+        RenderDrawBuffer* DrawBuf {};
+        Sprite* FirstSprite {};
+        size_t SpritesCount {};
+        vector<SpriteInfo*> UsedSprites {};
+        vector<DipData> Dips {};
+        FRect Bounds {};
+        bool NeedBake {};
+        bool EggAffected {};
+    };
+
+    vector<Chunk> _chunks {};
+    size_t _chunksCount {};
+    bool _valid {};
+    uint _treeVersion {};
+    int _drawOrderFrom {};
+    int _drawOrderTo {};
+    float _zoom {};
+    uint _baseColor {};
+    vector<pair<const uchar*, uchar>> _alphaValues {};
+    bool _useEgg {};
+    ushort _eggHx {};
+    ushort _eggHy {};
+    int _eggX {};
+    int _eggY {};
+    const SpriteInfo* _sprEgg {};
+    uint _atlasVersion {};
+    size_t _bakesCount {};
+};
+
 class SpriteManager final
 {
 public:
@@ -256,9 +336,13 @@ class SpriteManager final
     [[nodiscard]] auto IsEggTransp(int pix_x, int pix_y) const -> bool;
     [[nodiscard]] auto CompareHexEgg(ushort hx, ushort hy, int egg_type) const -> bool;
     [[nodiscard]] auto IsAccumulateAtlasActive() const -> bool;
+    [[nodiscard]] auto GetAtlasStatistics(AtlasType atlas_type) const -> AtlasStatistics;
+    [[nodiscard]] auto GetFrameIndex() const -> uint { return _frameIndex; }
     [[nodiscard]] auto LoadAnimation(string_view fname, bool use_dummy, bool frm_anim_pix) -> AnyFrames*;
     [[nodiscard]] auto ReloadAnimation(AnyFrames* anim, string_view fname) -> AnyFrames*;
     [[nodiscard]] auto CreateAnyFrames(uint frames, uint ticks) -> AnyFrames*;
+    // Does not touch sprites and atlases so may be called from resource loading threads
+    [[nodiscard]] auto Read2dAnimation(string_view fname) const -> unique_ptr<Animation2dData>;
 #if FO_ENABLE_3D
     [[nodiscard]] auto LoadModel(string_view fname, bool auto_redraw) -> ModelInstance*;
 #endif
@@ -287,6 +371,12 @@ class SpriteManager final
     void DumpAtlases();
     void CreateAnyFramesDirAnims(AnyFrames* anim, uint dirs);
     void DestroyAnyFrames(AnyFrames* anim);
+    void Fill2dAnimation(AnyFrames* anim, Animation2dData& data);
+    // Evicted sprites keep their ids and metrics, pixels are placed back by refill from same animation data
+    void EvictAnyFrames(AnyFrames* anim);
+    void RefillAnyFrames(AnyFrames* anim, Animation2dData& data);
+    // Moves sprites from sparse atlases to other atlases of same type and releases emptied atlases
+    void CompactAtlases(AtlasType atlas_type, float max_occupancy, size_t max_moves);
     void SetSpritesColor(uint c) { _baseColor = c; }
     void PrepareSquare(PrimitivePoints& points, const IRect& r, uint color);
     void PrepareSquare(PrimitivePoints& points, IPoint lt, IPoint rt, IPoint lb, IPoint rb, uint color);
@@ -298,6 +388,7 @@ class SpriteManager final
     void DrawSpriteSizeExt(uint id, int x, int y, int w, int h, bool zoom_up, bool center, bool stretch, uint color);
     void DrawSpritePattern(uint id, int x, int y, int w, int h, int spr_width, int spr_height, uint color);
     void DrawSprites(Sprites& dtree, bool collect_contours, bool use_egg, int draw_oder_from, int draw_oder_to, bool prerender, int prerender_ox, int prerender_oy);
+    void DrawCachedSprites(Sprites& dtree, SpriteChunkCache& cache, bool use_egg, int draw_oder_from, int draw_oder_to);
     void DrawPoints(PrimitivePoints& points, RenderPrimitiveType prim, const float* zoom, FPoint* offset, RenderEffect* custom_effect);
 
     void DrawContours();
@@ -318,13 +409,22 @@ class SpriteManager final
 private:
     [[nodiscard]] auto CreateAtlas(uint w, uint h) -> TextureAtlas*;
     [[nodiscard]] auto FindAtlasPlace(SpriteInfo* si, int& x, int& y) -> TextureAtlas*;
+    [[nodiscard]] auto UseSpriteInfo(uint id) -> SpriteInfo*;
     [[nodiscard]] auto RequestFillAtlas(SpriteInfo* si, uint w, uint h, uchar* data) -> uint;
     [[nodiscard]] auto Load2dAnimation(string_view fname) -> AnyFrames*;
 #if FO_ENABLE_3D
     [[nodiscard]] auto Load3dAnimation(string_view fname) -> AnyFrames*;
 #endif
 
+    [[nodiscard]] auto GetSpriteColors(const Sprite* spr) const -> pair<uint, uint>;
+    [[nodiscard]] auto FillEggCoords(Vertex2D* vbuf, const SpriteInfo* si, int egg_x, int egg_y) const -> bool;
+
     void FillAtlas(SpriteInfo* si);
+    void FreeAtlasPlace(SpriteInfo* si);
+    void DestroyRenderTarget(RenderTarget* rt);
+    void FillSpriteVertices(Vertex2D* vbuf, const SpriteInfo* si, float xf, float yf, float wf, float hf, uint color_l, uint color_r) const;
+    void PrepareChunkCache(Sprites& dtree, SpriteChunkCache& cache, int draw_oder_from, int draw_oder_to);
+    void BakeChunk(SpriteChunkCache& cache, SpriteChunkCache::Chunk& chunk, bool use_egg);
     void RefreshScissor();
     void EnableScissor();
     void DisableScissor();
@@ -348,6 +448,9 @@ class SpriteManager final
     bool _accumulatorActive {};
     vector<SpriteInfo*> _accumulatorSprInfo {};
     vector<SpriteInfo*> _sprData {};
+    uint _frameIndex {};
+    uint _atlasVersion {};
+    AtlasStatistics _atlasStats {};
     MemoryPool<sizeof(AnyFrames), ANY_FRAMES_POOL_SIZE> _anyFramesPool {};
     vector<DipData> _dipQueue {};
     RenderDrawBuffer* _spritesDrawBuf {};
@@ -32,6 +32,7 @@
 //
 
 #include "Sprites.h"
+#include "FrameProfiler.h"
 #include "SpriteManager.h"
 
 void Sprite::Unvalidate()
@@ -78,6 +79,7 @@ void Sprite::Unvalidate()
     }
 
     Root->_unvalidatedSprites.push_back(this);
+    Root->_version++;
 
     if (ChainRoot != nullptr) {
         *ChainRoot = ChainChild;
@@ -291,6 +293,7 @@ auto Sprites::RootSprite() -> Sprite*
 auto Sprites::PutSprite(Sprite* child, int draw_order, ushort hx, ushort hy, int x, int y, int* sx, int* sy, uint id, uint* id_ptr, short* ox, short* oy, uchar* alpha, RenderEffect** effect, bool* callback) -> Sprite&
 {
     _spriteCount++;
+    _version++;
 
     Sprite* spr;
     if (!_unvalidatedSprites.empty()) {
@@ -433,10 +436,14 @@ void Sprites::Unvalidate()
 
 void Sprites::SortByMapPos()
 {
+    PROFILER_ZONE("SortSprites");
+
     if (_rootSprite == nullptr) {
         return;
     }
 
+    _version++;
+
     SpriteVec sprites;
     sprites.reserve(_spriteCount);
     auto* spr = _rootSprite;
@@ -147,6 +147,8 @@ class Sprites final
 
     [[nodiscard]] auto RootSprite() -> Sprite*;
     [[nodiscard]] auto Size() const -> uint;
+    // Changed on any sprite add, remove or reorder
+    [[nodiscard]] auto GetVersion() const -> uint { return _version; }
 
     [[nodiscard]] auto AddSprite(int draw_order, ushort hx, ushort hy, int x, int y, int* sx, int* sy, uint id, uint* id_ptr, short* ox, short* oy, uchar* alpha, RenderEffect** effect, bool* callback) -> Sprite&;
     [[nodiscard]] auto InsertSprite(int draw_order, ushort hx, ushort hy, int x, int y, int* sx, int* sy, uint id, uint* id_ptr, short* ox, short* oy, uchar* alpha, RenderEffect** effect, bool* callback) -> Sprite&;
@@ -165,6 +167,7 @@ class Sprites final
     Sprite* _rootSprite {};
     Sprite* _lastSprite {};
     uint _spriteCount {};
+    uint _version {};
     SpriteVec _unvalidatedSprites {};
     bool _nonConstHelper {};
 };
@@ -60,6 +60,31 @@ GlobalDataCallback CreateGlobalDataCallbacks[MAX_GLOBAL_DATA_CALLBACKS];
 GlobalDataCallback DeleteGlobalDataCallbacks[MAX_GLOBAL_DATA_CALLBACKS];
 int GlobalDataCallbacksCount;
 
+// Buffered log records are written before crash report, they often explain the crash
+static std::terminate_handler PrevTerminateHandler;
+
+static void FlushLogTerminateHandler()
+{
+    FlushLogOnCrash();
+
+    if (PrevTerminateHandler != nullptr) {
+        PrevTerminateHandler();
+    }
+
+    std::abort();
+}
+
+#if FO_WINDOWS
+static LPTOP_LEVEL_EXCEPTION_FILTER PrevExceptionFilter;
+
+static auto WINAPI FlushLogExceptionFilter(EXCEPTION_POINTERS* info) -> LONG
+{
+    FlushLogOnCrash();
+
+    return PrevExceptionFilter != nullptr ? PrevExceptionFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+}
+#endif
+
 void InitApp(int argc, char** argv, string_view name_appendix)
 {
     // Ensure that we call init only once
@@ -78,6 +103,13 @@ void InitApp(int argc, char** argv, string_view name_appendix)
     }
 #endif
 
+    // Installed over crash reporter handlers and pass control to them after log flush
+    // Fatal signals are left to crash reporter, log flush is not async signal safe
+    PrevTerminateHandler = std::set_terminate(FlushLogTerminateHandler);
+#if FO_WINDOWS
+    PrevExceptionFilter = ::SetUnhandledExceptionFilter(FlushLogExceptionFilter);
+#endif
+
     CreateGlobalData();
 
     App = new Application(argc, argv, name_appendix);
@@ -144,6 +176,7 @@ void ReportExceptionAndExit(const std::exception& ex)
 {
     if (!BreakIntoDebugger(ex.what())) {
         WriteLog(LogType::Error, "\n{}\n", ex.what());
+        FlushLog();
         CreateDumpMessage("FatalException", ex.what());
         MessageBox::ShowErrorMessage("Fatal Error", ex.what(), GetStackTrace());
     }
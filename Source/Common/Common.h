@@ -195,6 +195,7 @@ using std::type_index;
 using std::type_info;
 using std::unique_ptr;
 using std::unordered_map;
+using std::unordered_multimap;
 using std::unordered_set;
 using std::variant;
 using std::vector;
@@ -54,6 +54,7 @@ class DataSource::Impl
     [[nodiscard]] virtual auto GetPackName() const -> string_view = 0;
     [[nodiscard]] virtual auto IsFilePresent(string_view path, string_view path_lower, size_t& size, uint64& write_time) const -> bool = 0;
     [[nodiscard]] virtual auto OpenFile(string_view path, string_view path_lower, size_t& size, uint64& write_time) const -> unique_del_ptr<uchar> = 0;
+    [[nodiscard]] virtual auto GetDiskPath(string_view /*path*/, string_view /*path_lower*/) const -> string { return {}; } // Empty for files inside packs
     [[nodiscard]] virtual auto GetFileNames(string_view path, bool include_subdirs, string_view ext) const -> vector<string> = 0;
 };
 
@@ -97,6 +98,7 @@ class NonCachedDir final : public DataSource::Impl
     [[nodiscard]] auto GetPackName() const -> string_view override { return _basePath; }
     [[nodiscard]] auto IsFilePresent(string_view path, string_view path_lower, size_t& size, uint64& write_time) const -> bool override;
     [[nodiscard]] auto OpenFile(string_view path, string_view path_lower, size_t& size, uint64& write_time) const -> unique_del_ptr<uchar> override;
+    [[nodiscard]] auto GetDiskPath(string_view path, string_view path_lower) const -> string override;
     [[nodiscard]] auto GetFileNames(string_view path, bool include_subdirs, string_view ext) const -> vector<string> override;
 
 private:
@@ -117,6 +119,7 @@ class CachedDir final : public DataSource::Impl
     [[nodiscard]] auto GetPackName() const -> string_view override { return _basePath; }
     [[nodiscard]] auto IsFilePresent(string_view path, string_view path_lower, size_t& size, uint64& write_time) const -> bool override;
     [[nodiscard]] auto OpenFile(string_view path, string_view path_lower, size_t& size, uint64& write_time) const -> unique_del_ptr<uchar> override;
+    [[nodiscard]] auto GetDiskPath(string_view path, string_view path_lower) const -> string override;
     [[nodiscard]] auto GetFileNames(string_view path, bool include_subdirs, string_view ext) const -> vector<string> override;
 
 private:
@@ -155,6 +158,7 @@ class FalloutDat final : public DataSource::Impl
     auto ReadTree() -> bool;
 
     mutable DiskFile _datFile;
+    mutable std::mutex _datFileLocker {};
     IndexMap _filesTree {};
     FileNameVec _filesTreeNames {};
     string _fileName {};
@@ -193,6 +197,7 @@ class ZipFile final : public DataSource::Impl
     FileNameVec _filesTreeNames {};
     string _fileName {};
     unzFile _zipHandle {};
+    mutable std::mutex _zipHandleLocker {};
     uint64 _writeTime {};
 };
 
@@ -326,6 +331,11 @@ auto DataSource::GetFileNames(string_view path, bool include_subdirs, string_vie
     return _pImpl->GetFileNames(path, include_subdirs, ext);
 }
 
+auto DataSource::GetDiskPath(string_view path, string_view path_lower) const -> string
+{
+    return _pImpl->GetDiskPath(path, path_lower);
+}
+
 NonCachedDir::NonCachedDir(string_view fname)
 {
     _basePath = fname;
@@ -368,6 +378,13 @@ auto NonCachedDir::OpenFile(string_view path, string_view path_lower, size_t& si
     return {buf, [](auto* p) { delete[] p; }};
 }
 
+auto NonCachedDir::GetDiskPath(string_view path, string_view path_lower) const -> string
+{
+    UNUSED_VARIABLE(path_lower);
+
+    return _str("{}{}", _basePath, path);
+}
+
 auto NonCachedDir::GetFileNames(string_view path, bool include_subdirs, string_view ext) const -> vector<string>
 {
     FileNameVec fnames;
@@ -440,6 +457,18 @@ auto CachedDir::OpenFile(string_view path, string_view path_lower, size_t& size,
     return {buf, [](auto* p) { delete[] p; }};
 }
 
+auto CachedDir::GetDiskPath(string_view path, string_view path_lower) const -> string
+{
+    UNUSED_VARIABLE(path);
+
+    const auto it = _filesTree.find(string(path_lower));
+    if (it == _filesTree.end()) {
+        return {};
+    }
+
+    return it->second.FileName;
+}
+
 auto CachedDir::GetFileNames(string_view path, bool include_subdirs, string_view ext) const -> vector<string>
 {
     return GetFileNamesGeneric(_filesTreeNames, path, include_subdirs, ext);
@@ -645,6 +674,9 @@ auto FalloutDat::OpenFile(string_view path, string_view path_lower, size_t& size
     int offset = 0;
     std::memcpy(&offset, ptr + 9, sizeof(offset));
 
+    // Shared file position, files may be read from resource loading threads
+    std::lock_guard locker(_datFileLocker);
+
     if (!_datFile.SetPos(offset, DiskFileSeek::Set)) {
         throw DataSourceException("Can't read file from fallout dat (1)", path);
     }
@@ -925,6 +957,9 @@ auto ZipFile::OpenFile(string_view path, string_view path_lower, size_t& size, u
     const auto& info = it->second;
     auto pos = info.Pos;
 
+    // Shared handle, files may be read from resource loading threads
+    std::lock_guard locker(_zipHandleLocker);
+
     if (unzGoToFilePos(_zipHandle, &pos) != UNZ_OK) {
         throw DataSourceException("Can't read file from zip (1)", path);
     }
@@ -43,6 +43,8 @@
 #include <io.h>
 #else
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #endif
@@ -64,6 +66,11 @@ auto DiskFileSystem::OpenFile(string_view fname, bool write, bool write_through)
     return DiskFile(fname, write, write_through);
 }
 
+auto DiskFileSystem::MapFile(string_view fname) -> DiskFileMapping
+{
+    return DiskFileMapping(fname);
+}
+
 auto DiskFileSystem::FindFiles(string_view path, string_view ext) -> DiskFind
 {
     return DiskFind(path, ext);
@@ -460,6 +467,146 @@ auto DiskFile::GetSize() const -> size_t
 }
 #endif
 
+#if FO_WINDOWS
+struct DiskFileMapping::Impl
+{
+    HANDLE FileHandle {};
+    HANDLE MappingHandle {};
+    const uchar* Data {};
+    size_t Size {};
+};
+
+DiskFileMapping::DiskFileMapping(string_view fname)
+{
+    const auto file_handle = ::CreateFileW(WinMultiByteToWideChar(fname).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER li;
+    if (::GetFileSizeEx(file_handle, &li) == FALSE || li.HighPart != 0 || li.LowPart == 0) {
+        ::CloseHandle(file_handle);
+        return;
+    }
+
+    const auto mapping_handle = ::CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        ::CloseHandle(file_handle);
+        return;
+    }
+
+    const auto* data = ::MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        ::CloseHandle(mapping_handle);
+        ::CloseHandle(file_handle);
+        return;
+    }
+
+    _pImpl = std::make_unique<Impl>();
+    _pImpl->FileHandle = file_handle;
+    _pImpl->MappingHandle = mapping_handle;
+    _pImpl->Data = static_cast<const uchar*>(data);
+    _pImpl->Size = li.LowPart;
+}
+
+DiskFileMapping::~DiskFileMapping()
+{
+    if (_pImpl) {
+        ::UnmapViewOfFile(_pImpl->Data);
+        ::CloseHandle(_pImpl->MappingHandle);
+        ::CloseHandle(_pImpl->FileHandle);
+    }
+}
+
+#elif !FO_ANDROID && !FO_WEB
+struct DiskFileMapping::Impl
+{
+    const uchar* Data {};
+    size_t Size {};
+};
+
+DiskFileMapping::DiskFileMapping(string_view fname)
+{
+    const auto fd = ::open(string(fname).c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return;
+    }
+
+    auto* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return;
+    }
+
+    _pImpl = std::make_unique<Impl>();
+    _pImpl->Data = static_cast<const uchar*>(data);
+    _pImpl->Size = static_cast<size_t>(st.st_size);
+}
+
+DiskFileMapping::~DiskFileMapping()
+{
+    if (_pImpl) {
+        ::munmap(const_cast<uchar*>(_pImpl->Data), _pImpl->Size);
+    }
+}
+
+#else
+// Android assets and web virtual file system are not backed by real files
+struct DiskFileMapping::Impl
+{
+    unique_ptr<uchar[]> Buf {};
+    const uchar* Data {};
+    size_t Size {};
+};
+
+DiskFileMapping::DiskFileMapping(string_view fname)
+{
+    auto file = DiskFileSystem::OpenFile(fname, false);
+    if (!file || file.GetSize() == 0u) {
+        return;
+    }
+
+    auto buf = std::make_unique<uchar[]>(file.GetSize());
+    if (!file.Read(buf.get(), file.GetSize())) {
+        return;
+    }
+
+    _pImpl = std::make_unique<Impl>();
+    _pImpl->Size = file.GetSize();
+    _pImpl->Buf = std::move(buf);
+    _pImpl->Data = _pImpl->Buf.get();
+}
+
+DiskFileMapping::~DiskFileMapping() = default;
+#endif
+
+DiskFileMapping::DiskFileMapping(DiskFileMapping&&) noexcept = default;
+
+DiskFileMapping::operator bool() const
+{
+    return !!_pImpl;
+}
+
+auto DiskFileMapping::GetData() const -> const uchar*
+{
+    RUNTIME_ASSERT(_pImpl);
+
+    return _pImpl->Data;
+}
+
+auto DiskFileMapping::GetSize() const -> size_t
+{
+    RUNTIME_ASSERT(_pImpl);
+
+    return _pImpl->Size;
+}
+
 #if FO_WINDOWS
 struct DiskFind::Impl
 {
@@ -74,6 +74,30 @@ class DiskFile final
     bool _nonConstHelper {};
 };
 
+// Read only view of whole file, mapped to memory where platform allows, otherwise read to memory
+class DiskFileMapping final
+{
+    friend class DiskFileSystem;
+
+public:
+    DiskFileMapping() = delete;
+    DiskFileMapping(const DiskFileMapping&) = delete;
+    DiskFileMapping(DiskFileMapping&&) noexcept;
+    auto operator=(const DiskFileMapping&) -> DiskFileMapping& = delete;
+    auto operator=(DiskFileMapping&&) -> DiskFileMapping& = delete;
+    explicit operator bool() const;
+    ~DiskFileMapping();
+
+    [[nodiscard]] auto GetData() const -> const uchar*;
+    [[nodiscard]] auto GetSize() const -> size_t;
+
+private:
+    explicit DiskFileMapping(string_view fname);
+
+    struct Impl;
+    unique_ptr<Impl> _pImpl {};
+};
+
 class DiskFind final
 {
     friend class DiskFileSystem;
@@ -110,6 +134,7 @@ class DiskFileSystem final
 
     [[nodiscard]] static auto OpenFile(string_view fname, bool write) -> DiskFile;
     [[nodiscard]] static auto OpenFile(string_view fname, bool write, bool write_through) -> DiskFile;
+    [[nodiscard]] static auto MapFile(string_view fname) -> DiskFileMapping;
     [[nodiscard]] static auto FindFiles(string_view path, string_view ext) -> DiskFind;
 
     static auto IsDir(string_view path) -> bool;
@@ -36,7 +36,9 @@
 #include "Log.h"
 #include "StringUtils.h"
 
-FOEngineBase::FOEngineBase(bool is_server) : Entity(new PropertyRegistrator(ENTITY_CLASS_NAME, is_server, *this)), GameProperties(GetInitRef()), _isServer {is_server}
+// Hash storage member is not constructed yet when Entity base gets registrator
+// Registrator only keeps the reference, it must not be used until engine construction is finished
+FOEngineBase::FOEngineBase(bool is_server) : Entity(new PropertyRegistrator(ENTITY_CLASS_NAME, is_server, *this, _hashStorage)), GameProperties(GetInitRef()), _isServer {is_server}
 {
     _registrators.emplace(ENTITY_CLASS_NAME, _propsRef.GetRegistrator());
 }
@@ -54,7 +56,7 @@ auto FOEngineBase::CreatePropertyRegistrator(string_view class_name) -> Property
         return const_cast<PropertyRegistrator*>(it->second);
     }
 
-    auto* registrator = new PropertyRegistrator(class_name, _isServer, *this);
+    auto* registrator = new PropertyRegistrator(class_name, _isServer, *this, _hashStorage);
     _registrators.emplace(class_name, registrator);
     return registrator;
 }
@@ -178,29 +180,31 @@ auto FOEngineBase::ToHashedString(string_view s) const -> hstring
     const auto hash_value = Hashing::MurmurHash2(s.data(), s.length());
     RUNTIME_ASSERT(hash_value != 0u);
 
-    if (const auto it = _hashStorage.find(hash_value); it != _hashStorage.end()) {
+    auto* entry = _hashStorage.Find(hash_value);
+    if (entry == nullptr) {
+        entry = _hashStorage.Add(hash_value, s);
+    }
+
 #if FO_DEBUG
-        const auto collision_detected = (s != it->second.Str);
+    const auto collision_detected = (s != entry->Str);
 #else
-        const auto collision_detected = (s.length() != it->second.Str.length() && s != it->second.Str);
+    const auto collision_detected = (s.length() != entry->Str.length() && s != entry->Str);
 #endif
-        if (collision_detected) {
-            throw HashCollisionException("Hash collision", s, it->second.Str, hash_value);
-        }
-
-        return hstring(&it->second);
+    if (collision_detected) {
+        throw HashCollisionException("Hash collision", s, entry->Str, hash_value);
     }
 
-    const auto [it, inserted] = _hashStorage.emplace(hash_value, hstring::entry {hash_value, string(s)});
-    RUNTIME_ASSERT(inserted);
-
-    return hstring(&it->second);
+    return hstring(entry);
 }
 
 auto FOEngineBase::ResolveHash(hstring::hash_t h, bool* failed) const -> hstring
 {
-    if (const auto it = _hashStorage.find(h); it != _hashStorage.end()) {
-        return hstring(&it->second);
+    if (auto* entry = _hashStorage.Find(h); entry != nullptr) {
+        return hstring(entry);
+    }
+
+    if (h == 0u) {
+        return hstring();
     }
 
     if (failed != nullptr) {
@@ -36,6 +36,7 @@
 #include "Common.h"
 
 #include "EntityProperties.h"
+#include "HashStorage.h"
 #include "Properties.h"
 
 DECLARE_EXCEPTION(DataRegistrationException);
@@ -82,5 +83,5 @@ class FOEngineBase : public NameResolver, public Entity, public GameProperties
     unordered_map<string, unordered_map<int, string>> _enumsRev {};
     unordered_map<string, int> _enumsFull {};
     unordered_map<string, const type_info*> _enumTypes {};
-    mutable unordered_map<hstring::hash_t, hstring::entry> _hashStorage {};
+    mutable HashStorage _hashStorage {}; // Referenced by engine registrator before constructed, see ctor
 };
@@ -74,6 +74,17 @@ auto FileHeader::GetWriteTime() const -> uint64
     return _writeTime;
 }
 
+auto FileHeader::GetDiskPath() const -> string
+{
+    RUNTIME_ASSERT(_isLoaded);
+
+    if (_dataSource == nullptr) {
+        return {};
+    }
+
+    return _dataSource->GetDiskPath(_filePath, _str(_filePath).lower());
+}
+
 File::File(string_view name, string_view path, size_t size, uint64 write_time, DataSource* ds, unique_del_ptr<uchar>&& buf) : FileHeader(name, path, size, write_time, ds), _fileBuf {std::move(buf)}
 {
 }
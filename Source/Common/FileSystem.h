@@ -58,6 +58,7 @@ class FileHeader
     [[nodiscard]] auto GetPath() const -> string_view;
     [[nodiscard]] auto GetSize() const -> size_t;
     [[nodiscard]] auto GetWriteTime() const -> uint64;
+    [[nodiscard]] auto GetDiskPath() const -> string; // Empty if file is not plain file on disk
 
 protected:
     FileHeader() = default;
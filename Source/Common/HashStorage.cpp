@@ -0,0 +1,90 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "HashStorage.h"
+
+HashStorage::HashStorage()
+{
+    auto& table = _tables.emplace_back(std::make_unique<Table>());
+    table->Slots = std::make_unique<Slot[]>(INITIAL_CAPACITY);
+    table->Mask = INITIAL_CAPACITY - 1;
+    _table.store(table.get(), std::memory_order_release);
+}
+
+auto HashStorage::GetSize() const -> size_t
+{
+    std::lock_guard locker(_addLocker);
+
+    return _entries.size();
+}
+
+auto HashStorage::Add(hstring::hash_t h, string_view str) -> hstring::entry*
+{
+    RUNTIME_ASSERT(h != 0u);
+
+    std::lock_guard locker(_addLocker);
+
+    if (auto* entry = Find(h); entry != nullptr) {
+        return entry;
+    }
+
+    // Keep load factor not greater than a half to make probe sequences short
+    if (auto* table = _table.load(std::memory_order_relaxed); (_entries.size() + 1) * 2 > table->Mask + 1) {
+        const auto capacity = (table->Mask + 1) * 2;
+        auto& new_table = _tables.emplace_back(std::make_unique<Table>());
+        new_table->Slots = std::make_unique<Slot[]>(capacity);
+        new_table->Mask = capacity - 1;
+
+        for (auto& entry : _entries) {
+            Insert(*new_table, &entry);
+        }
+
+        _table.store(new_table.get(), std::memory_order_release);
+    }
+
+    auto& entry = _entries.emplace_back(hstring::entry {h, string(str)});
+    Insert(*_table.load(std::memory_order_relaxed), &entry);
+    return &entry;
+}
+
+void HashStorage::Insert(Table& table, hstring::entry* entry)
+{
+    auto index = static_cast<size_t>(entry->Hash) & table.Mask;
+    while (table.Slots[index].Hash.load(std::memory_order_relaxed) != 0u) {
+        index = (index + 1) & table.Mask;
+    }
+
+    // Hash published last so readers never see slot without entry
+    table.Slots[index].Entry.store(entry, std::memory_order_relaxed);
+    table.Slots[index].Hash.store(entry->Hash, std::memory_order_release);
+}
@@ -0,0 +1,95 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Interning table for hashed strings
+// Open addressing with linear probing, hashes are already well mixed (MurmurHash2) so used as is
+// Entries are never removed and their addresses stay valid for the storage lifetime
+// Find is lock free and safe against concurrent Add, grown tables are kept alive for readers that still probe them
+class HashStorage final
+{
+public:
+    HashStorage();
+    HashStorage(const HashStorage&) = delete;
+    HashStorage(HashStorage&&) noexcept = delete;
+    auto operator=(const HashStorage&) = delete;
+    auto operator=(HashStorage&&) noexcept = delete;
+    ~HashStorage() = default;
+
+    [[nodiscard]] auto Find(hstring::hash_t h) const noexcept -> hstring::entry*
+    {
+        const auto* table = _table.load(std::memory_order_acquire);
+
+        for (auto index = static_cast<size_t>(h) & table->Mask;; index = (index + 1) & table->Mask) {
+            const auto& slot = table->Slots[index];
+            const auto slot_hash = slot.Hash.load(std::memory_order_acquire);
+            if (slot_hash == h) {
+                return slot.Entry.load(std::memory_order_relaxed);
+            }
+            if (slot_hash == 0u) {
+                return nullptr;
+            }
+        }
+    }
+
+    [[nodiscard]] auto GetSize() const -> size_t;
+    [[nodiscard]] auto GetCapacity() const noexcept -> size_t { return _table.load(std::memory_order_acquire)->Mask + 1; }
+
+    // Returns already added entry if other thread was first
+    auto Add(hstring::hash_t h, string_view str) -> hstring::entry*;
+
+private:
+    struct Slot
+    {
+        std::atomic<hstring::hash_t> Hash {};
+        std::atomic<hstring::entry*> Entry {};
+    };
+
+    struct Table
+    {
+        unique_ptr<Slot[]> Slots {};
+        size_t Mask {};
+    };
+
+    static constexpr size_t INITIAL_CAPACITY = 1024;
+
+    static void Insert(Table& table, hstring::entry* entry);
+
+    std::atomic<Table*> _table {};
+    vector<unique_ptr<Table>> _tables {};
+    deque<hstring::entry> _entries {};
+    mutable std::mutex _addLocker {};
+};
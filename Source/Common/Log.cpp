@@ -31,10 +31,6 @@
 // SOFTWARE.
 //
 
-// Todo: server logs append not rewrite (with checking of size)
-// Todo: add timestamps and process id and thread id to file logs
-// Todo: delete \n appendix from WriteLog
-
 #include "Log.h"
 #include "DiskFileSystem.h"
 #include "StringUtils.h"
@@ -44,30 +40,428 @@
 #include <android/log.h>
 #endif
 
+#include <condition_variable>
+
+#include "fmt/args.h"
+
+// Messages are not written on the caller thread
+// Every thread puts records to own lock-free ring buffer and dedicated writer thread drains them in batches
+#if !FO_WEB
+#define FO_ASYNC_LOG 1
+#else
+#define FO_ASYNC_LOG 0
+#endif
+
+static constexpr size_t LOG_RING_SIZE = 256 * 1024;
+static constexpr auto LOG_WRITER_SLEEP = std::chrono::milliseconds {10};
+static constexpr auto LOG_CRASH_FLUSH_TIMEOUT = std::chrono::milliseconds {1000};
+static constexpr uint LOG_RING_PADDING = static_cast<uint>(-1);
+static constexpr size_t DEFAULT_LOG_FILE_MAX_SIZE = 50 * 1024 * 1024;
+static constexpr uint DEFAULT_LOG_FILE_MAX_BACKUPS = 3;
+
 [[maybe_unused]] static void FlushLogAtExit();
 
+struct LogRecordHeader
+{
+    uint Size {};
+    uint MessageLen {};
+    uint ArgsSize {};
+    LogType Type {};
+    bool Deferred {};
+    uint64 Time {};
+};
+
+// Single producer (owner thread), single consumer (writer thread)
+struct LogRing
+{
+    explicit LogRing(uint thread_id) : ThreadId {thread_id}, Data(LOG_RING_SIZE) { }
+
+    [[nodiscard]] auto Reserve(size_t size) -> uchar*
+    {
+        const auto head = Head.load(std::memory_order_relaxed);
+        const auto tail = Tail.load(std::memory_order_acquire);
+        const auto pos = head % LOG_RING_SIZE;
+        const auto contiguous = LOG_RING_SIZE - pos;
+        const auto need = contiguous < size ? contiguous + size : size;
+
+        if (size > LOG_RING_SIZE || head - tail + need > LOG_RING_SIZE) {
+            return nullptr;
+        }
+
+        if (contiguous < size) {
+            // Tail space is too small for the record, skip it
+            std::memcpy(&Data[pos], &LOG_RING_PADDING, sizeof(LOG_RING_PADDING));
+            PendingHead = head + contiguous + size;
+            return &Data[0];
+        }
+
+        PendingHead = head + size;
+        return &Data[pos];
+    }
+
+    void Commit() { Head.store(PendingHead, std::memory_order_release); }
+
+    const uint ThreadId;
+    vector<uchar> Data;
+    std::atomic_size_t Head {};
+    std::atomic_size_t Tail {};
+    std::atomic_bool Abandoned {};
+    size_t PendingHead {};
+};
+
+struct ThreadLogRing
+{
+    ~ThreadLogRing()
+    {
+        if (Ring) {
+            Ring->Abandoned = true;
+        }
+    }
+
+    shared_ptr<LogRing> Ring {};
+};
+
 struct LogData
 {
-#if !FO_WEB && !FO_MAC && !FO_IOS && !FO_ANDROID
     LogData()
     {
+#if !FO_WEB && !FO_MAC && !FO_IOS && !FO_ANDROID
         const auto result = std::at_quick_exit(FlushLogAtExit);
         UNUSED_VARIABLE(result);
-    }
 #endif
+        const auto result2 = std::atexit(FlushLogAtExit);
+        UNUSED_VARIABLE(result2);
+
+#if FO_ASYNC_LOG
+        WriterThread = std::thread(&LogData::WriterEntry, this);
+#endif
+    }
+
+    ~LogData()
+    {
+        StopWriter();
+    }
+
+    LogData(const LogData&) = delete;
+    LogData(LogData&&) noexcept = delete;
+    auto operator=(const LogData&) = delete;
+    auto operator=(LogData&&) noexcept = delete;
+
+    void WriterEntry();
+    void StopWriter();
+    auto DrainRings() -> bool;
+    void WriteToTargets(string_view file_text, string_view console_text);
+    void RotateLogFile();
 
     std::mutex LogLocker {};
     bool LogDisableTimestamp {};
     unique_ptr<DiskFile> LogFileHandle {};
+    string LogFileName {};
+    size_t LogFileSize {};
+    size_t LogFileMaxSize {DEFAULT_LOG_FILE_MAX_SIZE};
+    uint LogFileMaxBackups {DEFAULT_LOG_FILE_MAX_BACKUPS};
     map<string, LogFunc> LogFunctions {};
+    std::atomic_size_t LogFunctionsCount {};
     std::atomic_bool LogFunctionsInProcess {};
+
+    std::mutex RingsLocker {};
+    vector<shared_ptr<LogRing>> Rings {};
+    std::atomic_uint ThreadCounter {};
+    std::thread WriterThread {};
+    std::atomic_bool WriterRunning {FO_ASYNC_LOG != 0};
+    std::atomic_bool WriterStopRequest {};
+    std::mutex WriterLocker {};
+    std::condition_variable WriterSignal {};
+    std::condition_variable FlushSignal {};
+    size_t FlushRequests {};
+    size_t FlushesDone {};
+
+    std::atomic_size_t WrittenCount {};
+    std::atomic_size_t DroppedCount {};
+    std::atomic_size_t RotationsCount {};
+    size_t ReportedDroppedCount {};
 };
 GLOBAL_DATA(LogData, Data);
 
+static thread_local ThreadLogRing CurThreadRing;
+static thread_local LogRing* CurPendingRing;
+
+static auto GetThreadRing() -> LogRing*
+{
+    if (!CurThreadRing.Ring) {
+        CurThreadRing.Ring = std::make_shared<LogRing>(++Data->ThreadCounter);
+
+        std::lock_guard locker(Data->RingsLocker);
+        Data->Rings.push_back(CurThreadRing.Ring);
+    }
+
+    return CurThreadRing.Ring.get();
+}
+
+static auto MakeConsoleTimestamp(uint64 time) -> string
+{
+    const auto now = static_cast<time_t>(time / 1000000u);
+    const auto* t = ::localtime(&now);
+    return _str("[{}:{}:{}] ", t->tm_hour, t->tm_min, t->tm_sec);
+}
+
+static auto MakeFileTimestamp(uint64 time, uint thread_id) -> string
+{
+    const auto now = static_cast<time_t>(time / 1000000u);
+    const auto* t = ::localtime(&now);
+    return _str("[{:02}:{:02}:{:02}.{:03}] [{}] ", t->tm_hour, t->tm_min, t->tm_sec, time / 1000u % 1000u, thread_id);
+}
+
+static auto GetLogTime() -> uint64
+{
+    return static_cast<uint64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+static auto FormatDeferredMessage(string_view message, const uchar* args, size_t args_size) -> string
+{
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+
+    const auto* end = args + args_size;
+    while (args < end) {
+        const auto tag = static_cast<char>(*args++);
+        const auto read_raw = [&args](auto& value) {
+            std::memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+        };
+
+        switch (tag) {
+        case 'b': {
+            bool value;
+            read_raw(value);
+            store.push_back(value);
+        } break;
+        case 'c': {
+            char value;
+            read_raw(value);
+            store.push_back(value);
+        } break;
+        case 'f': {
+            float value;
+            read_raw(value);
+            store.push_back(value);
+        } break;
+        case 'd': {
+            double value;
+            read_raw(value);
+            store.push_back(value);
+        } break;
+        case 'i': {
+            int64 value;
+            read_raw(value);
+            store.push_back(value);
+        } break;
+        case 'u': {
+            uint64 value;
+            read_raw(value);
+            store.push_back(value);
+        } break;
+        case 's': {
+            uint len;
+            read_raw(len);
+            store.push_back(string(reinterpret_cast<const char*>(args), len));
+            args += len;
+        } break;
+        default:
+            return _str("{} (invalid log arguments)", message);
+        }
+    }
+
+    try {
+        return fmt::vformat(message, store);
+    }
+    catch (const fmt::format_error& ex) {
+        return _str("{} (log format error: {})", message, ex.what());
+    }
+}
+
+void LogData::WriterEntry()
+{
+    while (true) {
+        size_t flush_request;
+        {
+            std::unique_lock locker(WriterLocker);
+            WriterSignal.wait_for(locker, LOG_WRITER_SLEEP, [this] { return WriterStopRequest || FlushRequests != FlushesDone; });
+            flush_request = FlushRequests;
+        }
+
+        while (DrainRings()) {
+        }
+
+        {
+            std::lock_guard locker(WriterLocker);
+            FlushesDone = flush_request;
+        }
+        FlushSignal.notify_all();
+
+        if (WriterStopRequest) {
+            break;
+        }
+    }
+}
+
+void LogData::StopWriter()
+{
+    if (!WriterRunning.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard locker(WriterLocker);
+        WriterStopRequest = true;
+    }
+    WriterSignal.notify_all();
+
+    if (WriterThread.joinable()) {
+        WriterThread.join();
+    }
+
+    // Catch up records that were put after last drain
+    while (DrainRings()) {
+    }
+}
+
+auto LogData::DrainRings() -> bool
+{
+    vector<shared_ptr<LogRing>> rings;
+    {
+        std::lock_guard locker(RingsLocker);
+        rings = Rings;
+        Rings.erase(std::remove_if(Rings.begin(), Rings.end(), [](auto&& ring) { return ring->Abandoned && ring->Head == ring->Tail; }), Rings.end());
+    }
+
+    struct Line
+    {
+        uint64 Time;
+        LogType Type;
+        uint ThreadId;
+        string Text;
+    };
+    vector<Line> lines;
+
+    for (auto& ring : rings) {
+        auto tail = ring->Tail.load(std::memory_order_relaxed);
+        const auto head = ring->Head.load(std::memory_order_acquire);
+
+        while (tail != head) {
+            const auto pos = tail % LOG_RING_SIZE;
+
+            uint size;
+            std::memcpy(&size, &ring->Data[pos], sizeof(size));
+            if (size == LOG_RING_PADDING) {
+                tail += LOG_RING_SIZE - pos;
+                continue;
+            }
+
+            LogRecordHeader header;
+            std::memcpy(&header, &ring->Data[pos], sizeof(header));
+            const auto* message_data = &ring->Data[pos + sizeof(header)];
+            const auto message = string_view(reinterpret_cast<const char*>(message_data), header.MessageLen);
+
+            if (header.Deferred) {
+                lines.push_back({header.Time, header.Type, ring->ThreadId, FormatDeferredMessage(message, message_data + header.MessageLen, header.ArgsSize)});
+            }
+            else {
+                lines.push_back({header.Time, header.Type, ring->ThreadId, string(message)});
+            }
+
+            tail += header.Size;
+        }
+
+        ring->Tail.store(tail, std::memory_order_release);
+    }
+
+    const auto dropped = DroppedCount.load();
+    if (lines.empty() && dropped == ReportedDroppedCount) {
+        return false;
+    }
+
+    std::stable_sort(lines.begin(), lines.end(), [](const Line& l1, const Line& l2) { return l1.Time < l2.Time; });
+
+    if (dropped != ReportedDroppedCount) {
+        lines.push_back({GetLogTime(), LogType::Warning, 0, _str("Log overflow, dropped {} messages", dropped - ReportedDroppedCount)});
+        ReportedDroppedCount = dropped;
+    }
+
+    string file_text;
+    string console_text;
+    for (const auto& line : lines) {
+        if (!LogDisableTimestamp) {
+            file_text += MakeFileTimestamp(line.Time, line.ThreadId);
+            console_text += MakeConsoleTimestamp(line.Time);
+        }
+
+        file_text += line.Text;
+        file_text += '\n';
+        console_text += line.Text;
+        console_text += '\n';
+    }
+
+    WriteToTargets(file_text, console_text);
+    WrittenCount += lines.size();
+    return true;
+}
+
+void LogData::WriteToTargets(string_view file_text, string_view console_text)
+{
+    {
+        std::lock_guard locker(LogLocker);
+
+        if (LogFileHandle) {
+            if (LogFileMaxSize != 0u && LogFileSize != 0u && LogFileSize + file_text.length() > LogFileMaxSize) {
+                RotateLogFile();
+            }
+
+            if (LogFileHandle) {
+                LogFileHandle->Write(file_text);
+                LogFileSize += file_text.length();
+            }
+        }
+    }
+
+#if FO_WINDOWS
+    ::OutputDebugStringW(_str(console_text).toWideChar().c_str());
+#endif
+
+#if FO_ANDROID
+    __android_log_print(ANDROID_LOG_INFO, "FOnline", "%s", string(console_text).c_str());
+#endif
+
+    // Todo: colorize log texts
+    std::cout << console_text;
+    std::cout.flush();
+}
+
+void LogData::RotateLogFile()
+{
+    // Name.log -> Name.log.1 -> ... -> Name.log.N
+    LogFileHandle.reset();
+
+    if (LogFileMaxBackups != 0u) {
+        DiskFileSystem::DeleteFile(_str("{}.{}", LogFileName, LogFileMaxBackups));
+        for (auto i = LogFileMaxBackups - 1; i >= 1u; i--) {
+            DiskFileSystem::RenameFile(_str("{}.{}", LogFileName, i), _str("{}.{}", LogFileName, i + 1));
+        }
+        DiskFileSystem::RenameFile(LogFileName, _str("{}.1", LogFileName));
+    }
+
+    LogFileHandle = std::make_unique<DiskFile>(DiskFile {DiskFileSystem::OpenFile(LogFileName, true, true)});
+    LogFileSize = 0;
+    RotationsCount++;
+}
+
 static void FlushLogAtExit()
 {
-    if (Data != nullptr && Data->LogFileHandle) {
-        Data->LogFileHandle.reset();
+    if (Data != nullptr) {
+        Data->StopWriter();
+
+        if (Data->LogFileHandle) {
+            Data->LogFileHandle.reset();
+        }
     }
 }
 
@@ -83,6 +477,16 @@ void LogToFile(string_view fname)
     std::lock_guard locker(Data->LogLocker);
 
     Data->LogFileHandle = std::make_unique<DiskFile>(DiskFile {DiskFileSystem::OpenFile(fname, true, true)});
+    Data->LogFileName = fname;
+    Data->LogFileSize = 0;
+}
+
+void LogFileRotation(size_t max_file_size, uint max_backups)
+{
+    std::lock_guard locker(Data->LogLocker);
+
+    Data->LogFileMaxSize = max_file_size;
+    Data->LogFileMaxBackups = max_backups;
 }
 
 void SetLogCallback(string_view key, LogFunc callback)
@@ -101,42 +505,140 @@ void SetLogCallback(string_view key, LogFunc callback)
         RUNTIME_ASSERT(!callback);
         Data->LogFunctions.clear();
     }
+
+    Data->LogFunctionsCount = Data->LogFunctions.size();
 }
 
-void WriteLogMessage(LogType type, string_view message)
+void FlushLog()
+{
+    if (!Data->WriterRunning) {
+        return;
+    }
+
+    std::unique_lock locker(Data->WriterLocker);
+    const auto request = ++Data->FlushRequests;
+    Data->WriterSignal.notify_all();
+    Data->FlushSignal.wait(locker, [request] { return Data->FlushesDone >= request || !Data->WriterRunning; });
+}
+
+void FlushLogOnCrash()
+{
+    if (Data == nullptr || !Data->WriterRunning || Data->WriterThread.get_id() == std::this_thread::get_id()) {
+        return;
+    }
+
+    // Crashed thread may hold writer lock, so don't block on it
+    std::unique_lock locker(Data->WriterLocker, std::defer_lock);
+    for (auto i = 0; i < 100 && !locker.try_lock(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds {1});
+    }
+    if (!locker.owns_lock()) {
+        return;
+    }
+
+    const auto request = ++Data->FlushRequests;
+    Data->WriterSignal.notify_all();
+    Data->FlushSignal.wait_for(locker, LOG_CRASH_FLUSH_TIMEOUT, [request] { return Data->FlushesDone >= request || !Data->WriterRunning; });
+}
+
+auto GetLogStatistics() -> LogStatistics
+{
+    return {Data->WrittenCount.load(), Data->DroppedCount.load(), Data->RotationsCount.load()};
+}
+
+auto IsLogDeferrable() -> bool
+{
+    return Data->WriterRunning;
+}
+
+auto HasLogCallbacks() -> bool
+{
+    return Data->LogFunctionsCount != 0u;
+}
+
+auto CallLogCallbacks(string_view message) -> bool
 {
     // Avoid recursive calls
     if (Data->LogFunctionsInProcess) {
-        return;
+        return false;
     }
 
     std::lock_guard locker(Data->LogLocker);
 
-    // Make message
+    if (!Data->LogFunctions.empty()) {
+        string result;
+        if (!Data->LogDisableTimestamp) {
+            result += MakeConsoleTimestamp(GetLogTime());
+        }
+
+        result.reserve(result.size() + message.length() + 1u);
+        result += message;
+        result += '\n';
+
+        Data->LogFunctionsInProcess = true;
+        for (auto&& [func_name, func] : Data->LogFunctions) {
+            func(result);
+        }
+        Data->LogFunctionsInProcess = false;
+    }
+
+    return true;
+}
+
+auto BeginDeferredLog(LogType type, string_view message, size_t args_size) -> uchar*
+{
+    RUNTIME_ASSERT(!CurPendingRing);
+
+    auto* ring = GetThreadRing();
+
+    const auto size = (sizeof(LogRecordHeader) + message.length() + args_size + 7u) & ~static_cast<size_t>(7u);
+    auto* data = ring->Reserve(size);
+    if (data == nullptr) {
+        ++Data->DroppedCount;
+        return nullptr;
+    }
+
+    LogRecordHeader header;
+    header.Size = static_cast<uint>(size);
+    header.MessageLen = static_cast<uint>(message.length());
+    header.ArgsSize = static_cast<uint>(args_size);
+    header.Type = type;
+    header.Deferred = true;
+    header.Time = GetLogTime();
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(data + sizeof(header), message.data(), message.length());
+
+    CurPendingRing = ring;
+    return data + sizeof(header) + message.length();
+}
+
+void EndDeferredLog()
+{
+    RUNTIME_ASSERT(CurPendingRing);
+
+    CurPendingRing->Commit();
+    CurPendingRing = nullptr;
+}
+
+static void WriteLogMessageSync(LogType type, string_view message)
+{
+    UNUSED_VARIABLE(type);
+
+    std::lock_guard locker(Data->LogLocker);
+
     string result;
     if (!Data->LogDisableTimestamp) {
-        const auto now = ::time(nullptr);
-        const auto* t = ::localtime(&now);
-        result += _str("[{}:{}:{}] ", t->tm_hour, t->tm_min, t->tm_sec);
+        result += MakeConsoleTimestamp(GetLogTime());
     }
 
     result.reserve(result.size() + message.length() + 1u);
     result += message;
     result += '\n';
 
-    // Write logs
     if (Data->LogFileHandle) {
         Data->LogFileHandle->Write(result);
     }
 
-    if (!Data->LogFunctions.empty()) {
-        Data->LogFunctionsInProcess = true;
-        for (auto&& [func_name, func] : Data->LogFunctions) {
-            func(result);
-        }
-        Data->LogFunctionsInProcess = false;
-    }
-
 #if FO_WINDOWS
     ::OutputDebugStringW(_str(result).toWideChar().c_str());
 #endif
@@ -145,29 +647,38 @@ void WriteLogMessage(LogType type, string_view message)
     __android_log_print(ANDROID_LOG_INFO, "FOnline", "%s", result.c_str());
 #endif
 
-    // Todo: colorize log texts
-    const char* color = nullptr;
-    switch (type) {
-    case LogType::InfoSection:
-        color = "\033[32m"; // Green
-        break;
-    case LogType::Warning:
-        color = "\033[33m"; // Yellow
-        break;
-    case LogType::Error:
-        color = "\031[31m"; // Red
-        break;
-    default:
-        break;
-    }
-
-    if (color != nullptr) {
-        // std::cout << color << result << "\033[39m";
-        std::cout << result;
+    std::cout << result;
+    std::cout.flush();
+}
+
+void WriteLogMessage(LogType type, string_view message)
+{
+    // Callbacks are called in place
+    if (HasLogCallbacks() && !CallLogCallbacks(message)) {
+        return;
     }
-    else {
-        std::cout << result;
+
+    const auto size = (sizeof(LogRecordHeader) + message.length() + 7u) & ~static_cast<size_t>(7u);
+
+    if (!Data->WriterRunning || size > LOG_RING_SIZE / 4) {
+        WriteLogMessageSync(type, message);
+        return;
     }
 
-    std::cout.flush();
+    auto* ring = GetThreadRing();
+    auto* data = ring->Reserve(size);
+    if (data == nullptr) {
+        ++Data->DroppedCount;
+        return;
+    }
+
+    LogRecordHeader header;
+    header.Size = static_cast<uint>(size);
+    header.MessageLen = static_cast<uint>(message.length());
+    header.Type = type;
+    header.Time = GetLogTime();
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(data + sizeof(header), message.data(), message.length());
+
+    ring->Commit();
 }
@@ -48,19 +48,115 @@ enum class LogType
 // Write formatted text
 extern void WriteLogMessage(LogType type, string_view message);
 
+// Arguments of these types are captured in binary and formatted later on the log writer thread
+// Any other argument makes the message formatted in place
+template<typename T>
+inline constexpr bool IS_LOG_DEFERRABLE_ARG = std::is_arithmetic_v<T> || std::is_same_v<T, string> || std::is_same_v<T, string_view> || std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, hstring>;
+
+[[nodiscard]] extern auto IsLogDeferrable() -> bool;
+[[nodiscard]] extern auto HasLogCallbacks() -> bool;
+// Returns false if called from log callback, then message is dropped
+[[nodiscard]] extern auto CallLogCallbacks(string_view message) -> bool;
+[[nodiscard]] extern auto BeginDeferredLog(LogType type, string_view message, size_t args_size) -> uchar*;
+extern void EndDeferredLog();
+
+template<typename T>
+[[nodiscard]] auto GetLogArgSize(const T& value) -> size_t
+{
+    if constexpr (std::is_arithmetic_v<T>) {
+        return 1u + sizeof(std::conditional_t<std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_same_v<T, float>, T, std::conditional_t<std::is_floating_point_v<T>, double, int64>>);
+    }
+    else {
+        return 1u + sizeof(uint) + string_view(value).length();
+    }
+}
+
+template<typename T>
+void WriteLogArg(uchar*& data, const T& value)
+{
+    const auto write_raw = [&data](char tag, const void* ptr, size_t size) {
+        *data++ = static_cast<uchar>(tag);
+        std::memcpy(data, ptr, size);
+        data += size;
+    };
+
+    if constexpr (std::is_same_v<T, bool>) {
+        write_raw('b', &value, sizeof(value));
+    }
+    else if constexpr (std::is_same_v<T, char>) {
+        write_raw('c', &value, sizeof(value));
+    }
+    else if constexpr (std::is_same_v<T, float>) {
+        write_raw('f', &value, sizeof(value));
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+        const auto v = static_cast<double>(value);
+        write_raw('d', &v, sizeof(v));
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        const auto v = static_cast<int64>(value);
+        write_raw('i', &v, sizeof(v));
+    }
+    else if constexpr (std::is_integral_v<T>) {
+        const auto v = static_cast<uint64>(value);
+        write_raw('u', &v, sizeof(v));
+    }
+    else {
+        const auto str = string_view(value);
+        const auto len = static_cast<uint>(str.length());
+        write_raw('s', &len, sizeof(len));
+        std::memcpy(data, str.data(), str.length());
+        data += str.length();
+    }
+}
+
+template<typename... Args>
+void WriteLogFormatted(LogType type, string_view message, Args&&... args)
+{
+    if constexpr ((IS_LOG_DEFERRABLE_ARG<std::decay_t<Args>> && ...)) {
+        if (IsLogDeferrable()) {
+            // Callbacks expect ready text at the moment of the call, file and console output stay deferred
+            if (HasLogCallbacks() && !CallLogCallbacks(fmt::format(message, args...))) {
+                return;
+            }
+
+            const size_t args_size = (0u + ... + GetLogArgSize<std::decay_t<Args>>(args));
+            if (auto* data = BeginDeferredLog(type, message, args_size); data != nullptr) {
+                (WriteLogArg<std::decay_t<Args>>(data, args), ...);
+                EndDeferredLog();
+            }
+            return;
+        }
+    }
+
+    WriteLogMessage(type, fmt::format(message, std::forward<Args>(args)...));
+}
+
+// Todo: delete \n appendix from WriteLog
 template<typename... Args>
 void WriteLog(string_view message, Args... args)
 {
-    WriteLogMessage(LogType::Info, fmt::format(message, std::forward<Args>(args)...));
+    WriteLogFormatted(LogType::Info, message, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 void WriteLog(LogType type, string_view message, Args... args)
 {
-    WriteLogMessage(type, fmt::format(message, std::forward<Args>(args)...));
+    WriteLogFormatted(type, message, std::forward<Args>(args)...);
 }
 
 // Control
+struct LogStatistics
+{
+    size_t Written {};
+    size_t Dropped {};
+    size_t Rotations {};
+};
+
 extern void LogWithoutTimestamp();
 extern void LogToFile(string_view fname);
+extern void LogFileRotation(size_t max_file_size, uint max_backups);
 extern void SetLogCallback(string_view key, LogFunc callback);
+extern void FlushLog();
+extern void FlushLogOnCrash();
+[[nodiscard]] extern auto GetLogStatistics() -> LogStatistics;
@@ -0,0 +1,267 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "MemoryPool.h"
+
+struct SubsystemCounters
+{
+    std::atomic_size_t Allocations {};
+    std::atomic_size_t Deallocations {};
+    std::atomic_size_t PoolReuses {};
+    std::atomic_size_t LiveBytes {};
+    std::atomic_size_t PeakBytes {};
+};
+
+static SubsystemCounters Counters[static_cast<size_t>(AllocationSubsystem::Count)];
+
+auto AllocationCounters::GetSubsystemName(AllocationSubsystem subsystem) -> string_view
+{
+    switch (subsystem) {
+    case AllocationSubsystem::Items:
+        return "Items";
+    case AllocationSubsystem::Critters:
+        return "Critters";
+    case AllocationSubsystem::Properties:
+        return "Properties";
+    case AllocationSubsystem::FrameArena:
+        return "Frame arena";
+    default:
+        break;
+    }
+
+    throw UnreachablePlaceException(LINE_STR);
+}
+
+auto AllocationCounters::GetStatistics(AllocationSubsystem subsystem) -> AllocationStatistics
+{
+    const auto& counters = Counters[static_cast<size_t>(subsystem)];
+
+    AllocationStatistics stats;
+    stats.Allocations = counters.Allocations.load(std::memory_order_relaxed);
+    stats.Deallocations = counters.Deallocations.load(std::memory_order_relaxed);
+    stats.PoolReuses = counters.PoolReuses.load(std::memory_order_relaxed);
+    stats.LiveBytes = counters.LiveBytes.load(std::memory_order_relaxed);
+    stats.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AllocationCounters::OnAllocate(AllocationSubsystem subsystem, size_t size, bool reused)
+{
+    auto& counters = Counters[static_cast<size_t>(subsystem)];
+
+    counters.Allocations.fetch_add(1, std::memory_order_relaxed);
+    if (reused) {
+        counters.PoolReuses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const auto live_bytes = counters.LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak_bytes = counters.PeakBytes.load(std::memory_order_relaxed);
+    while (live_bytes > peak_bytes && !counters.PeakBytes.compare_exchange_weak(peak_bytes, live_bytes, std::memory_order_relaxed)) {
+    }
+}
+
+void AllocationCounters::OnFree(AllocationSubsystem subsystem, size_t size, size_t count)
+{
+    auto& counters = Counters[static_cast<size_t>(subsystem)];
+
+    counters.Deallocations.fetch_add(count, std::memory_order_relaxed);
+    counters.LiveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+FixedSizePool::FixedSizePool(size_t block_size, size_t blocks_per_chunk, AllocationSubsystem subsystem) : _blockSize {std::max(block_size, sizeof(FreeBlock))}, _blocksPerChunk {blocks_per_chunk}, _subsystem {subsystem}
+{
+    RUNTIME_ASSERT(_blocksPerChunk != 0u);
+}
+
+auto FixedSizePool::Allocate() -> void*
+{
+    auto reused = true;
+    void* ptr;
+
+    {
+        std::lock_guard locker(_locker);
+
+        if (_freeBlocks == nullptr) {
+            // Chunk memory from new[] is aligned for any fundamental type, block size keeps that alignment for entities
+            const auto aligned_size = (_blockSize + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+            auto chunk = std::make_unique<uchar[]>(aligned_size * _blocksPerChunk);
+
+            for (size_t i = _blocksPerChunk; i > 0; i--) {
+                auto* block = reinterpret_cast<FreeBlock*>(chunk.get() + (i - 1) * aligned_size);
+                block->Next = _freeBlocks;
+                _freeBlocks = block;
+            }
+
+            _chunks.emplace_back(std::move(chunk));
+            reused = false;
+        }
+
+        ptr = _freeBlocks;
+        _freeBlocks = _freeBlocks->Next;
+    }
+
+    AllocationCounters::OnAllocate(_subsystem, _blockSize, reused);
+    return ptr;
+}
+
+void FixedSizePool::Free(void* ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    {
+        std::lock_guard locker(_locker);
+
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->Next = _freeBlocks;
+        _freeBlocks = block;
+    }
+
+    AllocationCounters::OnFree(_subsystem, _blockSize, 1);
+}
+
+SizeClassAllocator::SizeClassAllocator(AllocationSubsystem subsystem) : _subsystem {subsystem}
+{
+    for (auto size = MIN_CLASS_SIZE; size <= MAX_CLASS_SIZE; size *= 2) {
+        _classPools.emplace_back(std::make_unique<FixedSizePool>(size, std::max(static_cast<size_t>(64), 16384 / size), subsystem));
+    }
+}
+
+auto SizeClassAllocator::GetClassIndex(size_t size) -> size_t
+{
+    size_t index = 0;
+    for (auto class_size = MIN_CLASS_SIZE; class_size < size; class_size *= 2) {
+        index++;
+    }
+    return index;
+}
+
+auto SizeClassAllocator::Allocate(size_t size) -> uchar*
+{
+    RUNTIME_ASSERT(size != 0u);
+
+    if (size > MAX_CLASS_SIZE) {
+        AllocationCounters::OnAllocate(_subsystem, size, false);
+        return new uchar[size];
+    }
+
+    return static_cast<uchar*>(_classPools[GetClassIndex(size)]->Allocate());
+}
+
+void SizeClassAllocator::Free(uchar* ptr, size_t size)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    if (size > MAX_CLASS_SIZE) {
+        AllocationCounters::OnFree(_subsystem, size, 1);
+        delete[] ptr;
+        return;
+    }
+
+    _classPools[GetClassIndex(size)]->Free(ptr);
+}
+
+FrameArena::FrameArena(size_t block_size)
+{
+    RUNTIME_ASSERT(block_size != 0u);
+
+    _blocks.push_back({std::make_unique<uchar[]>(block_size), block_size});
+}
+
+FrameArena::~FrameArena()
+{
+    if (_allocationsCount != 0u) {
+        AllocationCounters::OnFree(AllocationSubsystem::FrameArena, _usedSize, _allocationsCount);
+    }
+}
+
+auto FrameArena::GetCapacity() const -> size_t
+{
+    size_t capacity = 0;
+    for (const auto& block : _blocks) {
+        capacity += block.Size;
+    }
+    return capacity;
+}
+
+auto FrameArena::Allocate(size_t size, size_t align) -> void*
+{
+    RUNTIME_ASSERT(align != 0u && (align & (align - 1)) == 0u);
+
+    auto grown = false;
+
+    while (true) {
+        auto& block = _blocks[_curBlock];
+        const auto base = reinterpret_cast<uintptr_t>(block.Data.get());
+        const auto offset = ((base + _curOffset + align - 1) & ~(align - 1)) - base;
+
+        if (offset + size <= block.Size) {
+            _curOffset = offset + size;
+            _usedSize += size;
+            _allocationsCount++;
+            AllocationCounters::OnAllocate(AllocationSubsystem::FrameArena, size, !grown);
+            return block.Data.get() + offset;
+        }
+
+        _curBlock++;
+        _curOffset = 0;
+
+        if (_curBlock == _blocks.size()) {
+            const auto block_size = std::max(_blocks.back().Size * 2, size + align);
+            _blocks.push_back({std::make_unique<uchar[]>(block_size), block_size});
+            grown = true;
+        }
+    }
+}
+
+void FrameArena::Reset()
+{
+    if (_allocationsCount != 0u) {
+        AllocationCounters::OnFree(AllocationSubsystem::FrameArena, _usedSize, _allocationsCount);
+    }
+
+    // Tick outgrew first block, take whole capacity as one block for next ticks
+    if (_blocks.size() > 1) {
+        const auto capacity = GetCapacity();
+        _blocks.clear();
+        _blocks.push_back({std::make_unique<uchar[]>(capacity), capacity});
+    }
+
+    _curBlock = 0;
+    _curOffset = 0;
+    _usedSize = 0;
+    _allocationsCount = 0;
+}
@@ -0,0 +1,191 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+enum class AllocationSubsystem : uchar
+{
+    Items,
+    Critters,
+    Properties,
+    FrameArena,
+    Count,
+};
+
+struct AllocationStatistics
+{
+    size_t Allocations {};
+    size_t Deallocations {};
+    size_t PoolReuses {};
+    size_t LiveBytes {};
+    size_t PeakBytes {};
+};
+
+// Allocation counters of engine subsystems, safe to update from any thread
+class AllocationCounters final
+{
+public:
+    AllocationCounters() = delete;
+
+    [[nodiscard]] static auto GetSubsystemName(AllocationSubsystem subsystem) -> string_view;
+    [[nodiscard]] static auto GetStatistics(AllocationSubsystem subsystem) -> AllocationStatistics;
+
+    static void OnAllocate(AllocationSubsystem subsystem, size_t size, bool reused);
+    static void OnFree(AllocationSubsystem subsystem, size_t size, size_t count);
+};
+
+// Thread safe free list of equal blocks carved from big chunks, memory is kept for reuse until pool destruction
+class FixedSizePool final
+{
+public:
+    FixedSizePool() = delete;
+    FixedSizePool(size_t block_size, size_t blocks_per_chunk, AllocationSubsystem subsystem);
+    FixedSizePool(const FixedSizePool&) = delete;
+    FixedSizePool(FixedSizePool&&) noexcept = delete;
+    auto operator=(const FixedSizePool&) = delete;
+    auto operator=(FixedSizePool&&) noexcept = delete;
+    ~FixedSizePool() = default;
+
+    [[nodiscard]] auto GetBlockSize() const -> size_t { return _blockSize; }
+
+    [[nodiscard]] auto Allocate() -> void*;
+    void Free(void* ptr);
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* Next {};
+    };
+
+    const size_t _blockSize;
+    const size_t _blocksPerChunk;
+    const AllocationSubsystem _subsystem;
+    std::mutex _locker {};
+    vector<unique_ptr<uchar[]>> _chunks {};
+    FreeBlock* _freeBlocks {};
+};
+
+// Byte buffers rounded up to power of two size classes, sizes above largest class go to heap
+// Caller passes same size to free as to allocate
+class SizeClassAllocator final
+{
+public:
+    static constexpr size_t MIN_CLASS_SIZE = 16;
+    static constexpr size_t MAX_CLASS_SIZE = 1024;
+
+    SizeClassAllocator() = delete;
+    explicit SizeClassAllocator(AllocationSubsystem subsystem);
+    SizeClassAllocator(const SizeClassAllocator&) = delete;
+    SizeClassAllocator(SizeClassAllocator&&) noexcept = delete;
+    auto operator=(const SizeClassAllocator&) = delete;
+    auto operator=(SizeClassAllocator&&) noexcept = delete;
+    ~SizeClassAllocator() = default;
+
+    [[nodiscard]] auto Allocate(size_t size) -> uchar*;
+    void Free(uchar* ptr, size_t size);
+
+private:
+    [[nodiscard]] static auto GetClassIndex(size_t size) -> size_t;
+
+    const AllocationSubsystem _subsystem;
+    vector<unique_ptr<FixedSizePool>> _classPools {};
+};
+
+// Bump allocator for temporaries living until end of server tick
+// Blocks used by a tick are merged to one on reset so steady state costs no heap calls, single thread only
+class FrameArena final
+{
+public:
+    FrameArena() = delete;
+    explicit FrameArena(size_t block_size);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) noexcept = delete;
+    auto operator=(const FrameArena&) = delete;
+    auto operator=(FrameArena&&) noexcept = delete;
+    ~FrameArena();
+
+    [[nodiscard]] auto GetUsedSize() const -> size_t { return _usedSize; }
+    [[nodiscard]] auto GetCapacity() const -> size_t;
+
+    [[nodiscard]] auto Allocate(size_t size, size_t align) -> void*;
+    void Reset();
+
+private:
+    struct Block
+    {
+        unique_ptr<uchar[]> Data {};
+        size_t Size {};
+    };
+
+    vector<Block> _blocks {};
+    size_t _curBlock {};
+    size_t _curOffset {};
+    size_t _usedSize {};
+    size_t _allocationsCount {};
+};
+
+template<typename T>
+class FrameArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit FrameArenaAllocator(FrameArena& arena) noexcept : _arena {&arena} { }
+    template<typename U>
+    FrameArenaAllocator(const FrameArenaAllocator<U>& other) noexcept : _arena {other.GetArena()} // Implicit for containers rebind
+    {
+    }
+
+    [[nodiscard]] auto GetArena() const noexcept -> FrameArena* { return _arena; }
+    [[nodiscard]] auto allocate(size_t count) -> T* { return static_cast<T*>(_arena->Allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T* /*ptr*/, size_t /*count*/) noexcept { }
+
+    template<typename U>
+    [[nodiscard]] auto operator==(const FrameArenaAllocator<U>& other) const noexcept -> bool
+    {
+        return _arena == other.GetArena();
+    }
+    template<typename U>
+    [[nodiscard]] auto operator!=(const FrameArenaAllocator<U>& other) const noexcept -> bool
+    {
+        return _arena != other.GetArena();
+    }
+
+private:
+    FrameArena* _arena;
+};
+
+template<typename T>
+using frame_vector = vector<T, FrameArenaAllocator<T>>;
@@ -83,18 +83,170 @@ static auto StrToHex(const char* str) -> uchar
     return result;
 }
 
-auto FOMsg::operator+=(const FOMsg& other) -> FOMsg&
+struct TextTable
 {
-    for (const auto& [key, value] : other._strData) {
-        EraseStr(key);
-        AddStr(key, value);
+    const_span<uint> Nums {};
+    const_span<uint> StrEnds {};
+    string_view StrPool {};
+};
+
+// Compiled table layout: signature, count, numbers[count], string ends[count], string pool
+static constexpr uint TEXT_TABLE_SIGNATURE = 0x31544F46;
+static constexpr size_t TEXT_TABLE_HEADER_SIZE = sizeof(uint) * 2;
+
+static auto ParseTextTable(const uchar* data, size_t size, TextTable& table) -> bool
+{
+    if (size < TEXT_TABLE_HEADER_SIZE) {
+        return false;
+    }
+
+    uint signature = 0;
+    uint count = 0;
+    std::memcpy(&signature, data, sizeof(signature));
+    std::memcpy(&count, data + sizeof(signature), sizeof(count));
+    if (signature != TEXT_TABLE_SIGNATURE) {
+        return false;
+    }
+
+    // Compare by division, count multiplication may wrap around on 32 bit platforms
+    if (count > (size - TEXT_TABLE_HEADER_SIZE) / (sizeof(uint) * 2)) {
+        return false;
+    }
+
+    const auto arrays_size = static_cast<size_t>(count) * sizeof(uint) * 2;
+
+    // Both heap buffers and mapped files are aligned enough to look at arrays in place
+    RUNTIME_ASSERT(reinterpret_cast<uintptr_t>(data) % alignof(uint) == 0);
+    const auto* arrays = reinterpret_cast<const uint*>(data + TEXT_TABLE_HEADER_SIZE);
+    const auto nums = const_span<uint>(arrays, count);
+    const auto str_ends = const_span<uint>(arrays + count, count);
+    const auto str_pool = string_view(reinterpret_cast<const char*>(data + TEXT_TABLE_HEADER_SIZE + arrays_size), size - TEXT_TABLE_HEADER_SIZE - arrays_size);
+
+    for (size_t i = 1; i < count; i++) {
+        if (nums[i] < nums[i - 1] || str_ends[i] < str_ends[i - 1]) {
+            return false;
+        }
+    }
+    if (count != 0 && str_ends[count - 1] > str_pool.size()) {
+        return false;
     }
+
+    table.Nums = nums;
+    table.StrEnds = str_ends;
+    table.StrPool = str_pool;
+    return true;
+}
+
+auto FOMsg::operator+=(const FOMsg& other) -> FOMsg&
+{
+    Merge(other, true);
     return *this;
 }
 
+auto FOMsg::GetNums() const -> const_span<uint>
+{
+    return _mappedFile ? _mappedNums : const_span<uint>(_nums);
+}
+
+auto FOMsg::GetStrEnds() const -> const_span<uint>
+{
+    return _mappedFile ? _mappedStrEnds : const_span<uint>(_strEnds);
+}
+
+auto FOMsg::GetStrPool() const -> string_view
+{
+    return _mappedFile ? _mappedStrPool : string_view(_strPool);
+}
+
+auto FOMsg::GetStrAt(size_t index) const -> string_view
+{
+    const auto str_ends = GetStrEnds();
+    const auto start = index == 0 ? 0u : str_ends[index - 1];
+    return GetStrPool().substr(start, str_ends[index] - start);
+}
+
+auto FOMsg::FindRange(uint num) const -> pair<size_t, size_t>
+{
+    const auto nums = GetNums();
+    const auto [first, last] = std::equal_range(nums.begin(), nums.end(), num);
+    return {static_cast<size_t>(first - nums.begin()), static_cast<size_t>(last - nums.begin())};
+}
+
+void FOMsg::Merge(const FOMsg& other, bool replace)
+{
+    const auto self_nums = GetNums();
+    const auto other_nums = other.GetNums();
+
+    vector<uint> nums;
+    vector<uint> str_ends;
+    string str_pool;
+    nums.reserve(self_nums.size() + other_nums.size());
+    str_ends.reserve(self_nums.size() + other_nums.size());
+    str_pool.reserve(GetStrPool().size() + other.GetStrPool().size());
+
+    const auto add_str = [&](uint num, string_view str) {
+        nums.push_back(num);
+        str_pool.append(str);
+        str_ends.push_back(static_cast<uint>(str_pool.size()));
+    };
+
+    // On replace other texts override ours and only last of other same numbered texts is taken, as sequential erase and add did
+    size_t i = 0;
+    size_t j = 0;
+    while (i < self_nums.size() || j < other_nums.size()) {
+        const auto num = j == other_nums.size() || (i < self_nums.size() && self_nums[i] < other_nums[j]) ? self_nums[i] : other_nums[j];
+        const auto other_has_num = j < other_nums.size() && other_nums[j] == num;
+
+        for (; i < self_nums.size() && self_nums[i] == num; i++) {
+            if (!replace || !other_has_num) {
+                add_str(num, GetStrAt(i));
+            }
+        }
+        for (; j < other_nums.size() && other_nums[j] == num; j++) {
+            if (!replace || j + 1 == other_nums.size() || other_nums[j + 1] != num) {
+                add_str(num, other.GetStrAt(j));
+            }
+        }
+    }
+
+    Clear();
+    _nums = std::move(nums);
+    _strEnds = std::move(str_ends);
+    _strPool = std::move(str_pool);
+}
+
+void FOMsg::Detach()
+{
+    if (!_mappedFile) {
+        return;
+    }
+
+    _nums.assign(_mappedNums.begin(), _mappedNums.end());
+    _strEnds.assign(_mappedStrEnds.begin(), _mappedStrEnds.end());
+    _strPool = _mappedStrPool;
+
+    _mappedFile.reset();
+    _mappedNums = {};
+    _mappedStrEnds = {};
+    _mappedStrPool = {};
+}
+
 void FOMsg::AddStr(uint num, string_view str)
 {
-    _strData.insert(std::make_pair(num, str));
+    Detach();
+
+    // Texts mostly come in ascending order so insertion usually goes to the end
+    const auto index = static_cast<size_t>(std::upper_bound(_nums.begin(), _nums.end(), num) - _nums.begin());
+    const auto start = index == 0 ? 0u : _strEnds[index - 1];
+    const auto len = static_cast<uint>(str.length());
+
+    _strPool.insert(start, str);
+    _nums.insert(_nums.begin() + static_cast<ptrdiff_t>(index), num);
+    _strEnds.insert(_strEnds.begin() + static_cast<ptrdiff_t>(index), start + len);
+
+    for (auto i = index + 1; i < _strEnds.size(); i++) {
+        _strEnds[i] += len;
+    }
 }
 
 void FOMsg::AddBinary(uint num, const uchar* binary, uint len)
@@ -113,75 +265,60 @@ void FOMsg::AddBinary(uint num, const uchar* binary, uint len)
 
 auto FOMsg::GetStr(uint num) const -> string
 {
-    const auto str_count = static_cast<uint>(_strData.count(num));
-    auto it = _strData.find(num);
+    const auto [first, last] = FindRange(num);
+    const auto str_count = static_cast<uint>(last - first);
 
     switch (str_count) {
     case 0:
         return "";
     case 1:
-        break;
+        return string(GetStrAt(first));
     default:
-        for (auto i = 0, j = GenericUtils::Random(0, static_cast<int>(str_count)) - 1; i < j; i++) {
-            ++it;
-        }
         break;
     }
 
-    return it->second;
+    const auto skip = GenericUtils::Random(0, static_cast<int>(str_count)) - 1;
+    return string(GetStrAt(first + (skip > 0 ? static_cast<size_t>(skip) : 0)));
 }
 
 auto FOMsg::GetStr(uint num, uint skip) const -> string
 {
-    const auto str_count = static_cast<uint>(_strData.count(num));
-    auto it = _strData.find(num);
+    const auto [first, last] = FindRange(num);
 
-    if (skip >= str_count) {
+    if (skip >= last - first) {
         return "";
     }
-    for (uint i = 0; i < skip; i++) {
-        ++it;
-    }
 
-    return it->second;
+    return string(GetStrAt(first + skip));
 }
 
 auto FOMsg::GetStrNumUpper(uint num) const -> uint
 {
-    const auto it = _strData.upper_bound(num);
-    if (it == _strData.end()) {
+    const auto nums = GetNums();
+    const auto it = std::upper_bound(nums.begin(), nums.end(), num);
+    if (it == nums.end()) {
         return 0;
     }
-    return it->first;
+    return *it;
 }
 
 auto FOMsg::GetStrNumLower(uint num) const -> uint
 {
-    const auto it = _strData.lower_bound(num);
-    if (it == _strData.end()) {
+    const auto nums = GetNums();
+    const auto it = std::lower_bound(nums.begin(), nums.end(), num);
+    if (it == nums.end()) {
         return 0;
     }
-    return it->first;
+    return *it;
 }
 
 auto FOMsg::GetInt(uint num) const -> int
 {
-    const auto str_count = static_cast<uint>(_strData.count(num));
-    auto it = _strData.find(num);
-
-    switch (str_count) {
-    case 0:
+    if (Count(num) == 0u) {
         return -1;
-    case 1:
-        break;
-    default:
-        for (auto i = 0, j = GenericUtils::Random(0, static_cast<int>(str_count)) - 1; i < j; i++) {
-            ++it;
-        }
-        break;
     }
 
-    return _str(it->second).toInt();
+    return _str(GetStr(num)).toInt();
 }
 
 auto FOMsg::GetBinary(uint num) const -> vector<uchar>
@@ -204,97 +341,130 @@ auto FOMsg::GetBinary(uint num) const -> vector<uchar>
 
 auto FOMsg::Count(uint num) const -> uint
 {
-    return static_cast<uint>(_strData.count(num));
+    const auto [first, last] = FindRange(num);
+    return static_cast<uint>(last - first);
 }
 
 void FOMsg::EraseStr(uint num)
 {
-    while (true) {
-        auto it = _strData.find(num);
-        if (it != _strData.end()) {
-            _strData.erase(it);
-        }
-        else {
-            break;
-        }
+    if (Count(num) == 0u) {
+        return;
+    }
+
+    Detach();
+
+    const auto [first, last] = FindRange(num);
+    const auto start = first == 0 ? 0u : _strEnds[first - 1];
+    const auto len = _strEnds[last - 1] - start;
+
+    _strPool.erase(start, len);
+    _nums.erase(_nums.begin() + static_cast<ptrdiff_t>(first), _nums.begin() + static_cast<ptrdiff_t>(last));
+    _strEnds.erase(_strEnds.begin() + static_cast<ptrdiff_t>(first), _strEnds.begin() + static_cast<ptrdiff_t>(last));
+
+    for (auto i = first; i < _strEnds.size(); i++) {
+        _strEnds[i] -= len;
     }
 }
 
 auto FOMsg::GetSize() const -> uint
 {
-    return static_cast<uint>(_strData.size());
+    return static_cast<uint>(GetNums().size());
 }
 
 auto FOMsg::IsIntersects(const FOMsg& other) const -> bool
 {
-    for (auto&& [key, value] : _strData) {
-        if (other._strData.count(key) != 0u) {
+    const auto self_nums = GetNums();
+    const auto other_nums = other.GetNums();
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < self_nums.size() && j < other_nums.size()) {
+        if (self_nums[i] == other_nums[j]) {
             return true;
         }
+
+        if (self_nums[i] < other_nums[j]) {
+            i++;
+        }
+        else {
+            j++;
+        }
     }
     return false;
 }
 
 auto FOMsg::GetBinaryData() const -> vector<uchar>
 {
-    // Fill raw data
-    const auto count = static_cast<uint>(_strData.size());
+    const auto nums = GetNums();
+    const auto str_ends = GetStrEnds();
+    const auto str_pool = GetStrPool();
+    const auto count = static_cast<uint>(nums.size());
+    const auto arrays_size = static_cast<size_t>(count) * sizeof(uint);
 
     vector<uchar> data;
-    data.resize(sizeof(count));
-    std::memcpy(&data[0], &count, sizeof(count));
+    data.resize(TEXT_TABLE_HEADER_SIZE + arrays_size * 2 + str_pool.size());
 
-    for (auto&& [num, str] : _strData) {
-        auto str_len = static_cast<uint>(str.length());
+    auto* buf = data.data();
+    std::memcpy(buf, &TEXT_TABLE_SIGNATURE, sizeof(TEXT_TABLE_SIGNATURE));
+    std::memcpy(buf + sizeof(TEXT_TABLE_SIGNATURE), &count, sizeof(count));
+    buf += TEXT_TABLE_HEADER_SIZE;
 
-        data.resize(data.size() + sizeof(num) + sizeof(str_len) + str_len);
-        std::memcpy(&data[data.size() - (sizeof(num) + sizeof(str_len) + str_len)], &num, sizeof(num));
-        std::memcpy(&data[data.size() - (sizeof(str_len) + str_len)], &str_len, sizeof(str_len));
-        if (str_len != 0u) {
-            std::memcpy(&data[data.size() - str_len], str.c_str(), str_len);
-        }
+    if (count != 0u) {
+        std::memcpy(buf, nums.data(), arrays_size);
+        std::memcpy(buf + arrays_size, str_ends.data(), arrays_size);
+        buf += arrays_size * 2;
+    }
+    if (!str_pool.empty()) {
+        std::memcpy(buf, str_pool.data(), str_pool.size());
     }
 
-    // Compress
     return data;
 }
 
 auto FOMsg::LoadFromBinaryData(const vector<uchar>& data) -> bool
 {
+    TextTable table;
+    if (!ParseTextTable(data.data(), data.size(), table)) {
+        return false;
+    }
+
     Clear();
 
-    // Read count of strings
-    const uchar* buf = data.data();
-    uint count = 0;
-    std::memcpy(&count, buf, sizeof(count));
-    buf += sizeof(count);
-
-    // Read strings
-    uint num = 0;
-    uint str_len = 0;
-    string str;
-    for (uint i = 0; i < count; i++) {
-        std::memcpy(&num, buf, sizeof(num));
-        buf += sizeof(num);
-
-        std::memcpy(&str_len, buf, sizeof(str_len));
-        buf += sizeof(str_len);
-
-        str.resize(str_len);
-        if (str_len != 0u) {
-            std::memcpy(&str[0], buf, str_len);
-        }
-        buf += str_len;
+    _nums.assign(table.Nums.begin(), table.Nums.end());
+    _strEnds.assign(table.StrEnds.begin(), table.StrEnds.end());
+    _strPool = table.StrPool;
 
-        AddStr(num, str);
+    return true;
+}
+
+auto FOMsg::LoadFromMappedFile(string_view fname) -> bool
+{
+    auto mapping = DiskFileSystem::MapFile(fname);
+    if (!mapping) {
+        return false;
     }
 
+    auto mapped_file = std::make_shared<DiskFileMapping>(std::move(mapping));
+
+    TextTable table;
+    if (!ParseTextTable(mapped_file->GetData(), mapped_file->GetSize(), table)) {
+        return false;
+    }
+
+    Clear();
+
+    _mappedFile = std::move(mapped_file);
+    _mappedNums = table.Nums;
+    _mappedStrEnds = table.StrEnds;
+    _mappedStrPool = table.StrPool;
+
     return true;
 }
 
 auto FOMsg::LoadFromString(string_view str, NameResolver& name_resolver) -> bool
 {
     auto fail = false;
+    vector<pair<uint, string>> entries;
 
     const auto sstr = string(str);
     istringstream istr(sstr);
@@ -331,7 +501,7 @@ auto FOMsg::LoadFromString(string_view str, NameResolver& name_resolver) -> bool
                 num += !substr.empty() ? (_str(substr).isNumber() ? _str(substr).toInt() : name_resolver.ToHashedString(substr).as_int()) : 0;
             }
             else if (i == 2 && num != 0u) {
-                AddStr(num, substr);
+                entries.emplace_back(num, std::move(substr));
             }
             else {
                 fail = true;
@@ -339,22 +509,40 @@ auto FOMsg::LoadFromString(string_view str, NameResolver& name_resolver) -> bool
         }
     }
 
+    // Sort once instead of inserting in the middle of the table for each text
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& e1, const auto& e2) { return e1.first < e2.first; });
+
+    FOMsg loaded;
+    for (const auto& [num, entry_str] : entries) {
+        loaded.AddStr(num, entry_str);
+    }
+    Merge(loaded, false);
+
     return !fail;
 }
 
 void FOMsg::LoadFromMap(const map<string, string>& kv)
 {
+    FOMsg loaded;
     for (const auto& [key, value] : kv) {
         const auto num = _str(key).toUInt();
         if (num != 0u) {
-            AddStr(num, value);
+            loaded.AddStr(num, value);
         }
     }
+    Merge(loaded, false);
 }
 
 void FOMsg::Clear()
 {
-    _strData.clear();
+    _nums.clear();
+    _strEnds.clear();
+    _strPool.clear();
+
+    _mappedFile.reset();
+    _mappedNums = {};
+    _mappedStrEnds = {};
+    _mappedStrPool = {};
 }
 
 auto FOMsg::GetMsgType(string_view type_name) -> int
@@ -442,20 +630,23 @@ void LanguagePack::LoadTexts(FileSystem& file_sys, string_view lang_name)
 
     auto msg_files = file_sys.FilterFiles("fotxtb", "", false);
     while (msg_files.MoveNext()) {
-        auto msg_file = msg_files.GetCurFile();
+        const auto msg_file_header = msg_files.GetCurFileHeader();
 
-        auto name = msg_file.GetName();
+        auto name = msg_file_header.GetName();
         RUNTIME_ASSERT(name.length() > 5);
         RUNTIME_ASSERT(name[4] == '-');
 
         if (name.substr(0, 4) == lang_name) {
             for (auto i = 0; i < TEXTMSG_COUNT; i++) {
                 if (Data->TextMsgFileName[i] == name.substr(5)) {
-                    if (!Msg[i].LoadFromBinaryData(msg_file.GetData())) {
-                        throw LanguagePackException("Invalid text file", msg_file.GetPath());
+                    // Plain files on disk are mapped as is, packed ones are read to memory
+                    const auto disk_path = msg_file_header.GetDiskPath();
+                    const auto loaded = !disk_path.empty() ? Msg[i].LoadFromMappedFile(disk_path) : Msg[i].LoadFromBinaryData(msg_files.GetCurFile().GetData());
+                    if (!loaded) {
+                        throw LanguagePackException("Invalid text file", msg_file_header.GetPath());
                     }
 
-                    WriteLog("Loaded {} texts for language '{}' from '{}'", Msg[i].GetSize(), lang_name, msg_file.GetPath());
+                    WriteLog("Loaded {} texts for language '{}' from '{}'", Msg[i].GetSize(), lang_name, msg_file_header.GetPath());
                 }
             }
         }
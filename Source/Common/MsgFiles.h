@@ -53,11 +53,11 @@ static constexpr auto TEXTMSG_INTERNAL = 8;
 static constexpr auto TEXTMSG_LOCATIONS = 9;
 static constexpr auto TEXTMSG_COUNT = 10;
 
+class DiskFileMapping;
+
 class FOMsg final
 {
 public:
-    using MsgMap = multimap<uint, string>;
-
     FOMsg() = default;
     FOMsg(const FOMsg&) = default;
     FOMsg(FOMsg&&) noexcept = default;
@@ -80,6 +80,7 @@ class FOMsg final
     [[nodiscard]] auto GetBinaryData() const -> vector<uchar>;
 
     auto LoadFromBinaryData(const vector<uchar>& data) -> bool;
+    auto LoadFromMappedFile(string_view fname) -> bool;
     auto LoadFromString(string_view str, NameResolver& name_resolver) -> bool;
     void LoadFromMap(const map<string, string>& kv);
     void AddStr(uint num, string_view str);
@@ -88,7 +89,25 @@ class FOMsg final
     void Clear();
 
 private:
-    MsgMap _strData {};
+    [[nodiscard]] auto GetNums() const -> const_span<uint>;
+    [[nodiscard]] auto GetStrEnds() const -> const_span<uint>;
+    [[nodiscard]] auto GetStrPool() const -> string_view;
+    [[nodiscard]] auto GetStrAt(size_t index) const -> string_view;
+    [[nodiscard]] auto FindRange(uint num) const -> pair<size_t, size_t>;
+
+    void Merge(const FOMsg& other, bool replace);
+    void Detach();
+
+    // Texts sorted by number, same numbers keep insertion order
+    vector<uint> _nums {};
+    vector<uint> _strEnds {};
+    string _strPool {};
+
+    // Compiled table mapped from disk, copied to own storage at first change
+    shared_ptr<DiskFileMapping> _mappedFile {};
+    const_span<uint> _mappedNums {};
+    const_span<uint> _mappedStrEnds {};
+    string_view _mappedStrPool {};
 };
 
 class LanguagePack final
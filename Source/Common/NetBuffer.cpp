@@ -47,6 +47,13 @@ auto NetBuffer::GenerateEncryptKey() -> uint
 
 void NetBuffer::SetEncryptKey(uint seed)
 {
+    // Key stream turned off at handshake
+    if (_encryptDisabled) {
+        seed = 0;
+    }
+
+    _encryptSeed = seed;
+
     if (seed == 0u) {
         _encryptActive = false;
         return;
@@ -64,6 +71,15 @@ void NetBuffer::SetEncryptKey(uint seed)
     _encryptActive = true;
 }
 
+void NetBuffer::SetEncryptDisabled(bool value)
+{
+    _encryptDisabled = value;
+
+    if (value) {
+        SetEncryptKey(0);
+    }
+}
+
 auto NetBuffer::EncryptKey(int move) -> uchar
 {
     uchar key = 0;
@@ -144,6 +160,10 @@ void NetOutBuffer::Push(const void* buf, uint len)
 
     CopyBuf(buf, _bufData.get() + _bufEndPos, EncryptKey(len), len);
     _bufEndPos += len;
+
+    if (_partsTracking) {
+        _parts.emplace_back(len);
+    }
 }
 
 void NetOutBuffer::Cut(uint len)
@@ -165,6 +185,13 @@ void NetOutBuffer::Cut(uint len)
     _bufEndPos -= len;
 }
 
+void NetOutBuffer::ResetBuf()
+{
+    NetBuffer::ResetBuf();
+
+    _parts.clear();
+}
+
 void NetInBuffer::ResetBuf()
 {
     NetBuffer::ResetBuf();
@@ -172,6 +199,55 @@ void NetInBuffer::ResetBuf()
     _bufReadPos = 0;
 }
 
+auto NetInBuffer::CutMsg(NetInMessage& message) -> bool
+{
+    if (!NeedProcess()) {
+        return false;
+    }
+
+    const auto start_pos = _bufReadPos;
+    const auto start_key_pos = _encryptKeyPos;
+
+    uint msg = 0;
+    CopyBuf(_bufData.get() + _bufReadPos, &msg, EncryptKey(0), sizeof(msg));
+
+    // Server info request, size is not checked by NeedProcess
+    if (msg == 0xFFFFFFFF && start_pos + 16 > _bufEndPos) {
+        return false;
+    }
+
+    _bufReadPos += sizeof(msg);
+    EncryptKey(sizeof(msg));
+    SkipMsg(msg);
+
+    if (_isError || _bufReadPos < start_pos + sizeof(msg) || _bufReadPos > _bufEndPos) {
+        _isError = true;
+        return false;
+    }
+
+    message.Msg = msg;
+    message.EncryptSeed = _encryptSeed;
+    message.EncryptKeyPos = start_key_pos;
+    message.Data.assign(_bufData.get() + start_pos, _bufData.get() + _bufReadPos);
+    return true;
+}
+
+void NetInBuffer::SetMsg(const NetInMessage& message)
+{
+    if (_isError) {
+        return;
+    }
+
+    ResetBuf();
+
+    if (message.EncryptSeed != _encryptSeed) {
+        SetEncryptKey(message.EncryptSeed);
+    }
+    _encryptKeyPos = message.EncryptKeyPos;
+
+    AddData(message.Data.data(), static_cast<uint>(message.Data.size()));
+}
+
 void NetInBuffer::AddData(const void* buf, uint len)
 {
     if (_isError || len == 0u) {
@@ -276,6 +352,8 @@ auto NetInBuffer::NeedProcess() -> bool
         return NETMSG_REGISTER_SUCCESS_SIZE + _bufReadPos <= _bufEndPos;
     case NETMSG_PING:
         return NETMSG_PING_SIZE + _bufReadPos <= _bufEndPos;
+    case NETMSG_HANDSHAKE:
+        return NETMSG_HANDSHAKE_SIZE + _bufReadPos <= _bufEndPos;
     case NETMSG_END_PARSE_TO_GAME:
         return NETMSG_END_PARSE_TO_GAME_SIZE + _bufReadPos <= _bufEndPos;
     case NETMSG_UPDATE:
@@ -466,6 +544,9 @@ void NetInBuffer::SkipMsg(uint msg)
     case NETMSG_PING:
         size = NETMSG_PING_SIZE;
         break;
+    case NETMSG_HANDSHAKE:
+        size = NETMSG_HANDSHAKE_SIZE;
+        break;
     case NETMSG_END_PARSE_TO_GAME:
         size = NETMSG_END_PARSE_TO_GAME_SIZE;
         break;
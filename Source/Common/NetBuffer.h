@@ -37,6 +37,15 @@
 
 #include "NetProtocol-Include.h"
 
+// Complete message cut from input stream, payload stays encrypted until it is read field by field
+struct NetInMessage
+{
+    uint Msg {};
+    uint EncryptSeed {};
+    int EncryptKeyPos {};
+    vector<uchar> Data {};
+};
+
 class NetBuffer
 {
 public:
@@ -54,10 +63,12 @@ class NetBuffer
     [[nodiscard]] auto IsError() const -> bool { return _isError; }
     [[nodiscard]] auto GetData() -> uchar*;
     [[nodiscard]] auto GetEndPos() const -> uint { return _bufEndPos; }
+    [[nodiscard]] auto GetEncryptSeed() const -> uint { return _encryptSeed; }
 
     void SetError(bool value) { _isError = value; }
     static auto GenerateEncryptKey() -> uint;
     void SetEncryptKey(uint seed);
+    void SetEncryptDisabled(bool value);
     virtual void ResetBuf();
     void GrowBuf(uint len);
 
@@ -70,6 +81,8 @@ class NetBuffer
     uint _bufLen {};
     uint _bufEndPos {};
     bool _encryptActive {};
+    bool _encryptDisabled {};
+    uint _encryptSeed {};
     int _encryptKeyPos {};
     uchar _encryptKeys[CRYPT_KEYS_COUNT] {};
     bool _nonConstHelper {};
@@ -86,9 +99,13 @@ class NetOutBuffer final : public NetBuffer
     ~NetOutBuffer() override = default;
 
     [[nodiscard]] auto IsEmpty() const -> bool { return _bufEndPos == 0u; }
+    [[nodiscard]] auto GetParts() const -> const vector<uint>& { return _parts; }
 
+    // Remember size of every push to replay data later with same key stream steps
+    void SetPartsTracking(bool enabled) { _partsTracking = enabled; }
     void Push(const void* buf, uint len);
     void Cut(uint len);
+    void ResetBuf() override;
 
     template<typename T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, int> = 0>
     auto operator<<(const T& i) -> NetBuffer&
@@ -111,6 +128,10 @@ class NetOutBuffer final : public NetBuffer
         *this << i.as_hash();
         return *this;
     }
+
+private:
+    bool _partsTracking {};
+    vector<uint> _parts {};
 };
 
 class NetInBuffer final : public NetBuffer
@@ -127,6 +148,8 @@ class NetInBuffer final : public NetBuffer
     [[nodiscard]] auto GetAvailLen() const -> uint { return _bufLen - _bufEndPos; }
     [[nodiscard]] auto NeedProcess() -> bool;
 
+    auto CutMsg(NetInMessage& message) -> bool;
+    void SetMsg(const NetInMessage& message);
     void AddData(const void* buf, uint len);
     void SetEndPos(uint pos) { _bufEndPos = pos; }
     void SkipMsg(uint msg);
@@ -0,0 +1,445 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "NetCodec.h"
+#include "GenericUtils.h"
+
+#include "zlib.h"
+
+#include <queue>
+
+struct NetCodecCounters
+{
+    std::atomic<uint64> EncodeCalls {};
+    std::atomic<uint64> EncodeInBytes {};
+    std::atomic<uint64> EncodeOutBytes {};
+    std::atomic<uint64> EncodeTime {};
+    std::atomic<uint64> DecodeCalls {};
+    std::atomic<uint64> DecodeInBytes {};
+    std::atomic<uint64> DecodeOutBytes {};
+    std::atomic<uint64> DecodeTime {};
+};
+
+static NetCodecCounters CodecCounters[static_cast<size_t>(NetCodecType::Count)];
+
+static auto ElapsedNanoseconds(std::chrono::steady_clock::time_point start_time) -> uint64
+{
+    return static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+}
+
+class NetCodecNone final : public NetCodec
+{
+public:
+    NetCodecNone() : NetCodec(NetCodecType::None) { }
+
+protected:
+    void EncodeImpl(const uchar* data, uint len, vector<uchar>& output) override { output.insert(output.end(), data, data + len); }
+
+    auto DecodeImpl(const uchar* data, uint len, vector<uchar>& output) -> bool override
+    {
+        output.insert(output.end(), data, data + len);
+        return true;
+    }
+};
+
+class NetCodecZlib final : public NetCodec
+{
+public:
+    NetCodecZlib(NetCodecType type, const vector<uchar>& dictionary) : NetCodec(type), _dictionary {dictionary} { }
+    NetCodecZlib(const NetCodecZlib&) = delete;
+    NetCodecZlib(NetCodecZlib&&) noexcept = delete;
+    auto operator=(const NetCodecZlib&) = delete;
+    auto operator=(NetCodecZlib&&) noexcept = delete;
+
+    ~NetCodecZlib() override
+    {
+        if (_deflateActive) {
+            deflateEnd(&_deflate);
+        }
+        if (_inflateActive) {
+            inflateEnd(&_inflate);
+        }
+    }
+
+protected:
+    void EncodeImpl(const uchar* data, uint len, vector<uchar>& output) override
+    {
+        if (!_deflateActive) {
+            if (deflateInit(&_deflate, Z_BEST_SPEED) != Z_OK) {
+                throw NetCodecException("Can't init deflate stream");
+            }
+            _deflateActive = true;
+
+            if (!_dictionary.empty() && deflateSetDictionary(&_deflate, _dictionary.data(), static_cast<uInt>(_dictionary.size())) != Z_OK) {
+                throw NetCodecException("Can't set deflate dictionary");
+            }
+        }
+
+        _deflate.next_in = const_cast<uchar*>(data);
+        _deflate.avail_in = len;
+
+        // Sync flush needs some room for block end marker, otherwise loop until all pending output taken
+        auto out_pos = output.size();
+        while (true) {
+            output.resize(out_pos + len + len / 8 + 64);
+            _deflate.next_out = output.data() + out_pos;
+            _deflate.avail_out = static_cast<uInt>(output.size() - out_pos);
+
+            const auto result = deflate(&_deflate, Z_SYNC_FLUSH);
+            if (result != Z_OK && result != Z_BUF_ERROR) {
+                throw NetCodecException("Deflate error", result);
+            }
+
+            out_pos = output.size() - _deflate.avail_out;
+            if (_deflate.avail_out != 0u) {
+                break;
+            }
+        }
+
+        RUNTIME_ASSERT(_deflate.avail_in == 0u);
+        output.resize(out_pos);
+    }
+
+    auto DecodeImpl(const uchar* data, uint len, vector<uchar>& output) -> bool override
+    {
+        if (!_inflateActive) {
+            if (inflateInit(&_inflate) != Z_OK) {
+                throw NetCodecException("Can't init inflate stream");
+            }
+            _inflateActive = true;
+        }
+
+        _inflate.next_in = const_cast<uchar*>(data);
+        _inflate.avail_in = len;
+
+        const auto start_pos = output.size();
+        auto out_pos = start_pos;
+        while (true) {
+            output.resize(out_pos + std::max(len * 4u, 4096u));
+            _inflate.next_out = output.data() + out_pos;
+            _inflate.avail_out = static_cast<uInt>(output.size() - out_pos);
+
+            auto result = inflate(&_inflate, Z_SYNC_FLUSH);
+            if (result == Z_NEED_DICT) {
+                if (_dictionary.empty() || inflateSetDictionary(&_inflate, _dictionary.data(), static_cast<uInt>(_dictionary.size())) != Z_OK) {
+                    output.resize(start_pos);
+                    return false;
+                }
+                result = inflate(&_inflate, Z_SYNC_FLUSH);
+            }
+            if (result != Z_OK && result != Z_BUF_ERROR) {
+                output.resize(start_pos);
+                return false;
+            }
+
+            out_pos = output.size() - _inflate.avail_out;
+            if (_inflate.avail_out != 0u) {
+                break;
+            }
+        }
+
+        output.resize(out_pos);
+        return _inflate.avail_in == 0u;
+    }
+
+private:
+    vector<uchar> _dictionary;
+    z_stream _deflate {};
+    z_stream _inflate {};
+    bool _deflateActive {};
+    bool _inflateActive {};
+};
+
+auto NetCodec::Create(NetCodecType type, const vector<uchar>& dictionary) -> unique_ptr<NetCodec>
+{
+    switch (type) {
+    case NetCodecType::None:
+        return std::make_unique<NetCodecNone>();
+    case NetCodecType::Zlib:
+        return std::make_unique<NetCodecZlib>(type, vector<uchar>());
+    case NetCodecType::ZlibDictionary:
+        if (dictionary.empty()) {
+            throw NetCodecException("Net codec dictionary not loaded", GetTypeName(type));
+        }
+        return std::make_unique<NetCodecZlib>(type, dictionary);
+    default:
+        break;
+    }
+
+    throw NetCodecException("Invalid net codec", static_cast<int>(type));
+}
+
+auto NetCodec::GetTypeName(NetCodecType type) -> string_view
+{
+    switch (type) {
+    case NetCodecType::None:
+        return "None";
+    case NetCodecType::Zlib:
+        return "Zlib";
+    case NetCodecType::ZlibDictionary:
+        return "ZlibDictionary";
+    default:
+        break;
+    }
+
+    throw NetCodecException("Invalid net codec", static_cast<int>(type));
+}
+
+auto NetCodec::ParseType(string_view name) -> NetCodecType
+{
+    for (uint i = 0; i < static_cast<uint>(NetCodecType::Count); i++) {
+        if (GetTypeName(static_cast<NetCodecType>(i)) == name) {
+            return static_cast<NetCodecType>(i);
+        }
+    }
+
+    throw NetCodecException("Unknown net codec", name);
+}
+
+auto NetCodec::GetDictionaryHash(const vector<uchar>& dictionary) -> uint
+{
+    if (dictionary.empty()) {
+        return 0;
+    }
+
+    return Hashing::MurmurHash2(dictionary.data(), dictionary.size());
+}
+
+auto NetCodec::LoadDictionary(string_view path) -> vector<uchar>
+{
+    if (path.empty()) {
+        return {};
+    }
+
+    auto file = DiskFileSystem::OpenFile(path, false);
+    if (!file) {
+        throw NetCodecException("Can't open net codec dictionary", path);
+    }
+
+    vector<uchar> dictionary(file.GetSize());
+    if (dictionary.empty() || dictionary.size() > MAX_DICTIONARY_SIZE || !file.Read(dictionary.data(), dictionary.size())) {
+        throw NetCodecException("Invalid net codec dictionary", path, dictionary.size());
+    }
+
+    return dictionary;
+}
+
+auto NetCodec::TrainDictionary(const vector<vector<uchar>>& samples, size_t dict_size) -> vector<uchar>
+{
+    // Greedy cover of most frequent fragments
+    // Samples are cut to segments, segment score is sum of frequencies of its not yet covered fragments
+    // Zlib matches recent bytes cheaper, so best segments are placed at dictionary end
+    constexpr size_t fragment_len = sizeof(uint64);
+    constexpr size_t segment_len = 32;
+    constexpr size_t max_sample_bytes = 16 * 1024 * 1024;
+
+    RUNTIME_ASSERT(dict_size <= MAX_DICTIONARY_SIZE);
+
+    const auto read_fragment = [](const uchar* data) -> uint64 {
+        uint64 fragment = 0;
+        std::memcpy(&fragment, data, fragment_len);
+        return fragment;
+    };
+
+    unordered_map<uint64, uint64> frequencies;
+    size_t sample_bytes = 0;
+    for (const auto& sample : samples) {
+        for (size_t i = 0; i + fragment_len <= sample.size() && sample_bytes < max_sample_bytes; i++, sample_bytes++) {
+            frequencies[read_fragment(&sample[i])]++;
+        }
+    }
+
+    const auto score_segment = [&](size_t sample_index, size_t offset) -> uint64 {
+        const auto& sample = samples[sample_index];
+        uint64 score = 0;
+        for (auto i = offset; i + fragment_len <= std::min(offset + segment_len, sample.size()); i++) {
+            const auto it = frequencies.find(read_fragment(&sample[i]));
+            if (it != frequencies.end() && it->second > 1) {
+                score += it->second;
+            }
+        }
+        return score;
+    };
+
+    std::priority_queue<tuple<uint64, size_t, size_t>> segments;
+    sample_bytes = 0;
+    for (size_t sample_index = 0; sample_index < samples.size(); sample_index++) {
+        for (size_t offset = 0; offset + fragment_len <= samples[sample_index].size() && sample_bytes < max_sample_bytes; offset += segment_len / 2, sample_bytes += segment_len / 2) {
+            if (const auto score = score_segment(sample_index, offset); score != 0) {
+                segments.emplace(score, sample_index, offset);
+            }
+        }
+    }
+
+    vector<pair<size_t, size_t>> picked;
+    size_t picked_size = 0;
+    while (!segments.empty() && picked_size < dict_size) {
+        const auto [score, sample_index, offset] = segments.top();
+        segments.pop();
+
+        // Scores only decrease, so segment still best if rescore not dropped below next one
+        const auto actual_score = score_segment(sample_index, offset);
+        if (actual_score == 0) {
+            continue;
+        }
+        if (actual_score < score) {
+            segments.emplace(actual_score, sample_index, offset);
+            continue;
+        }
+
+        const auto& sample = samples[sample_index];
+        for (auto i = offset; i + fragment_len <= std::min(offset + segment_len, sample.size()); i++) {
+            frequencies[read_fragment(&sample[i])] = 0;
+        }
+
+        picked.emplace_back(sample_index, offset);
+        picked_size += std::min(offset + segment_len, sample.size()) - offset;
+    }
+
+    vector<uchar> dictionary;
+    dictionary.reserve(picked_size);
+    for (auto it = picked.rbegin(); it != picked.rend(); ++it) {
+        const auto& sample = samples[it->first];
+        dictionary.insert(dictionary.end(), sample.begin() + static_cast<ptrdiff_t>(it->second), sample.begin() + static_cast<ptrdiff_t>(std::min(it->second + segment_len, sample.size())));
+    }
+
+    if (dictionary.size() > dict_size) {
+        dictionary.erase(dictionary.begin(), dictionary.begin() + static_cast<ptrdiff_t>(dictionary.size() - dict_size));
+    }
+
+    return dictionary;
+}
+
+auto NetCodec::GetStatistics(NetCodecType type) -> Statistics
+{
+    const auto& counters = CodecCounters[static_cast<size_t>(type)];
+
+    Statistics stats;
+    stats.EncodeCalls = counters.EncodeCalls;
+    stats.EncodeInBytes = counters.EncodeInBytes;
+    stats.EncodeOutBytes = counters.EncodeOutBytes;
+    stats.EncodeTime = counters.EncodeTime / 1000;
+    stats.DecodeCalls = counters.DecodeCalls;
+    stats.DecodeInBytes = counters.DecodeInBytes;
+    stats.DecodeOutBytes = counters.DecodeOutBytes;
+    stats.DecodeTime = counters.DecodeTime / 1000;
+    return stats;
+}
+
+void NetCodec::ResetStatistics()
+{
+    for (auto& counters : CodecCounters) {
+        counters.EncodeCalls = 0;
+        counters.EncodeInBytes = 0;
+        counters.EncodeOutBytes = 0;
+        counters.EncodeTime = 0;
+        counters.DecodeCalls = 0;
+        counters.DecodeInBytes = 0;
+        counters.DecodeOutBytes = 0;
+        counters.DecodeTime = 0;
+    }
+}
+
+void NetCodec::Encode(const uchar* data, uint len, vector<uchar>& output)
+{
+    if (len == 0u) {
+        return;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto start_size = output.size();
+
+    EncodeImpl(data, len, output);
+
+    auto& counters = CodecCounters[static_cast<size_t>(_type)];
+    counters.EncodeCalls++;
+    counters.EncodeInBytes += len;
+    counters.EncodeOutBytes += output.size() - start_size;
+    counters.EncodeTime += ElapsedNanoseconds(start_time);
+}
+
+auto NetCodec::Decode(const uchar* data, uint len, vector<uchar>& output) -> bool
+{
+    if (len == 0u) {
+        return true;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto start_size = output.size();
+
+    const auto result = DecodeImpl(data, len, output);
+
+    auto& counters = CodecCounters[static_cast<size_t>(_type)];
+    counters.DecodeCalls++;
+    counters.DecodeInBytes += len;
+    counters.DecodeOutBytes += output.size() - start_size;
+    counters.DecodeTime += ElapsedNanoseconds(start_time);
+    return result;
+}
+
+NetTrafficCapture::NetTrafficCapture(string_view path) : _file {DiskFileSystem::OpenFile(path, true)}
+{
+    if (!_file) {
+        throw NetCodecException("Can't open traffic capture file", path);
+    }
+}
+
+auto NetTrafficCapture::Read(string_view path) -> vector<Chunk>
+{
+    auto file = DiskFileSystem::OpenFile(path, false);
+    if (!file) {
+        throw NetCodecException("Can't open traffic capture file", path);
+    }
+
+    vector<Chunk> chunks;
+    uint header[2] = {};
+    while (file.Read(header, sizeof(header))) {
+        auto& chunk = chunks.emplace_back();
+        chunk.ConnectionId = header[0];
+        chunk.Data.resize(header[1]);
+        if (!file.Read(chunk.Data.data(), chunk.Data.size())) {
+            throw NetCodecException("Truncated traffic capture file", path);
+        }
+    }
+
+    return chunks;
+}
+
+void NetTrafficCapture::Write(uint connection_id, const uchar* data, uint len)
+{
+    std::lock_guard locker(_fileLocker);
+
+    const uint header[2] = {connection_id, len};
+    _file.Write(header, sizeof(header));
+    _file.Write(data, len);
+}
@@ -0,0 +1,125 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "DiskFileSystem.h"
+
+DECLARE_EXCEPTION(NetCodecException);
+
+// Compression of server output stream, chosen per connection at handshake
+// Client asks with mask of codecs it can decode, server answers with one of them
+enum class NetCodecType : uchar
+{
+    None = 0,
+    Zlib = 1,
+    ZlibDictionary = 2, // Zlib with preset dictionary trained on captured traffic
+    Count = 3,
+};
+
+class NetCodec
+{
+public:
+    struct Statistics
+    {
+        uint64 EncodeCalls {};
+        uint64 EncodeInBytes {};
+        uint64 EncodeOutBytes {};
+        uint64 EncodeTime {}; // In microseconds
+        uint64 DecodeCalls {};
+        uint64 DecodeInBytes {};
+        uint64 DecodeOutBytes {};
+        uint64 DecodeTime {}; // In microseconds
+    };
+
+    static constexpr size_t MAX_DICTIONARY_SIZE = 32768;
+
+    NetCodec(const NetCodec&) = delete;
+    NetCodec(NetCodec&&) noexcept = delete;
+    auto operator=(const NetCodec&) = delete;
+    auto operator=(NetCodec&&) noexcept = delete;
+    virtual ~NetCodec() = default;
+
+    [[nodiscard]] static auto Create(NetCodecType type, const vector<uchar>& dictionary) -> unique_ptr<NetCodec>;
+    [[nodiscard]] static auto GetTypeName(NetCodecType type) -> string_view;
+    [[nodiscard]] static auto ParseType(string_view name) -> NetCodecType;
+    [[nodiscard]] static auto GetDictionaryHash(const vector<uchar>& dictionary) -> uint;
+    [[nodiscard]] static auto LoadDictionary(string_view path) -> vector<uchar>;
+    [[nodiscard]] static auto TrainDictionary(const vector<vector<uchar>>& samples, size_t dict_size) -> vector<uchar>;
+    [[nodiscard]] static auto GetStatistics(NetCodecType type) -> Statistics;
+    static void ResetStatistics();
+
+    [[nodiscard]] auto GetType() const -> NetCodecType { return _type; }
+
+    // Each call flushes, so output can be sent as is and decoded by other side up to last input byte
+    void Encode(const uchar* data, uint len, vector<uchar>& output);
+    [[nodiscard]] auto Decode(const uchar* data, uint len, vector<uchar>& output) -> bool;
+
+protected:
+    explicit NetCodec(NetCodecType type) : _type {type} { }
+
+    virtual void EncodeImpl(const uchar* data, uint len, vector<uchar>& output) = 0;
+    virtual auto DecodeImpl(const uchar* data, uint len, vector<uchar>& output) -> bool = 0;
+
+private:
+    NetCodecType _type;
+};
+
+// Server output stream dump for codec replay, records of connection id, chunk length and chunk data
+class NetTrafficCapture final
+{
+public:
+    struct Chunk
+    {
+        uint ConnectionId {};
+        vector<uchar> Data {};
+    };
+
+    NetTrafficCapture() = delete;
+    explicit NetTrafficCapture(string_view path);
+    NetTrafficCapture(const NetTrafficCapture&) = delete;
+    NetTrafficCapture(NetTrafficCapture&&) noexcept = delete;
+    auto operator=(const NetTrafficCapture&) = delete;
+    auto operator=(NetTrafficCapture&&) noexcept = delete;
+    ~NetTrafficCapture() = default;
+
+    [[nodiscard]] static auto Read(string_view path) -> vector<Chunk>;
+
+    void Write(uint connection_id, const uchar* data, uint len);
+
+private:
+    DiskFile _file;
+    std::mutex _fileLocker {};
+};
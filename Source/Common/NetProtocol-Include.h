@@ -102,6 +102,16 @@ constexpr uint PING_CLIENT_LIFE_TIME = 15000;
 // uchar ping (see Ping in FOdefines.h)
 // ////////////////////////////////////////////////////////////////////////
 
+#define NETMSG_HANDSHAKE MAKE_NETMSG_HEADER(6)
+#define NETMSG_HANDSHAKE_SIZE (sizeof(uint) + sizeof(uchar) + sizeof(uint) + sizeof(bool))
+// ////////////////////////////////////////////////////////////////////////
+// Transport setup, first client message, server answers with same layout
+// Output after answer is encoded with chosen codec
+// uchar codecs (client - mask of 1 << NetCodecType, server - chosen NetCodecType)
+// uint codec_dictionary_hash
+// bool key_stream (both directions, from this message)
+// ////////////////////////////////////////////////////////////////////////
+
 #define NETMSG_END_PARSE_TO_GAME MAKE_NETMSG_HEADER(7)
 #define NETMSG_END_PARSE_TO_GAME_SIZE (sizeof(uint))
 // ////////////////////////////////////////////////////////////////////////
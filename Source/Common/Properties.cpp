@@ -32,10 +32,19 @@
 //
 
 #include "Properties.h"
+#include "HashStorage.h"
 #include "Log.h"
+#include "MemoryPool.h"
 #include "PropertiesSerializator.h"
 #include "StringUtils.h"
 
+// Never destroyed, properties may be released during static destruction
+static auto GetComplexDataAllocator() -> SizeClassAllocator&
+{
+    static auto* allocator = new SizeClassAllocator(AllocationSubsystem::Properties);
+    return *allocator;
+}
+
 Property::Property(const PropertyRegistrator* registrator) : _registrator {registrator}
 {
 }
@@ -50,7 +59,8 @@ Properties::Properties(const PropertyRegistrator* registrator) : _registrator {r
     RUNTIME_ASSERT(_registrator);
 
     // Allocate plain data
-    if (!_registrator->_podDataPool.empty()) {
+    const auto pod_data_reused = !_registrator->_podDataPool.empty();
+    if (pod_data_reused) {
         _podData = _registrator->_podDataPool.back();
         _registrator->_podDataPool.pop_back();
     }
@@ -58,6 +68,8 @@ Properties::Properties(const PropertyRegistrator* registrator) : _registrator {r
         _podData = new uchar[_registrator->_wholePodDataSize];
     }
 
+    AllocationCounters::OnAllocate(AllocationSubsystem::Properties, _registrator->_wholePodDataSize, pod_data_reused);
+
     std::memset(_podData, 0, _registrator->_wholePodDataSize);
 
     // Complex data
@@ -74,7 +86,7 @@ Properties::Properties(const Properties& other) : Properties(other._registrator)
     for (size_t i = 0; i < other._complexData.size(); i++) {
         const auto size = other._complexDataSizes[i];
         _complexDataSizes[i] = size;
-        _complexData[i] = size != 0u ? new uchar[size] : nullptr;
+        _complexData[i] = size != 0u ? GetComplexDataAllocator().Allocate(size) : nullptr;
         if (size != 0u) {
             std::memcpy(_complexData[i], other._complexData[i], size);
         }
@@ -90,8 +102,10 @@ Properties::~Properties()
     catch (...) {
     }
 
-    for (const auto* cd : _complexData) {
-        delete[] cd;
+    AllocationCounters::OnFree(AllocationSubsystem::Properties, _registrator->_wholePodDataSize, 1);
+
+    for (size_t i = 0; i < _complexData.size(); i++) {
+        GetComplexDataAllocator().Free(_complexData[i], _complexDataSizes[i]);
     }
 }
 
@@ -372,11 +386,9 @@ void Properties::SetRawData(const Property* prop, const uchar* data, uint data_s
         RUNTIME_ASSERT(prop->_complexDataIndex != static_cast<uint>(-1));
 
         if (data_size != _complexDataSizes[prop->_complexDataIndex]) {
+            GetComplexDataAllocator().Free(_complexData[prop->_complexDataIndex], _complexDataSizes[prop->_complexDataIndex]);
+            _complexData[prop->_complexDataIndex] = data_size != 0u ? GetComplexDataAllocator().Allocate(data_size) : nullptr;
             _complexDataSizes[prop->_complexDataIndex] = data_size;
-            delete[] _complexData[prop->_complexDataIndex];
-            if (data_size != 0u) {
-                _complexData[prop->_complexDataIndex] = new uchar[data_size];
-            }
         }
 
         if (data_size != 0u) {
@@ -767,10 +779,15 @@ void Properties::SetValueAsIntProps(int property_index, int value)
 
 auto Properties::ResolveHash(hstring::hash_t h) const -> hstring
 {
+    // Interned hashes resolved directly, name resolver handles the rest
+    if (auto* entry = _registrator->_hashStorage.Find(h); entry != nullptr) {
+        return hstring(entry);
+    }
+
     return _registrator->_nameResolver.ResolveHash(h);
 }
 
-PropertyRegistrator::PropertyRegistrator(string_view class_name, bool is_server, NameResolver& name_resolver) : _className {class_name}, _isServer {is_server}, _nameResolver {name_resolver}
+PropertyRegistrator::PropertyRegistrator(string_view class_name, bool is_server, NameResolver& name_resolver, const HashStorage& hash_storage) : _className {class_name}, _isServer {is_server}, _nameResolver {name_resolver}, _hashStorage {hash_storage}
 {
 }
 
@@ -42,6 +42,7 @@ DECLARE_EXCEPTION(PropertyRegistrationException);
 DECLARE_EXCEPTION(PropertiesException);
 
 class Entity;
+class HashStorage;
 class Property;
 class PropertyRegistrator;
 class Properties;
@@ -237,7 +238,7 @@ class Properties final
     {
         RUNTIME_ASSERT(sizeof(T) == prop->_baseSize);
         RUNTIME_ASSERT(prop->_dataType == Property::DataType::PlainData);
-        T old_value = *reinterpret_cast<T*>(_podData[prop->_podDataOffset]);
+        T old_value = *reinterpret_cast<T*>(&_podData[prop->_podDataOffset]);
         if (new_value != old_value) {
             *reinterpret_cast<T*>(&_podData[prop->_podDataOffset]) = new_value;
             for (const auto& callback : prop->_callbacks) {
@@ -262,7 +263,7 @@ class Properties final
         RUNTIME_ASSERT(sizeof(hstring::hash_t) == prop->_baseSize);
         RUNTIME_ASSERT(prop->_dataType == Property::DataType::PlainData);
         RUNTIME_ASSERT(prop->_isHash);
-        const auto old_value = ResolveHash(*reinterpret_cast<hstring::hash_t*>(_podData[prop->_podDataOffset]));
+        const auto old_value = ResolveHash(*reinterpret_cast<hstring::hash_t*>(&_podData[prop->_podDataOffset]));
         if (new_value != old_value) {
             *reinterpret_cast<hstring::hash_t*>(&_podData[prop->_podDataOffset]) = new_value.as_uint();
             for (const auto& callback : prop->_callbacks) {
@@ -347,7 +348,7 @@ class PropertyRegistrator final
 
 public:
     PropertyRegistrator() = delete;
-    PropertyRegistrator(string_view class_name, bool is_server, NameResolver& name_resolver);
+    PropertyRegistrator(string_view class_name, bool is_server, NameResolver& name_resolver, const HashStorage& hash_storage);
     PropertyRegistrator(const PropertyRegistrator&) = delete;
     PropertyRegistrator(PropertyRegistrator&&) noexcept = default;
     auto operator=(const PropertyRegistrator&) = delete;
@@ -368,6 +369,7 @@ class PropertyRegistrator final
     string _className;
     bool _isServer;
     NameResolver& _nameResolver;
+    const HashStorage& _hashStorage;
     vector<Property*> _registeredProperties {};
     unordered_map<string, const Property*> _registeredPropertiesLookup {};
     unordered_set<hstring> _registeredComponents {};
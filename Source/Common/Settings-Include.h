@@ -91,14 +91,24 @@ SETTING_GROUP(NetworkSettings, virtual DummySettings);
 FIXED_SETTING(uint, ServerPort, 4000);
 FIXED_SETTING(bool, SecuredWebSockets, false);
 FIXED_SETTING(bool, DisableTcpNagle, true);
-FIXED_SETTING(bool, DisableZlibCompression, false);
+FIXED_SETTING(string, NetCodec, "Zlib"); // server output compression: None, Zlib or ZlibDictionary, falls back to Zlib or None if client can't decode it
+FIXED_SETTING(string, NetCodecDictionary, ""); // preset dictionary for ZlibDictionary codec, same file on client and server
+FIXED_SETTING(bool, NetKeyStream, true); // xor key stream over messages, client decides for both directions at handshake
 FIXED_SETTING(uint, FloodSize, 2048);
+FIXED_SETTING(uint, InMessagesQueueSize, 256); // client messages parsed by network thread and waiting for server loop, overflow disconnects client
 SETTING_GROUP_END();
 
 ///@ ExportSettings Server
 SETTING_GROUP(ServerNetworkSettings, virtual NetworkSettings);
 FIXED_SETTING(string, WssPrivateKey, "");
 FIXED_SETTING(string, WssCertificate, "");
+FIXED_SETTING(string, NetTrafficCapture, ""); // append server output to this file before compression, input for codec replay benchmark and dictionary training
+FIXED_SETTING(uint, ClientOutputBandwidth, 0); // bytes per second of gameplay and bulk output per client, zero to send without shaping
+FIXED_SETTING(uint, ClientOutputBurst, 65536); // bytes that may go at once after idle time when shaping is on
+FIXED_SETTING(uint, ClientOutputWatermark, 65536); // unsent connection bytes that hold gameplay and bulk messages in queue so critical ones may overtake, zero for no limit
+FIXED_SETTING(uint, SlowClientOutputSize, 1048576); // pending output that marks client as slow if kept longer than SlowClientOutputTime
+FIXED_SETTING(uint, SlowClientOutputTime, 10000);
+FIXED_SETTING(uint, MaxClientOutputSize, 33554432); // queued output that disconnects client, zero for no limit
 SETTING_GROUP_END();
 
 ///@ ExportSettings Client
@@ -156,6 +166,7 @@ SETTING_GROUP(RenderSettings, virtual ViewSettings, virtual GeometrySettings);
 FIXED_SETTING(string, WindowName, "FOnline");
 VARIABLE_SETTING(bool, WindowCentered, true);
 VARIABLE_SETTING(bool, NullRenderer, false);
+VARIABLE_SETTING(bool, RecordingRenderer, false);
 VARIABLE_SETTING(bool, ForceOpenGL, false);
 VARIABLE_SETTING(bool, ForceDirect3D, false);
 VARIABLE_SETTING(bool, ForceMetal, false);
@@ -163,6 +174,7 @@ VARIABLE_SETTING(bool, ForceGNM, false);
 VARIABLE_SETTING(bool, RenderDebug, false);
 FIXED_SETTING(uint, Animation3dSmoothTime, 150);
 FIXED_SETTING(uint, Animation3dFPS, 30);
+FIXED_SETTING(uint, Animation3dThreads, 0);
 VARIABLE_SETTING(bool, VSync, false);
 VARIABLE_SETTING(bool, AlwaysOnTop, false);
 VARIABLE_SETTING(vector<float>, EffectValues, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
@@ -170,6 +182,16 @@ VARIABLE_SETTING(bool, FullScreen, false);
 VARIABLE_SETTING(int, Brightness, 20);
 VARIABLE_SETTING(uint, FPS, 0);
 VARIABLE_SETTING(int, FixedFPS, 100);
+FIXED_SETTING(bool, AsyncResourceLoading, true);
+FIXED_SETTING(uint, ResourceLoadingThreads, 0);
+FIXED_SETTING(uint, ResourceUploadTimeBudget, 4);
+FIXED_SETTING(uint, DynamicAtlasBudget, 4); // dynamic atlases count after which cold animations are evicted, zero disables eviction
+FIXED_SETTING(uint, AtlasEvictionFrames, 1800); // frames without drawing after which animation is cold
+FIXED_SETTING(uint, AtlasEvictionsPerFrame, 16); // animations
+FIXED_SETTING(float, AtlasCompactionOccupancy, 0.3f); // dynamic atlases with lower occupancy are compacted
+FIXED_SETTING(uint, AtlasCompactionMovesPerFrame, 32); // sprites
+VARIABLE_SETTING(bool, ShowDebugOverlay, false);
+VARIABLE_SETTING(bool, ProfilerEnabled, false); // collect client frame zones and show profiler window
 SETTING_GROUP_END();
 
 ///@ ExportSettings Common
@@ -282,6 +304,20 @@ VARIABLE_SETTING(string, Language, "engl");
 VARIABLE_SETTING(bool, WinNotify, true);
 VARIABLE_SETTING(bool, SoundNotify, false);
 VARIABLE_SETTING(bool, HelpInfo, false);
+FIXED_SETTING(string, RenderSessionRecord, ""); // file to record map view states for rendering benchmark
+FIXED_SETTING(string, RenderSessionReplay, ""); // file with recorded map view states, client quits after replay
+FIXED_SETTING(string, RenderSessionReport, ""); // replay results output, log only if empty
+FIXED_SETTING(uint, LoadTestBots, 100); // simulated players per load test process
+FIXED_SETTING(uint, LoadTestDuration, 60); // seconds, zero to run until quit
+FIXED_SETTING(uint, LoadTestConnectRate, 50); // new bot connections per second
+FIXED_SETTING(string, LoadTestNamePrefix, "bot"); // bot login is prefix with bot index
+FIXED_SETTING(string, LoadTestPassword, "loadtest");
+FIXED_SETTING(bool, LoadTestRegister, true); // register accounts before first login, server needs RegistrationTimeout 0
+FIXED_SETTING(vector<string>, LoadTestScenario, "Walk", "Say", "Walk", "Talk", "Info", "Walk", "ChangeMap"); // actions cycled by every bot
+FIXED_SETTING(uint, LoadTestActionPeriod, 1000); // average time between bot actions
+FIXED_SETTING(uint, LoadTestStallTime, 100); // ping round trip counted as server stall
+FIXED_SETTING(uint, LoadTestReportPeriod, 10); // seconds between intermediate reports
+FIXED_SETTING(string, LoadTestReport, ""); // final report output, log only if empty
 SETTING_GROUP_END();
 
 ///@ ExportSettings Server
@@ -289,8 +325,19 @@ SETTING_GROUP(ServerSettings, virtual CommonSettings, virtual FileSystemSettings
 FIXED_SETTING(uint, AdminPanelPort, 0);
 FIXED_SETTING(string, DbStorage, "Memory");
 FIXED_SETTING(string, DbHistory, "None");
+FIXED_SETTING(uint, LoadEntitiesThreads, 0);
 FIXED_SETTING(bool, NoStart, false);
-FIXED_SETTING(int, GameSleep, 0);
+FIXED_SETTING(uint, ServerTickRate, 50); // target loop ticks per second, zero to run loop without pacing
+FIXED_SETTING(uint, ServerTickCatchUp, 5); // max late ticks run back to back before schedule is dropped
+FIXED_SETTING(uint, ServerTickMinInterval, 1); // min ms between ticks woken early by input or timers
+FIXED_SETTING(uint, DormantProcessPeriod, 1000);
+FIXED_SETTING(uint, DeferredCallsPerTick, 1000);
+FIXED_SETTING(bool, AsyncPathFind, true); // searches read world snapshots, needs WorldSnapshots
+FIXED_SETTING(uint, PathFindThreads, 0);
+FIXED_SETTING(uint, FlowFieldsCacheSize, 32);
+FIXED_SETTING(uint, FlowFieldMinPursuers, 4); // critters moving to same hex before flow field is built for them
+FIXED_SETTING(uint, TraceBulletThreads, 0); // workers for batched line traces, zero traces on main thread
+FIXED_SETTING(bool, WorldSnapshots, true); // publish copy of maps state at tick end for readers on other threads
 SETTING_GROUP_END();
 
 #undef FIXED_SETTING
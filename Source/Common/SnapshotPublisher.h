@@ -0,0 +1,152 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Publishes immutable values from one writer thread to lock free readers on any thread
+// Replaced values are deleted by writer once no reader may still see them (epoch based reclamation)
+// Readers touch only their own slot and published pointer, no reference counters are shared
+template<typename T>
+class SnapshotPublisher final
+{
+public:
+    static constexpr size_t MAX_READERS = 64;
+
+    class ReadGuard final
+    {
+        friend class SnapshotPublisher;
+
+    public:
+        ReadGuard() = default;
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard(ReadGuard&& other) noexcept : _slot {other._slot}, _value {other._value}
+        {
+            other._slot = nullptr;
+            other._value = nullptr;
+        }
+        auto operator=(const ReadGuard&) = delete;
+        auto operator=(ReadGuard&&) noexcept = delete;
+        explicit operator bool() const { return _value != nullptr; }
+        auto operator->() const -> const T* { return _value; }
+        auto operator*() const -> const T& { return *_value; }
+        ~ReadGuard()
+        {
+            if (_slot != nullptr) {
+                _slot->store(0);
+            }
+        }
+
+        [[nodiscard]] auto Get() const -> const T* { return _value; }
+
+    private:
+        ReadGuard(std::atomic<uint64>* slot, const T* value) : _slot {slot}, _value {value} { }
+
+        std::atomic<uint64>* _slot {};
+        const T* _value {};
+    };
+
+    SnapshotPublisher() = default;
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher(SnapshotPublisher&&) noexcept = delete;
+    auto operator=(const SnapshotPublisher&) = delete;
+    auto operator=(SnapshotPublisher&&) noexcept = delete;
+    ~SnapshotPublisher() = default;
+
+    // Any thread, guard must be released soon because it holds reclamation of newer retired values
+    [[nodiscard]] auto Read() const -> ReadGuard
+    {
+        // Slot epoch is set before value is taken so writer sees reader before value can be retired
+        const auto start_index = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS;
+        while (true) {
+            for (size_t i = 0; i < MAX_READERS; i++) {
+                auto& slot = _readerSlots[(start_index + i) % MAX_READERS].Epoch;
+                uint64 free_epoch = 0;
+                if (slot.compare_exchange_strong(free_epoch, _epoch.load())) {
+                    return ReadGuard(&slot, _published.load());
+                }
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    // Writer thread only
+    [[nodiscard]] auto GetPublished() const -> const T* { return _published.load(); }
+    [[nodiscard]] auto GetRetiredCount() const -> size_t { return _retired.size(); }
+
+    void Publish(unique_ptr<const T> value)
+    {
+        const auto* prev_value = _published.exchange(value.get());
+        RUNTIME_ASSERT(prev_value == _publishedOwner.get());
+
+        // Readers that could take previous value have epoch not greater than retire epoch
+        const auto retire_epoch = _epoch.fetch_add(1);
+        if (_publishedOwner) {
+            _retired.emplace_back(std::move(_publishedOwner), retire_epoch);
+        }
+        _publishedOwner = std::move(value);
+
+        Reclaim();
+    }
+
+    void Reclaim()
+    {
+        if (_retired.empty()) {
+            return;
+        }
+
+        auto min_epoch = std::numeric_limits<uint64>::max();
+        for (const auto& reader_slot : _readerSlots) {
+            const auto epoch = reader_slot.Epoch.load();
+            if (epoch != 0 && epoch < min_epoch) {
+                min_epoch = epoch;
+            }
+        }
+
+        _retired.erase(std::remove_if(_retired.begin(), _retired.end(), [min_epoch](const auto& retired) { return retired.second < min_epoch; }), _retired.end());
+    }
+
+private:
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64> Epoch {}; // Zero for free slot
+    };
+
+    mutable ReaderSlot _readerSlots[MAX_READERS] {};
+    std::atomic<uint64> _epoch {1};
+    std::atomic<const T*> _published {};
+    unique_ptr<const T> _publishedOwner {};
+    vector<pair<unique_ptr<const T>, uint64>> _retired {};
+};
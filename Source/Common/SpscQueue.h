@@ -0,0 +1,97 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Bounded lock free queue for exactly one producer thread and one consumer thread
+// Capacity is rounded up to power of two, push to full queue fails
+template<typename T>
+class SpscQueue final
+{
+public:
+    explicit SpscQueue(size_t capacity)
+    {
+        RUNTIME_ASSERT(capacity != 0u);
+
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        _items.resize(size);
+        _mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue(SpscQueue&&) noexcept = delete;
+    auto operator=(const SpscQueue&) = delete;
+    auto operator=(SpscQueue&&) noexcept = delete;
+    ~SpscQueue() = default;
+
+    [[nodiscard]] auto GetCapacity() const -> size_t { return _items.size(); }
+    [[nodiscard]] auto GetCount() const -> size_t { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+
+    // Producer side
+    auto Push(T&& value) -> bool
+    {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == _items.size()) {
+            return false;
+        }
+
+        _items[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    auto Pop(T& value) -> bool
+    {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = std::move(_items[head & _mask]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    vector<T> _items {};
+    size_t _mask {};
+    alignas(64) std::atomic_size_t _head {};
+    alignas(64) std::atomic_size_t _tail {};
+};
@@ -0,0 +1,135 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threads_count)
+{
+    RUNTIME_ASSERT(threads_count > 0);
+
+    _threads.reserve(threads_count);
+    for (size_t i = 0; i < threads_count; i++) {
+        _threads.emplace_back(&ThreadPool::ThreadEntry, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    deque<Job> discarded_jobs;
+
+    {
+        std::unique_lock lock {_locker};
+        _stopRequest = true;
+        discarded_jobs.swap(_jobs);
+    }
+
+    _jobSignal.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+auto ThreadPool::GetDefaultThreadsCount() -> size_t
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+auto ThreadPool::GetThreadsCount() const -> size_t
+{
+    return _threads.size();
+}
+
+void ThreadPool::AddJob(Job job)
+{
+    {
+        std::unique_lock lock {_locker};
+        _jobs.emplace_back(std::move(job));
+    }
+
+    _jobSignal.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock lock {_locker};
+
+    _doneSignal.wait(lock, [this] { return _jobs.empty() && _activeJobs == 0; });
+
+    if (_jobException) {
+        auto ex = _jobException;
+        _jobException = nullptr;
+        std::rethrow_exception(ex);
+    }
+}
+
+void ThreadPool::ThreadEntry()
+{
+    while (true) {
+        Job job;
+
+        {
+            std::unique_lock lock {_locker};
+
+            _jobSignal.wait(lock, [this] { return _stopRequest || !_jobs.empty(); });
+
+            if (_jobs.empty()) {
+                return;
+            }
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+            _activeJobs++;
+        }
+
+        std::exception_ptr ex;
+        try {
+            job();
+        }
+        catch (...) {
+            ex = std::current_exception();
+        }
+
+        {
+            std::unique_lock lock {_locker};
+
+            if (ex && !_jobException) {
+                _jobException = ex;
+            }
+
+            _activeJobs--;
+        }
+
+        _doneSignal.notify_all();
+    }
+}
@@ -0,0 +1,90 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include <condition_variable>
+
+// Fixed set of worker threads for background jobs
+// Exception from a job is rethrown by next Wait call, other jobs are not interrupted
+// Destruction waits running jobs and discards not started ones
+class ThreadPool final
+{
+public:
+    using Job = std::function<void()>;
+
+    ThreadPool() = delete;
+    explicit ThreadPool(size_t threads_count);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) noexcept = delete;
+    auto operator=(const ThreadPool&) = delete;
+    auto operator=(ThreadPool&&) noexcept = delete;
+    ~ThreadPool();
+
+    [[nodiscard]] static auto GetDefaultThreadsCount() -> size_t;
+    [[nodiscard]] auto GetThreadsCount() const -> size_t;
+
+    void AddJob(Job job);
+    void Wait();
+
+    // Splits [0, count) into chunks and waits them
+    template<typename T>
+    void ParallelFor(size_t count, const T& func)
+    {
+        const auto chunks = std::min(count, _threads.size() * 4);
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            const auto from = count * chunk / chunks;
+            const auto to = count * (chunk + 1) / chunks;
+            AddJob([&func, from, to] {
+                for (auto i = from; i < to; i++) {
+                    func(i);
+                }
+            });
+        }
+        Wait();
+    }
+
+private:
+    void ThreadEntry();
+
+    vector<std::thread> _threads {};
+    std::mutex _locker {};
+    std::condition_variable _jobSignal {};
+    std::condition_variable _doneSignal {};
+    deque<Job> _jobs {};
+    size_t _activeJobs {};
+    std::exception_ptr _jobException {};
+    bool _stopRequest {};
+};
@@ -0,0 +1,310 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "TimingWheel.h"
+
+TimingWheel::TimingWheel() : TimingWheel(0u)
+{
+}
+
+TimingWheel::TimingWheel(uint time) : _time {time}
+{
+    _lists.resize(READY_LIST + 1);
+}
+
+auto TimingWheel::GetTime() const -> uint
+{
+    return _time;
+}
+
+auto TimingWheel::GetCount() const -> size_t
+{
+    return _count;
+}
+
+auto TimingWheel::GetReadyCount() const -> size_t
+{
+    return _readyCount;
+}
+
+auto TimingWheel::IsValidHandle(Handle handle) const -> bool
+{
+    return handle.Generation != 0u && handle.Index < _nodes.size() && _nodes[handle.Index].Generation == handle.Generation && _nodes[handle.Index].List != NONE;
+}
+
+auto TimingWheel::IsPending(Handle handle) const -> bool
+{
+    return IsValidHandle(handle);
+}
+
+auto TimingWheel::GetFireTime(Handle handle) const -> uint
+{
+    RUNTIME_ASSERT(IsValidHandle(handle));
+
+    return _nodes[handle.Index].FireTime;
+}
+
+auto TimingWheel::GetNextFireTime(uint& fire_time) const -> bool
+{
+    if (_readyCount != 0u) {
+        fire_time = _time;
+        return true;
+    }
+    if (_count == 0u) {
+        return false;
+    }
+
+    const auto diff = FindNextSlotDiff();
+    fire_time = _time + static_cast<uint>(std::min(diff, static_cast<uint64>(std::numeric_limits<uint>::max())));
+    return true;
+}
+
+auto TimingWheel::FindNextSlotDiff() const -> uint64
+{
+    RUNTIME_ASSERT(_count != _readyCount);
+
+    // Exact for lowest level, upper level timers are bounded by time of their slot cascade
+    auto min_diff = std::numeric_limits<uint64>::max();
+    for (uint level = 0; level < LEVELS_COUNT; level++) {
+        const auto shift = level * SLOT_BITS;
+        const auto base = _time >> shift;
+
+        // Cascades of higher levels are not earlier than ones of this level
+        if (((static_cast<uint64>(base) + 1) << shift) - _time >= min_diff) {
+            break;
+        }
+
+        for (uint dist = 1; dist <= SLOTS_COUNT; dist++) {
+            const auto diff = ((static_cast<uint64>(base) + dist) << shift) - _time;
+            if (diff >= min_diff) {
+                break;
+            }
+
+            if (_lists[level * SLOTS_COUNT + ((base + dist) & (SLOTS_COUNT - 1))].Head != NONE) {
+                min_diff = diff;
+                break;
+            }
+        }
+    }
+
+    RUNTIME_ASSERT(min_diff != std::numeric_limits<uint64>::max());
+    return min_diff;
+}
+
+auto TimingWheel::Add(uint fire_time, uint value) -> Handle
+{
+    uint index;
+    if (_freeNode != NONE) {
+        index = _freeNode;
+        _freeNode = _nodes[index].Next;
+    }
+    else {
+        RUNTIME_ASSERT(_nodes.size() < NONE);
+        index = static_cast<uint>(_nodes.size());
+        _nodes.emplace_back();
+    }
+
+    auto& node = _nodes[index];
+    node.FireTime = fire_time;
+    node.Value = value;
+    node.Prev = NONE;
+    node.Next = NONE;
+    if (++node.Generation == 0u) {
+        node.Generation = 1u;
+    }
+
+    _count++;
+    Schedule(index);
+
+    return {index, node.Generation};
+}
+
+auto TimingWheel::Cancel(Handle handle) -> bool
+{
+    if (!IsValidHandle(handle)) {
+        return false;
+    }
+
+    Unlink(handle.Index);
+    _count--;
+
+    _nodes[handle.Index].Next = _freeNode;
+    _freeNode = handle.Index;
+    return true;
+}
+
+void TimingWheel::Advance(uint time)
+{
+    while (static_cast<int>(time - _time) > 0) {
+        // Nothing in wheel, jump directly
+        if (_count == _readyCount) {
+            _time = time;
+            break;
+        }
+
+        // Skip empty slots, nothing happens until next occupied slot or cascade
+        const auto next_diff = FindNextSlotDiff();
+        if (next_diff > time - _time) {
+            _time = time;
+            break;
+        }
+
+        _time += static_cast<uint>(next_diff);
+
+        // Move timers from upper level slots when lower level wraps around
+        for (uint level = 1; level < LEVELS_COUNT; level++) {
+            if (((_time >> ((level - 1) * SLOT_BITS)) & (SLOTS_COUNT - 1)) != 0u) {
+                break;
+            }
+
+            Cascade(level, (_time >> (level * SLOT_BITS)) & (SLOTS_COUNT - 1));
+        }
+
+        auto& slot = _lists[_time & (SLOTS_COUNT - 1)];
+        while (slot.Head != NONE) {
+            const auto index = slot.Head;
+            Unlink(index);
+            Link(READY_LIST, index);
+        }
+    }
+}
+
+auto TimingWheel::PopReady(uint& value) -> bool
+{
+    const auto index = _lists[READY_LIST].Head;
+    if (index == NONE) {
+        return false;
+    }
+
+    value = _nodes[index].Value;
+
+    Unlink(index);
+    _count--;
+
+    _nodes[index].Next = _freeNode;
+    _freeNode = index;
+    return true;
+}
+
+void TimingWheel::Clear()
+{
+    _nodes.clear();
+    _lists.assign(READY_LIST + 1, List());
+    _freeNode = NONE;
+    _count = 0;
+    _readyCount = 0;
+}
+
+void TimingWheel::Schedule(uint index)
+{
+    const auto fire_time = _nodes[index].FireTime;
+    const auto diff = fire_time - _time;
+
+    if (static_cast<int>(diff) <= 0) {
+        Link(READY_LIST, index);
+        return;
+    }
+
+    uint level = 0;
+    while (level < LEVELS_COUNT - 1 && diff >= 1u << ((level + 1) * SLOT_BITS)) {
+        level++;
+    }
+
+    Link(level * SLOTS_COUNT + ((fire_time >> (level * SLOT_BITS)) & (SLOTS_COUNT - 1)), index);
+}
+
+void TimingWheel::Cascade(uint level, uint slot)
+{
+    auto& list = _lists[level * SLOTS_COUNT + slot];
+    auto index = list.Head;
+    list = List();
+
+    while (index != NONE) {
+        const auto next = _nodes[index].Next;
+        _nodes[index].List = NONE;
+        _nodes[index].Prev = NONE;
+        _nodes[index].Next = NONE;
+        Schedule(index);
+        index = next;
+    }
+}
+
+void TimingWheel::Link(uint list, uint index)
+{
+    auto& node = _nodes[index];
+    auto& target = _lists[list];
+
+    node.List = list;
+    node.Prev = target.Tail;
+    node.Next = NONE;
+
+    if (target.Tail != NONE) {
+        _nodes[target.Tail].Next = index;
+    }
+    else {
+        target.Head = index;
+    }
+    target.Tail = index;
+
+    if (list == READY_LIST) {
+        _readyCount++;
+    }
+}
+
+void TimingWheel::Unlink(uint index)
+{
+    auto& node = _nodes[index];
+    auto& source = _lists[node.List];
+
+    if (node.Prev != NONE) {
+        _nodes[node.Prev].Next = node.Next;
+    }
+    else {
+        source.Head = node.Next;
+    }
+
+    if (node.Next != NONE) {
+        _nodes[node.Next].Prev = node.Prev;
+    }
+    else {
+        source.Tail = node.Prev;
+    }
+
+    if (node.List == READY_LIST) {
+        _readyCount--;
+    }
+
+    node.List = NONE;
+    node.Prev = NONE;
+    node.Next = NONE;
+}
@@ -0,0 +1,109 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Hierarchical timing wheel, four levels of 256 slots cover whole uint time range
+// Timers are nodes of intrusive lists so insert and cancel are constant time
+// Due timers are moved to ready queue by Advance and taken out in fire time order by PopReady
+class TimingWheel final
+{
+public:
+    static constexpr uint LEVELS_COUNT = 4;
+    static constexpr uint SLOT_BITS = 8;
+    static constexpr uint SLOTS_COUNT = 1u << SLOT_BITS;
+
+    struct Handle
+    {
+        [[nodiscard]] explicit operator bool() const { return Generation != 0u; }
+        uint Index {};
+        uint Generation {};
+    };
+
+    TimingWheel();
+    explicit TimingWheel(uint time);
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel(TimingWheel&&) noexcept = default;
+    auto operator=(const TimingWheel&) = delete;
+    auto operator=(TimingWheel&&) noexcept -> TimingWheel& = default;
+    ~TimingWheel() = default;
+
+    [[nodiscard]] auto GetTime() const -> uint;
+    [[nodiscard]] auto GetCount() const -> size_t;
+    [[nodiscard]] auto GetReadyCount() const -> size_t;
+    [[nodiscard]] auto IsPending(Handle handle) const -> bool;
+    [[nodiscard]] auto GetFireTime(Handle handle) const -> uint;
+    [[nodiscard]] auto GetNextFireTime(uint& fire_time) const -> bool;
+
+    auto Add(uint fire_time, uint value) -> Handle;
+    auto Cancel(Handle handle) -> bool;
+    void Advance(uint time);
+    auto PopReady(uint& value) -> bool;
+    void Clear();
+
+private:
+    static constexpr uint NONE = std::numeric_limits<uint>::max();
+    static constexpr uint READY_LIST = LEVELS_COUNT * SLOTS_COUNT;
+
+    struct Node
+    {
+        uint FireTime {};
+        uint Value {};
+        uint Generation {};
+        uint List {NONE};
+        uint Prev {NONE};
+        uint Next {NONE};
+    };
+
+    struct List
+    {
+        uint Head {NONE};
+        uint Tail {NONE};
+    };
+
+    [[nodiscard]] auto IsValidHandle(Handle handle) const -> bool;
+    [[nodiscard]] auto FindNextSlotDiff() const -> uint64;
+    void Schedule(uint index);
+    void Cascade(uint level, uint slot);
+    void Link(uint list, uint index);
+    void Unlink(uint index);
+
+    uint _time {};
+    vector<Node> _nodes {};
+    vector<List> _lists {};
+    uint _freeNode {NONE};
+    size_t _count {};
+    size_t _readyCount {};
+};
@@ -57,6 +57,7 @@ static ImGuiKey KeycodeToImGuiKey(int keycode);
 enum class RenderType
 {
     Null,
+    Recording,
 #if FO_HAVE_OPENGL
     OpenGL,
 #endif
@@ -79,6 +80,7 @@ static SDL_Cursor* MouseCursors[ImGuiMouseCursor_COUNT] {};
 static Renderer* ActiveRenderer {};
 static RenderType ActiveRendererType {};
 static RenderTexture* RenderTargetTex {};
+static RenderStatistics LastFrameRenderStats {};
 static vector<InputEvent>* EventsQueue {};
 static vector<InputEvent>* NextFrameEventsQueue {};
 static SDL_AudioDeviceID AudioDeviceId {};
@@ -320,6 +322,10 @@ Application::Application(int argc, char** argv, string_view name_appendix) : Set
         ActiveRendererType = RenderType::Null;
         ActiveRenderer = new Null_Renderer();
     }
+    if (Settings.RecordingRenderer) {
+        ActiveRendererType = RenderType::Recording;
+        ActiveRenderer = new Recording_Renderer();
+    }
 #if FO_HAVE_OPENGL
     if (Settings.ForceOpenGL) {
         ActiveRendererType = RenderType::OpenGL;
@@ -381,6 +387,11 @@ Application::Application(int argc, char** argv, string_view name_appendix) : Set
         return;
     }
 
+    // Recording renderer draws nothing, so run it on hidden window without real video device
+    if (ActiveRendererType == RenderType::Recording) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    }
+
     if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
         throw AppInitException("SDL_InitSubSystem SDL_INIT_VIDEO failed", SDL_GetError());
     }
@@ -477,6 +488,11 @@ Application::Application(int argc, char** argv, string_view name_appendix) : Set
         window_create_flags |= SDL_WINDOW_BORDERLESS;
     }
 
+    if (ActiveRendererType == RenderType::Recording) {
+        window_create_flags &= ~(SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN_DESKTOP);
+        window_create_flags |= SDL_WINDOW_HIDDEN;
+    }
+
     int win_pos = SDL_WINDOWPOS_UNDEFINED;
     if (Settings.WindowCentered) {
         win_pos = SDL_WINDOWPOS_CENTERED;
@@ -588,6 +604,10 @@ void Application::SetMainLoopCallback(void (*callback)(void*))
 void Application::BeginFrame()
 {
     RUNTIME_ASSERT(RenderTargetTex == nullptr);
+
+    LastFrameRenderStats = RenderStats;
+    RenderStats = RenderStatistics();
+
     ActiveRenderer->ClearRenderTarget(COLOR_RGB(150, 150, 150));
 
     ImGuiIO& io = ImGui::GetIO();
@@ -1079,6 +1099,11 @@ auto Application::AppRender::GetRenderTarget() -> RenderTexture*
     return RenderTargetTex;
 }
 
+auto Application::AppRender::GetStatistics() const -> RenderStatistics
+{
+    return LastFrameRenderStats;
+}
+
 void Application::AppRender::ClearRenderTarget(optional<uint> color, bool depth, bool stencil)
 {
     ActiveRenderer->ClearRenderTarget(color, depth, stencil);
@@ -258,6 +258,8 @@ class Application final
         static const uint& MAX_BONES;
 
         [[nodiscard]] auto GetRenderTarget() -> RenderTexture*;
+        // Counters of last finished frame
+        [[nodiscard]] auto GetStatistics() const -> RenderStatistics;
         [[nodiscard]] auto CreateTexture(uint width, uint height, bool linear_filtered, bool with_depth) -> RenderTexture*;
         [[nodiscard]] auto CreateDrawBuffer(bool is_static) -> RenderDrawBuffer*;
         [[nodiscard]] auto CreateEffect(EffectUsage usage, string_view name, string_view defines, const RenderEffectLoader& loader) -> RenderEffect*;
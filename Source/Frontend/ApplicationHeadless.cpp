@@ -185,6 +185,11 @@ auto Application::AppRender::GetRenderTarget() -> RenderTexture*
     return nullptr;
 }
 
+auto Application::AppRender::GetStatistics() const -> RenderStatistics
+{
+    return {};
+}
+
 void Application::AppRender::ClearRenderTarget(optional<uint> color, bool depth, bool stencil)
 {
     UNUSED_VARIABLE(color);
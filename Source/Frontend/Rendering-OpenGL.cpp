@@ -176,6 +176,8 @@ class OpenGL_Texture final : public RenderTexture
         GL(glBindTexture(GL_TEXTURE_2D, TexId));
         GL(glTexSubImage2D(GL_TEXTURE_2D, 0, r.Left, r.Top, r.Width(), r.Height(), GL_RGBA, GL_UNSIGNED_BYTE, data));
         GL(glBindTexture(GL_TEXTURE_2D, 0));
+
+        RenderStats.BytesUploaded += static_cast<size_t>(r.Width()) * r.Height() * sizeof(uint);
     }
 
     GLuint FramebufObj {};
@@ -771,6 +773,8 @@ auto OpenGL_Renderer::CreateEffect(EffectUsage usage, string_view name, string_v
 
 void OpenGL_Renderer::SetRenderTarget(RenderTexture* tex)
 {
+    RenderStats.StateChanges++;
+
     if (tex != nullptr) {
         const auto* opengl_tex = static_cast<OpenGL_Texture*>(tex);
         GL(glBindFramebuffer(GL_FRAMEBUFFER, opengl_tex->FramebufObj));
@@ -819,6 +823,8 @@ void OpenGL_Renderer::SetRenderTarget(RenderTexture* tex)
 
 void OpenGL_Renderer::ClearRenderTarget(optional<uint> color, bool depth, bool stencil)
 {
+    RenderStats.StateChanges++;
+
     GLbitfield clear_flags = 0;
 
     if (color.has_value()) {
@@ -848,12 +854,16 @@ void OpenGL_Renderer::ClearRenderTarget(optional<uint> color, bool depth, bool s
 
 void OpenGL_Renderer::EnableScissor(int x, int y, uint w, uint h)
 {
+    RenderStats.StateChanges++;
+
     GL(glEnable(GL_SCISSOR_TEST));
     GL(glScissor(x, y, w, h));
 }
 
 void OpenGL_Renderer::DisableScissor()
 {
+    RenderStats.StateChanges++;
+
     GL(glDisable(GL_SCISSOR_TEST));
 }
 
@@ -1093,6 +1103,11 @@ void OpenGL_Effect::DrawBuffer(RenderDrawBuffer* dbuf, size_t start_index, optio
         GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, opengl_dbuf->IndexBufObj));
         GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, dbuf->Indices.size() * sizeof(ushort), dbuf->Indices.data(), buf_type));
 
+#if FO_ENABLE_3D
+        RenderStats.BytesUploaded += dbuf->Vertices3D.size() * sizeof(Vertex3D);
+#endif
+        RenderStats.BytesUploaded += dbuf->Vertices2D.size() * sizeof(Vertex2D) + dbuf->Indices.size() * sizeof(ushort);
+
         // Create vertex array object
         if (opengl_dbuf->VertexArrObj == 0u && GL_HAS(vertex_array_object)) {
             GL(glGenVertexArrays(1, &opengl_dbuf->VertexArrObj));
@@ -1219,6 +1234,8 @@ void OpenGL_Effect::DrawBuffer(RenderDrawBuffer* dbuf, size_t start_index, optio
 
         GL(glDrawElements(draw_mode, draw_count, GL_UNSIGNED_SHORT, start_pos));
 
+        RenderStats.CountDraw(this, opnegl_tex, static_cast<size_t>(draw_count));
+
         // if (effect_pass.IsNeedProcess)
         //     modelMngr.effectMngr.EffectProcessVariables(effect_pass, false, animPosProc, animPosTime, textures);
     }
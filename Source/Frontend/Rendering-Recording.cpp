@@ -0,0 +1,234 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "Rendering.h"
+
+class Recording_Texture final : public RenderTexture
+{
+public:
+    Recording_Texture(Recording_Renderer* renderer, uint width, uint height, bool linear_filtered, bool with_depth) : RenderTexture(width, height, linear_filtered, with_depth), _renderer {renderer}, _pixels(static_cast<size_t>(width) * height) { }
+
+    [[nodiscard]] auto GetTexturePixel(int x, int y) -> uint override
+    {
+        RUNTIME_ASSERT(x >= 0 && x < static_cast<int>(Width));
+        RUNTIME_ASSERT(y >= 0 && y < static_cast<int>(Height));
+
+        return _pixels[static_cast<size_t>(y) * Width + x];
+    }
+
+    [[nodiscard]] auto GetTextureRegion(int x, int y, uint w, uint h) -> vector<uint> override
+    {
+        RUNTIME_ASSERT(w && h);
+        RUNTIME_ASSERT(x >= 0 && x + w <= Width);
+        RUNTIME_ASSERT(y >= 0 && y + h <= Height);
+
+        vector<uint> result(static_cast<size_t>(w) * h);
+        for (uint yy = 0; yy < h; yy++) {
+            std::memcpy(&result[static_cast<size_t>(yy) * w], &_pixels[static_cast<size_t>(y + yy) * Width + x], w * sizeof(uint));
+        }
+        return result;
+    }
+
+    void UpdateTextureRegion(const IRect& r, const uint* data) override
+    {
+        RUNTIME_ASSERT(r.Left >= 0 && r.Right < static_cast<int>(Width));
+        RUNTIME_ASSERT(r.Top >= 0 && r.Bottom < static_cast<int>(Height));
+
+        const auto w = static_cast<size_t>(r.Width());
+        for (auto yy = 0; yy < r.Height(); yy++) {
+            std::memcpy(&_pixels[static_cast<size_t>(r.Top + yy) * Width + r.Left], data + yy * w, w * sizeof(uint));
+        }
+
+        const auto bytes = w * r.Height() * sizeof(uint);
+        RenderStats.BytesUploaded += bytes;
+        _renderer->Record({Recording_Renderer::CommandType::UploadTexture, this, nullptr, bytes, false});
+    }
+
+private:
+    Recording_Renderer* _renderer;
+    vector<uint> _pixels;
+};
+
+class Recording_DrawBuffer final : public RenderDrawBuffer
+{
+public:
+    explicit Recording_DrawBuffer(bool is_static) : RenderDrawBuffer(is_static) { }
+
+    bool Uploaded {};
+};
+
+class Recording_Effect final : public RenderEffect
+{
+public:
+    Recording_Effect(Recording_Renderer* renderer, EffectUsage usage, string_view name, string_view defines, const RenderEffectLoader& loader) : RenderEffect(usage, name, defines, loader), _renderer {renderer} { }
+
+    void DrawBuffer(RenderDrawBuffer* dbuf, size_t start_index = 0, optional<size_t> indices_to_draw = std::nullopt, RenderTexture* custom_tex = nullptr) override
+    {
+        auto* recording_dbuf = static_cast<Recording_DrawBuffer*>(dbuf);
+
+        if (!recording_dbuf->Uploaded || dbuf->DataChanged) {
+            dbuf->DataChanged = false;
+            recording_dbuf->Uploaded = true;
+
+            // Same index generation as in real backends to get equal draw counts
+            switch (Usage) {
+#if FO_ENABLE_3D
+            case EffectUsage::Model:
+#endif
+            case EffectUsage::ImGui:
+                break;
+            case EffectUsage::Font:
+            case EffectUsage::MapSprite:
+            case EffectUsage::Interface:
+                RUNTIME_ASSERT(dbuf->Vertices2D.size() % 4 == 0);
+                dbuf->Indices.resize(dbuf->Vertices2D.size() / 4 * 6);
+                break;
+            case EffectUsage::Flush:
+            case EffectUsage::Contour:
+            case EffectUsage::Primitive:
+                dbuf->Indices.resize(dbuf->Vertices2D.size());
+                break;
+            }
+
+            auto bytes = dbuf->Vertices2D.size() * sizeof(Vertex2D) + dbuf->Indices.size() * sizeof(ushort);
+#if FO_ENABLE_3D
+            bytes += dbuf->Vertices3D.size() * sizeof(Vertex3D);
+#endif
+            RenderStats.BytesUploaded += bytes;
+            _renderer->Record({Recording_Renderer::CommandType::UploadBuffer, dbuf, nullptr, bytes, false});
+        }
+
+        const auto* tex = custom_tex != nullptr ? custom_tex : MainTex;
+        const auto draw_count = indices_to_draw.value_or(dbuf->Indices.size());
+        RUNTIME_ASSERT(start_index + draw_count <= dbuf->Indices.size());
+
+        for (size_t pass = 0; pass < _passCount; pass++) {
+            const auto batch_break = RenderStats.DrawCalls != 0 && (RenderStats.LastEffect != this || RenderStats.LastTexture != tex);
+            RenderStats.CountDraw(this, tex, draw_count);
+            _renderer->Record({Recording_Renderer::CommandType::Draw, this, tex, draw_count, batch_break});
+        }
+    }
+
+private:
+    Recording_Renderer* _renderer;
+};
+
+auto Recording_Renderer::CreateTexture(uint width, uint height, bool linear_filtered, bool with_depth) -> RenderTexture*
+{
+    auto&& recording_tex = std::make_unique<Recording_Texture>(this, width, height, linear_filtered, with_depth);
+
+    Record({CommandType::CreateTexture, recording_tex.get(), nullptr, static_cast<size_t>(width) * height * sizeof(uint), false});
+
+    return recording_tex.release();
+}
+
+auto Recording_Renderer::CreateDrawBuffer(bool is_static) -> RenderDrawBuffer*
+{
+    auto&& recording_dbuf = std::make_unique<Recording_DrawBuffer>(is_static);
+
+    Record({CommandType::CreateDrawBuffer, recording_dbuf.get(), nullptr, 0, false});
+
+    return recording_dbuf.release();
+}
+
+auto Recording_Renderer::CreateEffect(EffectUsage usage, string_view name, string_view defines, const RenderEffectLoader& loader) -> RenderEffect*
+{
+    auto&& recording_effect = std::make_unique<Recording_Effect>(this, usage, name, defines, loader);
+
+    Record({CommandType::CreateEffect, recording_effect.get(), nullptr, 0, false});
+
+    return recording_effect.release();
+}
+
+void Recording_Renderer::Init(GlobalSettings& settings, SDL_Window* window)
+{
+    UNUSED_VARIABLE(settings);
+    UNUSED_VARIABLE(window);
+}
+
+void Recording_Renderer::Present()
+{
+    Record({CommandType::Present, nullptr, nullptr, 0, false});
+
+    if (_frames.size() < MAX_RECORDED_FRAMES) {
+        _frames.emplace_back(RenderStats);
+    }
+}
+
+void Recording_Renderer::SetRenderTarget(RenderTexture* tex)
+{
+    RenderStats.StateChanges++;
+    Record({CommandType::SetRenderTarget, tex, nullptr, 0, false});
+}
+
+void Recording_Renderer::ClearRenderTarget(optional<uint> color, bool depth, bool stencil)
+{
+    UNUSED_VARIABLE(color);
+    UNUSED_VARIABLE(depth);
+    UNUSED_VARIABLE(stencil);
+
+    RenderStats.StateChanges++;
+    Record({CommandType::ClearRenderTarget, nullptr, nullptr, 0, false});
+}
+
+void Recording_Renderer::EnableScissor(int x, int y, uint w, uint h)
+{
+    UNUSED_VARIABLE(x);
+    UNUSED_VARIABLE(y);
+
+    RenderStats.StateChanges++;
+    Record({CommandType::EnableScissor, nullptr, nullptr, static_cast<size_t>(w) * h, false});
+}
+
+void Recording_Renderer::DisableScissor()
+{
+    RenderStats.StateChanges++;
+    Record({CommandType::DisableScissor, nullptr, nullptr, 0, false});
+}
+
+void Recording_Renderer::Record(const Command& cmd)
+{
+    if (_commands.size() < MAX_RECORDED_COMMANDS) {
+        _commands.emplace_back(cmd);
+    }
+    else {
+        _droppedCommands++;
+    }
+}
+
+void Recording_Renderer::ClearRecords()
+{
+    _commands.clear();
+    _frames.clear();
+    _droppedCommands = 0;
+}
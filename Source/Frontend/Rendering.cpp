@@ -35,6 +35,24 @@
 #include "ConfigFile.h"
 #include "StringUtils.h"
 
+RenderStatistics RenderStats {};
+
+void RenderStatistics::CountDraw(const RenderEffect* effect, const RenderTexture* tex, size_t vertices)
+{
+    DrawCalls++;
+    Vertices += vertices;
+
+    if (DrawCalls > 1 && effect != LastEffect) {
+        EffectSwitches++;
+    }
+    if (DrawCalls > 1 && tex != LastTexture) {
+        TextureSwitches++;
+    }
+
+    LastEffect = effect;
+    LastTexture = tex;
+}
+
 // clang-format off
 RenderTexture::RenderTexture(uint width, uint height, bool linear_filtered, bool with_depth) :
     Width {width},
@@ -152,6 +152,25 @@ class RenderTexture : public RefCounter
     RenderTexture(uint width, uint height, bool linear_filtered, bool with_depth);
 };
 
+class RenderEffect;
+
+// Counted by render backends, reset by application at each frame begin
+struct RenderStatistics
+{
+    void CountDraw(const RenderEffect* effect, const RenderTexture* tex, size_t vertices);
+
+    size_t DrawCalls {};
+    size_t Vertices {};
+    size_t EffectSwitches {}; // Batch breaks caused by effect change
+    size_t TextureSwitches {}; // Batch breaks caused by texture change
+    size_t StateChanges {}; // Render target, clear and scissor changes
+    size_t BytesUploaded {}; // Vertex, index and texture data sent to backend
+    const RenderEffect* LastEffect {};
+    const RenderTexture* LastTexture {};
+};
+
+extern RenderStatistics RenderStats;
+
 class RenderDrawBuffer : public RefCounter
 {
 public:
@@ -336,6 +355,59 @@ class Null_Renderer final : public Renderer
     void DisableScissor() override { }
 };
 
+// Keeps all resources in memory and records every backend call, usable without gpu
+class Recording_Renderer final : public Renderer
+{
+public:
+    static constexpr size_t MAX_RECORDED_COMMANDS = 1000000;
+    static constexpr size_t MAX_RECORDED_FRAMES = 100000;
+
+    enum class CommandType
+    {
+        CreateTexture,
+        CreateDrawBuffer,
+        CreateEffect,
+        UploadTexture,
+        UploadBuffer,
+        Draw,
+        SetRenderTarget,
+        ClearRenderTarget,
+        EnableScissor,
+        DisableScissor,
+        Present,
+    };
+
+    struct Command
+    {
+        CommandType Type {};
+        const void* Object {}; // Texture, draw buffer or effect
+        const RenderTexture* Texture {}; // Texture used in draw
+        size_t Count {}; // Vertices for draw, bytes for uploads
+        bool BatchBreak {}; // Draw with other effect or texture than previous one
+    };
+
+    [[nodiscard]] auto CreateTexture(uint width, uint height, bool linear_filtered, bool with_depth) -> RenderTexture* override;
+    [[nodiscard]] auto CreateDrawBuffer(bool is_static) -> RenderDrawBuffer* override;
+    [[nodiscard]] auto CreateEffect(EffectUsage usage, string_view name, string_view defines, const RenderEffectLoader& loader) -> RenderEffect* override;
+    [[nodiscard]] auto GetCommands() const -> const vector<Command>& { return _commands; }
+    [[nodiscard]] auto GetFrames() const -> const vector<RenderStatistics>& { return _frames; }
+    [[nodiscard]] auto GetDroppedCommandsCount() const -> size_t { return _droppedCommands; }
+
+    void Init(GlobalSettings& settings, SDL_Window* window) override;
+    void Present() override;
+    void SetRenderTarget(RenderTexture* tex) override;
+    void ClearRenderTarget(optional<uint> color, bool depth = false, bool stencil = false) override;
+    void EnableScissor(int x, int y, uint w, uint h) override;
+    void DisableScissor() override;
+    void Record(const Command& cmd);
+    void ClearRecords();
+
+private:
+    vector<Command> _commands {};
+    vector<RenderStatistics> _frames {};
+    size_t _droppedCommands {};
+};
+
 #if FO_HAVE_OPENGL
 
 class OpenGL_Renderer final : public Renderer
@@ -1001,6 +1001,8 @@
     self->Moving.HexY = target->GetHexY();
     self->Moving.Cut = cut;
     self->Moving.IsRun = isRun;
+
+    self->GetEngine()->EntityMngr.WakeCritter(self);
 }
 
 ///# ...
@@ -1016,6 +1018,8 @@
     self->Moving.HexY = hy;
     self->Moving.Cut = cut;
     self->Moving.IsRun = isRun;
+
+    self->GetEngine()->EntityMngr.WakeCritter(self);
 }
 
 ///# ...
@@ -1044,3 +1048,30 @@
     self->Moving = Critter::MovingData();
     self->Moving.State = MovingState::Success;
 }
+
+///# ...
+///# param duration ...
+///@ ExportMethod
+[[maybe_unused]] void Server_Critter_SetDormantTime(Critter* self, uint duration)
+{
+    // Zero is reserved for not sleeping critters, new wake up tick applied by next critters processing
+    self->DormantWakeTick = duration != 0u ? std::max(self->GetEngine()->GameTime.GameTick() + duration, 1u) : 0u;
+    self->GetEngine()->EntityMngr.WakeCritter(self);
+}
+
+///# ...
+///@ ExportMethod
+[[maybe_unused]] void Server_Critter_WakeUp(Critter* self)
+{
+    self->DormantWakeTick = 0u;
+    self->DormantProcessTick = 0u;
+    self->GetEngine()->EntityMngr.WakeCritter(self);
+}
+
+///# ...
+///# return ...
+///@ ExportMethod
+[[maybe_unused]] bool Server_Critter_IsDormant(Critter* self)
+{
+    return self->DormantWakeTick != 0u;
+}
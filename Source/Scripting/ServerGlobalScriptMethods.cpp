@@ -119,23 +119,23 @@
 ///@ ExportMethod
 [[maybe_unused]] bool Server_Game_GetDeferredCallData(FOServer* server, uint id, uint& delay, vector<int>& values)
 {
-    /*ScriptInvoker* self = Script::GetInvoker();
     DeferredCall call;
-    if (self->GetDeferredCallData(id, call)) {
-        delay = (call.FireFullSecond > GameOpt.FullSecond ? (call.FireFullSecond - GameOpt.FullSecond) * Globals->GetTimeMultiplier() / 1000 : 0);
-        if (values) {
-            if (call.IsValue) {
-                values->Resize(1);
-                *(int*)values->At(0) = call.Value;
-            }
-            else if (call.IsValues) {
-                values->Resize(0);
-                Script::AppendVectorToArray(call.Values, values);
-            }
-        }
-        return true;
-    }*/
-    return false;
+    if (!server->DeferredCallMngr.GetDeferredCallData(id, call)) {
+        return false;
+    }
+
+    delay = server->DeferredCallMngr.GetDeferredCallDelay(call);
+
+    if (call.IsValue) {
+        values = {call.Value};
+    }
+    else if (call.IsValues) {
+        values = call.Values;
+    }
+    else {
+        values.clear();
+    }
+    return true;
 }
 
 ///@ ExportMethod
@@ -734,6 +734,47 @@
     }
 }
 
+///# ...
+///# param lines ...
+///# param dist ...
+///# return ...
+///@ ExportMethod
+[[maybe_unused]] vector<uint> Server_Map_TraceLines(Map* self, const vector<int>& lines, uint dist)
+{
+    // Lines packed as fromHx, fromHy, toHx, toHy, result is hexes passed before shoot through block
+    if (lines.size() % 4 != 0) {
+        throw ScriptException("Invalid lines args");
+    }
+
+    vector<BulletTraceRequest> requests;
+    requests.reserve(lines.size() / 4);
+
+    for (size_t i = 0; i < lines.size(); i += 4) {
+        if (lines[i] < 0 || lines[i] >= self->GetWidth() || lines[i + 1] < 0 || lines[i + 1] >= self->GetHeight() || lines[i + 2] < 0 || lines[i + 2] >= self->GetWidth() || lines[i + 3] < 0 || lines[i + 3] >= self->GetHeight()) {
+            throw ScriptException("Invalid hexes args");
+        }
+
+        BulletTraceRequest request;
+        request.BeginHx = static_cast<ushort>(lines[i]);
+        request.BeginHy = static_cast<ushort>(lines[i + 1]);
+        request.EndHx = static_cast<ushort>(lines[i + 2]);
+        request.EndHy = static_cast<ushort>(lines[i + 3]);
+        request.Dist = dist;
+        requests.push_back(request);
+    }
+
+    vector<BulletTraceResult> results;
+    self->GetEngine()->MapMngr.TraceBullets(self, requests, results);
+
+    vector<uint> passed;
+    passed.reserve(results.size());
+    for (const auto& result : results) {
+        passed.push_back(result.Steps);
+    }
+
+    return passed;
+}
+
 ///# ...
 ///# param fromHx ...
 ///# param fromHy ...
@@ -1137,3 +1178,19 @@
         self->GetEngine()->VerifyTrigger(self, cr, from_hx, from_hy, hx, hy, dir);
     }
 }
+
+///# ...
+///# param disabled ...
+///@ ExportMethod
+[[maybe_unused]] void Server_Map_SetDormancyDisabled(Map* self, bool disabled)
+{
+    self->SetDormancyDisabled(disabled);
+}
+
+///# ...
+///# return ...
+///@ ExportMethod
+[[maybe_unused]] bool Server_Map_IsDormant(Map* self)
+{
+    return self->IsDormant();
+}
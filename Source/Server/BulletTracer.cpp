@@ -0,0 +1,124 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "BulletTracer.h"
+#include "LineTracer.h"
+#include "ThreadPool.h"
+
+BulletTracer::BulletTracer(GeometrySettings& settings) : _settings {settings}, _geomHelper(settings)
+{
+}
+
+void BulletTracer::Rasterize(const BulletTraceRequest& request, ushort width, ushort height, vector<pair<ushort, ushort>>& hexes) const
+{
+    const auto dist = request.Dist != 0u ? request.Dist : _geomHelper.DistGame(request.BeginHx, request.BeginHy, request.EndHx, request.EndHy);
+
+    LineTracer line_tracer(_settings, request.BeginHx, request.BeginHy, request.EndHx, request.EndHy, width, height, request.Angle);
+
+    auto cx = request.BeginHx;
+    auto cy = request.BeginHy;
+
+    hexes.clear();
+    hexes.reserve(dist);
+
+    for (uint i = 0; i < dist; i++) {
+        if (_settings.MapHexagonal) {
+            line_tracer.GetNextHex(cx, cy);
+        }
+        else {
+            line_tracer.GetNextSquare(cx, cy);
+        }
+
+        hexes.emplace_back(cx, cy);
+    }
+}
+
+void BulletTracer::Trace(const HexBitPlane& no_shoot_plane, ushort width, ushort height, const vector<BulletTraceRequest>& requests, vector<BulletTraceResult>& results, ThreadPool* pool)
+{
+    results.resize(requests.size());
+
+    if (pool != nullptr && requests.size() >= MIN_REQUESTS_PER_JOB * 2) {
+        const auto jobs = std::min(pool->GetThreadsCount(), requests.size() / MIN_REQUESTS_PER_JOB);
+        pool->ParallelFor(jobs, [&](size_t job) { TraceRange(no_shoot_plane, width, height, requests, results, requests.size() * job / jobs, requests.size() * (job + 1) / jobs); });
+    }
+    else {
+        TraceRange(no_shoot_plane, width, height, requests, results, 0, requests.size());
+    }
+
+    _stats.Batches++;
+    _stats.Traces += requests.size();
+    for (const auto& result : results) {
+        _stats.Hexes += result.Steps + (result.IsFullTrace ? 0 : 1);
+    }
+}
+
+void BulletTracer::TraceRange(const HexBitPlane& no_shoot_plane, ushort width, ushort height, const vector<BulletTraceRequest>& requests, vector<BulletTraceResult>& results, size_t from, size_t to) const
+{
+    for (auto i = from; i < to; i++) {
+        const auto& request = requests[i];
+        auto& result = results[i];
+
+        const auto dist = request.Dist != 0u ? request.Dist : _geomHelper.DistGame(request.BeginHx, request.BeginHy, request.EndHx, request.EndHy);
+
+        LineTracer line_tracer(_settings, request.BeginHx, request.BeginHy, request.EndHx, request.EndHy, width, height, request.Angle);
+
+        auto cx = request.BeginHx;
+        auto cy = request.BeginHy;
+        auto pre_cx = cx;
+        auto pre_cy = cy;
+        uint steps = 0;
+
+        for (; steps < dist; steps++) {
+            if (_settings.MapHexagonal) {
+                line_tracer.GetNextHex(cx, cy);
+            }
+            else {
+                line_tracer.GetNextSquare(cx, cy);
+            }
+
+            if (no_shoot_plane.Get(cx, cy)) {
+                break;
+            }
+
+            pre_cx = cx;
+            pre_cy = cy;
+        }
+
+        result.IsFullTrace = steps == dist;
+        result.Steps = steps;
+        result.PreBlockHx = pre_cx;
+        result.PreBlockHy = pre_cy;
+        result.BlockHx = cx;
+        result.BlockHy = cy;
+    }
+}
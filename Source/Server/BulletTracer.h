@@ -0,0 +1,99 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "GeometryHelper.h"
+#include "HexBitPlane.h"
+#include "Settings.h"
+
+class ThreadPool;
+
+struct BulletTraceRequest
+{
+    ushort BeginHx {};
+    ushort BeginHy {};
+    ushort EndHx {};
+    ushort EndHy {};
+    uint Dist {};
+    float Angle {};
+};
+
+struct BulletTraceResult
+{
+    ushort PreBlockHx {};
+    ushort PreBlockHy {};
+    ushort BlockHx {};
+    ushort BlockHy {};
+    uint Steps {};
+    bool IsFullTrace {};
+};
+
+// Many shoot through traces against one map, same hexes and results as MapManager::TraceBullet without critter checks
+// Lines are tested against no shoot plane bits instead of map lookups, requests are independent so work may be split between threads
+class BulletTracer final
+{
+public:
+    struct Statistics
+    {
+        size_t Batches {};
+        size_t Traces {};
+        size_t Hexes {};
+    };
+
+    BulletTracer() = delete;
+    explicit BulletTracer(GeometrySettings& settings);
+    BulletTracer(const BulletTracer&) = delete;
+    BulletTracer(BulletTracer&&) noexcept = delete;
+    auto operator=(const BulletTracer&) = delete;
+    auto operator=(BulletTracer&&) noexcept = delete;
+    ~BulletTracer() = default;
+
+    [[nodiscard]] auto GetStatistics() const -> const Statistics& { return _stats; }
+
+    // All hexes of line in trace order regardless of blocks, zero dist means distance to end hex
+    void Rasterize(const BulletTraceRequest& request, ushort width, ushort height, vector<pair<ushort, ushort>>& hexes) const;
+    // Results in requests order, without pool all work is done on calling thread
+    void Trace(const HexBitPlane& no_shoot_plane, ushort width, ushort height, const vector<BulletTraceRequest>& requests, vector<BulletTraceResult>& results, ThreadPool* pool);
+
+private:
+    static constexpr size_t MIN_REQUESTS_PER_JOB = 64;
+
+    void TraceRange(const HexBitPlane& no_shoot_plane, ushort width, ushort height, const vector<BulletTraceRequest>& requests, vector<BulletTraceResult>& results, size_t from, size_t to) const;
+
+    GeometrySettings& _settings;
+    GeometryHelper _geomHelper;
+    Statistics _stats {};
+};
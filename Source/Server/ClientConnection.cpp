@@ -36,9 +36,11 @@
 #include "Log.h"
 #include "MsgFiles.h"
 #include "Networking.h"
+#include "Timer.h"
 
-ClientConnection::ClientConnection(NetConnection* net_connection) : Bin {net_connection->Bin}, BinLocker {net_connection->BinLocker}, Bout {net_connection->Bout}, BoutLocker {net_connection->BoutLocker}, _netConnection {net_connection}
+ClientConnection::ClientConnection(NetConnection* net_connection, const OutgoingScheduler::Config& output_config) : _netConnection {net_connection}, _outputScheduler(output_config)
 {
+    Bout.SetPartsTracking(true);
     _netConnection->AddRef();
 }
 
@@ -73,16 +75,63 @@ auto ClientConnection::IsGracefulDisconnected() const -> bool
     return _gracefulDisconnected;
 }
 
-void ClientConnection::DisableCompression()
+auto ClientConnection::ReadMsg(uint& msg) -> bool
 {
-    NON_CONST_METHOD_HINT();
+    if (!_netConnection->InMessages.Pop(_inMessage)) {
+        return false;
+    }
 
-    _netConnection->Dispatch();
+    Bin.SetMsg(_inMessage);
+    Bin >> msg;
+    return true;
+}
+
+void ClientConnection::ClearInput()
+{
+    while (_netConnection->InMessages.Pop(_inMessage)) {
+    }
+}
+
+void ClientConnection::SetInputEncryptKey(uint seed)
+{
+    std::lock_guard locker(_netConnection->BinLocker);
+
+    _netConnection->Bin.SetEncryptKey(seed);
+}
+
+void ClientConnection::SetOutputEncryptKey(uint seed)
+{
+    // Queued output goes with previous key
+    std::lock_guard locker(_netConnection->BoutLocker);
+
+    _outputScheduler.FlushAll(_netConnection->Bout);
+    _netConnection->Bout.SetEncryptKey(seed);
+}
+
+void ClientConnection::EndOutput(uint64 coalesce_key)
+{
+    _outputScheduler.Enqueue(Bout, coalesce_key);
+
+    Dispatch();
 }
 
 void ClientConnection::Dispatch()
 {
-    NON_CONST_METHOD_HINT();
+    if (_netConnection->IsDisconnected()) {
+        return;
+    }
+
+    {
+        std::lock_guard locker(_netConnection->BoutLocker);
+
+        _outputScheduler.Flush(_netConnection->Bout, Timer::RealtimeTick());
+    }
+
+    if (_outputScheduler.IsOverflowed()) {
+        WriteLog("Output queue overflow for host '{}', {} bytes", GetHost(), _outputScheduler.GetQueuedBytes());
+        _netConnection->Disconnect();
+        return;
+    }
 
     _netConnection->Dispatch();
 }
@@ -101,6 +150,15 @@ void ClientConnection::GracefulDisconnect()
     CONNECTION_OUTPUT_BEGIN(this);
     Bout << NETMSG_DISCONNECT;
     CONNECTION_OUTPUT_END(this);
+
+    // Nothing else is sent, so whole queue goes out without shaping
+    {
+        std::lock_guard locker(_netConnection->BoutLocker);
+
+        _outputScheduler.FlushAll(_netConnection->Bout);
+    }
+
+    _netConnection->Dispatch();
 }
 
 void ClientConnection::Send_CustomMessage(uint msg)
@@ -36,6 +36,7 @@
 #include "Common.h"
 
 #include "NetBuffer.h"
+#include "OutgoingScheduler.h"
 
 #define CHECK_CLIENT_IN_BUF_ERROR(conn) \
     do { \
@@ -46,12 +47,22 @@
         } \
     } while (0)
 
+// Message interrupted by exception is dropped from staging, so next output starts clean
 #define CONNECTION_OUTPUT_BEGIN(conn) \
     { \
-        std::lock_guard locker((conn)->BoutLocker)
+        RUNTIME_ASSERT((conn)->Bout.IsEmpty()); \
+        auto reset_output = ScopeCallback([conn_ = (conn)]() noexcept { \
+            if (!conn_->Bout.IsEmpty()) { \
+                conn_->Bout.ResetBuf(); \
+            } \
+        })
 #define CONNECTION_OUTPUT_END(conn) \
-    } \
-    (conn)->Dispatch()
+    (conn)->EndOutput(0); \
+    }
+// Pending message with same key is dropped as superseded
+#define CONNECTION_OUTPUT_END_COALESCED(conn, key) \
+    (conn)->EndOutput(key); \
+    }
 
 class NetConnection;
 
@@ -59,7 +70,7 @@ class ClientConnection final
 {
 public:
     ClientConnection() = delete;
-    explicit ClientConnection(NetConnection* net_connection);
+    ClientConnection(NetConnection* net_connection, const OutgoingScheduler::Config& output_config);
     ClientConnection(const ClientConnection&) = delete;
     ClientConnection(ClientConnection&&) noexcept = delete;
     auto operator=(const ClientConnection&) = delete;
@@ -71,8 +82,13 @@ class ClientConnection final
     [[nodiscard]] auto GetPort() const -> ushort;
     [[nodiscard]] auto IsHardDisconnected() const -> bool;
     [[nodiscard]] auto IsGracefulDisconnected() const -> bool;
+    [[nodiscard]] auto GetOutputScheduler() const -> const OutgoingScheduler& { return _outputScheduler; }
 
-    void DisableCompression();
+    auto ReadMsg(uint& msg) -> bool;
+    void ClearInput();
+    void SetInputEncryptKey(uint seed);
+    void SetOutputEncryptKey(uint seed);
+    void EndOutput(uint64 coalesce_key);
     void Dispatch();
     void HardDisconnect();
     void GracefulDisconnect();
@@ -81,10 +97,10 @@ class ClientConnection final
     void Send_TextMsg(uint num_str);
     void Send_TextMsgLex(uint num_str, string_view lexems);
 
-    NetInBuffer& Bin;
-    std::mutex& BinLocker;
-    NetOutBuffer& Bout;
-    std::mutex& BoutLocker;
+    // Current message taken from network thread queue
+    NetInBuffer Bin {};
+    // Unencrypted output of current message, goes to scheduler lanes at output end
+    NetOutBuffer Bout {};
 
     uint PingNextTick {};
     bool PingOk {true};
@@ -94,6 +110,8 @@ class ClientConnection final
 
 private:
     NetConnection* _netConnection;
+    OutgoingScheduler _outputScheduler;
+    NetInMessage _inMessage {};
     bool _gracefulDisconnected {};
     bool _nonConstHelper {};
 };
@@ -36,10 +36,30 @@
 #include "Location.h"
 #include "Map.h"
 #include "MapManager.h"
+#include "MemoryPool.h"
 #include "Player.h"
 #include "Server.h"
 #include "Settings.h"
 
+// Not destroyed at exit, like items pool
+static auto GetCrittersPool() -> FixedSizePool&
+{
+    static auto* pool = new FixedSizePool(sizeof(Critter), 64, AllocationSubsystem::Critters);
+    return *pool;
+}
+
+auto Critter::operator new(size_t size) -> void*
+{
+    RUNTIME_ASSERT(size == sizeof(Critter));
+
+    return GetCrittersPool().Allocate();
+}
+
+void Critter::operator delete(void* ptr)
+{
+    GetCrittersPool().Free(ptr);
+}
+
 Critter::Critter(FOServer* engine, uint id, Player* owner, const ProtoCritter* proto) : ServerEntity(engine, id, engine->GetPropertyRegistrator(ENTITY_CLASS_NAME), proto), CritterProperties(GetInitRef()), _player {owner}
 {
     if (_player != nullptr) {
@@ -39,6 +39,7 @@
 #include "EntityProperties.h"
 #include "EntityProtos.h"
 #include "ServerEntity.h"
+#include "TimingWheel.h"
 
 struct PathStep
 {
@@ -82,6 +83,10 @@ class Critter final : public ServerEntity, public CritterProperties
     auto operator=(Critter&&) noexcept = delete;
     ~Critter() override;
 
+    // Pooled, npc spawns and despawns come in waves
+    static auto operator new(size_t size) -> void*;
+    static void operator delete(void* ptr);
+
     [[nodiscard]] auto IsPlayer() const -> bool { return _player != nullptr || _playerDetached; } // Todo: rename to IsOwnedByPlayer
     [[nodiscard]] auto IsNpc() const -> bool { return _player == nullptr && !_playerDetached; } // Todo: replace to !IsOwnedByPlayer
     [[nodiscard]] auto GetOwner() const -> const Player* { return _player; }
@@ -254,6 +259,9 @@ class Critter final : public ServerEntity, public CritterProperties
     MovingData Moving {};
     uint CacheValuesNextTick {};
     uint LookCacheValue {};
+    uint DormantWakeTick {}; // Skip processing until this tick, zero if not requested
+    uint DormantProcessTick {};
+    TimingWheel::Handle DormantWakeHandle {}; // Pending wake up while out of awake set
     vector<Critter*>* GlobalMapGroup {};
     uint RadioMessageSended {};
     TalkData Talk {}; // Todo: incapsulate Critter::Talk
@@ -347,20 +347,103 @@ auto CritterManager::GetGlobalMapCritters(ushort wx, ushort wy, uint radius, Cri
 {
     NON_CONST_METHOD_HINT();
 
-    const auto all_critters = _engine->EntityMngr.GetCritters();
-
     vector<Critter*> critters;
-    critters.reserve(all_critters.size());
 
-    for (auto* cr : all_critters) {
-        if (cr->GetMapId() == 0u && GenericUtils::DistSqrt(static_cast<int>(cr->GetWorldX()), static_cast<int>(cr->GetWorldY()), wx, wy) <= radius && cr->CheckFind(find_type)) {
-            critters.push_back(cr);
+    const auto collect_cell = [&](const vector<Critter*>& cell_critters) {
+        for (auto* cr : cell_critters) {
+            if (GenericUtils::DistSqrt(static_cast<int>(cr->GetWorldX()), static_cast<int>(cr->GetWorldY()), wx, wy) <= radius && cr->CheckFind(find_type)) {
+                critters.push_back(cr);
+            }
+        }
+    };
+
+    const auto cell_size = static_cast<int>(GetGlobalMapGridCellSize());
+    const auto clamped_radius = static_cast<int>(std::min(radius, 0xFFFFu));
+    const auto from_cx = std::max(static_cast<int>(wx) - clamped_radius, 0) / cell_size;
+    const auto from_cy = std::max(static_cast<int>(wy) - clamped_radius, 0) / cell_size;
+    const auto to_cx = std::min(static_cast<int>(wx) + clamped_radius, 0xFFFF) / cell_size;
+    const auto to_cy = std::min(static_cast<int>(wy) + clamped_radius, 0xFFFF) / cell_size;
+    const auto cells_count = static_cast<size_t>(to_cx - from_cx + 1) * static_cast<size_t>(to_cy - from_cy + 1);
+
+    // Huge radius covers more cells than occupied ones, so just walk through all of them
+    if (cells_count >= _globalMapGrid.size()) {
+        for (auto&& [cell, cell_critters] : _globalMapGrid) {
+            collect_cell(cell_critters);
+        }
+    }
+    else {
+        for (auto cy = from_cy; cy <= to_cy; cy++) {
+            for (auto cx = from_cx; cx <= to_cx; cx++) {
+                if (const auto it = _globalMapGrid.find(static_cast<uint>(cx) << 16 | static_cast<uint>(cy)); it != _globalMapGrid.end()) {
+                    collect_cell(it->second);
+                }
+            }
         }
     }
 
+    // Keep order same as in entities collection
+    std::sort(critters.begin(), critters.end(), [](const Critter* cr1, const Critter* cr2) { return cr1->GetId() < cr2->GetId(); });
+
     return critters;
 }
 
+void CritterManager::AddToGlobalMapGrid(Critter* cr)
+{
+    NON_CONST_METHOD_HINT();
+
+    auto& cell_critters = _globalMapGrid[GetGlobalMapGridCell(cr->GetWorldX(), cr->GetWorldY())];
+    RUNTIME_ASSERT(std::find(cell_critters.begin(), cell_critters.end(), cr) == cell_critters.end());
+    cell_critters.push_back(cr);
+}
+
+void CritterManager::RemoveFromGlobalMapGrid(Critter* cr)
+{
+    NON_CONST_METHOD_HINT();
+
+    EraseFromGlobalMapGridCell(cr, GetGlobalMapGridCell(cr->GetWorldX(), cr->GetWorldY()));
+}
+
+void CritterManager::MoveInGlobalMapGrid(Critter* cr, ushort old_wx, ushort old_wy)
+{
+    NON_CONST_METHOD_HINT();
+
+    const auto old_cell = GetGlobalMapGridCell(old_wx, old_wy);
+    const auto new_cell = GetGlobalMapGridCell(cr->GetWorldX(), cr->GetWorldY());
+    if (old_cell == new_cell) {
+        return;
+    }
+
+    EraseFromGlobalMapGridCell(cr, old_cell);
+    _globalMapGrid[new_cell].push_back(cr);
+}
+
+void CritterManager::EraseFromGlobalMapGridCell(Critter* cr, uint cell)
+{
+    NON_CONST_METHOD_HINT();
+
+    const auto it = _globalMapGrid.find(cell);
+    RUNTIME_ASSERT(it != _globalMapGrid.end());
+
+    const auto cr_it = std::find(it->second.begin(), it->second.end(), cr);
+    RUNTIME_ASSERT(cr_it != it->second.end());
+    it->second.erase(cr_it);
+
+    if (it->second.empty()) {
+        _globalMapGrid.erase(it);
+    }
+}
+
+auto CritterManager::GetGlobalMapGridCellSize() const -> uint
+{
+    return std::max(_engine->Settings.GlobalMapZoneLength, 1u);
+}
+
+auto CritterManager::GetGlobalMapGridCell(ushort wx, ushort wy) const -> uint
+{
+    const auto cell_size = GetGlobalMapGridCellSize();
+    return (wx / cell_size) << 16 | (wy / cell_size);
+}
+
 auto CritterManager::GetCritter(uint cr_id) -> Critter*
 {
     NON_CONST_METHOD_HINT();
@@ -384,13 +467,7 @@ auto CritterManager::GetPlayerByName(string_view name) -> Player*
 {
     NON_CONST_METHOD_HINT();
 
-    for (auto* entity : _engine->EntityMngr.GetEntities()) {
-        if (auto* player = dynamic_cast<Player*>(entity); player != nullptr && _str(name).compareIgnoreCaseUtf8(player->GetName())) {
-            return player;
-        }
-    }
-
-    return nullptr;
+    return _engine->EntityMngr.GetPlayerByName(name);
 }
 
 auto CritterManager::GetItemByPidInvPriority(Critter* cr, hstring item_pid) -> Item*
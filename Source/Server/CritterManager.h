@@ -84,8 +84,17 @@ class CritterManager final
     void EraseItemFromCritter(Critter* cr, Item* item, bool send);
     void ProcessTalk(Critter* cr, bool force);
     void CloseTalk(Critter* cr);
+    void AddToGlobalMapGrid(Critter* cr);
+    void RemoveFromGlobalMapGrid(Critter* cr);
+    void MoveInGlobalMapGrid(Critter* cr, ushort old_wx, ushort old_wy);
 
 private:
+    [[nodiscard]] auto GetGlobalMapGridCellSize() const -> uint;
+    [[nodiscard]] auto GetGlobalMapGridCell(ushort wx, ushort wy) const -> uint;
+
+    void EraseFromGlobalMapGridCell(Critter* cr, uint cell);
+
     FOServer* _engine;
+    unordered_map<uint, vector<Critter*>> _globalMapGrid {};
     bool _nonConstHelper {};
 };
@@ -60,6 +60,7 @@ class DataBaseImpl
 
     [[nodiscard]] virtual auto GetAllIds(string_view collection_name) -> vector<uint> = 0;
     [[nodiscard]] auto Get(string_view collection_name, uint id) -> AnyData::Document;
+    [[nodiscard]] auto GetBinary(string_view collection_name, uint id, vector<uchar>& data) -> const BinaryRecordSchema*;
 
     void StartChanges();
     void Insert(string_view collection_name, uint id, const AnyData::Document& doc);
@@ -69,6 +70,7 @@ class DataBaseImpl
 
 protected:
     [[nodiscard]] virtual auto GetRecord(string_view collection_name, uint id) -> AnyData::Document = 0;
+    [[nodiscard]] virtual auto GetBinaryRecord(string_view /*collection_name*/, uint /*id*/, vector<uchar>& /*data*/) -> const BinaryRecordSchema* { return nullptr; }
     virtual void InsertRecord(string_view collection_name, uint id, const AnyData::Document& doc) = 0;
     virtual void UpdateRecord(string_view collection_name, uint id, const AnyData::Document& doc) = 0;
     virtual void DeleteRecord(string_view collection_name, uint id) = 0;
@@ -105,6 +107,11 @@ auto DataBase::Get(string_view collection_name, uint id) const -> AnyData::Docum
     return _impl->Get(collection_name, id);
 }
 
+auto DataBase::GetBinaryRecord(string_view collection_name, uint id, vector<uchar>& data) const -> const BinaryRecordSchema*
+{
+    return _impl->GetBinary(collection_name, id, data);
+}
+
 auto DataBase::Valid(string_view collection_name, uint id) const -> bool
 {
     return !_impl->Get(collection_name, id).empty();
@@ -459,29 +466,434 @@ static void BsonToDocument(const bson_t* bson, AnyData::Document& doc)
     }
 }
 
+// Binary record layout: magic, keys count, then [key index, value type, payload] per key
+// Plain values stored as fixed size blocks in host byte order, strings and containers prefixed with count
+static constexpr uchar BINARY_RECORD_MAGIC[] = {'F', 'O', 'B', 'R'};
+static constexpr uchar BINARY_SCHEMA_MAGIC[] = {'F', 'O', 'B', 'S'};
+
+class BinaryRecordWriter final
+{
+public:
+    explicit BinaryRecordWriter(vector<uchar>& buf) : _buf {buf} { }
+
+    template<typename T>
+    void Write(T value)
+    {
+        static_assert(std::is_arithmetic_v<T>);
+        const auto pos = _buf.size();
+        _buf.resize(pos + sizeof(T));
+        std::memcpy(&_buf[pos], &value, sizeof(T));
+    }
+
+    void WriteBlock(const void* data, size_t size)
+    {
+        if (size != 0u) {
+            const auto pos = _buf.size();
+            _buf.resize(pos + size);
+            std::memcpy(&_buf[pos], data, size);
+        }
+    }
+
+    void WriteString(const string& str)
+    {
+        Write<uint>(static_cast<uint>(str.length()));
+        WriteBlock(str.data(), str.length());
+    }
+
+    template<typename T>
+    void WriteValue(const T& value)
+    {
+        const auto value_index = value.index();
+        Write<uchar>(static_cast<uchar>(value_index));
+
+        if (value_index == AnyData::INT_VALUE) {
+            Write<int>(std::get<AnyData::INT_VALUE>(value));
+        }
+        else if (value_index == AnyData::INT64_VALUE) {
+            Write<int64>(std::get<AnyData::INT64_VALUE>(value));
+        }
+        else if (value_index == AnyData::DOUBLE_VALUE) {
+            Write<double>(std::get<AnyData::DOUBLE_VALUE>(value));
+        }
+        else if (value_index == AnyData::BOOL_VALUE) {
+            Write<uchar>(std::get<AnyData::BOOL_VALUE>(value) ? 1 : 0);
+        }
+        else if (value_index == AnyData::STRING_VALUE) {
+            WriteString(std::get<AnyData::STRING_VALUE>(value));
+        }
+        else if constexpr (std::variant_size_v<T> > AnyData::ARRAY_VALUE) {
+            if (value_index == AnyData::ARRAY_VALUE) {
+                const auto& arr = std::get<AnyData::ARRAY_VALUE>(value);
+                Write<uint>(static_cast<uint>(arr.size()));
+                for (const auto& arr_value : arr) {
+                    WriteValue(arr_value);
+                }
+            }
+            else if constexpr (std::variant_size_v<T> > AnyData::DICT_VALUE) {
+                if (value_index == AnyData::DICT_VALUE) {
+                    const auto& dict = std::get<AnyData::DICT_VALUE>(value);
+                    Write<uint>(static_cast<uint>(dict.size()));
+                    for (auto&& [dict_key, dict_value] : dict) {
+                        WriteString(dict_key);
+                        WriteValue(dict_value);
+                    }
+                }
+                else {
+                    throw DataBaseException("BinaryRecordWriter Invalid type", value_index);
+                }
+            }
+            else {
+                throw DataBaseException("BinaryRecordWriter Invalid type", value_index);
+            }
+        }
+        else {
+            throw DataBaseException("BinaryRecordWriter Invalid type", value_index);
+        }
+    }
+
+private:
+    vector<uchar>& _buf;
+};
+
+class BinaryRecordReader final
+{
+public:
+    BinaryRecordReader(const uchar* data, size_t size) : _data {data}, _size {size} { }
+
+    [[nodiscard]] auto IsEnd() const -> bool { return _pos == _size; }
+    [[nodiscard]] auto GetPos() const -> size_t { return _pos; }
+
+    template<typename T>
+    [[nodiscard]] auto Read() -> T
+    {
+        static_assert(std::is_arithmetic_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] auto ReadString() -> string
+    {
+        const auto len = Read<uint>();
+        const auto* str = Take(len);
+        return string(reinterpret_cast<const char*>(str), len);
+    }
+
+    template<typename T>
+    [[nodiscard]] auto ReadValue() -> T
+    {
+        const auto value_index = static_cast<size_t>(Read<uchar>());
+
+        if (value_index == AnyData::INT_VALUE) {
+            return Read<int>();
+        }
+        if (value_index == AnyData::INT64_VALUE) {
+            return Read<int64>();
+        }
+        if (value_index == AnyData::DOUBLE_VALUE) {
+            return Read<double>();
+        }
+        if (value_index == AnyData::BOOL_VALUE) {
+            return Read<uchar>() != 0;
+        }
+        if (value_index == AnyData::STRING_VALUE) {
+            return ReadString();
+        }
+
+        if constexpr (std::variant_size_v<T> > AnyData::ARRAY_VALUE) {
+            if (value_index == AnyData::ARRAY_VALUE) {
+                const auto count = Read<uint>();
+                AnyData::Array arr;
+                arr.reserve(std::min(static_cast<size_t>(count), _size - _pos));
+                for (uint i = 0; i < count; i++) {
+                    arr.emplace_back(ReadValue<AnyData::Array::value_type>());
+                }
+                return arr;
+            }
+        }
+        if constexpr (std::variant_size_v<T> > AnyData::DICT_VALUE) {
+            if (value_index == AnyData::DICT_VALUE) {
+                const auto count = Read<uint>();
+                AnyData::Dict dict;
+                for (uint i = 0; i < count; i++) {
+                    auto dict_key = ReadString();
+                    dict.emplace(std::move(dict_key), ReadValue<AnyData::Dict::mapped_type>());
+                }
+                return dict;
+            }
+        }
+
+        throw DataBaseException("BinaryRecordReader Invalid type", value_index);
+    }
+
+    void SkipValue()
+    {
+        const auto value_index = static_cast<size_t>(Read<uchar>());
+
+        if (value_index == AnyData::INT_VALUE) {
+            Skip(sizeof(int));
+        }
+        else if (value_index == AnyData::INT64_VALUE) {
+            Skip(sizeof(int64));
+        }
+        else if (value_index == AnyData::DOUBLE_VALUE) {
+            Skip(sizeof(double));
+        }
+        else if (value_index == AnyData::BOOL_VALUE) {
+            Skip(sizeof(uchar));
+        }
+        else if (value_index == AnyData::STRING_VALUE) {
+            Skip(Read<uint>());
+        }
+        else if (value_index == AnyData::ARRAY_VALUE) {
+            const auto count = Read<uint>();
+            for (uint i = 0; i < count; i++) {
+                SkipValue();
+            }
+        }
+        else if (value_index == AnyData::DICT_VALUE) {
+            const auto count = Read<uint>();
+            for (uint i = 0; i < count; i++) {
+                Skip(Read<uint>());
+                SkipValue();
+            }
+        }
+        else {
+            throw DataBaseException("BinaryRecordReader Invalid type", value_index);
+        }
+    }
+
+private:
+    void Skip(size_t size)
+    {
+        if (size > _size - _pos) {
+            throw DataBaseException("BinaryRecordReader Unexpected end of data", _pos, size, _size);
+        }
+
+        _pos += size;
+    }
+
+    [[nodiscard]] auto Take(size_t size) -> const uchar*
+    {
+        const auto* ptr = _data + _pos;
+        Skip(size);
+        return ptr;
+    }
+
+    const uchar* _data;
+    size_t _size;
+    size_t _pos {};
+};
+
+auto BinaryRecordSchema::IsBinaryRecord(const uchar* data, size_t size) -> bool
+{
+    return size >= sizeof(BINARY_RECORD_MAGIC) && std::memcmp(data, BINARY_RECORD_MAGIC, sizeof(BINARY_RECORD_MAGIC)) == 0;
+}
+
+auto BinaryRecordSchema::DecodeValue(const BinaryRecordValue& value) -> AnyData::Value
+{
+    BinaryRecordReader reader {value.Data, value.Size};
+    return reader.ReadValue<AnyData::Value>();
+}
+
+auto BinaryRecordSchema::GetKeysCount() const -> size_t
+{
+    return _keys.size();
+}
+
+auto BinaryRecordSchema::GetKey(size_t index) const -> const string&
+{
+    return _keys[index];
+}
+
+auto BinaryRecordSchema::IsChanged() const -> bool
+{
+    return _changed;
+}
+
+auto BinaryRecordSchema::Decode(const uchar* data, size_t size) const -> AnyData::Document
+{
+    if (!IsBinaryRecord(data, size)) {
+        throw DataBaseException("BinaryRecordSchema Invalid record header");
+    }
+
+    BinaryRecordReader reader {data + sizeof(BINARY_RECORD_MAGIC), size - sizeof(BINARY_RECORD_MAGIC)};
+
+    AnyData::Document doc;
+
+    const auto count = reader.Read<ushort>();
+    for (ushort i = 0; i < count; i++) {
+        const auto key_index = reader.Read<ushort>();
+        if (key_index >= _keys.size()) {
+            throw DataBaseException("BinaryRecordSchema Key index out of schema", key_index, _keys.size());
+        }
+
+        doc.emplace_hint(doc.end(), _keys[key_index], reader.ReadValue<AnyData::Value>());
+    }
+
+    if (!reader.IsEnd()) {
+        throw DataBaseException("BinaryRecordSchema Trailing data in record");
+    }
+
+    return doc;
+}
+
+void BinaryRecordSchema::Split(const uchar* data, size_t size, vector<pair<ushort, BinaryRecordValue>>& values) const
+{
+    if (!IsBinaryRecord(data, size)) {
+        throw DataBaseException("BinaryRecordSchema Invalid record header");
+    }
+
+    const auto* body = data + sizeof(BINARY_RECORD_MAGIC);
+    BinaryRecordReader reader {body, size - sizeof(BINARY_RECORD_MAGIC)};
+
+    values.clear();
+
+    const auto count = reader.Read<ushort>();
+    for (ushort i = 0; i < count; i++) {
+        const auto key_index = reader.Read<ushort>();
+        if (key_index >= _keys.size()) {
+            throw DataBaseException("BinaryRecordSchema Key index out of schema", key_index, _keys.size());
+        }
+
+        const auto value_pos = reader.GetPos();
+        reader.SkipValue();
+        values.emplace_back(key_index, BinaryRecordValue {body + value_pos, reader.GetPos() - value_pos});
+    }
+
+    if (!reader.IsEnd()) {
+        throw DataBaseException("BinaryRecordSchema Trailing data in record");
+    }
+}
+
+auto BinaryRecordSchema::Encode(const AnyData::Document& doc) -> vector<uchar>
+{
+    RUNTIME_ASSERT(doc.size() <= MAX_KEYS);
+
+    vector<uchar> buf;
+    buf.reserve(sizeof(BINARY_RECORD_MAGIC) + doc.size() * 8u);
+
+    BinaryRecordWriter writer {buf};
+    writer.WriteBlock(BINARY_RECORD_MAGIC, sizeof(BINARY_RECORD_MAGIC));
+    writer.Write<ushort>(static_cast<ushort>(doc.size()));
+
+    for (auto&& [key, value] : doc) {
+        auto it = _keyIndices.find(key);
+        if (it == _keyIndices.end()) {
+            if (_keys.size() >= MAX_KEYS) {
+                throw DataBaseException("BinaryRecordSchema Keys limit reached", key);
+            }
+
+            it = _keyIndices.emplace(key, static_cast<ushort>(_keys.size())).first;
+            _keys.emplace_back(key);
+            _changed = true;
+        }
+
+        writer.Write<ushort>(it->second);
+        writer.WriteValue(value);
+    }
+
+    return buf;
+}
+
+auto BinaryRecordSchema::Store() -> vector<uchar>
+{
+    vector<uchar> buf;
+
+    BinaryRecordWriter writer {buf};
+    writer.WriteBlock(BINARY_SCHEMA_MAGIC, sizeof(BINARY_SCHEMA_MAGIC));
+    writer.Write<uint>(SCHEMA_VERSION);
+    writer.Write<uint>(static_cast<uint>(_keys.size()));
+    for (const auto& key : _keys) {
+        writer.WriteString(key);
+    }
+
+    _changed = false;
+    return buf;
+}
+
+void BinaryRecordSchema::Restore(const uchar* data, size_t size)
+{
+    if (size < sizeof(BINARY_SCHEMA_MAGIC) || std::memcmp(data, BINARY_SCHEMA_MAGIC, sizeof(BINARY_SCHEMA_MAGIC)) != 0) {
+        throw DataBaseException("BinaryRecordSchema Invalid schema header");
+    }
+
+    BinaryRecordReader reader {data + sizeof(BINARY_SCHEMA_MAGIC), size - sizeof(BINARY_SCHEMA_MAGIC)};
+
+    const auto version = reader.Read<uint>();
+    if (version > SCHEMA_VERSION) {
+        throw DataBaseException("BinaryRecordSchema Schema version is newer than supported", version, SCHEMA_VERSION);
+    }
+
+    const auto count = reader.Read<uint>();
+    if (count > MAX_KEYS) {
+        throw DataBaseException("BinaryRecordSchema Too many keys", count);
+    }
+
+    _keys.clear();
+    _keyIndices.clear();
+
+    for (uint i = 0; i < count; i++) {
+        auto key = reader.ReadString();
+        if (!_keyIndices.emplace(key, static_cast<ushort>(i)).second) {
+            throw DataBaseException("BinaryRecordSchema Duplicate key", key);
+        }
+        _keys.emplace_back(std::move(key));
+    }
+
+    _changed = false;
+}
+
 auto DataBaseImpl::Get(string_view collection_name, uint id) -> AnyData::Document
 {
+    // Lookups only, reading allowed from multiple threads
     const auto collection_name_str = string(collection_name);
 
-    if (_deletedRecords[collection_name_str].count(id) != 0u) {
+    if (const auto it = _deletedRecords.find(collection_name_str); it != _deletedRecords.end() && it->second.count(id) != 0u) {
         return AnyData::Document();
     }
 
-    if (_newRecords[collection_name_str].count(id) != 0u) {
-        return _recordChanges[collection_name_str].at(id);
+    const auto changes_it = _recordChanges.find(collection_name_str);
+
+    if (const auto it = _newRecords.find(collection_name_str); it != _newRecords.end() && it->second.count(id) != 0u) {
+        return changes_it->second.at(id);
     }
 
     auto doc = GetRecord(collection_name_str, id);
 
-    if (_recordChanges[collection_name_str].count(id) != 0u) {
-        for (auto&& [key, value] : _recordChanges[collection_name_str].at(id)) {
-            doc[key] = value;
+    if (changes_it != _recordChanges.end()) {
+        if (const auto it = changes_it->second.find(id); it != changes_it->second.end()) {
+            for (auto&& [key, value] : it->second) {
+                doc[key] = value;
+            }
         }
     }
 
     return doc;
 }
 
+auto DataBaseImpl::GetBinary(string_view collection_name, uint id, vector<uchar>& data) -> const BinaryRecordSchema*
+{
+    const auto* schema = GetBinaryRecord(collection_name, id, data);
+    if (schema == nullptr) {
+        return nullptr;
+    }
+
+    // Not committed changes are merged only in documents
+    const auto collection_name_str = string(collection_name);
+
+    for (const auto* records : {&_deletedRecords, &_newRecords}) {
+        if (const auto it = records->find(collection_name_str); it != records->end() && it->second.count(id) != 0u) {
+            return nullptr;
+        }
+    }
+    if (const auto it = _recordChanges.find(collection_name_str); it != _recordChanges.end() && it->second.count(id) != 0u) {
+        return nullptr;
+    }
+
+    return schema;
+}
+
 void DataBaseImpl::StartChanges()
 {
     RUNTIME_ASSERT(!_changesStarted);
@@ -570,12 +982,12 @@ class DbJson final : public DataBaseImpl
     auto operator=(DbJson&&) noexcept = delete;
     ~DbJson() override = default;
 
-    explicit DbJson(string_view storage_dir) : _storageDir {storage_dir} { DiskFileSystem::MakeDirTree(storage_dir); }
+    DbJson(string_view storage_dir, bool binary_records) : _storageDir {storage_dir}, _binaryRecords {binary_records} { DiskFileSystem::MakeDirTree(storage_dir); }
 
     [[nodiscard]] auto GetAllIds(string_view collection_name) -> vector<uint> override
     {
         vector<uint> ids;
-        DiskFileSystem::IterateDir(_str("{}/{}/", _storageDir, collection_name), "json", false, [&ids](string_view path, size_t size, uint64 write_time) {
+        const auto collect_ids = [&ids](string_view path, size_t size, uint64 write_time) {
             UNUSED_VARIABLE(size);
             UNUSED_VARIABLE(write_time);
 
@@ -586,13 +998,28 @@ class DbJson final : public DataBaseImpl
             }
 
             ids.push_back(id);
-        });
+        };
+
+        DiskFileSystem::IterateDir(_str("{}/{}/", _storageDir, collection_name), "json", false, collect_ids);
+
+        if (_binaryRecords) {
+            // Not yet migrated records may still be stored as json
+            DiskFileSystem::IterateDir(_str("{}/{}/", _storageDir, collection_name), "fobin", false, collect_ids);
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+
         return ids;
     }
 
 protected:
     [[nodiscard]] auto GetRecord(string_view collection_name, uint id) -> AnyData::Document override
     {
+        vector<uchar> data;
+        if (const auto* schema = GetBinaryRecord(collection_name, id, data); schema != nullptr) {
+            return schema->Decode(data.data(), data.size());
+        }
+
         const string path = _str("{}/{}/{}.json", _storageDir, collection_name, id);
 
         size_t length;
@@ -623,6 +1050,26 @@ class DbJson final : public DataBaseImpl
         return doc;
     }
 
+    [[nodiscard]] auto GetBinaryRecord(string_view collection_name, uint id, vector<uchar>& data) -> const BinaryRecordSchema* override
+    {
+        if (!_binaryRecords) {
+            return nullptr;
+        }
+
+        const string bin_path = _str("{}/{}/{}.fobin", _storageDir, collection_name, id);
+        auto f = DiskFileSystem::OpenFile(bin_path, false);
+        if (!f) {
+            return nullptr;
+        }
+
+        data.resize(f.GetSize());
+        if (!f.Read(data.data(), data.size())) {
+            throw DataBaseException("DbJson Can't read file", bin_path);
+        }
+
+        return &GetSchema(collection_name);
+    }
+
     void InsertRecord(string_view collection_name, uint id, const AnyData::Document& doc) override
     {
         RUNTIME_ASSERT(!doc.empty());
@@ -633,6 +1080,16 @@ class DbJson final : public DataBaseImpl
             throw DataBaseException("DbJson File exists for inserting", path);
         }
 
+        if (_binaryRecords) {
+            const string bin_path = _str("{}/{}/{}.fobin", _storageDir, collection_name, id);
+            if (const auto f_check = DiskFileSystem::OpenFile(bin_path, false)) {
+                throw DataBaseException("DbJson File exists for inserting", bin_path);
+            }
+
+            WriteBinaryRecord(collection_name, bin_path, doc);
+            return;
+        }
+
         bson_t bson;
         bson_init(&bson);
         DocumentToBson(doc, &bson);
@@ -665,6 +1122,27 @@ class DbJson final : public DataBaseImpl
 
         const string path = _str("{}/{}/{}.json", _storageDir, collection_name, id);
 
+        if (_binaryRecords) {
+            auto actual_doc = GetRecord(collection_name, id);
+            if (actual_doc.empty()) {
+                throw DataBaseException("DbJson Document not found", collection_name, id);
+            }
+
+            for (auto&& [key, value] : doc) {
+                actual_doc[key] = value;
+            }
+
+            WriteBinaryRecord(collection_name, _str("{}/{}/{}.fobin", _storageDir, collection_name, id), actual_doc);
+
+            // Migrated from json
+            if (const auto f_check = DiskFileSystem::OpenFile(path, false)) {
+                if (!DiskFileSystem::DeleteFile(path)) {
+                    throw DataBaseException("DbJson Can't delete file", path);
+                }
+            }
+            return;
+        }
+
         size_t length;
         char* json;
         if (auto f_read = DiskFileSystem::OpenFile(path, false)) {
@@ -712,6 +1190,16 @@ class DbJson final : public DataBaseImpl
 
     void DeleteRecord(string_view collection_name, uint id) override
     {
+        if (_binaryRecords) {
+            const string bin_path = _str("{}/{}/{}.fobin", _storageDir, collection_name, id);
+            if (const auto f_check = DiskFileSystem::OpenFile(bin_path, false)) {
+                if (!DiskFileSystem::DeleteFile(bin_path)) {
+                    throw DataBaseException("DbJson Can't delete file", bin_path);
+                }
+                return;
+            }
+        }
+
         const string path = _str("{}/{}/{}.json", _storageDir, collection_name, id);
         if (!DiskFileSystem::DeleteFile(path)) {
             throw DataBaseException("DbJson Can't delete file", path);
@@ -724,7 +1212,63 @@ class DbJson final : public DataBaseImpl
     }
 
 private:
+    [[nodiscard]] auto GetSchema(string_view collection_name) -> BinaryRecordSchema&
+    {
+        std::lock_guard locker(_schemasLocker);
+
+        const auto it = _schemas.find(string(collection_name));
+        if (it != _schemas.end()) {
+            return it->second;
+        }
+
+        auto& schema = _schemas[string(collection_name)];
+
+        const string schema_path = _str("{}/{}/Schema.fobs", _storageDir, collection_name);
+        if (auto f = DiskFileSystem::OpenFile(schema_path, false)) {
+            vector<uchar> data(f.GetSize());
+            if (!f.Read(data.data(), data.size())) {
+                throw DataBaseException("DbJson Can't read file", schema_path);
+            }
+
+            schema.Restore(data.data(), data.size());
+        }
+
+        return schema;
+    }
+
+    void WriteBinaryRecord(string_view collection_name, const string& path, const AnyData::Document& doc)
+    {
+        auto& schema = GetSchema(collection_name);
+        const auto data = schema.Encode(doc);
+
+        // Schema must be on disk before any record that refers to new keys
+        if (schema.IsChanged()) {
+            const string schema_path = _str("{}/{}/Schema.fobs", _storageDir, collection_name);
+            const auto schema_data = schema.Store();
+            if (auto f = DiskFileSystem::OpenFile(schema_path, true)) {
+                if (!f.Write(schema_data.data(), schema_data.size())) {
+                    throw DataBaseException("DbJson Can't write file", schema_path);
+                }
+            }
+            else {
+                throw DataBaseException("DbJson Can't open file", schema_path);
+            }
+        }
+
+        if (auto f = DiskFileSystem::OpenFile(path, true)) {
+            if (!f.Write(data.data(), data.size())) {
+                throw DataBaseException("DbJson Can't write file", path);
+            }
+        }
+        else {
+            throw DataBaseException("DbJson Can't open file", path);
+        }
+    }
+
     string _storageDir {};
+    bool _binaryRecords {};
+    map<string, BinaryRecordSchema> _schemas {};
+    std::mutex _schemasLocker {};
 };
 #endif
 
@@ -738,7 +1282,7 @@ class DbUnQLite final : public DataBaseImpl
     auto operator=(const DbUnQLite&) = delete;
     auto operator=(DbUnQLite&&) noexcept = delete;
 
-    explicit DbUnQLite(string_view storage_dir)
+    DbUnQLite(string_view storage_dir, bool binary_records) : _binaryRecords {binary_records}
     {
         DiskFileSystem::MakeDirTree(storage_dir);
 
@@ -800,12 +1344,14 @@ class DbUnQLite final : public DataBaseImpl
             if (kv_cursor_key_callback != UNQLITE_OK) {
                 throw DataBaseException("DbUnQLite unqlite_kv_cursor_init", kv_cursor_key_callback);
             }
-            if (id == 0) {
+
+            if (id != SCHEMA_KEY) {
+                ids.push_back(id);
+            }
+            else if (!_binaryRecords) {
                 throw DataBaseException("DbUnQLite Id is zero");
             }
 
-            ids.push_back(id);
-
             const auto kv_cursor_next_entry = unqlite_kv_cursor_next_entry(cursor);
             if (kv_cursor_next_entry != UNQLITE_OK && kv_cursor_next_entry != UNQLITE_DONE) {
                 throw DataBaseException("DbUnQLite kv_cursor_next_entry", kv_cursor_next_entry);
@@ -818,11 +1364,38 @@ class DbUnQLite final : public DataBaseImpl
 protected:
     [[nodiscard]] auto GetRecord(string_view collection_name, uint id) -> AnyData::Document override
     {
+        // Unqlite handles are not shared between threads
+        std::unique_lock locker(_readLocker);
+
         auto* db = GetCollection(collection_name);
         if (db == nullptr) {
             throw DataBaseException("DbUnQLite Can't open collection", collection_name);
         }
 
+        if (_binaryRecords) {
+            vector<uchar> data;
+            if (!FetchRaw(db, id, data)) {
+                return AnyData::Document();
+            }
+
+            const auto& schema = GetSchema(collection_name, db);
+            locker.unlock();
+
+            if (BinaryRecordSchema::IsBinaryRecord(data.data(), data.size())) {
+                return schema.Decode(data.data(), data.size());
+            }
+
+            // Not yet migrated bson record
+            bson_t bson;
+            if (!bson_init_static(&bson, data.data(), data.size())) {
+                throw DataBaseException("DbUnQLite bson_init_static");
+            }
+
+            AnyData::Document doc;
+            BsonToDocument(&bson, doc);
+            return doc;
+        }
+
         AnyData::Document doc;
         const auto kv_fetch_callback = unqlite_kv_fetch_callback(
             db, &id, sizeof(id),
@@ -846,6 +1419,27 @@ class DbUnQLite final : public DataBaseImpl
         return doc;
     }
 
+    [[nodiscard]] auto GetBinaryRecord(string_view collection_name, uint id, vector<uchar>& data) -> const BinaryRecordSchema* override
+    {
+        if (!_binaryRecords) {
+            return nullptr;
+        }
+
+        std::lock_guard locker(_readLocker);
+
+        auto* db = GetCollection(collection_name);
+        if (db == nullptr) {
+            throw DataBaseException("DbUnQLite Can't open collection", collection_name);
+        }
+
+        // Not yet migrated bson records go through documents
+        if (!FetchRaw(db, id, data) || !BinaryRecordSchema::IsBinaryRecord(data.data(), data.size())) {
+            return nullptr;
+        }
+
+        return &GetSchema(collection_name, db);
+    }
+
     void InsertRecord(string_view collection_name, uint id, const AnyData::Document& doc) override
     {
         RUNTIME_ASSERT(!doc.empty());
@@ -861,6 +1455,11 @@ class DbUnQLite final : public DataBaseImpl
             throw DataBaseException("DbUnQLite unqlite_kv_fetch_callback", kv_fetch_callback);
         }
 
+        if (_binaryRecords) {
+            StoreBinaryRecord(collection_name, db, id, doc);
+            return;
+        }
+
         bson_t bson;
         bson_init(&bson);
         DocumentToBson(doc, &bson);
@@ -897,6 +1496,11 @@ class DbUnQLite final : public DataBaseImpl
             actual_doc[key] = value;
         }
 
+        if (_binaryRecords) {
+            StoreBinaryRecord(collection_name, db, id, actual_doc);
+            return;
+        }
+
         bson_t bson;
         bson_init(&bson);
         DocumentToBson(actual_doc, &bson);
@@ -960,8 +1564,73 @@ class DbUnQLite final : public DataBaseImpl
         return db;
     }
 
+    [[nodiscard]] static auto FetchRaw(unqlite* db, uint id, vector<uchar>& data) -> bool
+    {
+        const auto kv_fetch_callback = unqlite_kv_fetch_callback(
+            db, &id, sizeof(id),
+            [](const void* output, unsigned int output_len, void* user_data) {
+                auto& data2 = *static_cast<vector<uchar>*>(user_data);
+                const auto* output_data = static_cast<const uchar*>(output);
+                data2.insert(data2.end(), output_data, output_data + output_len);
+                return UNQLITE_OK;
+            },
+            &data);
+
+        if (kv_fetch_callback == UNQLITE_NOTFOUND) {
+            return false;
+        }
+        if (kv_fetch_callback != UNQLITE_OK) {
+            throw DataBaseException("DbUnQLite unqlite_kv_fetch_callback", kv_fetch_callback);
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] auto GetSchema(string_view collection_name, unqlite* db) -> BinaryRecordSchema&
+    {
+        const auto it = _schemas.find(string(collection_name));
+        if (it != _schemas.end()) {
+            return it->second;
+        }
+
+        auto& schema = _schemas[string(collection_name)];
+
+        vector<uchar> data;
+        if (FetchRaw(db, SCHEMA_KEY, data)) {
+            schema.Restore(data.data(), data.size());
+        }
+
+        return schema;
+    }
+
+    void StoreBinaryRecord(string_view collection_name, unqlite* db, uint id, const AnyData::Document& doc)
+    {
+        auto& schema = GetSchema(collection_name, db);
+        const auto data = schema.Encode(doc);
+
+        // Stored in same transaction as record that refers to new keys
+        if (schema.IsChanged()) {
+            const auto schema_data = schema.Store();
+            const auto kv_store = unqlite_kv_store(db, &SCHEMA_KEY, sizeof(SCHEMA_KEY), schema_data.data(), static_cast<unqlite_int64>(schema_data.size()));
+            if (kv_store != UNQLITE_OK) {
+                throw DataBaseException("DbUnQLite unqlite_kv_store", kv_store);
+            }
+        }
+
+        const auto kv_store = unqlite_kv_store(db, &id, sizeof(id), data.data(), static_cast<unqlite_int64>(data.size()));
+        if (kv_store != UNQLITE_OK) {
+            throw DataBaseException("DbUnQLite unqlite_kv_store", kv_store);
+        }
+    }
+
+    // Record ids start from one, so zero key is free for schema
+    static constexpr uint SCHEMA_KEY = 0;
+
     string _storageDir {};
+    bool _binaryRecords {};
     mutable map<string, unqlite*> _collections {};
+    map<string, BinaryRecordSchema> _schemas {};
+    std::mutex _readLocker {};
 };
 #endif
 
@@ -1075,6 +1744,9 @@ class DbMongo final : public DataBaseImpl
 protected:
     [[nodiscard]] auto GetRecord(string_view collection_name, uint id) -> AnyData::Document override
     {
+        // Single client is not thread safe
+        std::lock_guard locker(_readLocker);
+
         auto* collection = GetCollection(collection_name);
         if (collection == nullptr) {
             throw DataBaseException("DbMongo Can't get collection", collection_name);
@@ -1224,6 +1896,7 @@ class DbMongo final : public DataBaseImpl
     mongoc_database_t* _database {};
     string _databaseName {};
     mutable map<string, mongoc_collection_t*> _collections {};
+    std::mutex _readLocker {};
 };
 #endif
 
@@ -1254,10 +1927,13 @@ class DbMemory final : public DataBaseImpl
 protected:
     [[nodiscard]] auto GetRecord(string_view collection_name, uint id) -> AnyData::Document override
     {
-        const auto& collection = _collections[string(collection_name)];
+        const auto collection_it = _collections.find(string(collection_name));
+        if (collection_it == _collections.end()) {
+            return AnyData::Document();
+        }
 
-        const auto it = collection.find(id);
-        return it != collection.end() ? it->second : AnyData::Document();
+        const auto it = collection_it->second.find(id);
+        return it != collection_it->second.end() ? it->second : AnyData::Document();
     }
 
     void InsertRecord(string_view collection_name, uint id, const AnyData::Document& doc) override
@@ -1307,13 +1983,13 @@ auto ConnectToDataBase(string_view connection_info) -> DataBase
 {
     if (const auto options = _str(connection_info).split(' '); !options.empty()) {
 #if FO_HAVE_JSON
-        if (options[0] == "JSON" && options.size() == 2) {
-            return DataBase(new DbJson(options[1]));
+        if (options[0] == "JSON" && (options.size() == 2 || (options.size() == 3 && options[2] == "Binary"))) {
+            return DataBase(new DbJson(options[1], options.size() == 3));
         }
 #endif
 #if FO_HAVE_UNQLITE
-        if (options[0] == "DbUnQLite" && options.size() == 2) {
-            return DataBase(new DbUnQLite(options[1]));
+        if (options[0] == "DbUnQLite" && (options.size() == 2 || (options.size() == 3 && options[2] == "Binary"))) {
+            return DataBase(new DbUnQLite(options[1], options.size() == 3));
         }
 #endif
 #if FO_HAVE_MONGO && !FO_SINGLEPLAYER
@@ -41,6 +41,47 @@ DECLARE_EXCEPTION(DataBaseException);
 
 class DataBaseImpl;
 
+// Single value of binary record read in place, first byte is value type
+struct BinaryRecordValue
+{
+    const uchar* Data {};
+    size_t Size {};
+};
+
+// Compact binary record encoding, document keys are stored as indices in per collection schema
+// Schema is append only so records written by older schemas stay readable after keys are added or removed
+// Values are stored in host byte order, so records are not portable between hosts with different endianness
+class BinaryRecordSchema final
+{
+public:
+    static constexpr uint SCHEMA_VERSION = 1;
+    static constexpr size_t MAX_KEYS = 0xFFFF;
+
+    BinaryRecordSchema() = default;
+    BinaryRecordSchema(const BinaryRecordSchema&) = delete;
+    BinaryRecordSchema(BinaryRecordSchema&&) noexcept = default;
+    auto operator=(const BinaryRecordSchema&) = delete;
+    auto operator=(BinaryRecordSchema&&) noexcept -> BinaryRecordSchema& = default;
+    ~BinaryRecordSchema() = default;
+
+    [[nodiscard]] static auto IsBinaryRecord(const uchar* data, size_t size) -> bool;
+    [[nodiscard]] static auto DecodeValue(const BinaryRecordValue& value) -> AnyData::Value;
+    [[nodiscard]] auto GetKeysCount() const -> size_t;
+    [[nodiscard]] auto GetKey(size_t index) const -> const string&;
+    [[nodiscard]] auto IsChanged() const -> bool;
+    [[nodiscard]] auto Decode(const uchar* data, size_t size) const -> AnyData::Document;
+    // Cuts record to values without building document
+    void Split(const uchar* data, size_t size, vector<pair<ushort, BinaryRecordValue>>& values) const;
+    [[nodiscard]] auto Encode(const AnyData::Document& doc) -> vector<uchar>;
+    [[nodiscard]] auto Store() -> vector<uchar>;
+    void Restore(const uchar* data, size_t size);
+
+private:
+    vector<string> _keys {};
+    unordered_map<string, ushort> _keyIndices {};
+    bool _changed {};
+};
+
 class DataBase
 {
     friend auto ConnectToDataBase(string_view connection_info) -> DataBase;
@@ -59,7 +100,10 @@ class DataBase
     ~DataBase();
 
     [[nodiscard]] auto GetAllIds(string_view collection_name) const -> vector<uint>;
+    // Get may be called from multiple threads while no changes are made
     [[nodiscard]] auto Get(string_view collection_name, uint id) const -> AnyData::Document;
+    // Stored record for bulk loads, null if it is kept in other format or has uncommitted changes
+    [[nodiscard]] auto GetBinaryRecord(string_view collection_name, uint id, vector<uchar>& data) const -> const BinaryRecordSchema*;
     [[nodiscard]] auto Valid(string_view collection_name, uint id) const -> bool;
 
     void StartChanges();
@@ -38,200 +38,245 @@
 #include "Settings.h"
 #include "StringUtils.h"
 
+static constexpr string_view DEFERRED_CALLS_COLLECTION = "DeferredCalls";
+
 DeferredCallManager::DeferredCallManager(FOServer* engine) : _engine {engine}
 {
-    UNUSED_VARIABLE(_engine);
 }
 
 auto DeferredCallManager::AddDeferredCall(uint delay, bool saved, string_view func_name, int* value, const vector<int>* values, uint* value2, const vector<uint>* values2) -> uint
 {
-    /*uint func_num = Script::GetFuncNum(func);
-    uint bind_id = Script::BindByFunc(func, false);
-    RUNTIME_ASSERT(bind_id);
+    RUNTIME_ASSERT(!(value != nullptr && value2 != nullptr));
+    RUNTIME_ASSERT(!(values != nullptr && values2 != nullptr));
 
-    uint time_mul = Globals->GetTimeMultiplier();
-    if (time_mul == 0)
-        time_mul = 1;
+    const auto time_mul = std::max(static_cast<uint>(_engine->GetTimeMultiplier()), 1u);
+    const auto full_second = _engine->GameTime.GetFullSecond();
 
     DeferredCall call;
-    call.Id = 0;
-    call.FireFullSecond = (delay ? GameOpt.FullSecond + delay * time_mul / 1000 : 0);
-    call.FuncNum = func_num;
-    call.BindId = bind_id;
+    call.FireFullSecond = delay != 0u ? full_second + static_cast<uint>(static_cast<uint64>(delay) * time_mul / 1000u) : 0u;
+    call.FuncName = _engine->ToHashedString(func_name);
     call.Saved = saved;
 
-    if (value) {
+    if (value != nullptr || value2 != nullptr) {
         call.IsValue = true;
-        call.Value = *value;
-        int value_type_id = 0;
-        func->GetParam(0, &value_type_id);
-        RUNTIME_ASSERT((value_type_id == asTYPEID_INT32 || value_type_id == asTYPEID_UINT32));
-        call.ValueSigned = (value_type_id == asTYPEID_INT32);
-    }
-    else {
-        call.IsValue = false;
-        call.Value = 0;
-        call.ValueSigned = false;
+        call.ValueSigned = value != nullptr;
+        call.Value = value != nullptr ? *value : static_cast<int>(*value2);
     }
 
-    if (values) {
+    if (values != nullptr) {
         call.IsValues = true;
-        Script::AssignScriptArrayInVector(call.Values, values);
-        RUNTIME_ASSERT((values->GetElementTypeId() == asTYPEID_INT32 || values->GetElementTypeId() == asTYPEID_UINT32));
-        call.ValuesSigned = (values->GetElementTypeId() == asTYPEID_INT32);
+        call.ValuesSigned = true;
+        call.Values = *values;
     }
-    else {
-        call.IsValues = false;
+    else if (values2 != nullptr) {
+        call.IsValues = true;
         call.ValuesSigned = false;
+        call.Values.reserve(values2->size());
+        for (const auto v : *values2) {
+            call.Values.push_back(static_cast<int>(v));
+        }
     }
 
-    if (delay == 0) {
+    if (delay == 0u) {
         RunDeferredCall(call);
+        return 0;
     }
-    else {
-        RUNTIME_ASSERT(call.FireFullSecond != 0);
-        call.Id = Globals->GetLastDeferredCallId() + 1;
-        Globals->SetLastDeferredCallId(call.Id);
-        _deferredCalls.push_back(call);
 
-        if (call.Saved) {
-            DataBase::Document call_doc;
-            call_doc["Script"] = _str().parseHash(call.FuncNum);
-            call_doc["FireFullSecond"] = (int64)call.FireFullSecond;
+    call.Id = _engine->GetLastDeferredCallId() + 1;
+    _engine->SetLastDeferredCallId(call.Id);
 
-            if (call.IsValue) {
-                call_doc["ValueSigned"] = call.ValueSigned;
-                call_doc["Value"] = call.Value;
-            }
+    if (call.Saved) {
+        AnyData::Document call_doc;
+        call_doc["Script"] = string(call.FuncName.as_str());
+        call_doc["FireFullSecond"] = static_cast<int64>(call.FireFullSecond);
 
-            if (call.IsValues) {
-                call_doc["ValuesSigned"] = call.ValuesSigned;
-                DataBase::Array values;
-                for (int v : call.Values)
-                    values.push_back(v);
-                call_doc["Values"] = values;
-            }
+        if (call.IsValue) {
+            call_doc["ValueSigned"] = call.ValueSigned;
+            call_doc["Value"] = call.Value;
+        }
 
-            DbStorage->Insert("DeferredCalls", call.Id, call_doc);
+        if (call.IsValues) {
+            call_doc["ValuesSigned"] = call.ValuesSigned;
+            AnyData::Array arr;
+            arr.reserve(call.Values.size());
+            for (const auto v : call.Values) {
+                arr.emplace_back(v);
+            }
+            call_doc["Values"] = std::move(arr);
         }
+
+        _engine->DbStorage.Insert(DEFERRED_CALLS_COLLECTION, call.Id, call_doc);
     }
-    return call.Id;*/
-    return 0;
+
+    // Keep wheel time in sync before insertion, otherwise stale wheel would step through whole gap
+    _wheel.Advance(full_second);
+
+    const auto id = call.Id;
+    const auto handle = _wheel.Add(call.FireFullSecond, id);
+    _deferredCalls.emplace(id, PendingCall {std::move(call), handle});
+    return id;
 }
 
 auto DeferredCallManager::IsDeferredCallPending(uint id) -> bool
 {
-    for (auto it = _deferredCalls.begin(); it != _deferredCalls.end(); ++it) {
-        if (it->Id == id) {
-            return true;
-        }
-    }
-    return false;
+    return _deferredCalls.count(id) != 0u;
 }
 
 auto DeferredCallManager::CancelDeferredCall(uint id) -> bool
 {
-    /*for (auto it = _deferredCalls.begin(); it != _deferredCalls.end(); ++it) {
-        if (it->Id == id) {
-            if (it->Saved) {
-                DbStorage->Delete("DeferredCalls", id);
-            }
+    const auto it = _deferredCalls.find(id);
+    if (it == _deferredCalls.end()) {
+        return false;
+    }
 
-            _deferredCalls.erase(it);
-            return true;
-        }
+    const auto cancelled = _wheel.Cancel(it->second.Handle);
+    RUNTIME_ASSERT(cancelled);
+
+    if (it->second.Call.Saved) {
+        _engine->DbStorage.Delete(DEFERRED_CALLS_COLLECTION, id);
     }
-    return false;*/
-    return false;
+
+    _deferredCalls.erase(it);
+    return true;
 }
 
 auto DeferredCallManager::GetDeferredCallData(uint id, DeferredCall& data) -> bool
 {
-    /*for (auto it = _deferredCalls.begin(); it != _deferredCalls.end(); ++it) {
-        DeferredCall& call = *it;
-        if (call.Id == id) {
-            data = call;
-            return true;
-        }
-    }*/
-    return false;
+    const auto it = _deferredCalls.find(id);
+    if (it == _deferredCalls.end()) {
+        return false;
+    }
+
+    data = it->second.Call;
+    return true;
 }
 
 auto DeferredCallManager::GetDeferredCallsList() -> vector<int>
 {
-    /*ids.reserve(_deferredCalls.size());
-    for (auto it = _deferredCalls.begin(); it != _deferredCalls.end(); ++it)
-        ids.push_back(it->Id);*/
-    return {};
+    vector<int> ids;
+    ids.reserve(_deferredCalls.size());
+    for (auto&& [id, pending] : _deferredCalls) {
+        ids.push_back(static_cast<int>(id));
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+auto DeferredCallManager::GetDeferredCallsCount() const -> size_t
+{
+    return _deferredCalls.size();
+}
+
+auto DeferredCallManager::GetDeferredCallDelay(const DeferredCall& call) const -> uint
+{
+    const auto time_mul = std::max(static_cast<uint>(_engine->GetTimeMultiplier()), 1u);
+    const auto full_second = _engine->GameTime.GetFullSecond();
+    return call.FireFullSecond > full_second ? static_cast<uint>(static_cast<uint64>(call.FireFullSecond - full_second) * 1000u / time_mul) : 0u;
+}
+
+auto DeferredCallManager::GetNextCallDelay(uint& delay) const -> bool
+{
+    uint fire_full_second = 0;
+    if (!_wheel.GetNextFireTime(fire_full_second)) {
+        return false;
+    }
+
+    const auto time_mul = std::max(static_cast<uint>(_engine->GetTimeMultiplier()), 1u);
+    const auto full_second = _engine->GameTime.GetFullSecond();
+    delay = static_cast<int>(fire_full_second - full_second) > 0 ? static_cast<uint>(static_cast<uint64>(fire_full_second - full_second) * 1000u / time_mul) : 0u;
+    return true;
 }
 
 void DeferredCallManager::Process()
 {
-    /*bool done = false;
-    while (!done) {
-        done = true;
-
-        for (auto it = _deferredCalls.begin(); it != _deferredCalls.end(); ++it) {
-            RUNTIME_ASSERT(it->FireFullSecond != 0);
-            if (GameOpt.FullSecond >= it->FireFullSecond) {
-                DeferredCall call = *it;
-                it = _deferredCalls.erase(it);
-
-                if (call.Saved)
-                    DbStorage->Delete("DeferredCalls", call.Id);
-
-                RunDeferredCall(call);
-                done = false;
-                break;
-            }
+    _wheel.Advance(_engine->GameTime.GetFullSecond());
+
+    // Calls over budget stay in ready queue for next cycles
+    const auto budget = _engine->Settings.DeferredCallsPerTick;
+
+    uint fired = 0;
+    uint id = 0;
+    while ((budget == 0u || fired < budget) && _wheel.PopReady(id)) {
+        const auto it = _deferredCalls.find(id);
+        RUNTIME_ASSERT(it != _deferredCalls.end());
+
+        auto call = std::move(it->second.Call);
+        _deferredCalls.erase(it);
+
+        if (call.Saved) {
+            _engine->DbStorage.Delete(DEFERRED_CALLS_COLLECTION, call.Id);
         }
-    }*/
+
+        fired++;
+
+        try {
+            RunDeferredCall(call);
+        }
+        catch (const std::exception& ex) {
+            ReportExceptionAndContinue(ex);
+        }
+    }
 }
 
 void DeferredCallManager::RunDeferredCall(DeferredCall& call)
 {
-    /*Script::PrepareContext(call.BindId, "Invoker");
-
-    CScriptArray* arr = nullptr;
+    auto* script_sys = _engine->ScriptSys;
+    RUNTIME_ASSERT(script_sys);
 
+    bool success;
     if (call.IsValue) {
-        Script::SetArgUInt(call.Value);
+        if (call.ValueSigned) {
+            success = script_sys->CallFunc<void, int>(call.FuncName, call.Value);
+        }
+        else {
+            success = script_sys->CallFunc<void, uint>(call.FuncName, static_cast<uint>(call.Value));
+        }
     }
     else if (call.IsValues) {
-        arr = Script::CreateArray(call.ValuesSigned ? "int[]" : "uint[]");
-        Script::AppendVectorToArray(call.Values, arr);
-        Script::SetArgObject(arr);
+        if (call.ValuesSigned) {
+            success = script_sys->CallFunc<void, vector<int>>(call.FuncName, call.Values);
+        }
+        else {
+            vector<uint> values;
+            values.reserve(call.Values.size());
+            for (const auto v : call.Values) {
+                values.push_back(static_cast<uint>(v));
+            }
+            success = script_sys->CallFunc<void, vector<uint>>(call.FuncName, values);
+        }
+    }
+    else {
+        success = script_sys->CallFunc<void>(call.FuncName);
     }
 
-    if (call.FireFullSecond == 0)
-        Script::RunPreparedSuspend();
-    else
-        Script::RunPrepared();
-
-    if (arr)
-        arr->Release();*/
+    if (!success) {
+        WriteLog("Deferred call {} to function '{}' failed", call.Id, call.FuncName);
+    }
 }
 
 auto DeferredCallManager::GetStatistics() -> string
 {
-    /*uint time_mul = Globals->GetTimeMultiplier();
-    string result = _str("Deferred calls count: {}\n", (uint)_deferredCalls.size());
-    result += "Id         Delay      Saved    Function                                                              Values\n";
-    for (auto it = _deferredCalls.begin(); it != _deferredCalls.end(); ++it) {
-        DeferredCall& call = *it;
-        string func_name = Script::GetBindFuncName(call.BindId);
-        uint delay = call.FireFullSecond > GameOpt.FullSecond ? (call.FireFullSecond - GameOpt.FullSecond) * time_mul / 1000 : 0;
+    vector<const DeferredCall*> calls;
+    calls.reserve(_deferredCalls.size());
+    for (auto&& [id, pending] : _deferredCalls) {
+        calls.push_back(&pending.Call);
+    }
+    std::sort(calls.begin(), calls.end(), [](const DeferredCall* a, const DeferredCall* b) { return a->Id < b->Id; });
 
-        result += _str("{:<10} {:<10} {:<8} {:<70}", call.Id, delay, call.Saved ? "true" : "false", func_name.c_str());
+    string result = _str("Deferred calls count: {} (ready {})\n", _deferredCalls.size(), _wheel.GetReadyCount());
+    result += "Id         Delay      Saved    Function                                                              Values\n";
+    for (const auto* call : calls) {
+        result += _str("{:<10} {:<10} {:<8} {:<70}", call->Id, GetDeferredCallDelay(*call), call->Saved ? "true" : "false", call->FuncName);
 
-        if (call.IsValue) {
+        if (call->IsValue) {
             result += "Single:";
-            result += _str(" {}", call.Value);
+            result += _str(" {}", call->Value);
         }
-        else if (call.IsValues) {
+        else if (call->IsValues) {
             result += "Multiple:";
-            for (size_t i = 0; i < call.Values.size(); i++)
-                result += _str(" {}", call.Values[i]);
+            for (const auto v : call->Values) {
+                result += _str(" {}", v);
+            }
         }
         else {
             result += "None";
@@ -239,83 +284,69 @@ auto DeferredCallManager::GetStatistics() -> string
 
         result += "\n";
     }
-    return result;*/
-    return "";
+    return result;
 }
 
 auto DeferredCallManager::LoadDeferredCalls() -> bool
 {
-    /*WriteLog("Load deferred calls...");
+    WriteLog("Load deferred calls");
 
-    Uvector<int> call_ids = DbStorage->GetAllIds("DeferredCalls");
-    int errors = 0;
-    for (uint call_id : call_ids) {
-        DataBase::Document call_doc = DbStorage->Get("DeferredCalls", call_id);
+    _wheel.Clear();
+    _wheel.Advance(_engine->GameTime.GetFullSecond());
+    _deferredCalls.clear();
 
-        DeferredCall call;
-        call.Id = call_doc["Id"].get<int>();
-        call.FireFullSecond = (uint)call_doc["FireFullSecond"].get<int64>();
-        RUNTIME_ASSERT(call.FireFullSecond != 0);
-
-        call.IsValue = (call_doc.count("Value") > 0);
-        if (call.IsValue) {
-            call.ValueSigned = call_doc["ValueSigned"].get<bool>();
-            call.Value = call_doc["Value"].get<int>();
+    const auto get_int = [](const AnyData::Value& value) -> int64 {
+        if (const auto* v = std::get_if<int>(&value)) {
+            return *v;
         }
-        else {
-            call.ValueSigned = false;
-            call.Value = 0;
+        if (const auto* v = std::get_if<int64>(&value)) {
+            return *v;
         }
+        throw DataBaseException("Invalid deferred call integer value");
+    };
+
+    auto errors = 0;
+
+    for (const auto call_id : _engine->DbStorage.GetAllIds(DEFERRED_CALLS_COLLECTION)) {
+        try {
+            const auto call_doc = _engine->DbStorage.Get(DEFERRED_CALLS_COLLECTION, call_id);
+
+            DeferredCall call;
+            call.Id = call_id;
+            call.Saved = true;
+            call.FuncName = _engine->ToHashedString(std::get<string>(call_doc.at("Script")));
+            call.FireFullSecond = static_cast<uint>(get_int(call_doc.at("FireFullSecond")));
+            RUNTIME_ASSERT(call.FireFullSecond != 0u);
+
+            if (call_doc.count("Value") != 0u) {
+                call.IsValue = true;
+                call.ValueSigned = std::get<bool>(call_doc.at("ValueSigned"));
+                call.Value = static_cast<int>(get_int(call_doc.at("Value")));
+            }
 
-        call.IsValues = (call_doc.count("Values") > 0);
-        if (call.IsValues) {
-            call.ValuesSigned = call_doc["ValuesSigned"].get<bool>();
-            const DataBase::Array& arr = call_doc["Values"].get<DataBase::Array>();
-            for (auto& v : arr)
-                call.Values.push_back(v.get<int>());
-        }
-        else {
-            call.ValuesSigned = false;
-            call.Values.clear();
-        }
+            if (call_doc.count("Values") != 0u) {
+                call.IsValues = true;
+                call.ValuesSigned = std::get<bool>(call_doc.at("ValuesSigned"));
+                for (auto&& v : std::get<AnyData::Array>(call_doc.at("Values"))) {
+                    call.Values.push_back(std::get<int>(v));
+                }
+            }
 
-        if (call.IsValue && call.IsValues) {
-            WriteLog("Deferred call {} have value and values", call.Id);
-            errors++;
-            continue;
-        }
+            if (call.IsValue && call.IsValues) {
+                WriteLog("Deferred call {} have value and values", call.Id);
+                errors++;
+                continue;
+            }
 
-        const char* decl;
-        if (call.IsValue && call.ValueSigned)
-            decl = "void %s(int)";
-        else if (call.IsValue && !call.ValueSigned)
-            decl = "void %s(uint)";
-        else if (call.IsValues && call.ValuesSigned)
-            decl = "void %s(int[]&)";
-        else if (call.IsValues && !call.ValuesSigned)
-            decl = "void %s(uint[]&)";
-        else
-            decl = "void %s()";
-
-        call.FuncNum = Script::BindScriptFuncNumByFuncName(call_doc["Script"].get<string>(), decl);
-        if (!call.FuncNum) {
-            WriteLog("Unable to find function '{}' with declaration '{}' for deferred call {}", call_doc["Script"].get<string>(), decl, call.Id);
-            errors++;
-            continue;
+            const auto handle = _wheel.Add(call.FireFullSecond, call_id);
+            _deferredCalls.emplace(call_id, PendingCall {std::move(call), handle});
         }
-
-        call.BindId = Script::BindByFuncNum(call.FuncNum, false);
-        if (!call.BindId) {
-            WriteLog("Unable to bind script function '{}' for deferred call {}", _str().parseHash(call.FuncNum), call.Id);
+        catch (const std::exception& ex) {
+            WriteLog("Unable to load deferred call {}: {}", call_id, ex.what());
             errors++;
-            continue;
         }
-
-        call.Saved = true;
-        _deferredCalls.push_back(call);
     }
 
-    WriteLog("Load deferred calls complete, count {}", (uint)_deferredCalls.size());
-    return errors == 0;*/
-    return false;
+    WriteLog("Load deferred calls complete, count {}", _deferredCalls.size());
+    return errors == 0;
 }
@@ -31,12 +31,12 @@
 // SOFTWARE.
 //
 
-// Todo: improve deferred calls
-
 #pragma once
 
 #include "Common.h"
 
+#include "TimingWheel.h"
+
 class FOServer;
 
 struct DeferredCall
@@ -68,6 +68,9 @@ class DeferredCallManager final
     [[nodiscard]] auto CancelDeferredCall(uint id) -> bool;
     [[nodiscard]] auto GetDeferredCallData(uint id, DeferredCall& data) -> bool;
     [[nodiscard]] auto GetDeferredCallsList() -> vector<int>;
+    [[nodiscard]] auto GetDeferredCallsCount() const -> size_t;
+    [[nodiscard]] auto GetDeferredCallDelay(const DeferredCall& call) const -> uint;
+    [[nodiscard]] auto GetNextCallDelay(uint& delay) const -> bool;
     [[nodiscard]] auto GetStatistics() -> string;
 
     auto AddDeferredCall(uint delay, bool saved, string_view func_name, int* value, const vector<int>* values, uint* value2, const vector<uint>* values2) -> uint;
@@ -75,8 +78,15 @@ class DeferredCallManager final
     void Process();
 
 private:
+    struct PendingCall
+    {
+        DeferredCall Call {};
+        TimingWheel::Handle Handle {};
+    };
+
     void RunDeferredCall(DeferredCall& call);
 
     FOServer* _engine;
-    list<DeferredCall> _deferredCalls {};
+    TimingWheel _wheel {};
+    unordered_map<uint, PendingCall> _deferredCalls {};
 };
@@ -37,6 +37,7 @@
 #include "ProtoManager.h"
 #include "Server.h"
 #include "StringUtils.h"
+#include "ThreadPool.h"
 
 EntityManager::EntityManager(FOServer* engine) : _engine {engine}
 {
@@ -59,6 +60,17 @@ void EntityManager::RegisterEntity(ServerEntity* entity)
 
     const auto [it, inserted] = _allEntities.emplace(entity->GetId(), entity);
     RUNTIME_ASSERT(inserted);
+
+    if (auto* player = dynamic_cast<Player*>(entity); player != nullptr) {
+        _playersByName.emplace(_str(player->GetName()).lowerUtf8().str(), player);
+    }
+    else if (auto* cr = dynamic_cast<Critter*>(entity); cr != nullptr) {
+        _allCritters.emplace(cr->GetId(), cr);
+        _awakeCritters.emplace(cr->GetId(), cr);
+    }
+    else if (auto* map = dynamic_cast<Map*>(entity); map != nullptr) {
+        _allMaps.emplace(map->GetId(), map);
+    }
 }
 
 void EntityManager::UnregisterEntity(ServerEntity* entity)
@@ -67,6 +79,25 @@ void EntityManager::UnregisterEntity(ServerEntity* entity)
     RUNTIME_ASSERT(it != _allEntities.end());
     _allEntities.erase(it);
 
+    if (auto* player = dynamic_cast<Player*>(entity); player != nullptr) {
+        const auto [begin, end] = _playersByName.equal_range(_str(player->GetName()).lowerUtf8().str());
+        const auto name_it = std::find_if(begin, end, [player](auto&& kv) { return kv.second == player; });
+        RUNTIME_ASSERT(name_it != end);
+        _playersByName.erase(name_it);
+    }
+    else if (auto* cr = dynamic_cast<Critter*>(entity); cr != nullptr) {
+        _allCritters.erase(cr->GetId());
+        _awakeCritters.erase(cr->GetId());
+
+        if (cr->DormantWakeHandle) {
+            _suspendedCritters.Cancel(cr->DormantWakeHandle);
+            cr->DormantWakeHandle = {};
+        }
+    }
+    else if (dynamic_cast<Map*>(entity) != nullptr) {
+        _allMaps.erase(entity->GetId());
+    }
+
     _engine->DbStorage.Delete(_str("{}s", entity->GetClassName()), entity->GetId());
 
     entity->SetId(0);
@@ -102,6 +133,19 @@ auto EntityManager::GetPlayer(uint id) -> Player*
     return nullptr;
 }
 
+auto EntityManager::GetPlayerByName(string_view name) -> Player*
+{
+    // Index is keyed by lowered name, final check keeps exact compare semantics
+    const auto [begin, end] = _playersByName.equal_range(_str(name).lowerUtf8().str());
+    for (auto it = begin; it != end; ++it) {
+        if (_str(name).compareIgnoreCaseUtf8(it->second->GetName())) {
+            return it->second;
+        }
+    }
+
+    return nullptr;
+}
+
 auto EntityManager::GetPlayers() -> vector<Player*>
 {
     vector<Player*> players;
@@ -130,6 +174,20 @@ auto EntityManager::GetPlayers() const -> vector<const Player*>
     return players;
 }
 
+auto EntityManager::GetPlayers(FrameArena& arena) -> frame_vector<Player*>
+{
+    frame_vector<Player*> players {FrameArenaAllocator<Player*>(arena)};
+    players.reserve(_allEntities.size());
+
+    for (auto&& [id, entity] : _allEntities) {
+        if (auto* player = dynamic_cast<Player*>(entity); player != nullptr) {
+            players.push_back(player);
+        }
+    }
+
+    return players;
+}
+
 auto EntityManager::GetItem(uint id) -> Item*
 {
     if (const auto it = _allEntities.find(id); it != _allEntities.end()) {
@@ -182,17 +240,88 @@ auto EntityManager::GetCritters() -> vector<Critter*>
     NON_CONST_METHOD_HINT();
 
     vector<Critter*> critters;
-    critters.reserve(_allEntities.size());
+    critters.reserve(_allCritters.size());
 
-    for (auto&& [id, entity] : _allEntities) {
-        if (auto* cr = dynamic_cast<Critter*>(entity); cr != nullptr) {
-            critters.push_back(cr);
-        }
+    for (auto&& [id, cr] : _allCritters) {
+        critters.push_back(cr);
     }
 
     return critters;
 }
 
+auto EntityManager::GetCritters(FrameArena& arena) -> frame_vector<Critter*>
+{
+    NON_CONST_METHOD_HINT();
+
+    frame_vector<Critter*> critters {FrameArenaAllocator<Critter*>(arena)};
+    critters.reserve(_allCritters.size());
+
+    for (auto&& [id, cr] : _allCritters) {
+        critters.push_back(cr);
+    }
+
+    return critters;
+}
+
+auto EntityManager::GetAwakeCritters(FrameArena& arena) -> frame_vector<Critter*>
+{
+    NON_CONST_METHOD_HINT();
+
+    frame_vector<Critter*> critters {FrameArenaAllocator<Critter*>(arena)};
+    critters.reserve(_awakeCritters.size());
+
+    for (auto&& [id, cr] : _awakeCritters) {
+        critters.push_back(cr);
+    }
+
+    return critters;
+}
+
+auto EntityManager::GetSuspendedCrittersCount() const -> size_t
+{
+    return _suspendedCritters.GetCount();
+}
+
+void EntityManager::WakeCritter(Critter* cr)
+{
+    if (cr->DormantWakeHandle) {
+        _suspendedCritters.Cancel(cr->DormantWakeHandle);
+        cr->DormantWakeHandle = {};
+    }
+
+    if (_allCritters.count(cr->GetId()) != 0u) {
+        _awakeCritters.emplace(cr->GetId(), cr);
+    }
+}
+
+void EntityManager::SuspendCritter(Critter* cr, uint wake_tick)
+{
+    RUNTIME_ASSERT(_allCritters.count(cr->GetId()) != 0u);
+
+    if (cr->DormantWakeHandle) {
+        _suspendedCritters.Cancel(cr->DormantWakeHandle);
+    }
+
+    _awakeCritters.erase(cr->GetId());
+
+    // Keep wheel time in sync before insertion, otherwise stale wheel would step through whole gap
+    _suspendedCritters.Advance(_engine->GameTime.GameTick());
+    cr->DormantWakeHandle = _suspendedCritters.Add(wake_tick, cr->GetId());
+}
+
+void EntityManager::WakeDueCritters(uint tick)
+{
+    _suspendedCritters.Advance(tick);
+
+    uint id = 0;
+    while (_suspendedCritters.PopReady(id)) {
+        // Unregistered critters cancel their wake up, so id is always valid
+        auto* cr = _allCritters.at(id);
+        cr->DormantWakeHandle = {};
+        _awakeCritters.emplace(id, cr);
+    }
+}
+
 auto EntityManager::GetMap(uint id) -> Map*
 {
     if (const auto it = _allEntities.find(id); it != _allEntities.end()) {
@@ -221,12 +350,22 @@ auto EntityManager::GetMapByPid(hstring pid, uint skip_count) -> Map*
 auto EntityManager::GetMaps() -> vector<Map*>
 {
     vector<Map*> maps;
-    maps.reserve(_allEntities.size());
+    maps.reserve(_allMaps.size());
 
-    for (auto&& [id, entity] : _allEntities) {
-        if (auto* map = dynamic_cast<Map*>(entity); map != nullptr) {
-            maps.push_back(map);
-        }
+    for (auto&& [id, map] : _allMaps) {
+        maps.push_back(map);
+    }
+
+    return maps;
+}
+
+auto EntityManager::GetMaps(FrameArena& arena) -> frame_vector<Map*>
+{
+    frame_vector<Map*> maps {FrameArenaAllocator<Map*>(arena)};
+    maps.reserve(_allMaps.size());
+
+    for (auto&& [id, map] : _allMaps) {
+        maps.push_back(map);
     }
 
     return maps;
@@ -271,102 +410,257 @@ auto EntityManager::GetLocations() -> vector<Location*>
     return locations;
 }
 
-void EntityManager::LoadEntities(const LocationFabric& loc_fabric, const MapFabric& map_fabric, const NpcFabric& npc_fabric, const ItemFabric& item_fabric)
+// Serializes hash interning for decode on worker threads, enums lookup is read only
+class LockedNameResolver final : public NameResolver
 {
-    WriteLog("Load entities...");
+public:
+    explicit LockedNameResolver(NameResolver& resolver) : _resolver {resolver} { }
+    LockedNameResolver(const LockedNameResolver&) = delete;
+    LockedNameResolver(LockedNameResolver&&) noexcept = delete;
+    auto operator=(const LockedNameResolver&) = delete;
+    auto operator=(LockedNameResolver&&) noexcept = delete;
+    ~LockedNameResolver() override = default;
+
+    [[nodiscard]] auto ResolveEnumValue(string_view enum_value_name, bool* failed) const -> int override { return _resolver.ResolveEnumValue(enum_value_name, failed); }
+    [[nodiscard]] auto ResolveEnumValue(string_view enum_name, string_view value_name, bool* failed) const -> int override { return _resolver.ResolveEnumValue(enum_name, value_name, failed); }
+    [[nodiscard]] auto ResolveEnumValueName(string_view enum_name, int value, bool* failed) const -> string override { return _resolver.ResolveEnumValueName(enum_name, value, failed); }
+
+    [[nodiscard]] auto ResolveGenericValue(string_view str, bool* failed) -> int override
+    {
+        std::lock_guard locker(_locker);
+        return _resolver.ResolveGenericValue(str, failed);
+    }
 
-    // Todo: load locations -> theirs maps -> critters/items on map -> items in critters/containers
-    const string query[] = {
-        "Locations",
-        "Maps",
-        "Critters",
-        "Items",
-    };
+    [[nodiscard]] auto ToHashedString(string_view s) const -> hstring override
+    {
+        std::lock_guard locker(_locker);
+        return _resolver.ToHashedString(s);
+    }
 
-    for (auto q = 0; q < 4; q++) {
-        string collection_name = query[q];
+    [[nodiscard]] auto ResolveHash(hstring::hash_t h, bool* failed) const -> hstring override
+    {
+        std::lock_guard locker(_locker);
+        return _resolver.ResolveHash(h, failed);
+    }
 
-        const auto ids = _engine->DbStorage.GetAllIds(collection_name);
+private:
+    NameResolver& _resolver;
+    mutable std::mutex _locker {};
+};
 
-        for (const auto id : ids) {
-            auto doc = _engine->DbStorage.Get(collection_name, id);
+auto EntityManager::FetchEntities(ThreadPool& pool, const DataBase& db, string_view collection_name, NameResolver& name_resolver, const ProtoGetter& proto_getter, LoadTimings& timings) -> vector<LoadedEntity>
+{
+    const auto ids = db.GetAllIds(collection_name);
 
-            const auto proto_it = doc.find("_Proto");
-            if (proto_it == doc.end()) {
-                throw EntitiesLoadException("'_Proto' section not found in entity", collection_name, id);
-            }
-            if (proto_it->second.index() != AnyData::STRING_VALUE) {
-                throw EntitiesLoadException("'_Proto' section is not string type", collection_name, id, proto_it->second.index());
+    vector<LoadedEntity> entities(ids.size());
+    vector<AnyData::Document> docs(ids.size());
+    vector<vector<uchar>> records(ids.size());
+    vector<const BinaryRecordSchema*> schemas(ids.size());
+    vector<string> proto_names(ids.size());
+
+    // Fetch documents, binary records stay raw and are restored in place
+    auto stage_time = Timer::RealtimeTick();
+
+    pool.ParallelFor(ids.size(), [&](size_t i) {
+        const auto id = ids[i];
+
+        const AnyData::Value* proto_value = nullptr;
+        AnyData::Value record_proto_value;
+
+        schemas[i] = db.GetBinaryRecord(collection_name, id, records[i]);
+
+        if (schemas[i] != nullptr) {
+            thread_local vector<pair<ushort, BinaryRecordValue>> values;
+            schemas[i]->Split(records[i].data(), records[i].size(), values);
+
+            for (const auto& [key_index, value] : values) {
+                if (schemas[i]->GetKey(key_index) == "_Proto") {
+                    record_proto_value = BinaryRecordSchema::DecodeValue(value);
+                    proto_value = &record_proto_value;
+                    break;
+                }
             }
+        }
+        else {
+            docs[i] = db.Get(collection_name, id);
 
-            const auto& proto_name = std::get<string>(proto_it->second);
-            if (proto_name.empty()) {
-                throw EntitiesLoadException("'_Proto' section is empty", collection_name, id);
+            if (const auto proto_it = docs[i].find("_Proto"); proto_it != docs[i].end()) {
+                proto_value = &proto_it->second;
             }
+        }
 
-            const auto proto_id = _engine->ToHashedString(std::get<string>(proto_it->second));
+        if (proto_value == nullptr) {
+            throw EntitiesLoadException("'_Proto' section not found in entity", collection_name, id);
+        }
+        if (proto_value->index() != AnyData::STRING_VALUE) {
+            throw EntitiesLoadException("'_Proto' section is not string type", collection_name, id, proto_value->index());
+        }
+        if (std::get<string>(*proto_value).empty()) {
+            throw EntitiesLoadException("'_Proto' section is empty", collection_name, id);
+        }
 
-            if (q == 0) {
-                const auto* proto = _engine->ProtoMngr.GetProtoLocation(proto_id);
-                if (proto == nullptr) {
-                    throw EntitiesLoadException("Location proto not found", proto_name);
-                }
+        entities[i].Id = id;
+        proto_names[i] = std::get<string>(*proto_value);
+    });
 
-                auto* loc = loc_fabric(id, proto);
-                if (!PropertiesSerializator::LoadFromDocument(&loc->GetPropertiesForEdit(), doc, *_engine)) {
-                    throw EntitiesLoadException("Failed to restore location properties", proto_name, id);
-                }
+    timings.Fetch += Timer::RealtimeTick() - stage_time;
 
-                loc->BindScript();
+    // Resolve protos, properties allocation goes through not thread safe registrator pool
+    stage_time = Timer::RealtimeTick();
 
-                RegisterEntity(loc);
-            }
-            else if (q == 1) {
-                const auto* proto = _engine->ProtoMngr.GetProtoMap(proto_id);
-                if (proto == nullptr) {
-                    throw EntitiesLoadException("Map proto not found", proto_name);
-                }
+    // Schema keys bound to properties once per collection instead of lookup by name for every value
+    struct RecordBinding
+    {
+        const BinaryRecordSchema* Schema {};
+        const PropertyRegistrator* Registrator {};
+        vector<const Property*> KeyProperties {};
+    };
+    vector<RecordBinding> bindings;
+    vector<const RecordBinding*> entity_bindings(ids.size());
+
+    for (size_t i = 0; i < entities.size(); i++) {
+        const auto proto_id = name_resolver.ToHashedString(proto_names[i]);
+        const auto* proto = proto_getter(proto_id);
+        if (proto == nullptr) {
+            throw EntitiesLoadException("Proto not found", collection_name, proto_names[i], entities[i].Id);
+        }
 
-                auto* map = map_fabric(id, proto);
-                if (!PropertiesSerializator::LoadFromDocument(&map->GetPropertiesForEdit(), doc, *_engine)) {
-                    throw EntitiesLoadException("Failed to restore map properties", proto_name, id);
-                }
+        entities[i].Proto = proto;
+        entities[i].Props = std::make_unique<Properties>(proto->GetProperties());
 
-                RegisterEntity(map);
-            }
-            else if (q == 2) {
-                const auto* proto = _engine->ProtoMngr.GetProtoCritter(proto_id);
-                if (proto == nullptr) {
-                    throw EntitiesLoadException("Proto critter not found", proto_name);
+        if (schemas[i] != nullptr) {
+            const auto* registrator = entities[i].Props->GetRegistrator();
+            auto it = std::find_if(bindings.begin(), bindings.end(), [&](const RecordBinding& b) { return b.Schema == schemas[i] && b.Registrator == registrator; });
+            if (it == bindings.end()) {
+                auto& binding = bindings.emplace_back(RecordBinding {schemas[i], registrator, {}});
+                for (size_t k = 0; k < schemas[i]->GetKeysCount(); k++) {
+                    binding.KeyProperties.emplace_back(registrator->Find(schemas[i]->GetKey(k)));
                 }
+                it = std::prev(bindings.end());
+            }
+            entity_bindings[i] = &*it;
+        }
+    }
 
-                auto* npc = npc_fabric(id, proto);
-                if (!PropertiesSerializator::LoadFromDocument(&npc->GetPropertiesForEdit(), doc, *_engine)) {
-                    throw EntitiesLoadException("Failed to restore critter properties", proto_name, id);
-                }
+    timings.Resolve += Timer::RealtimeTick() - stage_time;
 
-                RegisterEntity(npc);
-            }
-            else if (q == 3) {
-                const auto* proto = _engine->ProtoMngr.GetProtoItem(proto_id);
-                if (proto == nullptr) {
-                    throw EntitiesLoadException("Proto item is not loaded", proto_name);
-                }
+    // Decode properties
+    stage_time = Timer::RealtimeTick();
+
+    LockedNameResolver locked_resolver {name_resolver};
 
-                auto* item = item_fabric(id, proto);
-                if (!PropertiesSerializator::LoadFromDocument(&item->GetPropertiesForEdit(), doc, *_engine)) {
-                    throw EntitiesLoadException("Failed to restore item properties", proto_name, id);
+    pool.ParallelFor(entities.size(), [&](size_t i) {
+        auto* props = entities[i].Props.get();
+        auto is_error = false;
+
+        if (const auto* binding = entity_bindings[i]; binding != nullptr) {
+            thread_local vector<pair<ushort, BinaryRecordValue>> values;
+            binding->Schema->Split(records[i].data(), records[i].size(), values);
+
+            for (const auto& [key_index, value] : values) {
+                const auto* prop = binding->KeyProperties[key_index];
+
+                if (prop == nullptr) {
+                    // Skip technical fields
+                    if (const auto& key = binding->Schema->GetKey(key_index); !key.empty() && key[0] != '$' && key[0] != '_') {
+                        WriteLog("Unknown property {}", key);
+                        is_error = true;
+                    }
+                    continue;
                 }
 
-                RegisterEntity(item);
-            }
-            else {
-                throw UnreachablePlaceException(LINE_STR);
+                if (!PropertiesSerializator::LoadPropertyFromValue(props, prop, BinaryRecordSchema::DecodeValue(value), locked_resolver)) {
+                    is_error = true;
+                }
             }
+
+            records[i] = vector<uchar>();
         }
-    }
+        else {
+            is_error = !PropertiesSerializator::LoadFromDocument(props, docs[i], locked_resolver);
+            docs[i] = AnyData::Document();
+        }
+
+        if (is_error) {
+            throw EntitiesLoadException("Failed to restore entity properties", collection_name, proto_names[i], entities[i].Id);
+        }
+    });
+
+    timings.Decode += Timer::RealtimeTick() - stage_time;
+    timings.Entities += entities.size();
+
+    return entities;
+}
+
+void EntityManager::LoadEntities(const LocationFabric& loc_fabric, const MapFabric& map_fabric, const NpcFabric& npc_fabric, const ItemFabric& item_fabric)
+{
+    WriteLog("Load entities...");
+
+    const auto threads_count = _engine->Settings.LoadEntitiesThreads != 0u ? static_cast<size_t>(_engine->Settings.LoadEntitiesThreads) : ThreadPool::GetDefaultThreadsCount();
+    ThreadPool pool {threads_count};
+
+    LoadTimings total_timings;
+
+    // Todo: load locations -> theirs maps -> critters/items on map -> items in critters/containers
+    const auto load_collection = [&](string_view collection_name, const ProtoGetter& proto_getter, const std::function<void(LoadedEntity&)>& link) {
+        LoadTimings timings;
+
+        auto entities = FetchEntities(pool, _engine->DbStorage, collection_name, *_engine, proto_getter, timings);
+
+        const auto link_time = Timer::RealtimeTick();
+
+        for (auto& entity : entities) {
+            link(entity);
+        }
+
+        // Temporary properties freed here to keep registrator pool access on this thread
+        entities.clear();
+
+        timings.Link = Timer::RealtimeTick() - link_time;
+
+        WriteLog("Loaded {} {} (fetch {:.0f}ms, resolve {:.0f}ms, decode {:.0f}ms, link {:.0f}ms)", timings.Entities, collection_name, timings.Fetch, timings.Resolve, timings.Decode, timings.Link);
+
+        total_timings.Entities += timings.Entities;
+        total_timings.Fetch += timings.Fetch;
+        total_timings.Resolve += timings.Resolve;
+        total_timings.Decode += timings.Decode;
+        total_timings.Link += timings.Link;
+    };
 
-    WriteLog("Load entities complete");
+    load_collection(
+        "Locations", [this](hstring pid) -> const ProtoEntity* { return _engine->ProtoMngr.GetProtoLocation(pid); },
+        [this, &loc_fabric](LoadedEntity& entity) {
+            auto* loc = loc_fabric(entity.Id, static_cast<const ProtoLocation*>(entity.Proto));
+            loc->SetProperties(*entity.Props);
+            loc->BindScript();
+            RegisterEntity(loc);
+        });
+
+    load_collection(
+        "Maps", [this](hstring pid) -> const ProtoEntity* { return _engine->ProtoMngr.GetProtoMap(pid); },
+        [this, &map_fabric](LoadedEntity& entity) {
+            auto* map = map_fabric(entity.Id, static_cast<const ProtoMap*>(entity.Proto));
+            map->SetProperties(*entity.Props);
+            RegisterEntity(map);
+        });
+
+    load_collection(
+        "Critters", [this](hstring pid) -> const ProtoEntity* { return _engine->ProtoMngr.GetProtoCritter(pid); },
+        [this, &npc_fabric](LoadedEntity& entity) {
+            auto* npc = npc_fabric(entity.Id, static_cast<const ProtoCritter*>(entity.Proto));
+            npc->SetProperties(*entity.Props);
+            RegisterEntity(npc);
+        });
+
+    load_collection(
+        "Items", [this](hstring pid) -> const ProtoEntity* { return _engine->ProtoMngr.GetProtoItem(pid); },
+        [this, &item_fabric](LoadedEntity& entity) {
+            auto* item = item_fabric(entity.Id, static_cast<const ProtoItem*>(entity.Proto));
+            item->SetProperties(*entity.Props);
+            RegisterEntity(item);
+        });
+
+    WriteLog("Load entities complete, {} entities on {} threads (fetch {:.0f}ms, resolve {:.0f}ms, decode {:.0f}ms, link {:.0f}ms)", total_timings.Entities, pool.GetThreadsCount(), total_timings.Fetch, total_timings.Resolve, total_timings.Decode, total_timings.Link);
 }
 
 void EntityManager::InitAfterLoad()
@@ -41,11 +41,13 @@
 #include "Item.h"
 #include "Location.h"
 #include "Map.h"
+#include "MemoryPool.h"
 #include "Player.h"
 
 DECLARE_EXCEPTION(EntitiesLoadException);
 
 class ProtoManager;
+class ThreadPool;
 
 class EntityManager final
 {
@@ -54,6 +56,23 @@ class EntityManager final
     using MapFabric = std::function<Map*(uint, const ProtoMap*)>;
     using NpcFabric = std::function<Critter*(uint, const ProtoCritter*)>;
     using ItemFabric = std::function<Item*(uint, const ProtoItem*)>;
+    using ProtoGetter = std::function<const ProtoEntity*(hstring)>;
+
+    struct LoadedEntity
+    {
+        uint Id {};
+        const ProtoEntity* Proto {};
+        unique_ptr<Properties> Props {};
+    };
+
+    struct LoadTimings
+    {
+        size_t Entities {};
+        double Fetch {};
+        double Resolve {};
+        double Decode {};
+        double Link {};
+    };
 
     static constexpr auto ENTITIES_FINALIZATION_FUSE_VALUE = 10000;
 
@@ -69,6 +88,7 @@ class EntityManager final
     [[nodiscard]] auto GetEntity(uint id) -> ServerEntity*;
     [[nodiscard]] auto GetEntities() -> vector<ServerEntity*>;
     [[nodiscard]] auto GetPlayer(uint id) -> Player*;
+    [[nodiscard]] auto GetPlayerByName(string_view name) -> Player*;
     [[nodiscard]] auto GetPlayers() -> vector<Player*>;
     [[nodiscard]] auto GetPlayers() const -> vector<const Player*>;
     [[nodiscard]] auto GetItem(uint id) -> Item*;
@@ -82,14 +102,32 @@ class EntityManager final
     [[nodiscard]] auto GetLocationByPid(hstring pid, uint skip_count) -> Location*;
     [[nodiscard]] auto GetLocations() -> vector<Location*>;
 
+    // Lists for one tick, memory is dropped with arena reset
+    [[nodiscard]] auto GetPlayers(FrameArena& arena) -> frame_vector<Player*>;
+    [[nodiscard]] auto GetCritters(FrameArena& arena) -> frame_vector<Critter*>;
+    [[nodiscard]] auto GetMaps(FrameArena& arena) -> frame_vector<Map*>;
+    [[nodiscard]] auto GetAwakeCritters(FrameArena& arena) -> frame_vector<Critter*>;
+    [[nodiscard]] auto GetSuspendedCrittersCount() const -> size_t;
+
+    // Fetch and decode done on worker threads, entities created and registered on caller thread in ids order
+    [[nodiscard]] static auto FetchEntities(ThreadPool& pool, const DataBase& db, string_view collection_name, NameResolver& name_resolver, const ProtoGetter& proto_getter, LoadTimings& timings) -> vector<LoadedEntity>;
+
     void LoadEntities(const LocationFabric& loc_fabric, const MapFabric& map_fabric, const NpcFabric& npc_fabric, const ItemFabric& item_fabric);
     void InitAfterLoad();
     void RegisterEntity(ServerEntity* entity);
     void UnregisterEntity(ServerEntity* entity);
     void FinalizeEntities();
+    void WakeCritter(Critter* cr);
+    void SuspendCritter(Critter* cr, uint wake_tick);
+    void WakeDueCritters(uint tick);
 
 private:
     FOServer* _engine;
     map<uint, ServerEntity*> _allEntities {};
+    map<uint, Critter*> _allCritters {};
+    map<uint, Map*> _allMaps {};
+    map<uint, Critter*> _awakeCritters {};
+    TimingWheel _suspendedCritters {};
+    unordered_multimap<string, Player*> _playersByName {};
     bool _nonConstHelper {};
 };
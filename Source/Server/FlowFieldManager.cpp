@@ -0,0 +1,562 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "FlowFieldManager.h"
+#include "GeometryHelper.h"
+#include "Log.h"
+#include "Map.h"
+#include "Server.h"
+#include "Settings.h"
+#include "ThreadPool.h"
+
+// Items and static blockers only, critters move meanwhile and are checked when path is built
+static constexpr auto FLOW_FIELD_NOWAY = static_cast<ushort>(FH_BLOCK_ITEM << 8 | FH_BLOCK);
+
+// Pursuers of same hex must ask for path within this time to be counted together
+static constexpr uint FLOW_FIELD_DEMAND_TIME = 3000;
+
+FlowField::FlowField(ushort width, ushort height, ushort target_hx, ushort target_hy, uint multihex, bool gag_items, ushort max_dist) : _width {width}, _height {height}, _targetHx {target_hx}, _targetHy {target_hy}, _multihex {multihex}, _gagItems {gag_items}, _maxDist {max_dist}
+{
+    RUNTIME_ASSERT(target_hx < width);
+    RUNTIME_ASSERT(target_hy < height);
+    RUNTIME_ASSERT(max_dist < UNREACHABLE);
+}
+
+auto FlowField::GetFieldView(const MapHexFlagsView& hex_flags) -> MapHexFlagsView
+{
+    auto field_view = hex_flags;
+    field_view.NoWayMask = FLOW_FIELD_NOWAY;
+    return field_view;
+}
+
+auto FlowField::GetDistance(ushort hx, ushort hy) const -> ushort
+{
+    RUNTIME_ASSERT(!_dist.empty());
+
+    return _dist[hy * _width + hx];
+}
+
+auto FlowField::GetMemorySize() const -> size_t
+{
+    return _dist.capacity() * sizeof(ushort) + _marks.capacity() / 8;
+}
+
+auto FlowField::GetStepCost(const MapHexFlagsView& field_view, const GeometryHelper& geom_helper, bool hexagonal, ushort hx, ushort hy, uchar dir) const -> ushort
+{
+    if (field_view.IsMovePassed(geom_helper, hexagonal, hx, hy, dir, _multihex)) {
+        return 1;
+    }
+
+    // Path stops before gag item, same as regular search it is not used for multihex critters
+    if (_gagItems && _multihex == 0u && IsBitSet(field_view.GetHexFlags(hx, hy), static_cast<ushort>(FH_GAG_ITEM << 8))) {
+        return 1 + GAG_STEP_COST;
+    }
+
+    return 0;
+}
+
+void FlowField::Compute(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, bool hexagonal)
+{
+    RUNTIME_ASSERT(hex_flags.Width == _width);
+    RUNTIME_ASSERT(hex_flags.Height == _height);
+
+    _dist.assign(static_cast<size_t>(_width) * _height, UNREACHABLE);
+    _buckets.resize(static_cast<size_t>(_maxDist) + 1);
+
+    const auto target_index = _targetHy * _width + _targetHx;
+    _dist[target_index] = 0;
+    _buckets[0].push_back(target_index);
+
+    Relax(GetFieldView(hex_flags), geom_helper, hexagonal);
+}
+
+void FlowField::Repair(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, bool hexagonal, const vector<uint>& changed_hexes)
+{
+    RUNTIME_ASSERT(!_dist.empty());
+
+    const auto field_view = GetFieldView(hex_flags);
+    const auto dirs_count = hexagonal ? 6 : 8;
+    const auto target_index = static_cast<uint>(_targetHy * _width + _targetHx);
+
+    _marks.resize(_dist.size());
+
+    vector<pair<uint, ushort>> invalidated;
+    const auto invalidate = [&](uint index) {
+        _marks[index] = true;
+        invalidated.emplace_back(index, _dist[index]);
+        _dist[index] = UNREACHABLE;
+    };
+
+    // Moves into hexes around changed one depend on its flags, multihex critters check hexes in radius
+    const auto radius = static_cast<int>(_multihex) + 1;
+    for (const auto changed_index : changed_hexes) {
+        const auto chx = static_cast<int>(changed_index % _width);
+        const auto chy = static_cast<int>(changed_index / _width);
+
+        for (auto hy = std::max(chy - radius, 0); hy <= std::min(chy + radius, _height - 1); hy++) {
+            for (auto hx = std::max(chx - radius, 0); hx <= std::min(chx + radius, _width - 1); hx++) {
+                const auto index = static_cast<uint>(hy * _width + hx);
+                if (index != target_index && !_marks[index]) {
+                    invalidate(index);
+                }
+            }
+        }
+    }
+
+    // Invalidate hexes which distance was supported only by invalidated hexes
+    for (size_t i = 0; i < invalidated.size(); i++) {
+        const auto [index, old_dist] = invalidated[i];
+        if (old_dist == UNREACHABLE) {
+            continue;
+        }
+
+        const auto hx = static_cast<int>(index % _width);
+        const auto hy = static_cast<int>(index / _width);
+        const auto [sx, sy] = geom_helper.GetHexOffsets((hx & 1) != 0);
+
+        for (auto j = 0; j < dirs_count; j++) {
+            const auto nx = hx + sx[j];
+            const auto ny = hy + sy[j];
+            if (nx < 0 || ny < 0 || nx >= _width || ny >= _height) {
+                continue;
+            }
+
+            const auto n_index = static_cast<uint>(ny * _width + nx);
+            if (_marks[n_index] || n_index == target_index || _dist[n_index] == UNREACHABLE || _dist[n_index] <= old_dist) {
+                continue;
+            }
+
+            auto supported = false;
+            const auto [nsx, nsy] = geom_helper.GetHexOffsets((nx & 1) != 0);
+            for (auto k = 0; k < dirs_count && !supported; k++) {
+                const auto mx = nx + nsx[k];
+                const auto my = ny + nsy[k];
+                if (mx < 0 || my < 0 || mx >= _width || my >= _height) {
+                    continue;
+                }
+
+                const auto m_index = static_cast<uint>(my * _width + mx);
+                if (!_marks[m_index] && _dist[m_index] < _dist[n_index] && _dist[m_index] + GetStepCost(field_view, geom_helper, hexagonal, static_cast<ushort>(mx), static_cast<ushort>(my), static_cast<uchar>(k)) == _dist[n_index]) {
+                    supported = true;
+                }
+            }
+
+            if (!supported) {
+                invalidate(n_index);
+            }
+        }
+    }
+
+    // Take best distance from valid neighbors and propagate from there
+    for (const auto& [index, old_dist] : invalidated) {
+        const auto hx = static_cast<int>(index % _width);
+        const auto hy = static_cast<int>(index / _width);
+        const auto [sx, sy] = geom_helper.GetHexOffsets((hx & 1) != 0);
+
+        auto best_dist = UNREACHABLE;
+        for (auto j = 0; j < dirs_count; j++) {
+            const auto mx = hx + sx[j];
+            const auto my = hy + sy[j];
+            if (mx < 0 || my < 0 || mx >= _width || my >= _height) {
+                continue;
+            }
+
+            const auto m_dist = _dist[my * _width + mx];
+            if (_marks[my * _width + mx] || m_dist >= _maxDist || m_dist + 1 >= best_dist) {
+                continue;
+            }
+
+            const auto cost = GetStepCost(field_view, geom_helper, hexagonal, static_cast<ushort>(mx), static_cast<ushort>(my), static_cast<uchar>(j));
+            if (cost != 0 && m_dist + cost <= _maxDist && m_dist + cost < best_dist) {
+                best_dist = static_cast<ushort>(m_dist + cost);
+            }
+        }
+
+        if (best_dist != UNREACHABLE) {
+            _dist[index] = best_dist;
+            _buckets[best_dist].push_back(index);
+        }
+    }
+
+    for (const auto& [index, old_dist] : invalidated) {
+        _marks[index] = false;
+    }
+
+    Relax(field_view, geom_helper, hexagonal);
+}
+
+void FlowField::Relax(const MapHexFlagsView& field_view, const GeometryHelper& geom_helper, bool hexagonal)
+{
+    const auto dirs_count = hexagonal ? 6 : 8;
+
+    // Buckets by distance, all moves cost one step
+    for (uint dist = 0; dist < _buckets.size(); dist++) {
+        auto& bucket = _buckets[dist];
+
+        for (size_t i = 0; i < bucket.size(); i++) {
+            const auto index = bucket[i];
+            if (_dist[index] != dist || dist >= _maxDist) {
+                continue;
+            }
+
+            const auto hx = static_cast<int>(index % _width);
+            const auto hy = static_cast<int>(index / _width);
+            const auto [sx, sy] = geom_helper.GetHexOffsets((hx & 1) != 0);
+
+            for (auto j = 0; j < dirs_count; j++) {
+                const auto nx = hx + sx[j];
+                const auto ny = hy + sy[j];
+                if (nx < 0 || ny < 0 || nx >= _width || ny >= _height) {
+                    continue;
+                }
+
+                const auto n_index = static_cast<uint>(ny * _width + nx);
+                if (_dist[n_index] <= dist + 1) {
+                    continue;
+                }
+
+                // Critter at neighbor hex moves back by reversed direction
+                const auto move_dir = geom_helper.ReverseDir(static_cast<uchar>(j));
+                const auto cost = GetStepCost(field_view, geom_helper, hexagonal, static_cast<ushort>(hx), static_cast<ushort>(hy), move_dir);
+                if (cost == 0 || dist + cost > _maxDist || _dist[n_index] <= dist + cost) {
+                    continue;
+                }
+
+                _dist[n_index] = static_cast<ushort>(dist + cost);
+                _buckets[dist + cost].push_back(n_index);
+            }
+        }
+
+        bucket.clear();
+    }
+}
+
+auto FlowField::BuildPath(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, bool hexagonal, ushort from_hx, ushort from_hy, uint cut, vector<PathStep>& steps) const -> bool
+{
+    RUNTIME_ASSERT(!_dist.empty());
+
+    steps.clear();
+
+    if (from_hx >= _width || from_hy >= _height || _dist[from_hy * _width + from_hx] == UNREACHABLE) {
+        return false;
+    }
+
+    const auto field_view = GetFieldView(hex_flags);
+    const auto dirs_count = hexagonal ? 6 : 8;
+
+    auto hx = static_cast<int>(from_hx);
+    auto hy = static_cast<int>(from_hy);
+    while (!geom_helper.CheckDist(static_cast<ushort>(hx), static_cast<ushort>(hy), _targetHx, _targetHy, cut)) {
+        const auto dist = _dist[hy * _width + hx];
+        if (dist == 0) {
+            break;
+        }
+
+        auto best_dir = -1;
+        const auto [sx, sy] = geom_helper.GetHexOffsets((hx & 1) != 0);
+        for (auto j = 0; j < dirs_count && best_dir == -1; j++) {
+            const auto nx = hx + sx[j];
+            const auto ny = hy + sy[j];
+            if (nx < 0 || ny < 0 || nx >= _width || ny >= _height || _dist[ny * _width + nx] >= dist) {
+                continue;
+            }
+            if (_dist[ny * _width + nx] + GetStepCost(field_view, geom_helper, hexagonal, static_cast<ushort>(nx), static_cast<ushort>(ny), static_cast<uchar>(j)) != dist) {
+                continue;
+            }
+
+            // Hexes under own multihex body are not busy
+            const auto busy = IsBitSet(hex_flags.GetHexFlags(static_cast<ushort>(nx), static_cast<ushort>(ny)), static_cast<ushort>(FH_CRITTER << 8));
+            if (busy && geom_helper.DistGame(from_hx, from_hy, static_cast<ushort>(nx), static_cast<ushort>(ny)) > _multihex) {
+                continue;
+            }
+
+            best_dir = j;
+        }
+
+        if (best_dir == -1) {
+            steps.clear();
+            return false;
+        }
+
+        hx += sx[best_dir];
+        hy += sy[best_dir];
+
+        PathStep step;
+        step.HexX = static_cast<ushort>(hx);
+        step.HexY = static_cast<ushort>(hy);
+        step.Dir = static_cast<uchar>(best_dir);
+        steps.push_back(step);
+    }
+
+    return true;
+}
+
+FlowFieldManager::FlowFieldManager(FOServer* engine) : _engine {engine}
+{
+}
+
+FlowFieldManager::~FlowFieldManager()
+{
+    // Wait running builds before their data is released
+    _threadPool.reset();
+}
+
+auto FlowFieldManager::IsEnabled() const -> bool
+{
+    return _engine->Settings.FlowFieldsCacheSize != 0u && _engine->WorldSnapshotMngr.IsEnabled();
+}
+
+auto FlowFieldManager::FindPath(const FindPathInput& input, FindPathOutput& output) -> bool
+{
+    if (!IsEnabled()) {
+        return false;
+    }
+
+    auto* map = _engine->MapMngr.GetMap(input.MapId);
+    if (map == nullptr || input.ToX >= map->GetWidth() || input.ToY >= map->GetHeight()) {
+        return false;
+    }
+
+    if (!map->GetBlockChanges().empty()) {
+        RepairMapFields(map);
+    }
+
+    const auto key = FieldKey {input.MapId, input.ToX, input.ToY, input.Multihex, input.CheckGagItems};
+    const auto it = _fields.find(key);
+    if (it == _fields.end()) {
+        _stats.Misses++;
+        RequestField(map, key, input);
+        return false;
+    }
+
+    _stats.Hits++;
+    _lru.splice(_lru.begin(), _lru, it->second.LruPos);
+
+    vector<PathStep> steps;
+    if (!it->second.Field->BuildPath(map->GetHexFlagsView(), _engine->GeomHelper, _engine->Settings.MapHexagonal, input.FromX, input.FromY, input.Cut, steps)) {
+        return false;
+    }
+
+    output = FindPathOutput();
+
+    if (steps.empty()) {
+        output.Result = FindPathResult::AlreadyHere;
+        return true;
+    }
+
+    output.Steps = std::move(steps);
+    output.Result = FindPathResult::Ok;
+    _engine->MapMngr.FinishFindPath(input, map, output);
+    return true;
+}
+
+void FlowFieldManager::Process()
+{
+    // Install finished builds, builds of removed maps are dropped
+    for (auto it = _builds.begin(); it != _builds.end();) {
+        auto& build = *it->second;
+        if (!build.Done.load(std::memory_order_acquire)) {
+            ++it;
+            continue;
+        }
+
+        auto* map = _engine->MapMngr.GetMap(std::get<0>(it->first));
+        if (map != nullptr && !build.Failed) {
+            InstallField(map, it->first, build);
+        }
+
+        it = _builds.erase(it);
+    }
+
+    // Forget hexes which critters stopped moving to
+    const auto tick = _engine->GameTime.GameTick();
+    for (auto it = _demands.begin(); it != _demands.end();) {
+        if (tick - it->second.LastTick > FLOW_FIELD_DEMAND_TIME) {
+            it = _demands.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    // Drop fields of removed maps
+    for (auto it = _fields.begin(); it != _fields.end();) {
+        if (_engine->MapMngr.GetMap(std::get<0>(it->first)) == nullptr) {
+            const auto cur_it = it++;
+            EvictField(cur_it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    _stats.Fields = _fields.size();
+    _stats.Pending = _builds.size();
+    _stats.MemorySize = 0;
+    for (auto&& [key, cached] : _fields) {
+        _stats.MemorySize += cached.Field->GetMemorySize();
+    }
+}
+
+void FlowFieldManager::Stop()
+{
+    _threadPool.reset();
+    _builds.clear();
+    _demands.clear();
+    _stats.Pending = 0;
+}
+
+void FlowFieldManager::RequestField(Map* map, const FieldKey& key, const FindPathInput& input)
+{
+    if (_builds.count(key) != 0u) {
+        return;
+    }
+
+    // Field pays off only when it is shared by several critters
+    auto& demand = _demands[key];
+    const auto requester_id = input.FromCritter != nullptr ? input.FromCritter->GetId() : 0u;
+    if (std::find(demand.Requesters.begin(), demand.Requesters.end(), requester_id) == demand.Requesters.end()) {
+        demand.Requesters.push_back(requester_id);
+    }
+    demand.LastTick = _engine->GameTime.GameTick();
+
+    if (demand.Requesters.size() < _engine->Settings.FlowFieldMinPursuers) {
+        return;
+    }
+
+    // Map created after last publish, build on later request
+    auto snapshot = _engine->WorldSnapshotMngr.GetPublishedMap(map->GetId());
+    if (!snapshot) {
+        return;
+    }
+
+    _demands.erase(key);
+
+    auto build = std::make_unique<FieldBuild>();
+    build->Field = std::make_unique<FlowField>(map->GetWidth(), map->GetHeight(), input.ToX, input.ToY, input.Multihex, input.CheckGagItems, static_cast<ushort>(FPATH_MAX_PATH));
+    build->Snapshot = std::move(snapshot);
+
+    if (!_threadPool) {
+        _threadPool = std::make_unique<ThreadPool>(_engine->Settings.PathFindThreads != 0u ? static_cast<size_t>(_engine->Settings.PathFindThreads) : ThreadPool::GetDefaultThreadsCount());
+    }
+
+    // Hex offsets tables are built lazily, make sure it happened before workers use them
+    UNUSED_VARIABLE(_engine->GeomHelper.GetHexOffsets(false));
+
+    // Build is owned by main thread and dropped only after it is done
+    _threadPool->AddJob([this, build = build.get()] {
+        try {
+            build->Field->Compute(build->Snapshot->HexFlags, _engine->GeomHelper, _engine->Settings.MapHexagonal);
+        }
+        catch (const std::exception& ex) {
+            ReportExceptionAndContinue(ex);
+            build->Failed = true;
+        }
+
+        build->Done.store(true, std::memory_order_release);
+    });
+
+    _builds.emplace(key, std::move(build));
+    _stats.Builds++;
+}
+
+void FlowFieldManager::InstallField(Map* map, const FieldKey& key, FieldBuild& build)
+{
+    const auto hex_flags = map->GetHexFlagsView();
+    const auto& snapshot = *build.Snapshot;
+
+    // Block changes made after snapshot publish, only bands changed since then are compared
+    vector<uint> changed_hexes;
+    for (uint band = 0; band < snapshot.HexFlagsBands.size(); band++) {
+        const auto& snapshot_band = *snapshot.HexFlagsBands[band];
+        if (snapshot_band.Version == map->GetHexFlagsBandVersion(band)) {
+            continue;
+        }
+
+        const auto first_index = band * Map::HEX_FLAGS_BAND_ROWS * hex_flags.Width;
+        for (uint i = 0; i < snapshot_band.DynamicFlags.size(); i++) {
+            const auto diff = static_cast<uchar>(snapshot_band.DynamicFlags[i] ^ hex_flags.DynamicFlagsBands[band][i]);
+            if (IsBitSet(diff, static_cast<uchar>(FH_BLOCK_ITEM | FH_GAG_ITEM))) {
+                changed_hexes.push_back(first_index + i);
+            }
+        }
+    }
+
+    if (!changed_hexes.empty()) {
+        build.Field->Repair(hex_flags, _engine->GeomHelper, _engine->Settings.MapHexagonal, changed_hexes);
+        _stats.Repairs++;
+    }
+
+    _lru.push_front(key);
+    _fields.emplace(key, CachedField {std::move(build.Field), _lru.begin()});
+
+    if (_mapFieldsCount[map->GetId()]++ == 0) {
+        map->SetBlockChangesTracking(true);
+    }
+
+    while (_fields.size() > _engine->Settings.FlowFieldsCacheSize) {
+        EvictField(_fields.find(_lru.back()));
+    }
+}
+
+void FlowFieldManager::RepairMapFields(Map* map)
+{
+    const auto hex_flags = map->GetHexFlagsView();
+
+    for (auto&& [key, cached] : _fields) {
+        if (std::get<0>(key) == map->GetId()) {
+            cached.Field->Repair(hex_flags, _engine->GeomHelper, _engine->Settings.MapHexagonal, map->GetBlockChanges());
+            _stats.Repairs++;
+        }
+    }
+
+    map->ClearBlockChanges();
+}
+
+void FlowFieldManager::EvictField(map<FieldKey, CachedField>::iterator it)
+{
+    RUNTIME_ASSERT(it != _fields.end());
+
+    const auto map_id = std::get<0>(it->first);
+    _lru.erase(it->second.LruPos);
+    _fields.erase(it);
+    _stats.Evictions++;
+
+    if (--_mapFieldsCount[map_id] == 0) {
+        _mapFieldsCount.erase(map_id);
+
+        if (auto* map = _engine->MapMngr.GetMap(map_id); map != nullptr) {
+            map->SetBlockChangesTracking(false);
+        }
+    }
+}
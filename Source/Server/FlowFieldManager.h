@@ -0,0 +1,159 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "MapManager.h"
+#include "WorldSnapshotManager.h"
+
+class FOServer;
+class GeometryHelper;
+class ThreadPool;
+
+// Step costs from every map hex to target hex, critters are not part of field
+// Built once and shared by all critters moving to same target
+class FlowField final
+{
+public:
+    static constexpr ushort UNREACHABLE = std::numeric_limits<ushort>::max();
+    // Gag hex is entered only if way around is longer, like in regular search
+    static constexpr ushort GAG_STEP_COST = 10;
+
+    FlowField() = delete;
+    FlowField(ushort width, ushort height, ushort target_hx, ushort target_hy, uint multihex, bool gag_items, ushort max_dist);
+    FlowField(const FlowField&) = delete;
+    FlowField(FlowField&&) noexcept = default;
+    auto operator=(const FlowField&) = delete;
+    auto operator=(FlowField&&) noexcept -> FlowField& = default;
+    ~FlowField() = default;
+
+    [[nodiscard]] static auto GetFieldView(const MapHexFlagsView& hex_flags) -> MapHexFlagsView;
+    [[nodiscard]] auto GetDistance(ushort hx, ushort hy) const -> ushort;
+    [[nodiscard]] auto GetMemorySize() const -> size_t;
+    // Fails if next step is busy by critter, regular search goes around it
+    [[nodiscard]] auto BuildPath(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, bool hexagonal, ushort from_hx, ushort from_hy, uint cut, vector<PathStep>& steps) const -> bool;
+
+    void Compute(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, bool hexagonal);
+    void Repair(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, bool hexagonal, const vector<uint>& changed_hexes);
+
+private:
+    [[nodiscard]] auto GetStepCost(const MapHexFlagsView& field_view, const GeometryHelper& geom_helper, bool hexagonal, ushort hx, ushort hy, uchar dir) const -> ushort;
+
+    void Relax(const MapHexFlagsView& field_view, const GeometryHelper& geom_helper, bool hexagonal);
+
+    ushort _width;
+    ushort _height;
+    ushort _targetHx;
+    ushort _targetHy;
+    uint _multihex;
+    bool _gagItems;
+    ushort _maxDist;
+    vector<ushort> _dist {};
+    vector<vector<uint>> _buckets {};
+    vector<bool> _marks {};
+};
+
+// Cache of flow fields per map, target hex, multihex and gag items check
+// Field is built on worker thread from published map snapshot once enough critters move to same hex
+// Fields are repaired on block flags changes and least recently used ones are evicted
+class FlowFieldManager final
+{
+public:
+    struct Statistics
+    {
+        size_t Hits {};
+        size_t Misses {};
+        size_t Builds {};
+        size_t Repairs {};
+        size_t Evictions {};
+        size_t Fields {};
+        size_t Pending {};
+        size_t MemorySize {};
+    };
+
+    FlowFieldManager() = delete;
+    explicit FlowFieldManager(FOServer* engine);
+    FlowFieldManager(const FlowFieldManager&) = delete;
+    FlowFieldManager(FlowFieldManager&&) noexcept = delete;
+    auto operator=(const FlowFieldManager&) = delete;
+    auto operator=(FlowFieldManager&&) noexcept = delete;
+    ~FlowFieldManager();
+
+    [[nodiscard]] auto IsEnabled() const -> bool;
+    [[nodiscard]] auto GetStatistics() const -> const Statistics& { return _stats; }
+
+    // Returns false if field is not built yet or path can't be built from it, then regular search is needed
+    auto FindPath(const FindPathInput& input, FindPathOutput& output) -> bool;
+    void Process();
+    // Waits running builds and drops all others
+    void Stop();
+
+private:
+    using FieldKey = tuple<uint, ushort, ushort, uint, bool>;
+
+    struct CachedField
+    {
+        unique_ptr<FlowField> Field {};
+        list<FieldKey>::iterator LruPos {};
+    };
+
+    struct FieldBuild
+    {
+        unique_ptr<FlowField> Field {};
+        shared_ptr<const MapSnapshot> Snapshot {}; // Released on main thread
+        bool Failed {};
+        std::atomic_bool Done {};
+    };
+
+    struct FieldDemand
+    {
+        vector<uint> Requesters {};
+        uint LastTick {};
+    };
+
+    void RequestField(Map* map, const FieldKey& key, const FindPathInput& input);
+    void InstallField(Map* map, const FieldKey& key, FieldBuild& build);
+    void RepairMapFields(Map* map);
+    void EvictField(map<FieldKey, CachedField>::iterator it);
+
+    FOServer* _engine;
+    map<FieldKey, CachedField> _fields {};
+    list<FieldKey> _lru {};
+    unordered_map<uint, size_t> _mapFieldsCount {};
+    map<FieldKey, FieldDemand> _demands {};
+    map<FieldKey, unique_ptr<FieldBuild>> _builds {};
+    Statistics _stats {};
+    unique_ptr<ThreadPool> _threadPool {};
+};
@@ -0,0 +1,229 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "HexBitPlane.h"
+#include "GenericUtils.h"
+#include "GeometryHelper.h"
+
+HexBitPlane::HexBitPlane(ushort width, ushort height) : _width {width}, _height {height}, _rowWords {(width + 63u) / 64u}
+{
+    _words.resize(_rowWords * height);
+}
+
+void HexBitPlane::Set(ushort hx, ushort hy, bool value)
+{
+    auto& word = _words[hy * _rowWords + hx / 64];
+    const auto bit = static_cast<uint64>(1) << (hx % 64);
+
+    if (value) {
+        word |= bit;
+    }
+    else {
+        word &= ~bit;
+    }
+}
+
+auto HexBitPlane::GetRowBits(int hx, int hy, uint count) const -> uint64
+{
+    if (hy < 0 || hy >= _height || hx >= _width) {
+        return 0;
+    }
+
+    // Left part outside of map
+    if (hx < 0) {
+        const auto shift = static_cast<uint>(-hx);
+        return shift < count ? GetRowBits(0, hy, count - shift) << shift : 0;
+    }
+
+    const auto* row = &_words[hy * _rowWords];
+    const auto word = static_cast<size_t>(hx) / 64;
+    const auto bit = static_cast<uint>(hx) % 64;
+
+    auto bits = row[word] >> bit;
+    if (bit != 0 && word + 1 < _rowWords) {
+        bits |= row[word + 1] << (64 - bit);
+    }
+
+    return count < 64 ? bits & ((static_cast<uint64>(1) << count) - 1) : bits;
+}
+
+auto HexFootprint::IsFree(const HexBitPlane& plane, ushort hx, ushort hy) const -> bool
+{
+    const auto x = hx + MinX;
+    const auto y = hy + MinY;
+
+    for (size_t i = 0; i < RowMasks.size(); i++) {
+        if ((plane.GetRowBits(x, y + static_cast<int>(i), Width) & RowMasks[i]) != 0u) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto HexFootprint::IsFreeInside(const HexBitPlane& plane, ushort hx, ushort hy, ushort width, ushort height) const -> bool
+{
+    if (hx + VisitMinX < 0 || hy + VisitMinY < 0 || hx + VisitMaxX >= width || hy + VisitMaxY >= height) {
+        return false;
+    }
+
+    return IsFree(plane, hx, hy);
+}
+
+static auto MakeFootprint(const vector<tuple<int, int>>& tested, const vector<tuple<int, int>>& visited) -> HexFootprint
+{
+    HexFootprint footprint;
+
+    auto max_x = std::numeric_limits<int>::min();
+    auto max_y = std::numeric_limits<int>::min();
+    footprint.MinX = std::numeric_limits<int>::max();
+    footprint.MinY = std::numeric_limits<int>::max();
+
+    for (const auto& [x, y] : tested) {
+        footprint.MinX = std::min(footprint.MinX, x);
+        footprint.MinY = std::min(footprint.MinY, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+    }
+
+    footprint.VisitMinX = footprint.MinX;
+    footprint.VisitMinY = footprint.MinY;
+    footprint.VisitMaxX = max_x;
+    footprint.VisitMaxY = max_y;
+
+    for (const auto& [x, y] : visited) {
+        footprint.VisitMinX = std::min(footprint.VisitMinX, x);
+        footprint.VisitMinY = std::min(footprint.VisitMinY, y);
+        footprint.VisitMaxX = std::max(footprint.VisitMaxX, x);
+        footprint.VisitMaxY = std::max(footprint.VisitMaxY, y);
+    }
+
+    // Too wide for one word, left empty
+    footprint.Width = static_cast<uint>(max_x - footprint.MinX + 1);
+    if (footprint.Width > 64) {
+        return footprint;
+    }
+
+    footprint.RowMasks.resize(static_cast<size_t>(max_y - footprint.MinY + 1));
+    for (const auto& [x, y] : tested) {
+        footprint.RowMasks[y - footprint.MinY] |= static_cast<uint64>(1) << (x - footprint.MinX);
+    }
+
+    return footprint;
+}
+
+HexFootprints::HexFootprints(const GeometryHelper& geom_helper, bool hexagonal, uint dir_count) : _dirCount {dir_count}
+{
+    vector<tuple<int, int>> tested;
+    vector<tuple<int, int>> visited;
+
+    // Offsets walked on virtual map, start parity is all what matters
+    constexpr auto virtual_size = static_cast<ushort>(1024);
+    constexpr auto virtual_origin = 512;
+
+    for (const auto odd : {false, true}) {
+        const auto [sx, sy] = geom_helper.GetHexOffsets(odd);
+
+        for (uint radius = 0; radius <= MAX_RADIUS; radius++) {
+            tested.clear();
+            tested.emplace_back(0, 0);
+
+            const auto count = GenericUtils::NumericalNumber(radius) * dir_count;
+            for (uint i = 0; i < count; i++) {
+                tested.emplace_back(sx[i], sy[i]);
+            }
+
+            _radius.emplace_back(MakeFootprint(tested, {}));
+        }
+    }
+
+    for (const auto odd : {false, true}) {
+        const auto origin_x = virtual_origin + (odd ? 1 : 0);
+        const auto origin_y = virtual_origin;
+
+        for (uint dir = 0; dir < dir_count; dir++) {
+            for (uint multihex = 1; multihex <= MAX_MULTIHEX; multihex++) {
+                tested.clear();
+                visited.clear();
+
+                auto hx = origin_x;
+                auto hy = origin_y;
+                for (uint k = 0; k < multihex; k++) {
+                    geom_helper.MoveHexByDirUnsafe(hx, hy, static_cast<uchar>(dir), virtual_size, virtual_size);
+                    visited.emplace_back(hx - origin_x, hy - origin_y);
+                }
+                tested.emplace_back(hx - origin_x, hy - origin_y);
+
+                const auto is_square_corner = !hexagonal && (dir % 2) != 0;
+                const auto steps_count = is_square_corner ? multihex * 2 : multihex;
+
+                auto dir_cw = static_cast<uchar>(hexagonal ? (dir + 2) % 6 : (dir + 2) % 8);
+                auto dir_ccw = static_cast<uchar>(hexagonal ? (dir + 4) % 6 : (dir + 6) % 8);
+                if (is_square_corner) {
+                    dir_cw = static_cast<uchar>((dir_cw + 1) % 8);
+                    dir_ccw = static_cast<uchar>((dir_ccw + 7) % 8);
+                }
+
+                for (const auto side_dir : {dir_cw, dir_ccw}) {
+                    auto side_hx = hx;
+                    auto side_hy = hy;
+                    for (uint k = 0; k < steps_count; k++) {
+                        geom_helper.MoveHexByDirUnsafe(side_hx, side_hy, side_dir, virtual_size, virtual_size);
+                        tested.emplace_back(side_hx - origin_x, side_hy - origin_y);
+                    }
+                }
+
+                _move.emplace_back(MakeFootprint(tested, visited));
+            }
+        }
+    }
+}
+
+auto HexFootprints::GetRadius(bool odd, uint radius) const -> const HexFootprint*
+{
+    if (radius > MAX_RADIUS) {
+        return nullptr;
+    }
+
+    const auto& footprint = _radius[(odd ? MAX_RADIUS + 1 : 0) + radius];
+    return !footprint.RowMasks.empty() ? &footprint : nullptr;
+}
+
+auto HexFootprints::GetMove(bool odd, uchar dir, uint multihex) const -> const HexFootprint*
+{
+    if (multihex == 0 || multihex > MAX_MULTIHEX || dir >= _dirCount) {
+        return nullptr;
+    }
+
+    const auto& footprint = _move[((odd ? _dirCount : 0) + dir) * MAX_MULTIHEX + multihex - 1];
+    return !footprint.RowMasks.empty() ? &footprint : nullptr;
+}
@@ -0,0 +1,109 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+class GeometryHelper;
+
+// One bit per hex, rows start at word boundary and never set bits past map width
+class HexBitPlane final
+{
+public:
+    HexBitPlane() = default;
+    HexBitPlane(ushort width, ushort height);
+    HexBitPlane(const HexBitPlane&) = delete;
+    HexBitPlane(HexBitPlane&&) noexcept = default;
+    auto operator=(const HexBitPlane&) = delete;
+    auto operator=(HexBitPlane&&) noexcept -> HexBitPlane& = default;
+    ~HexBitPlane() = default;
+
+    [[nodiscard]] auto Get(ushort hx, ushort hy) const -> bool { return ((_words[hy * _rowWords + hx / 64] >> (hx % 64)) & 1u) != 0u; }
+    // Bits of hexes [hx, hx + count) in row hy, hexes outside of map give zero bits, count up to 64
+    [[nodiscard]] auto GetRowBits(int hx, int hy, uint count) const -> uint64;
+
+    void Set(ushort hx, ushort hy, bool value);
+
+private:
+    ushort _width {};
+    ushort _height {};
+    size_t _rowWords {};
+    vector<uint64> _words {};
+};
+
+// Hexes relative to origin hex packed to row masks, bit i of row r is hex (origin + MinX + i, origin + MinY + r)
+struct HexFootprint
+{
+    // True if no tested hex is set in plane, hexes outside of map are ignored
+    [[nodiscard]] auto IsFree(const HexBitPlane& plane, ushort hx, ushort hy) const -> bool;
+    // Same but all visited hexes must be inside of map
+    [[nodiscard]] auto IsFreeInside(const HexBitPlane& plane, ushort hx, ushort hy, ushort width, ushort height) const -> bool;
+
+    int MinX {};
+    int MinY {};
+    uint Width {};
+    vector<uint64> RowMasks {};
+    // Bounds of all hexes passed on the way, tested or not
+    int VisitMinX {};
+    int VisitMinY {};
+    int VisitMaxX {};
+    int VisitMaxY {};
+};
+
+// Footprints for radius checks and multihex moves, tables built once from geometry
+// Unsupported sizes return null and callers fall back to hex by hex checks
+class HexFootprints final
+{
+public:
+    static constexpr uint MAX_RADIUS = 31;
+    static constexpr uint MAX_MULTIHEX = 15;
+
+    HexFootprints() = delete;
+    HexFootprints(const GeometryHelper& geom_helper, bool hexagonal, uint dir_count);
+    HexFootprints(const HexFootprints&) = delete;
+    HexFootprints(HexFootprints&&) noexcept = delete;
+    auto operator=(const HexFootprints&) = delete;
+    auto operator=(HexFootprints&&) noexcept = delete;
+    ~HexFootprints() = default;
+
+    // Hex with all neighbors up to radius, like GeometryHelper::GetHexOffsets
+    [[nodiscard]] auto GetRadius(bool odd, uint radius) const -> const HexFootprint*;
+    // Hexes tested when multihex critter moves to hex in dir, like MapHexFlagsView::IsMovePassed
+    [[nodiscard]] auto GetMove(bool odd, uchar dir, uint multihex) const -> const HexFootprint*;
+
+private:
+    uint _dirCount;
+    vector<HexFootprint> _radius {};
+    vector<HexFootprint> _move {};
+};
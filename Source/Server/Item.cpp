@@ -34,8 +34,28 @@
 #include "Item.h"
 #include "CritterManager.h"
 #include "ItemManager.h"
+#include "MemoryPool.h"
 #include "Server.h"
 
+// Not destroyed at exit, last items may be released after static destruction
+static auto GetItemsPool() -> FixedSizePool&
+{
+    static auto* pool = new FixedSizePool(sizeof(Item), 256, AllocationSubsystem::Items);
+    return *pool;
+}
+
+auto Item::operator new(size_t size) -> void*
+{
+    RUNTIME_ASSERT(size == sizeof(Item));
+
+    return GetItemsPool().Allocate();
+}
+
+void Item::operator delete(void* ptr)
+{
+    GetItemsPool().Free(ptr);
+}
+
 Item::Item(FOServer* engine, uint id, const ProtoItem* proto) : ServerEntity(engine, id, engine->GetPropertyRegistrator(ENTITY_CLASS_NAME), proto), ItemProperties(GetInitRef())
 {
     RUNTIME_ASSERT(proto);
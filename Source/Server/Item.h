@@ -58,6 +58,10 @@ class Item final : public ServerEntity, public ItemProperties
     auto operator=(Item&&) noexcept = delete;
     ~Item() override = default;
 
+    // Pooled, items are created and destroyed in bulk
+    static auto operator new(size_t size) -> void*;
+    static void operator delete(void* ptr);
+
     [[nodiscard]] auto IsStatic() const -> bool { return GetIsStatic(); }
     [[nodiscard]] auto IsAnyScenery() const -> bool { return IsScenery() || IsWall(); }
     [[nodiscard]] auto IsScenery() const -> bool { return GetIsScenery(); }
@@ -49,6 +49,16 @@ Map::Map(FOServer* engine, uint id, const ProtoMap* proto, Location* location, c
     _hexFlagsSize = GetWidth() * GetHeight();
     _hexFlags = new uchar[_hexFlagsSize];
     std::memset(_hexFlags, 0, _hexFlagsSize);
+    _hexFlagsBandVersions.resize((GetHeight() + HEX_FLAGS_BAND_ROWS - 1) / HEX_FLAGS_BAND_ROWS);
+    _hexFlagsBands = MapHexFlagsView::MakeBands(_hexFlags, GetWidth(), GetHeight());
+
+    _noWayPlane = HexBitPlane(GetWidth(), GetHeight());
+    _noShootPlane = HexBitPlane(GetWidth(), GetHeight());
+    for (ushort hy = 0; hy < GetHeight(); hy++) {
+        for (ushort hx = 0; hx < GetWidth(); hx++) {
+            UpdateHexPlanes(hx, hy);
+        }
+    }
 }
 
 Map::~Map()
@@ -56,6 +66,35 @@ Map::~Map()
     delete[] _hexFlags;
 }
 
+auto Map::UpdateDormancy(uint process_period) -> bool
+{
+    // Returns true when map wakes up
+    const auto dormant = process_period != 0u && !_dormancyDisabled && _mapPlayerCritters.empty();
+    const auto woke_up = _isDormant && !dormant;
+
+    if (woke_up) {
+        for (auto* cr : _mapCritters) {
+            cr->DormantWakeTick = 0u;
+            _engine->EntityMngr.WakeCritter(cr);
+        }
+    }
+
+    _isDormant = dormant;
+    return woke_up;
+}
+
+auto Map::ProcessDormant(uint tick, uint process_period) -> bool
+{
+    // Low frequency tier, loop timers shorter than period are coarsened to it
+    if (tick - _dormantProcessTick < process_period) {
+        return false;
+    }
+
+    _dormantProcessTick = tick;
+    Process();
+    return true;
+}
+
 void Map::Process()
 {
     const auto tick = _engine->GameTime.GameTick();
@@ -179,6 +218,7 @@ void Map::AddCritter(Critter* cr)
         _mapNonPlayerCritters.push_back(cr);
     }
     _mapCritters.push_back(cr);
+    _crittersVersion++;
 
     SetFlagCritter(cr->GetHexX(), cr->GetHexY(), cr->GetMultihex(), cr->IsDead());
 
@@ -202,6 +242,7 @@ void Map::EraseCritter(Critter* cr)
     const auto it = std::find(_mapCritters.begin(), _mapCritters.end(), cr);
     RUNTIME_ASSERT(it != _mapCritters.end());
     _mapCritters.erase(it);
+    _crittersVersion++;
 
     cr->SetTimeoutBattle(0);
 }
@@ -621,32 +662,73 @@ auto Map::GetHexFlags(ushort hx, ushort hy) const -> ushort
     return hi | lo;
 }
 
+auto Map::GetHexFlagsView() const -> MapHexFlagsView
+{
+    return {GetWidth(), GetHeight(), GetStaticMap()->HexFlags, _hexFlagsBands.data()};
+}
+
 void Map::SetHexFlag(ushort hx, ushort hy, uchar flag)
 {
-    NON_CONST_METHOD_HINT();
+    const auto index = hy * GetWidth() + hx;
+    auto& flags = _hexFlags[index];
+    if (!IsBitSet(flags, flag)) {
+        SetBit(flags, flag);
+        _hexFlagsVersion++;
+        _hexFlagsBandVersions[hy / HEX_FLAGS_BAND_ROWS]++;
+        UpdateHexPlanes(hx, hy);
 
-    SetBit(_hexFlags[hy * GetWidth() + hx], flag);
+        if (_trackBlockChanges && IsBitSet(flag, static_cast<uchar>(FH_BLOCK_ITEM | FH_GAG_ITEM))) {
+            _blockChanges.push_back(index);
+        }
+    }
 }
 
 void Map::UnsetHexFlag(ushort hx, ushort hy, uchar flag)
 {
-    NON_CONST_METHOD_HINT();
+    const auto index = hy * GetWidth() + hx;
+    auto& flags = _hexFlags[index];
+    if (IsBitSet(flags, flag)) {
+        UnsetBit(flags, flag);
+        _hexFlagsVersion++;
+        _hexFlagsBandVersions[hy / HEX_FLAGS_BAND_ROWS]++;
+        UpdateHexPlanes(hx, hy);
 
-    UnsetBit(_hexFlags[hy * GetWidth() + hx], flag);
+        if (_trackBlockChanges && IsBitSet(flag, static_cast<uchar>(FH_BLOCK_ITEM | FH_GAG_ITEM))) {
+            _blockChanges.push_back(index);
+        }
+    }
+}
+
+void Map::UpdateHexPlanes(ushort hx, ushort hy)
+{
+    const auto flags = GetHexFlags(hx, hy);
+    _noWayPlane.Set(hx, hy, IsBitSet(flags, FH_NOWAY));
+    _noShootPlane.Set(hx, hy, IsBitSet(flags, FH_NOSHOOT));
+}
+
+void Map::SetBlockChangesTracking(bool enabled)
+{
+    _trackBlockChanges = enabled;
+    _blockChanges.clear();
 }
 
 auto Map::IsHexPassed(ushort hx, ushort hy) const -> bool
 {
-    return !IsBitSet(GetHexFlags(hx, hy), FH_NOWAY);
+    return !_noWayPlane.Get(hx, hy);
 }
 
 auto Map::IsHexRaked(ushort hx, ushort hy) const -> bool
 {
-    return !IsBitSet(GetHexFlags(hx, hy), FH_NOSHOOT);
+    return !_noShootPlane.Get(hx, hy);
 }
 
 auto Map::IsHexesPassed(ushort hx, ushort hy, uint radius) const -> bool
 {
+    // Whole radius at once
+    if (const auto* footprint = _engine->MapMngr.GetHexFootprints().GetRadius((hx % 2) != 0, radius); footprint != nullptr) {
+        return footprint->IsFree(_noWayPlane, hx, hy);
+    }
+
     // Base
     if (IsBitSet(GetHexFlags(hx, hy), FH_NOWAY)) {
         return false;
@@ -674,6 +756,40 @@ auto Map::IsHexesPassed(ushort hx, ushort hy, uint radius) const -> bool
 }
 
 auto Map::IsMovePassed(ushort hx, ushort hy, uchar dir, uint multihex) const -> bool
+{
+    if (multihex == 0u) {
+        return IsHexPassed(hx, hy);
+    }
+
+    if (const auto* footprint = _engine->MapMngr.GetHexFootprints().GetMove((hx % 2) != 0, dir, multihex); footprint != nullptr) {
+        return footprint->IsFreeInside(_noWayPlane, hx, hy, GetWidth(), GetHeight());
+    }
+
+    return GetHexFlagsView().IsMovePassed(_engine->GeomHelper, _engine->Settings.MapHexagonal, hx, hy, dir, multihex);
+}
+
+auto MapHexFlagsView::MakeBands(const uchar* dynamic_flags, ushort width, ushort height) -> vector<const uchar*>
+{
+    vector<const uchar*> bands;
+    for (uint hy = 0; hy < height; hy += BAND_ROWS) {
+        bands.push_back(dynamic_flags + hy * width);
+    }
+    return bands;
+}
+
+auto MapHexFlagsView::GetHexFlags(ushort hx, ushort hy) const -> ushort
+{
+    const auto hi = static_cast<ushort>(static_cast<ushort>(DynamicFlagsBands[hy / BAND_ROWS][hy % BAND_ROWS * Width + hx]) << 8);
+    const auto lo = static_cast<ushort>(StaticFlags[hy * Width + hx]);
+    return hi | lo;
+}
+
+auto MapHexFlagsView::IsHexPassed(ushort hx, ushort hy) const -> bool
+{
+    return !IsBitSet(GetHexFlags(hx, hy), NoWayMask);
+}
+
+auto MapHexFlagsView::IsMovePassed(const GeometryHelper& geom_helper, bool hexagonal, ushort hx, ushort hy, uchar dir, uint multihex) const -> bool
 {
     // Single hex
     if (multihex == 0u) {
@@ -681,13 +797,13 @@ auto Map::IsMovePassed(ushort hx, ushort hy, uchar dir, uint multihex) const ->
     }
 
     // Multihex
-    const auto map_width = GetWidth();
-    const auto map_height = GetHeight();
+    const auto map_width = Width;
+    const auto map_height = Height;
 
     int hx_ = hx;
     int hy_ = hy;
     for (uint k = 0; k < multihex; k++) {
-        if (!_engine->GeomHelper.MoveHexByDirUnsafe(hx_, hy_, dir, map_width, map_height)) {
+        if (!geom_helper.MoveHexByDirUnsafe(hx_, hy_, dir, map_width, map_height)) {
             return false;
         }
     }
@@ -695,11 +811,11 @@ auto Map::IsMovePassed(ushort hx, ushort hy, uchar dir, uint multihex) const ->
         return false;
     }
 
-    const auto is_square_corner = (!_engine->Settings.MapHexagonal && (dir % 2) != 0);
+    const auto is_square_corner = (!hexagonal && (dir % 2) != 0);
     const auto steps_count = (is_square_corner ? multihex * 2 : multihex);
 
     // Clock wise hexes
-    auto dir_cw = static_cast<uchar>(_engine->Settings.MapHexagonal ? (dir + 2) % 6 : (dir + 2) % 8);
+    auto dir_cw = static_cast<uchar>(hexagonal ? (dir + 2) % 6 : (dir + 2) % 8);
     if (is_square_corner) {
         dir_cw = (dir_cw + 1) % 8;
     }
@@ -707,7 +823,7 @@ auto Map::IsMovePassed(ushort hx, ushort hy, uchar dir, uint multihex) const ->
     auto hx_cw = hx_;
     auto hy_cw = hy_;
     for (uint k = 0; k < steps_count; k++) {
-        if (!_engine->GeomHelper.MoveHexByDirUnsafe(hx_cw, hy_cw, dir_cw, map_width, map_height)) {
+        if (!geom_helper.MoveHexByDirUnsafe(hx_cw, hy_cw, dir_cw, map_width, map_height)) {
             return false;
         }
         if (!IsHexPassed(static_cast<ushort>(hx_cw), static_cast<ushort>(hy_cw))) {
@@ -716,7 +832,7 @@ auto Map::IsMovePassed(ushort hx, ushort hy, uchar dir, uint multihex) const ->
     }
 
     // Counter clock wise hexes
-    auto dir_ccw = static_cast<uchar>(_engine->Settings.MapHexagonal ? (dir + 4) % 6 : (dir + 6) % 8);
+    auto dir_ccw = static_cast<uchar>(hexagonal ? (dir + 4) % 6 : (dir + 6) % 8);
     if (is_square_corner) {
         dir_ccw = (dir_ccw + 7) % 8;
     }
@@ -724,7 +840,7 @@ auto Map::IsMovePassed(ushort hx, ushort hy, uchar dir, uint multihex) const ->
     auto hx_ccw = hx_;
     auto hy_ccw = hy_;
     for (uint k = 0; k < steps_count; k++) {
-        if (!_engine->GeomHelper.MoveHexByDirUnsafe(hx_ccw, hy_ccw, dir_ccw, map_width, map_height)) {
+        if (!geom_helper.MoveHexByDirUnsafe(hx_ccw, hy_ccw, dir_ccw, map_width, map_height)) {
             return false;
         }
         if (!IsHexPassed(static_cast<ushort>(hx_ccw), static_cast<ushort>(hy_ccw))) {
@@ -37,6 +37,7 @@
 
 #include "EntityProperties.h"
 #include "EntityProtos.h"
+#include "HexBitPlane.h"
 #include "MapLoader.h"
 #include "ScriptSystem.h"
 #include "ServerEntity.h"
@@ -46,6 +47,26 @@ using StaticItem = Item;
 class Critter;
 class Map;
 class Location;
+class GeometryHelper;
+
+// Read only access to hex flags, static flags in low byte and dynamic flags in high byte
+// Dynamic flags are addressed by bands of rows, so snapshots may share unchanged bands
+struct MapHexFlagsView
+{
+    static constexpr ushort BAND_ROWS = 16;
+
+    [[nodiscard]] static auto MakeBands(const uchar* dynamic_flags, ushort width, ushort height) -> vector<const uchar*>;
+
+    [[nodiscard]] auto GetHexFlags(ushort hx, ushort hy) const -> ushort;
+    [[nodiscard]] auto IsHexPassed(ushort hx, ushort hy) const -> bool;
+    [[nodiscard]] auto IsMovePassed(const GeometryHelper& geom_helper, bool hexagonal, ushort hx, ushort hy, uchar dir, uint multihex) const -> bool;
+
+    ushort Width {};
+    ushort Height {};
+    const uchar* StaticFlags {};
+    const uchar* const* DynamicFlagsBands {};
+    ushort NoWayMask {FH_NOWAY};
+};
 
 struct StaticMap
 {
@@ -67,6 +88,8 @@ class Map final : public ServerEntity, public MapProperties
     friend class MapManager;
 
 public:
+    static constexpr ushort HEX_FLAGS_BAND_ROWS = MapHexFlagsView::BAND_ROWS;
+
     Map() = delete;
     Map(FOServer* engine, uint id, const ProtoMap* proto, Location* location, const StaticMap* static_map);
     Map(const Map&) = delete;
@@ -91,6 +114,12 @@ class Map final : public ServerEntity, public MapProperties
     [[nodiscard]] auto FindStartHex(ushort hx, ushort hy, uint multihex, uint seek_radius, bool skip_unsafe) const -> optional<tuple<ushort, ushort>>;
     [[nodiscard]] auto FindPlaceOnMap(ushort hx, ushort hy, Critter* cr, uint radius) const -> optional<tuple<ushort, ushort>>;
     [[nodiscard]] auto GetHexFlags(ushort hx, ushort hy) const -> ushort;
+    [[nodiscard]] auto GetHexFlagsVersion() const -> uint { return _hexFlagsVersion; }
+    [[nodiscard]] auto GetHexFlagsBandVersion(uint band) const -> uint { return _hexFlagsBandVersions[band]; }
+    [[nodiscard]] auto GetHexFlagsView() const -> MapHexFlagsView;
+    [[nodiscard]] auto GetCrittersVersion() const -> uint { return _crittersVersion; }
+    [[nodiscard]] auto GetNoShootPlane() const -> const HexBitPlane& { return _noShootPlane; }
+    [[nodiscard]] auto GetBlockChanges() const -> const vector<uint>& { return _blockChanges; }
     [[nodiscard]] auto IsHexPassed(ushort hx, ushort hy) const -> bool;
     [[nodiscard]] auto IsHexRaked(ushort hx, ushort hy) const -> bool;
     [[nodiscard]] auto IsHexesPassed(ushort hx, ushort hy, uint radius) const -> bool;
@@ -117,8 +146,13 @@ class Map final : public ServerEntity, public MapProperties
     [[nodiscard]] auto GetStaticItemsHex(ushort hx, ushort hy) -> vector<StaticItem*>;
     [[nodiscard]] auto GetStaticItemsHexEx(ushort hx, ushort hy, uint radius, hstring pid) -> vector<StaticItem*>;
     [[nodiscard]] auto GetStaticItemsByPid(hstring pid) -> vector<StaticItem*>;
+    [[nodiscard]] auto IsDormant() const -> bool { return _isDormant; }
+    [[nodiscard]] auto IsDormancyDisabled() const -> bool { return _dormancyDisabled; }
 
     void SetLocation(Location* loc);
+    void SetDormancyDisabled(bool disabled) { _dormancyDisabled = disabled; }
+    auto UpdateDormancy(uint process_period) -> bool;
+    auto ProcessDormant(uint tick, uint process_period) -> bool;
     void Process();
     void ProcessLoop(int index, uint time, uint tick);
     void PlaceItemBlocks(ushort hx, ushort hy, Item* item);
@@ -128,6 +162,7 @@ class Map final : public ServerEntity, public MapProperties
     void SetTextMsgLex(ushort hx, ushort hy, uint color, ushort text_msg, uint num_str, string_view lexems);
     void AddCritter(Critter* cr);
     void EraseCritter(Critter* cr);
+    void MarkCrittersChanged() { _crittersVersion++; }
     auto AddItem(Item* item, ushort hx, ushort hy) -> bool;
     void SetItem(Item* item, ushort hx, ushort hy);
     void EraseItem(uint item_id);
@@ -141,6 +176,8 @@ class Map final : public ServerEntity, public MapProperties
     void SetFlagCritter(ushort hx, ushort hy, uint multihex, bool dead);
     void UnsetFlagCritter(ushort hx, ushort hy, uint multihex, bool dead);
     void RecacheHexFlags(ushort hx, ushort hy);
+    void SetBlockChangesTracking(bool enabled);
+    void ClearBlockChanges() { _blockChanges.clear(); }
 
     ///@ ExportEvent
     ENTITY_EVENT(Finish);
@@ -158,9 +195,20 @@ class Map final : public ServerEntity, public MapProperties
     ENTITY_EVENT(CheckTrapLook, Critter* /*critter*/, Item* /*item*/);
 
 private:
+    void UpdateHexPlanes(ushort hx, ushort hy);
+
     const StaticMap* _staticMap {};
     uchar* _hexFlags {};
     int _hexFlagsSize {};
+    uint _hexFlagsVersion {};
+    vector<uint> _hexFlagsBandVersions {};
+    vector<const uchar*> _hexFlagsBands {};
+    uint _crittersVersion {};
+    // Combined static and dynamic FH_NOWAY / FH_NOSHOOT, kept in sync with hex flags
+    HexBitPlane _noWayPlane {};
+    HexBitPlane _noShootPlane {};
+    bool _trackBlockChanges {};
+    vector<uint> _blockChanges {};
     vector<Critter*> _mapCritters {};
     vector<Critter*> _mapPlayerCritters {};
     vector<Critter*> _mapNonPlayerCritters {};
@@ -170,4 +218,7 @@ class Map final : public ServerEntity, public MapProperties
     map<uint, vector<Item*>> _mapBlockLinesByHex {};
     Location* _mapLocation {};
     uint _loopLastTick[5] {};
+    bool _isDormant {};
+    bool _dormancyDisabled {};
+    uint _dormantProcessTick {};
 };
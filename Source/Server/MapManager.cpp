@@ -43,11 +43,17 @@
 #include "Server.h"
 #include "Settings.h"
 #include "StringUtils.h"
+#include "ThreadPool.h"
 
-MapManager::MapManager(FOServer* engine) : _engine {engine}
+MapManager::MapManager(FOServer* engine) : _engine {engine}, _hexFootprints(engine->GeomHelper, engine->Settings.MapHexagonal, engine->Settings.MapDirCount), _bulletTracer(engine->Settings)
 {
 }
 
+MapManager::~MapManager()
+{
+    _traceThreadPool.reset();
+}
+
 void MapManager::LinkMaps()
 {
     WriteLog("Link maps...");
@@ -738,6 +744,63 @@ void MapManager::DeleteLocation(Location* loc, vector<Critter*>* gmap_player_cri
     loc->Release();
 }
 
+void MapManager::TraceBullets(Map* map, const vector<BulletTraceRequest>& requests, vector<BulletTraceResult>& results)
+{
+    if (!_traceThreadPool && _engine->Settings.TraceBulletThreads != 0u) {
+        _traceThreadPool = std::make_unique<ThreadPool>(_engine->Settings.TraceBulletThreads);
+    }
+
+    _bulletTracer.Trace(map->GetNoShootPlane(), map->GetWidth(), map->GetHeight(), requests, results, _traceThreadPool.get());
+}
+
+void MapManager::TraceLooks(Map* map, ushort hx, ushort hy, const vector<Critter*>& critters, const std::function<uint(Critter*)>& get_look, LookTraceBatch& batch)
+{
+    batch.HexFlagsVersion = map->GetHexFlagsVersion();
+    batch.Requests.clear();
+    batch.RequestIndexes.assign(critters.size(), -1);
+
+    for (size_t i = 0; i < critters.size(); i++) {
+        auto* cr = critters[i];
+        if (cr->IsDestroyed() || (cr->GetHexX() == hx && cr->GetHexY() == hy)) {
+            continue;
+        }
+
+        // Dir and sneak modifiers only lower look distance, so farther pairs are never traced
+        const auto dist = _engine->GeomHelper.DistGame(hx, hy, cr->GetHexX(), cr->GetHexY());
+        if (dist > get_look(cr)) {
+            continue;
+        }
+
+        batch.RequestIndexes[i] = static_cast<int>(batch.Requests.size());
+        batch.Requests.push_back({hx, hy, cr->GetHexX(), cr->GetHexY(), dist, 0.0f});
+    }
+
+    if (!batch.Requests.empty()) {
+        TraceBullets(map, batch.Requests, batch.Results);
+    }
+}
+
+auto MapManager::IsLookTraced(Map* map, ushort hx, ushort hy, Critter* cr, size_t index, const LookTraceBatch& batch) -> bool
+{
+    // Batch is stale if callbacks moved someone or changed map blocks
+    if (index < batch.RequestIndexes.size() && batch.RequestIndexes[index] != -1 && map->GetHexFlagsVersion() == batch.HexFlagsVersion) {
+        const auto request_index = static_cast<size_t>(batch.RequestIndexes[index]);
+        const auto& request = batch.Requests[request_index];
+        if (request.BeginHx == hx && request.BeginHy == hy && request.EndHx == cr->GetHexX() && request.EndHy == cr->GetHexY()) {
+            return batch.Results[request_index].IsFullTrace;
+        }
+    }
+
+    TraceData trace;
+    trace.TraceMap = map;
+    trace.BeginHx = hx;
+    trace.BeginHy = hy;
+    trace.EndHx = cr->GetHexX();
+    trace.EndHy = cr->GetHexY();
+    TraceBullet(trace);
+    return trace.IsFullTrace;
+}
+
 void MapManager::TraceBullet(TraceData& trace)
 {
     NON_CONST_METHOD_HINT();
@@ -831,70 +894,77 @@ void MapManager::TraceBullet(TraceData& trace)
 
 static thread_local int MapGridOffsX = 0;
 static thread_local int MapGridOffsY = 0;
-static thread_local short* Grid = nullptr;
+static thread_local vector<short> Grid {};
 #define GRID(x, y) Grid[((FPATH_MAX_PATH + 1) + (y)-MapGridOffsY) * (FPATH_MAX_PATH * 2 + 2) + ((FPATH_MAX_PATH + 1) + (x)-MapGridOffsX)]
 
 auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
 {
-    // Allocate temporary grid
-    if (Grid == nullptr) {
-        Grid = new short[(FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2)];
-    }
-
-    // Data
-    auto map_id = pfd.MapId;
-    auto from_hx = pfd.FromX;
-    auto from_hy = pfd.FromY;
-    auto to_hx = pfd.ToX;
-    auto to_hy = pfd.ToY;
-    auto multihex = pfd.Multihex;
-    auto cut = pfd.Cut;
-    auto trace = pfd.Trace;
-    auto is_run = pfd.IsRun;
-    auto check_cr = pfd.CheckCrit;
-    auto check_gag_items = pfd.CheckGagItems;
-    auto dirs_count = _engine->Settings.MapDirCount;
-
     FindPathOutput output;
 
-    // Checks
-    if (trace != 0u && pfd.TraceCr == nullptr) {
+    if (pfd.Trace != 0u && pfd.TraceCr == nullptr) {
         output.Result = FindPathResult::TraceTargetNullptr;
         return output;
     }
 
-    auto* map = GetMap(map_id);
+    auto* map = GetMap(pfd.MapId);
     if (map == nullptr) {
         output.Result = FindPathResult::MapNotFound;
         return output;
     }
 
-    const auto maxhx = map->GetWidth();
-    const auto maxhy = map->GetHeight();
+    output = FindPathSteps(pfd, map->GetHexFlagsView(), _engine->Settings, _engine->GeomHelper, _smoothSwitcher);
+    if (output.Result == FindPathResult::Ok) {
+        FinishFindPath(pfd, map, output);
+    }
+    return output;
+}
+
+auto MapManager::FindPathSteps(const FindPathInput& pfd, const MapHexFlagsView& hex_flags, const GeometrySettings& settings, const GeometryHelper& geom_helper, bool& smooth_switcher) -> FindPathOutput
+{
+    // Allocate temporary grid
+    if (Grid.empty()) {
+        Grid.resize((FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2));
+    }
+
+    // Data
+    const auto from_hx = pfd.FromX;
+    const auto from_hy = pfd.FromY;
+    const auto to_hx = pfd.ToX;
+    const auto to_hy = pfd.ToY;
+    const auto multihex = pfd.Multihex;
+    const auto cut = pfd.Cut;
+    const auto check_cr = pfd.CheckCrit;
+    const auto check_gag_items = pfd.CheckGagItems;
+    const auto dirs_count = settings.MapDirCount;
+
+    FindPathOutput output;
+
+    const auto maxhx = hex_flags.Width;
+    const auto maxhy = hex_flags.Height;
 
     if (from_hx >= maxhx || from_hy >= maxhy || to_hx >= maxhx || to_hy >= maxhy) {
         output.Result = FindPathResult::InvalidHexes;
         return output;
     }
-    if (_engine->GeomHelper.CheckDist(from_hx, from_hy, to_hx, to_hy, cut)) {
+    if (geom_helper.CheckDist(from_hx, from_hy, to_hx, to_hy, cut)) {
         output.Result = FindPathResult::AlreadyHere;
         return output;
     }
-    if (cut == 0u && IsBitSet(map->GetHexFlags(to_hx, to_hy), FH_NOWAY)) {
+    if (cut == 0u && IsBitSet(hex_flags.GetHexFlags(to_hx, to_hy), FH_NOWAY)) {
         output.Result = FindPathResult::HexBusy;
         return output;
     }
 
     // Ring check
     if (cut <= 1u && multihex == 0u) {
-        auto [rsx, rsy] = _engine->GeomHelper.GetHexOffsets((to_hx % 2) != 0);
+        auto [rsx, rsy] = geom_helper.GetHexOffsets((to_hx % 2) != 0);
 
         auto i = 0;
         for (; i < dirs_count; i++, rsx++, rsy++) {
             const auto xx = static_cast<int>(to_hx + *rsx);
             const auto yy = static_cast<int>(to_hy + *rsy);
             if (xx >= 0 && xx < maxhx && yy >= 0 && yy < maxhy) {
-                const auto flags = map->GetHexFlags(static_cast<ushort>(xx), static_cast<ushort>(yy));
+                const auto flags = hex_flags.GetHexFlags(static_cast<ushort>(xx), static_cast<ushort>(yy));
                 if (IsBitSet(flags, static_cast<ushort>(FH_GAG_ITEM << 8))) {
                     break;
                 }
@@ -933,7 +1003,7 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
     MapGridOffsY = from_hy;
 
     short numindex = 1;
-    std::memset(Grid, 0, (FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2) * sizeof(short));
+    std::fill(Grid.begin(), Grid.end(), static_cast<short>(0));
     GRID(from_hx, from_hy) = numindex;
 
     vector<pair<ushort, ushort>> coords;
@@ -957,7 +1027,7 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
             cy = coords[p].second;
             numindex = GRID(cx, cy);
 
-            if (_engine->GeomHelper.CheckDist(cx, cy, to_hx, to_hy, cut)) {
+            if (geom_helper.CheckDist(cx, cy, to_hx, to_hy, cut)) {
                 goto label_FindOk;
             }
             if (++numindex > FPATH_MAX_PATH) {
@@ -965,7 +1035,7 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
                 return output;
             }
 
-            const auto [sx, sy] = _engine->GeomHelper.GetHexOffsets((cx & 1) != 0);
+            const auto [sx, sy] = geom_helper.GetHexOffsets((cx & 1) != 0);
 
             for (auto j = 0; j < dirs_count; j++) {
                 const auto nxi = cx + sx[j];
@@ -982,7 +1052,7 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
                 }
 
                 if (multihex == 0u) {
-                    auto flags = map->GetHexFlags(nx, ny);
+                    auto flags = hex_flags.GetHexFlags(nx, ny);
                     if (!IsBitSet(flags, FH_NOWAY)) {
                         coords.emplace_back(nx, ny);
                         grid_cell = numindex;
@@ -1031,7 +1101,7 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
                        }
                      */
 
-                    if (map->IsMovePassed(nx, ny, static_cast<uchar>(j), multihex)) {
+                    if (hex_flags.IsMovePassed(geom_helper, settings.MapHexagonal, nx, ny, static_cast<uchar>(j), multihex)) {
                         coords.emplace_back(nx, ny);
                         grid_cell = numindex;
                     }
@@ -1085,13 +1155,13 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
     steps.resize(static_cast<size_t>(numindex - 1));
 
     // Smooth data
-    if (!_engine->Settings.MapSmoothPath) {
-        _smoothSwitcher = false;
+    if (!settings.MapSmoothPath) {
+        smooth_switcher = false;
     }
 
     auto smooth_count = 0;
     auto smooth_iteration = 0;
-    if (_engine->Settings.MapSmoothPath && !_engine->Settings.MapHexagonal) {
+    if (settings.MapSmoothPath && !settings.MapHexagonal) {
         int x1 = cx;
         int y1 = cy;
         int x2 = from_hx;
@@ -1117,14 +1187,14 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
     }
 
     while (numindex > 1) {
-        if (_engine->Settings.MapSmoothPath) {
-            if (_engine->Settings.MapHexagonal) {
+        if (settings.MapSmoothPath) {
+            if (settings.MapHexagonal) {
                 if ((numindex & 1) != 0) {
-                    _smoothSwitcher = !_smoothSwitcher;
+                    smooth_switcher = !smooth_switcher;
                 }
             }
             else {
-                _smoothSwitcher = smooth_count < 2 || smooth_iteration % smooth_count != 0;
+                smooth_switcher = smooth_count < 2 || smooth_iteration % smooth_count != 0;
             }
         }
 
@@ -1132,7 +1202,7 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
         auto& ps = steps[numindex - 1];
         ps.HexX = cx;
         ps.HexY = cy;
-        const auto dir = FindPathGrid(cx, cy, numindex, _smoothSwitcher);
+        const auto dir = FindPathGrid(cx, cy, numindex, settings, smooth_switcher);
         if (dir == std::numeric_limits<uchar>::max()) {
             output.Result = FindPathResult::InternalError;
             return output;
@@ -1142,6 +1212,19 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
         smooth_iteration++;
     }
 
+    output.Result = FindPathResult::Ok;
+    return output;
+}
+
+void MapManager::FinishFindPath(const FindPathInput& pfd, Map* map, FindPathOutput& output)
+{
+    RUNTIME_ASSERT(output.Result == FindPathResult::Ok);
+
+    const auto trace = pfd.Trace;
+    const auto check_cr = pfd.CheckCrit;
+    const auto check_gag_items = pfd.CheckGagItems;
+    auto& steps = output.Steps;
+
     // Check for closed door and critter
     if (check_cr || check_gag_items) {
         for (auto i = 0, j = static_cast<int>(steps.size()); i < j; i++) {
@@ -1224,7 +1307,7 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
 
         if (!trace_ok && output.GagItem == nullptr && output.GagCritter == nullptr) {
             output.Result = FindPathResult::TraceFailed;
-            return output;
+            return;
         }
 
     label_TraceOk:
@@ -1235,12 +1318,12 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
     }
 
     // Parse move params
-    PathSetMoveParams(steps, is_run);
+    PathSetMoveParams(steps, pfd.IsRun);
 
     // Number of path
     if (steps.empty()) {
         output.Result = FindPathResult::AlreadyHere;
-        return output;
+        return;
     }
 
     // New X,Y
@@ -1248,13 +1331,12 @@ auto MapManager::FindPath(const FindPathInput& pfd) -> FindPathOutput
     output.NewToX = ps.HexX;
     output.NewToY = ps.HexY;
     output.Result = FindPathResult::Ok;
-    return output;
 }
 
-auto MapManager::FindPathGrid(ushort& hx, ushort& hy, int index, bool smooth_switcher) const -> uchar
+auto MapManager::FindPathGrid(ushort& hx, ushort& hy, int index, const GeometrySettings& settings, bool smooth_switcher) -> uchar
 {
     // Hexagonal
-    if (_engine->Settings.MapHexagonal) {
+    if (settings.MapHexagonal) {
         if (smooth_switcher) {
             if ((hx & 1) != 0) {
                 if (GRID(hx - 1, hy - 1) == index) {
@@ -1375,7 +1457,7 @@ auto MapManager::FindPathGrid(ushort& hx, ushort& hy, int index, bool smooth_swi
     // Square
     else {
         // Without smoothing
-        if (!_engine->Settings.MapSmoothPath) {
+        if (!settings.MapSmoothPath) {
             if (GRID(hx - 1, hy) == index) {
                 hx--;
                 return 0u;
@@ -1675,6 +1757,9 @@ void MapManager::AddCrToMap(Critter* cr, Map* map, ushort hx, ushort hy, uchar d
     cr->SetTimeoutBattle(0);
     cr->SetTimeoutTransfer(_engine->GameTime.GetFullSecond() + _engine->Settings.TimeoutTransfer);
 
+    // Dormancy tier is chosen again for new map
+    _engine->EntityMngr.WakeCritter(cr);
+
     if (map != nullptr) {
         RUNTIME_ASSERT(hx < map->GetWidth() && hy < map->GetHeight());
 
@@ -1722,6 +1807,8 @@ void MapManager::AddCrToMap(Critter* cr, Map* map, ushort hx, ushort hy, uchar d
             cr->GlobalMapGroup->push_back(cr);
         }
 
+        _engine->CrMngr.AddToGlobalMapGrid(cr);
+
         _engine->OnGlobalMapCritterIn.Fire(cr);
     }
 
@@ -1752,6 +1839,8 @@ void MapManager::EraseCrFromMap(Critter* cr, Map* map)
 
         _engine->OnGlobalMapCritterOut.Fire(cr);
 
+        _engine->CrMngr.RemoveFromGlobalMapGrid(cr);
+
         const auto it = std::find(cr->GlobalMapGroup->begin(), cr->GlobalMapGroup->end(), cr);
         cr->GlobalMapGroup->erase(it);
 
@@ -1820,8 +1909,15 @@ void MapManager::ProcessVisibleCritters(Critter* view_cr)
     const auto show_cr3 = show_cr_dist3 > 0;
     const auto show_cr = (show_cr1 || show_cr2 || show_cr3);
     const auto sneak_base_self = view_cr->GetSneakCoefficient();
+    const auto critters = map->GetCritters();
+
+    LookTraceBatch trace_batch;
+    if (IsBitSet(_engine->Settings.LookChecks, LOOK_CHECK_TRACE) && !IsBitSet(_engine->Settings.LookChecks, LOOK_CHECK_SCRIPT)) {
+        TraceLooks(map, view_cr->GetHexX(), view_cr->GetHexY(), critters, [look_base_self](Critter* cr) { return std::max(look_base_self, cr->GetLookDistance()); }, trace_batch);
+    }
 
-    for (auto* cr : map->GetCritters()) {
+    for (size_t cr_index = 0; cr_index < critters.size(); cr_index++) {
+        auto* cr = critters[cr_index];
         if (cr == view_cr || cr->IsDestroyed()) {
             continue;
         }
@@ -1967,14 +2063,7 @@ void MapManager::ProcessVisibleCritters(Critter* view_cr)
 
         // Trace
         if (IsBitSet(_engine->Settings.LookChecks, LOOK_CHECK_TRACE) && dist != std::numeric_limits<uint>::max()) {
-            TraceData trace;
-            trace.TraceMap = map;
-            trace.BeginHx = view_cr->GetHexX();
-            trace.BeginHy = view_cr->GetHexY();
-            trace.EndHx = cr->GetHexX();
-            trace.EndHy = cr->GetHexY();
-            TraceBullet(trace);
-            if (!trace.IsFullTrace) {
+            if (!IsLookTraced(map, view_cr->GetHexX(), view_cr->GetHexY(), cr, cr_index, trace_batch)) {
                 dist = std::numeric_limits<uint>::max();
             }
         }
@@ -2196,7 +2285,15 @@ void MapManager::ViewMap(Critter* view_cr, Map* map, uint look, ushort hx, ushor
 
     // Critters
     const auto dirs_count = _engine->Settings.MapDirCount;
-    for (auto* cr : map->GetCritters()) {
+    const auto critters = map->GetCritters();
+
+    LookTraceBatch trace_batch;
+    if (IsBitSet(_engine->Settings.LookChecks, LOOK_CHECK_TRACE) && !IsBitSet(_engine->Settings.LookChecks, LOOK_CHECK_SCRIPT)) {
+        TraceLooks(map, hx, hy, critters, [look](Critter*) { return look; }, trace_batch);
+    }
+
+    for (size_t cr_index = 0; cr_index < critters.size(); cr_index++) {
+        auto* cr = critters[cr_index];
         if (cr == view_cr || cr->IsDestroyed()) {
             continue;
         }
@@ -2227,14 +2324,7 @@ void MapManager::ViewMap(Critter* view_cr, Map* map, uint look, ushort hx, ushor
 
         // Trace
         if (IsBitSet(_engine->Settings.LookChecks, LOOK_CHECK_TRACE) && dist != std::numeric_limits<uint>::max()) {
-            TraceData trace;
-            trace.TraceMap = map;
-            trace.BeginHx = hx;
-            trace.BeginHy = hy;
-            trace.EndHx = cr->GetHexX();
-            trace.EndHy = cr->GetHexY();
-            TraceBullet(trace);
-            if (!trace.IsFullTrace) {
+            if (!IsLookTraced(map, hx, hy, cr, cr_index, trace_batch)) {
                 continue;
             }
         }
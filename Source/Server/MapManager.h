@@ -35,10 +35,12 @@
 
 #include "Common.h"
 
+#include "BulletTracer.h"
 #include "Critter.h"
 #include "Entity.h"
 #include "FileSystem.h"
 #include "GeometryHelper.h"
+#include "HexBitPlane.h"
 #include "Item.h"
 #include "Location.h"
 #include "Map.h"
@@ -82,6 +84,15 @@ struct TraceData
     bool IsHaveLastPassed {};
 };
 
+// Shoot through look traces from one hex to map critters, made in one BulletTracer call
+struct LookTraceBatch
+{
+    uint HexFlagsVersion {};
+    vector<BulletTraceRequest> Requests {};
+    vector<BulletTraceResult> Results {};
+    vector<int> RequestIndexes {}; // Per critter, -1 if not in batch
+};
+
 struct FindPathInput
 {
     uint MapId {};
@@ -137,7 +148,7 @@ class MapManager final
     MapManager(MapManager&&) noexcept = delete;
     auto operator=(const MapManager&) = delete;
     auto operator=(MapManager&&) noexcept = delete;
-    ~MapManager() = default;
+    ~MapManager();
 
     [[nodiscard]] auto FindStaticMap(const ProtoMap* proto_map) const -> const StaticMap*;
     [[nodiscard]] auto GetLocation(uint loc_id) -> Location*;
@@ -156,7 +167,11 @@ class MapManager final
     [[nodiscard]] auto CheckKnownLoc(Critter* cr, uint loc_id) const -> bool;
     [[nodiscard]] auto CanAddCrToMap(Critter* cr, Map* map, ushort hx, ushort hy, uint leader_id) const -> bool;
     [[nodiscard]] auto FindPath(const FindPathInput& pfd) -> FindPathOutput;
+    // Grid search part of FindPath, touches only hex flags and may be called from any thread
+    [[nodiscard]] static auto FindPathSteps(const FindPathInput& pfd, const MapHexFlagsView& hex_flags, const GeometrySettings& settings, const GeometryHelper& geom_helper, bool& smooth_switcher) -> FindPathOutput;
     [[nodiscard]] auto GetLocationAndMapsStatistics() const -> string;
+    [[nodiscard]] auto GetHexFootprints() const -> const HexFootprints& { return _hexFootprints; }
+    [[nodiscard]] auto GetBulletTracerStatistics() const -> const BulletTracer::Statistics& { return _bulletTracer.GetStatistics(); }
 
     [[nodiscard]] auto CreateLocation(hstring proto_id, ushort wx, ushort wy) -> Location*;
     [[nodiscard]] auto CreateMap(hstring proto_id, Location* loc) -> Map*;
@@ -167,12 +182,15 @@ class MapManager final
     void LocationGarbager();
     void RegenerateMap(Map* map);
     void TraceBullet(TraceData& trace);
+    // Batched TraceBullet for shoot through checks only, no critters or callbacks
+    void TraceBullets(Map* map, const vector<BulletTraceRequest>& requests, vector<BulletTraceResult>& results);
     void AddCrToMap(Critter* cr, Map* map, ushort hx, ushort hy, uchar dir, uint leader_id);
     void EraseCrFromMap(Critter* cr, Map* map);
     auto TransitToGlobal(Critter* cr, uint leader_id, bool force) -> bool;
     auto Transit(Critter* cr, Map* map, ushort hx, ushort hy, uchar dir, uint radius, uint leader_id, bool force) -> bool;
     void KickPlayersToGlobalMap(Map* map);
     void PathSetMoveParams(vector<PathStep>& path, bool is_run);
+    void FinishFindPath(const FindPathInput& pfd, Map* map, FindPathOutput& output);
     void ProcessVisibleCritters(Critter* view_cr);
     void ProcessVisibleItems(Critter* view_cr);
     void ViewMap(Critter* view_cr, Map* map, uint look, ushort hx, ushort hy, int dir);
@@ -180,13 +198,19 @@ class MapManager final
     void EraseKnownLoc(Critter* cr, uint loc_id);
 
 private:
-    [[nodiscard]] auto FindPathGrid(ushort& hx, ushort& hy, int index, bool smooth_switcher) const -> uchar;
+    [[nodiscard]] static auto FindPathGrid(ushort& hx, ushort& hy, int index, const GeometrySettings& settings, bool smooth_switcher) -> uchar;
+
+    [[nodiscard]] auto IsLookTraced(Map* map, ushort hx, ushort hy, Critter* cr, size_t index, const LookTraceBatch& batch) -> bool;
 
+    void TraceLooks(Map* map, ushort hx, ushort hy, const vector<Critter*>& critters, const std::function<uint(Critter*)>& get_look, LookTraceBatch& batch);
     void LoadStaticMap(FileSystem& file_sys, const ProtoMap* pmap);
     void GenerateMapContent(Map* map);
     void DeleteMapContent(Map* map);
 
     FOServer* _engine;
+    HexFootprints _hexFootprints;
+    BulletTracer _bulletTracer;
+    unique_ptr<ThreadPool> _traceThreadPool {};
     bool _runGarbager {true};
     bool _smoothSwitcher {};
     map<const ProtoMap*, StaticMap> _staticMaps {};
@@ -38,6 +38,7 @@
 #if !FO_SINGLEPLAYER
 
 #include "Log.h"
+#include "NetCodec.h"
 #include "Settings.h"
 #include "StringUtils.h"
 #include "Timer.h"
@@ -65,8 +66,6 @@ using web_sockets_no_tls = websocketpp::server<websocketpp::config::asio>;
 using ssl_context = asio::ssl::context;
 #endif
 
-#include "zlib.h"
-
 #include "WinApi-Include.h" // After all because ASIO using WinAPI
 
 void NetConnection::AddRef() const
@@ -82,11 +81,39 @@ void NetConnection::Release() const
 }
 
 #if FO_HAVE_ASIO
+// Codec setup shared by all connections, made at server start
+struct NetTransportSetup
+{
+    NetCodecType Codec {};
+    vector<uchar> Dictionary {};
+    uint DictionaryHash {};
+    unique_ptr<NetTrafficCapture> Capture {};
+};
+
+static auto GetTransportSetup(const ServerNetworkSettings& settings) -> NetTransportSetup&
+{
+    static NetTransportSetup setup = [&settings] {
+        NetTransportSetup new_setup;
+        new_setup.Codec = NetCodec::ParseType(settings.NetCodec);
+        new_setup.Dictionary = NetCodec::LoadDictionary(settings.NetCodecDictionary);
+        new_setup.DictionaryHash = NetCodec::GetDictionaryHash(new_setup.Dictionary);
+        if (new_setup.Codec == NetCodecType::ZlibDictionary && new_setup.Dictionary.empty()) {
+            throw NetCodecException("Net codec dictionary not specified");
+        }
+        if (!settings.NetTrafficCapture.empty()) {
+            new_setup.Capture = std::make_unique<NetTrafficCapture>(settings.NetTrafficCapture);
+        }
+        return new_setup;
+    }();
+
+    return setup;
+}
+
 class NetTcpServer : public NetServerBase
 {
 public:
     NetTcpServer() = delete;
-    NetTcpServer(ServerNetworkSettings& settings, ConnectionCallback callback);
+    NetTcpServer(ServerNetworkSettings& settings, ConnectionCallback callback, InputCallback input_callback);
     NetTcpServer(const NetTcpServer&) = delete;
     NetTcpServer(NetTcpServer&&) noexcept = delete;
     auto operator=(const NetTcpServer&) = delete;
@@ -104,6 +131,7 @@ class NetTcpServer : public NetServerBase
     asio::io_service _ioService {};
     asio::ip::tcp::acceptor _acceptor;
     ConnectionCallback _connectionCallback {};
+    InputCallback _inputCallback {};
     std::thread _runThread {};
 };
 
@@ -111,7 +139,7 @@ class NetNoTlsWebSocketsServer : public NetServerBase
 {
 public:
     NetNoTlsWebSocketsServer() = delete;
-    NetNoTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback);
+    NetNoTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback, InputCallback input_callback);
     NetNoTlsWebSocketsServer(const NetNoTlsWebSocketsServer&) = delete;
     NetNoTlsWebSocketsServer(NetNoTlsWebSocketsServer&&) noexcept = delete;
     auto operator=(const NetNoTlsWebSocketsServer&) = delete;
@@ -127,6 +155,7 @@ class NetNoTlsWebSocketsServer : public NetServerBase
 
     ServerNetworkSettings& _settings;
     ConnectionCallback _connectionCallback {};
+    InputCallback _inputCallback {};
     web_sockets_no_tls _server {};
     std::thread _runThread {};
 };
@@ -135,7 +164,7 @@ class NetTlsWebSocketsServer : public NetServerBase
 {
 public:
     NetTlsWebSocketsServer() = delete;
-    NetTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback);
+    NetTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback, InputCallback input_callback);
     NetTlsWebSocketsServer(const NetTlsWebSocketsServer&) = delete;
     NetTlsWebSocketsServer(NetTlsWebSocketsServer&&) noexcept = delete;
     auto operator=(const NetTlsWebSocketsServer&) = delete;
@@ -152,6 +181,7 @@ class NetTlsWebSocketsServer : public NetServerBase
 
     ServerNetworkSettings& _settings;
     ConnectionCallback _connectionCallback {};
+    InputCallback _inputCallback {};
     web_sockets_tls _server {};
     std::thread _runThread {};
 };
@@ -159,19 +189,13 @@ class NetTlsWebSocketsServer : public NetServerBase
 class NetConnectionImpl : public NetConnection
 {
 public:
-    explicit NetConnectionImpl(ServerNetworkSettings& settings) : _settings {settings}
+    NetConnectionImpl(ServerNetworkSettings& settings, NetServerBase::InputCallback input_callback) : NetConnection(settings.InMessagesQueueSize), _settings {settings}, _inputCallback {std::move(input_callback)}
     {
-        std::memset(_outBuf, 0, sizeof(_outBuf));
+        static std::atomic_uint connections_counter;
+        _connectionId = ++connections_counter;
 
-        if (!settings.DisableZlibCompression) {
-            _zStream = new z_stream();
-            _zStream->zalloc = [](void*, unsigned int items, unsigned int size) { return calloc(items, size); };
-            _zStream->zfree = [](void*, void* address) { free(address); };
-            _zStream->opaque = nullptr;
-
-            const auto result = deflateInit(_zStream, Z_BEST_SPEED);
-            RUNTIME_ASSERT(result == Z_OK);
-        }
+        // Raw output until handshake
+        _codec = NetCodec::Create(NetCodecType::None, {});
     }
 
     NetConnectionImpl() = delete;
@@ -180,27 +204,13 @@ class NetConnectionImpl : public NetConnection
     auto operator=(const NetConnectionImpl&) = delete;
     auto operator=(NetConnectionImpl&&) noexcept = delete;
 
-    ~NetConnectionImpl() override
-    {
-        if (_zStream != nullptr) {
-            deflateEnd(_zStream);
-            delete _zStream;
-        }
-    }
+    ~NetConnectionImpl() override = default;
 
     [[nodiscard]] auto GetIp() const -> uint override { return _ip; }
     [[nodiscard]] auto GetHost() const -> string_view override { return _host; }
     [[nodiscard]] auto GetPort() const -> ushort override { return _port; }
     [[nodiscard]] auto IsDisconnected() const -> bool override { return _isDisconnected; }
 
-    void DisableCompression() override
-    {
-        if (_zStream != nullptr) {
-            deflateEnd(_zStream);
-            delete _zStream;
-        }
-    }
-
     void Dispatch() override
     {
         if (_isDisconnected) {
@@ -239,38 +249,25 @@ class NetConnectionImpl : public NetConnection
             return nullptr;
         }
 
-        // Compress
-        if (_zStream != nullptr) {
-            auto to_compr = Bout.GetEndPos();
-            if (to_compr > sizeof(_outBuf) - 32) {
-                to_compr = sizeof(_outBuf) - 32;
-            }
-
-            _zStream->next_in = Bout.GetData();
-            _zStream->avail_in = to_compr;
-            _zStream->next_out = _outBuf;
-            _zStream->avail_out = sizeof(_outBuf);
-
-            const auto result = deflate(_zStream, Z_SYNC_FLUSH);
-            RUNTIME_ASSERT(result == Z_OK);
-
-            const auto compr = static_cast<uint>(_zStream->next_out - _outBuf);
-            const auto real = static_cast<uint>(_zStream->next_in - Bout.GetData());
-            out_len = compr;
+        // Handshake answer is last output of previous codec
+        auto len = std::min(Bout.GetEndPos(), NetBuffer::DEFAULT_BUF_SIZE);
+        if (_nextCodec) {
+            len = std::min(len, _codecSwitchPos);
+        }
 
-            Bout.Cut(real);
+        if (auto* capture = GetTransportSetup(_settings).Capture.get(); capture != nullptr) {
+            capture->Write(_connectionId, Bout.GetData(), len);
         }
-        // Without compressing
-        else {
-            auto len = Bout.GetEndPos();
-            if (len > sizeof(_outBuf)) {
-                len = sizeof(_outBuf);
-            }
 
-            std::memcpy(_outBuf, Bout.GetData(), len);
-            out_len = len;
+        _outBuf.clear();
+        _codec->Encode(Bout.GetData(), len, _outBuf);
+        Bout.Cut(len);
 
-            Bout.Cut(len);
+        if (_nextCodec) {
+            _codecSwitchPos -= len;
+            if (_codecSwitchPos == 0u) {
+                _codec = std::move(_nextCodec);
+            }
         }
 
         // Normalize buffer size
@@ -278,21 +275,136 @@ class NetConnectionImpl : public NetConnection
             Bout.ResetBuf();
         }
 
+        out_len = static_cast<uint>(_outBuf.size());
         RUNTIME_ASSERT(out_len > 0);
-        return _outBuf;
+        return _outBuf.data();
     }
 
     void ReceiveCallback(const uchar* buf, uint len)
     {
-        std::lock_guard locker(BinLocker);
+        {
+            std::lock_guard locker(BinLocker);
 
-        if (Bin.GetReadPos() + len < _settings.FloodSize) {
-            Bin.AddData(buf, len);
+            if (Bin.GetReadPos() + len < _settings.FloodSize) {
+                Bin.AddData(buf, len);
+                ParseInput();
+            }
+            else {
+                Bin.ResetBuf();
+                Disconnect();
+            }
         }
-        else {
-            Bin.ResetBuf();
+
+        if (_handshakeAnswered) {
+            _handshakeAnswered = false;
+            Dispatch();
+        }
+
+        if (_inputCallback) {
+            _inputCallback();
+        }
+    }
+
+    // Malformed clients are dropped here and never reach server loop
+    void ParseInput()
+    {
+        NetInMessage message;
+
+        while (!_isDisconnected && Bin.CutMsg(message)) {
+            // Handshake messages switch encryption of following input
+            switch (message.Msg) {
+            case NETMSG_HANDSHAKE:
+                if (!SetupTransport(message)) {
+                    WriteLog("Wrong handshake from host '{}'", _host);
+                    Disconnect();
+                    return;
+                }
+                continue;
+            case NETMSG_UPDATE: {
+                NetInBuffer update_buf;
+                update_buf.SetMsg(message);
+                uint msg = 0;
+                ushort proto_ver = 0;
+                uint encrypt_key = 0;
+                update_buf >> msg;
+                update_buf >> proto_ver;
+                update_buf >> encrypt_key;
+                Bin.SetEncryptKey(encrypt_key);
+            } break;
+            case NETMSG_REGISTER:
+                Bin.SetEncryptKey(1234567890);
+                break;
+            case NETMSG_LOGIN:
+                Bin.SetEncryptKey(12345);
+                break;
+            default:
+                break;
+            }
+
+            if (!InMessages.Push(std::move(message))) {
+                WriteLog("Input messages overflow from host '{}'", _host);
+                Bin.ResetBuf();
+                Disconnect();
+                return;
+            }
+        }
+
+        if (Bin.IsError()) {
+            WriteLog("Wrong network data from host '{}'", _host);
             Disconnect();
+            return;
+        }
+
+        Bin.ShrinkReadBuf();
+    }
+
+    // Client asks codecs it can decode, server takes configured one or falls back to plain zlib
+    auto SetupTransport(const NetInMessage& message) -> bool
+    {
+        if (_handshaked) {
+            return false;
         }
+
+        _handshaked = true;
+
+        NetInBuffer handshake_buf;
+        handshake_buf.SetMsg(message);
+        uint msg = 0;
+        uchar codecs = 0;
+        uint dictionary_hash = 0;
+        bool key_stream = false;
+        handshake_buf >> msg;
+        handshake_buf >> codecs;
+        handshake_buf >> dictionary_hash;
+        handshake_buf >> key_stream;
+
+        const auto& setup = GetTransportSetup(_settings);
+        const auto is_acceptable = [&](NetCodecType type) {
+            if ((codecs & (1u << static_cast<uint>(type))) == 0u) {
+                return false;
+            }
+            return type != NetCodecType::ZlibDictionary || dictionary_hash == setup.DictionaryHash;
+        };
+
+        auto codec = setup.Codec;
+        if (!is_acceptable(codec)) {
+            codec = is_acceptable(NetCodecType::Zlib) ? NetCodecType::Zlib : NetCodecType::None;
+        }
+
+        Bin.SetEncryptDisabled(!key_stream);
+
+        std::lock_guard locker(BoutLocker);
+
+        Bout.SetEncryptDisabled(!key_stream);
+        Bout << NETMSG_HANDSHAKE;
+        Bout << static_cast<uchar>(codec);
+        Bout << setup.DictionaryHash;
+        Bout << key_stream;
+
+        _nextCodec = NetCodec::Create(codec, setup.Dictionary);
+        _codecSwitchPos = Bout.GetEndPos();
+        _handshakeAnswered = true;
+        return true;
     }
 
     ServerNetworkSettings& _settings;
@@ -302,14 +414,20 @@ class NetConnectionImpl : public NetConnection
     std::atomic_bool _isDisconnected {};
 
 private:
-    z_stream* _zStream {};
-    uchar _outBuf[NetBuffer::DEFAULT_BUF_SIZE] {};
+    NetServerBase::InputCallback _inputCallback {};
+    uint _connectionId {};
+    bool _handshaked {};
+    bool _handshakeAnswered {};
+    unique_ptr<NetCodec> _codec {};
+    unique_ptr<NetCodec> _nextCodec {};
+    uint _codecSwitchPos {};
+    vector<uchar> _outBuf {};
 };
 
 class NetConnectionAsio final : public NetConnectionImpl
 {
 public:
-    NetConnectionAsio(ServerNetworkSettings& settings, asio::ip::tcp::socket* socket) : NetConnectionImpl(settings), _socket {socket}
+    NetConnectionAsio(ServerNetworkSettings& settings, NetServerBase::InputCallback input_callback, asio::ip::tcp::socket* socket) : NetConnectionImpl(settings, std::move(input_callback)), _socket {socket}
     {
         const auto& address = socket->remote_endpoint().address();
         _ip = address.is_v4() ? address.to_v4().to_ulong() : static_cast<uint>(-1);
@@ -397,7 +515,7 @@ class NetConnectionWebSocket final : public NetConnectionImpl
     using message_ptr = typename WebSockets::message_ptr;
 
 public:
-    NetConnectionWebSocket(ServerNetworkSettings& settings, WebSockets* server, connection_ptr connection) : NetConnectionImpl(settings), _server {server}, _connection {connection}
+    NetConnectionWebSocket(ServerNetworkSettings& settings, NetServerBase::InputCallback input_callback, WebSockets* server, connection_ptr connection) : NetConnectionImpl(settings, std::move(input_callback)), _server {server}, _connection {connection}
     {
         const auto& address = connection->get_raw_socket().remote_endpoint().address();
         _ip = address.is_v4() ? address.to_v4().to_ulong() : static_cast<uint>(-1);
@@ -469,9 +587,10 @@ class NetConnectionWebSocket final : public NetConnectionImpl
     connection_ptr _connection {};
 };
 
-NetTcpServer::NetTcpServer(ServerNetworkSettings& settings, ConnectionCallback callback) : _settings {settings}, _acceptor(_ioService, asio::ip::tcp::endpoint(asio::ip::tcp::v6(), static_cast<ushort>(settings.ServerPort)))
+NetTcpServer::NetTcpServer(ServerNetworkSettings& settings, ConnectionCallback callback, InputCallback input_callback) : _settings {settings}, _acceptor(_ioService, asio::ip::tcp::endpoint(asio::ip::tcp::v6(), static_cast<ushort>(settings.ServerPort)))
 {
     _connectionCallback = std::move(callback);
+    _inputCallback = std::move(input_callback);
     AcceptNext();
     _runThread = std::thread(&NetTcpServer::Run, this);
 }
@@ -497,7 +616,7 @@ void NetTcpServer::AcceptNext()
 void NetTcpServer::AcceptConnection(std::error_code error, asio::ip::tcp::socket* socket)
 {
     if (!error) {
-        _connectionCallback(new NetConnectionAsio(_settings, socket));
+        _connectionCallback(new NetConnectionAsio(_settings, _inputCallback, socket));
     }
     else {
         WriteLog("Accept error: {}", error.message());
@@ -507,9 +626,10 @@ void NetTcpServer::AcceptConnection(std::error_code error, asio::ip::tcp::socket
     AcceptNext();
 }
 
-NetNoTlsWebSocketsServer::NetNoTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback) : _settings {settings}
+NetNoTlsWebSocketsServer::NetNoTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback, InputCallback input_callback) : _settings {settings}
 {
     _connectionCallback = std::move(callback);
+    _inputCallback = std::move(input_callback);
 
     _server.init_asio();
     _server.set_open_handler(websocketpp::lib::bind(&NetNoTlsWebSocketsServer::OnOpen, this, websocketpp::lib::placeholders::_1));
@@ -534,7 +654,7 @@ void NetNoTlsWebSocketsServer::Run()
 void NetNoTlsWebSocketsServer::OnOpen(websocketpp::connection_hdl hdl)
 {
     const auto connection = _server.get_con_from_hdl(std::move(hdl));
-    _connectionCallback(new NetConnectionWebSocket<web_sockets_no_tls>(_settings, &_server, connection));
+    _connectionCallback(new NetConnectionWebSocket<web_sockets_no_tls>(_settings, _inputCallback, &_server, connection));
 }
 
 auto NetNoTlsWebSocketsServer::OnValidate(websocketpp::connection_hdl hdl) -> bool
@@ -545,7 +665,7 @@ auto NetNoTlsWebSocketsServer::OnValidate(websocketpp::connection_hdl hdl) -> bo
     return !error;
 }
 
-NetTlsWebSocketsServer::NetTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback) : _settings {settings}
+NetTlsWebSocketsServer::NetTlsWebSocketsServer(ServerNetworkSettings& settings, ConnectionCallback callback, InputCallback input_callback) : _settings {settings}
 {
     if (settings.WssPrivateKey.empty()) {
         throw GenericException("'WssPrivateKey' not provided");
@@ -555,6 +675,7 @@ NetTlsWebSocketsServer::NetTlsWebSocketsServer(ServerNetworkSettings& settings,
     }
 
     _connectionCallback = std::move(callback);
+    _inputCallback = std::move(input_callback);
 
     _server.init_asio();
     _server.set_open_handler(websocketpp::lib::bind(&NetTlsWebSocketsServer::OnOpen, this, websocketpp::lib::placeholders::_1));
@@ -580,7 +701,7 @@ void NetTlsWebSocketsServer::Run()
 void NetTlsWebSocketsServer::OnOpen(websocketpp::connection_hdl hdl)
 {
     const auto connection = _server.get_con_from_hdl(std::move(hdl));
-    _connectionCallback(new NetConnectionWebSocket<web_sockets_tls>(_settings, &_server, connection));
+    _connectionCallback(new NetConnectionWebSocket<web_sockets_tls>(_settings, _inputCallback, &_server, connection));
 }
 
 auto NetTlsWebSocketsServer::OnValidate(websocketpp::connection_hdl hdl) -> bool
@@ -601,11 +722,12 @@ auto NetTlsWebSocketsServer::OnTlsInit(const websocketpp::connection_hdl& /*hdl*
 }
 #endif // FO_HAVE_ASIO
 
-auto NetServerBase::StartTcpServer(ServerNetworkSettings& settings, const ConnectionCallback& callback) -> NetServerBase*
+auto NetServerBase::StartTcpServer(ServerNetworkSettings& settings, const ConnectionCallback& callback, const InputCallback& input_callback) -> NetServerBase*
 {
 #if FO_HAVE_ASIO
     try {
-        return new NetTcpServer(settings, callback);
+        GetTransportSetup(settings); // Wrong codec settings fail server start
+        return new NetTcpServer(settings, callback, input_callback);
     }
     catch (const std::exception& ex) {
         WriteLog("Can't start Tcp server: {}", ex.what());
@@ -616,15 +738,16 @@ auto NetServerBase::StartTcpServer(ServerNetworkSettings& settings, const Connec
 #endif
 }
 
-auto NetServerBase::StartWebSocketsServer(ServerNetworkSettings& settings, const ConnectionCallback& callback) -> NetServerBase*
+auto NetServerBase::StartWebSocketsServer(ServerNetworkSettings& settings, const ConnectionCallback& callback, const InputCallback& input_callback) -> NetServerBase*
 {
 #if FO_HAVE_ASIO
     try {
+        GetTransportSetup(settings); // Wrong codec settings fail server start
         if (!settings.SecuredWebSockets) {
-            return new NetNoTlsWebSocketsServer(settings, callback);
+            return new NetNoTlsWebSocketsServer(settings, callback, input_callback);
         }
 
-        return new NetTlsWebSocketsServer(settings, callback);
+        return new NetTlsWebSocketsServer(settings, callback, input_callback);
     }
     catch (const std::exception& ex) {
         WriteLog("Can't start Web sockets server: {}", ex.what());
@@ -637,12 +760,12 @@ auto NetServerBase::StartWebSocketsServer(ServerNetworkSettings& settings, const
 
 #else
 
-NetServerBase* NetServerBase::StartTcpServer(ServerNetworkSettings& settings, const ConnectionCallback& callback)
+NetServerBase* NetServerBase::StartTcpServer(ServerNetworkSettings& settings, const ConnectionCallback& callback, const InputCallback& input_callback)
 {
     throw UnreachablePlaceException(LINE_STR);
 }
 
-NetServerBase* NetServerBase::StartWebSocketsServer(ServerNetworkSettings& settings, const ConnectionCallback& callback)
+NetServerBase* NetServerBase::StartWebSocketsServer(ServerNetworkSettings& settings, const ConnectionCallback& callback, const InputCallback& input_callback)
 {
     throw UnreachablePlaceException(LINE_STR);
 }
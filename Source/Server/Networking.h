@@ -37,11 +37,13 @@
 
 #include "NetBuffer.h"
 #include "Settings.h"
+#include "SpscQueue.h"
 
 class NetConnection
 {
 public:
-    NetConnection() = default;
+    NetConnection() = delete;
+    explicit NetConnection(uint in_messages_capacity) : InMessages(in_messages_capacity) { }
     NetConnection(const NetConnection&) = delete;
     NetConnection(NetConnection&&) noexcept = delete;
     auto operator=(const NetConnection&) = delete;
@@ -53,15 +55,16 @@ class NetConnection
     [[nodiscard]] virtual auto GetPort() const -> ushort = 0;
     [[nodiscard]] virtual auto IsDisconnected() const -> bool = 0;
 
-    virtual void DisableCompression() = 0;
     virtual void Dispatch() = 0;
     virtual void Disconnect() = 0;
 
     void AddRef() const;
     void Release() const;
 
+    // Raw input is cut to messages by network thread, server loop takes them from queue
     NetInBuffer Bin {};
     std::mutex BinLocker {};
+    SpscQueue<NetInMessage> InMessages;
     NetOutBuffer Bout {};
     std::mutex BoutLocker {};
 
@@ -73,6 +76,7 @@ class NetServerBase
 {
 public:
     using ConnectionCallback = std::function<void(NetConnection*)>;
+    using InputCallback = std::function<void()>;
 
     NetServerBase() = default;
     NetServerBase(const NetServerBase&) = delete;
@@ -83,6 +87,6 @@ class NetServerBase
 
     virtual void Shutdown() = 0;
 
-    [[nodiscard]] static auto StartTcpServer(ServerNetworkSettings& settings, const ConnectionCallback& callback) -> NetServerBase*;
-    [[nodiscard]] static auto StartWebSocketsServer(ServerNetworkSettings& settings, const ConnectionCallback& callback) -> NetServerBase*;
+    [[nodiscard]] static auto StartTcpServer(ServerNetworkSettings& settings, const ConnectionCallback& callback, const InputCallback& input_callback) -> NetServerBase*;
+    [[nodiscard]] static auto StartWebSocketsServer(ServerNetworkSettings& settings, const ConnectionCallback& callback, const InputCallback& input_callback) -> NetServerBase*;
 };
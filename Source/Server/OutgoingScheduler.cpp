@@ -0,0 +1,318 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "OutgoingScheduler.h"
+
+// Consumed data is moved out of lane front only when it takes noticeable part of buffer
+static constexpr size_t LANE_COMPACT_SIZE = 64 * 1024;
+
+static OutgoingScheduler::Statistics Stats;
+
+OutgoingScheduler::OutgoingScheduler(const Config& config) : _config {config}
+{
+    _tokens = static_cast<double>(_config.BurstBytes);
+}
+
+OutgoingScheduler::~OutgoingScheduler()
+{
+    if (_isSlowConsumer) {
+        Stats.SlowConsumersNow--;
+    }
+}
+
+auto OutgoingScheduler::GetLaneName(OutgoingLane lane) -> string_view
+{
+    switch (lane) {
+    case OutgoingLane::Critical:
+        return "critical";
+    case OutgoingLane::Gameplay:
+        return "gameplay";
+    case OutgoingLane::Bulk:
+        return "bulk";
+    default:
+        break;
+    }
+
+    throw UnreachablePlaceException(LINE_STR);
+}
+
+auto OutgoingScheduler::GetLane(uint msg) -> OutgoingLane
+{
+    switch (msg) {
+    case NETMSG_PING:
+    case NETMSG_CRITTER_MOVE:
+    case NETMSG_CRITTER_DIR:
+    case NETMSG_CRITTER_XY:
+    case NETMSG_CRITTER_ACTION:
+    case NETMSG_CRITTER_ANIMATE:
+    case NETMSG_COMBAT_RESULTS:
+    case NETMSG_EFFECT:
+    case NETMSG_FLY_EFFECT:
+        return OutgoingLane::Critical;
+    case NETMSG_UPDATE_FILE_DATA:
+    case NETMSG_AUTOMAPS_INFO:
+        return OutgoingLane::Bulk;
+    default:
+        return OutgoingLane::Gameplay;
+    }
+}
+
+auto OutgoingScheduler::IsBarrier(uint msg) -> bool
+{
+    switch (msg) {
+    case NETMSG_LOGIN_SUCCESS:
+    case NETMSG_REGISTER_SUCCESS:
+    case NETMSG_LOADMAP:
+    case NETMSG_ADD_PLAYER:
+    case NETMSG_ADD_NPC:
+    case NETMSG_REMOVE_CRITTER:
+    case NETMSG_VIEW_MAP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+auto OutgoingScheduler::MakeCoalesceKey(uchar group, uchar sub_group, ushort index, uint id) -> uint64
+{
+    RUNTIME_ASSERT(group != 0);
+
+    return static_cast<uint64>(group) << 56 | static_cast<uint64>(sub_group) << 48 | static_cast<uint64>(index) << 32 | id;
+}
+
+auto OutgoingScheduler::GetStatistics() -> const Statistics&
+{
+    return Stats;
+}
+
+void OutgoingScheduler::Enqueue(NetOutBuffer& staging, uint64 coalesce_key)
+{
+    const auto data_size = staging.GetEndPos();
+    if (data_size == 0u) {
+        return;
+    }
+
+    uint msg = 0;
+    if (data_size >= sizeof(msg)) {
+        std::memcpy(&msg, staging.GetData(), sizeof(msg));
+    }
+
+    const auto lane_index = GetLane(msg);
+    auto& lane = _lanes[static_cast<size_t>(lane_index)];
+    const auto& parts = staging.GetParts();
+
+    Chunk chunk;
+    chunk.Seq = ++_lastSeq;
+    chunk.WaitSeq = _lastBarrierSeq;
+    chunk.DataSize = data_size;
+    chunk.PartsCount = static_cast<uint>(parts.size());
+    chunk.IsBarrier = lane_index == OutgoingLane::Gameplay && IsBarrier(msg);
+    chunk.CoalesceKey = chunk.IsBarrier ? 0 : coalesce_key;
+
+    if (chunk.IsBarrier) {
+        _lastBarrierSeq = chunk.Seq;
+    }
+
+    // Superseded message is skipped when lane reaches it
+    if (chunk.CoalesceKey != 0u) {
+        if (const auto it = _pendingKeys.find(chunk.CoalesceKey); it != _pendingKeys.end()) {
+            const auto prev_it = std::lower_bound(lane.Chunks.begin(), lane.Chunks.end(), it->second, [](const Chunk& c, uint seq) { return c.Seq < seq; });
+            if (prev_it != lane.Chunks.end() && prev_it->Seq == it->second && !prev_it->IsDropped) {
+                prev_it->IsDropped = true;
+                _queuedBytes -= prev_it->DataSize;
+                Stats.Coalesced++;
+            }
+        }
+
+        _pendingKeys[chunk.CoalesceKey] = chunk.Seq;
+    }
+
+    lane.Data.insert(lane.Data.end(), staging.GetData(), staging.GetData() + data_size);
+    lane.Parts.insert(lane.Parts.end(), parts.begin(), parts.end());
+    lane.Chunks.push_back(chunk);
+    _queuedBytes += data_size;
+
+    staging.ResetBuf();
+}
+
+void OutgoingScheduler::Flush(NetOutBuffer& wire, double time)
+{
+    if (_config.BytesPerSecond != 0u) {
+        if (_lastFlushTime >= 0.0) {
+            _tokens = std::min(_tokens + (time - _lastFlushTime) * _config.BytesPerSecond / 1000.0, static_cast<double>(_config.BurstBytes));
+        }
+        _lastFlushTime = time;
+    }
+
+    auto shaped = false;
+
+    while (true) {
+        // Critical goes first unless it waits for barrier in gameplay lane
+        if (const auto* chunk = TakeFront(_lanes[static_cast<size_t>(OutgoingLane::Critical)]); chunk != nullptr && chunk->WaitSeq <= _flushedBarrierSeq) {
+            WriteFront(OutgoingLane::Critical, wire);
+            continue;
+        }
+
+        auto lane_index = OutgoingLane::Gameplay;
+        if (TakeFront(_lanes[static_cast<size_t>(lane_index)]) == nullptr) {
+            lane_index = OutgoingLane::Bulk;
+            if (TakeFront(_lanes[static_cast<size_t>(lane_index)]) == nullptr) {
+                break;
+            }
+        }
+
+        if (_config.Watermark != 0u && wire.GetEndPos() >= _config.Watermark) {
+            break;
+        }
+        if (_config.BytesPerSecond != 0u && _tokens <= 0.0) {
+            shaped = true;
+            break;
+        }
+
+        WriteFront(lane_index, wire);
+    }
+
+    if (shaped) {
+        Stats.ShapedFlushes++;
+    }
+
+    UpdateConsumerState(wire.GetEndPos(), time);
+}
+
+void OutgoingScheduler::FlushAll(NetOutBuffer& wire)
+{
+    // Same order as unlimited flush
+    while (true) {
+        if (const auto* chunk = TakeFront(_lanes[static_cast<size_t>(OutgoingLane::Critical)]); chunk != nullptr && chunk->WaitSeq <= _flushedBarrierSeq) {
+            WriteFront(OutgoingLane::Critical, wire);
+        }
+        else if (TakeFront(_lanes[static_cast<size_t>(OutgoingLane::Gameplay)]) != nullptr) {
+            WriteFront(OutgoingLane::Gameplay, wire);
+        }
+        else if (TakeFront(_lanes[static_cast<size_t>(OutgoingLane::Bulk)]) != nullptr) {
+            WriteFront(OutgoingLane::Bulk, wire);
+        }
+        else {
+            break;
+        }
+    }
+}
+
+auto OutgoingScheduler::TakeFront(Lane& lane) -> Chunk*
+{
+    while (!lane.Chunks.empty() && lane.Chunks.front().IsDropped) {
+        const auto& chunk = lane.Chunks.front();
+        lane.DataPos += chunk.DataSize;
+        lane.PartsPos += chunk.PartsCount;
+        lane.Chunks.pop_front();
+    }
+
+    if (lane.Chunks.empty()) {
+        lane.Data.clear();
+        lane.Parts.clear();
+        lane.DataPos = 0;
+        lane.PartsPos = 0;
+        return nullptr;
+    }
+
+    return &lane.Chunks.front();
+}
+
+void OutgoingScheduler::WriteFront(OutgoingLane lane_index, NetOutBuffer& wire)
+{
+    auto& lane = _lanes[static_cast<size_t>(lane_index)];
+    const auto chunk = lane.Chunks.front();
+    lane.Chunks.pop_front();
+
+    // Pushed by same parts as were written to keep key stream in sync with client reads
+    const auto* data = lane.Data.data() + lane.DataPos;
+    for (uint i = 0; i < chunk.PartsCount; i++) {
+        const auto part_size = lane.Parts[lane.PartsPos + i];
+        wire.Push(data, part_size);
+        data += part_size;
+    }
+
+    lane.DataPos += chunk.DataSize;
+    lane.PartsPos += chunk.PartsCount;
+
+    if (lane.DataPos >= LANE_COMPACT_SIZE && lane.DataPos * 2 >= lane.Data.size()) {
+        lane.Data.erase(lane.Data.begin(), lane.Data.begin() + static_cast<ptrdiff_t>(lane.DataPos));
+        lane.Parts.erase(lane.Parts.begin(), lane.Parts.begin() + static_cast<ptrdiff_t>(lane.PartsPos));
+        lane.DataPos = 0;
+        lane.PartsPos = 0;
+    }
+
+    if (chunk.IsBarrier) {
+        _flushedBarrierSeq = chunk.Seq;
+    }
+    if (chunk.CoalesceKey != 0u) {
+        if (const auto it = _pendingKeys.find(chunk.CoalesceKey); it != _pendingKeys.end() && it->second == chunk.Seq) {
+            _pendingKeys.erase(it);
+        }
+    }
+
+    _queuedBytes -= chunk.DataSize;
+    if (lane_index != OutgoingLane::Critical) {
+        _tokens -= static_cast<double>(chunk.DataSize);
+    }
+
+    Stats.LaneMessages[static_cast<size_t>(lane_index)]++;
+    Stats.LaneBytes[static_cast<size_t>(lane_index)] += chunk.DataSize;
+}
+
+void OutgoingScheduler::UpdateConsumerState(size_t wire_pending, double time)
+{
+    if (_config.MaxQueuedBytes != 0u && _queuedBytes > _config.MaxQueuedBytes && !_isOverflowed) {
+        _isOverflowed = true;
+        Stats.Overflows++;
+    }
+
+    if (_config.SlowConsumerBytes != 0u && _queuedBytes + wire_pending > _config.SlowConsumerBytes) {
+        if (!_isBacklogged) {
+            _isBacklogged = true;
+            _backlogTime = time;
+        }
+        else if (!_isSlowConsumer && time - _backlogTime >= static_cast<double>(_config.SlowConsumerTime)) {
+            _isSlowConsumer = true;
+            Stats.SlowConsumers++;
+            Stats.SlowConsumersNow++;
+        }
+    }
+    else {
+        _isBacklogged = false;
+        if (_isSlowConsumer) {
+            _isSlowConsumer = false;
+            Stats.SlowConsumersNow--;
+        }
+    }
+}
@@ -0,0 +1,137 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "NetBuffer.h"
+
+enum class OutgoingLane : uchar
+{
+    Critical,
+    Gameplay,
+    Bulk,
+    Count,
+};
+
+// Client output waits in priority lanes until connection buffer has room and shaping allows
+// Critical messages skip shaping and may overtake gameplay ones, but never barriers like map load or critter add/remove
+// Bulk messages have no dependencies and go only when other lanes are empty
+class OutgoingScheduler final
+{
+public:
+    struct Config
+    {
+        uint BytesPerSecond {};
+        uint BurstBytes {};
+        uint Watermark {};
+        uint SlowConsumerBytes {};
+        uint SlowConsumerTime {};
+        uint MaxQueuedBytes {};
+    };
+
+    struct Statistics
+    {
+        size_t LaneMessages[static_cast<size_t>(OutgoingLane::Count)] {};
+        size_t LaneBytes[static_cast<size_t>(OutgoingLane::Count)] {};
+        size_t Coalesced {};
+        size_t ShapedFlushes {};
+        size_t SlowConsumers {};
+        size_t SlowConsumersNow {};
+        size_t Overflows {};
+    };
+
+    OutgoingScheduler() = delete;
+    explicit OutgoingScheduler(const Config& config);
+    OutgoingScheduler(const OutgoingScheduler&) = delete;
+    OutgoingScheduler(OutgoingScheduler&&) noexcept = delete;
+    auto operator=(const OutgoingScheduler&) = delete;
+    auto operator=(OutgoingScheduler&&) noexcept = delete;
+    ~OutgoingScheduler();
+
+    [[nodiscard]] static auto GetLaneName(OutgoingLane lane) -> string_view;
+    [[nodiscard]] static auto GetLane(uint msg) -> OutgoingLane;
+    [[nodiscard]] static auto IsBarrier(uint msg) -> bool;
+    [[nodiscard]] static auto MakeCoalesceKey(uchar group, uchar sub_group, ushort index, uint id) -> uint64;
+    [[nodiscard]] static auto GetStatistics() -> const Statistics&;
+    [[nodiscard]] auto GetQueuedBytes() const -> size_t { return _queuedBytes; }
+    [[nodiscard]] auto IsSlowConsumer() const -> bool { return _isSlowConsumer; }
+    [[nodiscard]] auto IsOverflowed() const -> bool { return _isOverflowed; }
+
+    // Takes message from unencrypted staging buffer, pending message with same non zero key is dropped
+    void Enqueue(NetOutBuffer& staging, uint64 coalesce_key);
+    // Moves to wire what lanes and shaping allow, time in milliseconds
+    void Flush(NetOutBuffer& wire, double time);
+    void FlushAll(NetOutBuffer& wire);
+
+private:
+    struct Chunk
+    {
+        uint Seq {};
+        uint WaitSeq {};
+        uint DataSize {};
+        uint PartsCount {};
+        uint64 CoalesceKey {};
+        bool IsBarrier {};
+        bool IsDropped {};
+    };
+
+    struct Lane
+    {
+        vector<uchar> Data {};
+        vector<uint> Parts {};
+        deque<Chunk> Chunks {};
+        size_t DataPos {};
+        size_t PartsPos {};
+    };
+
+    [[nodiscard]] auto TakeFront(Lane& lane) -> Chunk*;
+
+    void WriteFront(OutgoingLane lane_index, NetOutBuffer& wire);
+    void UpdateConsumerState(size_t wire_pending, double time);
+
+    Config _config;
+    Lane _lanes[static_cast<size_t>(OutgoingLane::Count)] {};
+    unordered_map<uint64, uint> _pendingKeys {};
+    size_t _queuedBytes {};
+    uint _lastSeq {};
+    uint _lastBarrierSeq {};
+    uint _flushedBarrierSeq {};
+    double _tokens {};
+    double _lastFlushTime {-1.0};
+    bool _isBacklogged {};
+    double _backlogTime {};
+    bool _isSlowConsumer {};
+    bool _isOverflowed {};
+};
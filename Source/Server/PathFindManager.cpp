@@ -0,0 +1,259 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "PathFindManager.h"
+#include "Critter.h"
+#include "Log.h"
+#include "Map.h"
+#include "Server.h"
+#include "Settings.h"
+#include "ThreadPool.h"
+
+PathSearchQueue::PathSearchQueue(size_t threads_count, SearchFunc search_func) : _threadsCount {threads_count}, _searchFunc {std::move(search_func)}
+{
+    RUNTIME_ASSERT(_threadsCount != 0u);
+}
+
+PathSearchQueue::~PathSearchQueue()
+{
+    // Wait running searches before search data is released
+    _threadPool.reset();
+}
+
+auto PathSearchQueue::MakeSearchKey(const FindPathInput& input) -> SearchKey
+{
+    return {input.MapId, input.FromX, input.FromY, input.ToX, input.ToY, input.Multihex, input.Cut, input.CheckCrit, input.CheckGagItems};
+}
+
+auto PathSearchQueue::IsSameRequest(const FindPathInput& a, const FindPathInput& b) -> bool
+{
+    return MakeSearchKey(a) == MakeSearchKey(b) && a.Trace == b.Trace && a.TraceCr == b.TraceCr && a.IsRun == b.IsRun;
+}
+
+auto PathSearchQueue::TakeResult(uint requester_id, const FindPathInput& input, FindPathOutput& output) -> RequestState
+{
+    const auto it = _requests.find(requester_id);
+    if (it == _requests.end()) {
+        return RequestState::None;
+    }
+
+    auto& request = it->second;
+
+    // Critter or target moved, map changed or moving was reset by scripts
+    if (!IsSameRequest(request.Input, input)) {
+        _stats.Stale++;
+        _requests.erase(it);
+        return RequestState::None;
+    }
+
+    if (!request.Search->Done.load(std::memory_order_acquire)) {
+        return RequestState::Pending;
+    }
+
+    output = request.Search->Output;
+    _requests.erase(it);
+    return RequestState::Ready;
+}
+
+void PathSearchQueue::Request(uint requester_id, const FindPathInput& input)
+{
+    _stats.Requests++;
+
+    auto& request = _requests[requester_id];
+    request.Input = input;
+
+    // Same search may be shared by several critters
+    const auto key = MakeSearchKey(input);
+    const auto it = _searches.find(key);
+    if (it != _searches.end()) {
+        request.Search = it->second;
+        _stats.Deduplicated++;
+        return;
+    }
+
+    auto search = std::make_shared<SearchJob>();
+    search->Input = input;
+    search->Input.FromCritter = nullptr;
+    search->Input.TraceCr = nullptr;
+    search->SmoothSwitcher = (_stats.Searches % 2) != 0;
+
+    request.Search = search;
+    _searches.emplace(key, search);
+    _stats.Searches++;
+
+    if (!_threadPool) {
+        _threadPool = std::make_unique<ThreadPool>(_threadsCount);
+    }
+
+    _threadPool->AddJob([this, search] {
+        try {
+            search->Output = _searchFunc(search->Input, search->SmoothSwitcher);
+        }
+        catch (const std::exception& ex) {
+            ReportExceptionAndContinue(ex);
+            search->Output = FindPathOutput();
+            search->Output.Result = FindPathResult::InternalError;
+        }
+
+        search->Done.store(true, std::memory_order_release);
+    });
+}
+
+void PathSearchQueue::Reject(uint requester_id, const FindPathInput& input, FindPathResult result)
+{
+    _stats.Requests++;
+
+    auto search = std::make_shared<SearchJob>();
+    search->Output.Result = result;
+    search->Done = true;
+
+    auto& request = _requests[requester_id];
+    request.Input = input;
+    request.Search = std::move(search);
+}
+
+void PathSearchQueue::Process(const ActiveChecker& is_active)
+{
+    // Finished searches are not shared anymore, new requests must see newer map state
+    for (auto it = _searches.begin(); it != _searches.end();) {
+        if (it->second->Done.load(std::memory_order_acquire)) {
+            it = _searches.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    // Drop requests of critters which gone or stopped moving
+    for (auto it = _requests.begin(); it != _requests.end();) {
+        if (!is_active(it->first)) {
+            it = _requests.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    _stats.Pending = _searches.size();
+}
+
+void PathSearchQueue::Stop()
+{
+    _threadPool.reset();
+    _searches.clear();
+    _requests.clear();
+    _stats.Pending = 0;
+}
+
+PathFindManager::PathFindManager(FOServer* engine) : _engine {engine}, _queue {engine->Settings.PathFindThreads != 0u ? static_cast<size_t>(engine->Settings.PathFindThreads) : ThreadPool::GetDefaultThreadsCount(), [engine](const FindPathInput& input, bool& smooth_switcher) {
+    // Guard holds published world until search is done
+    const auto world = engine->WorldSnapshotMngr.Read();
+    return SearchOnSnapshot(world.Get(), input, engine->Settings, engine->GeomHelper, smooth_switcher);
+}}
+{
+}
+
+auto PathFindManager::SearchOnSnapshot(const WorldSnapshot* world, const FindPathInput& input, const GeometrySettings& settings, const GeometryHelper& geom_helper, bool& smooth_switcher) -> FindPathOutput
+{
+    const auto* map_snapshot = world != nullptr ? world->GetMap(input.MapId) : nullptr;
+    if (map_snapshot == nullptr) {
+        FindPathOutput output;
+        output.Result = FindPathResult::MapNotFound;
+        return output;
+    }
+
+    return MapManager::FindPathSteps(input, map_snapshot->HexFlags, settings, geom_helper, smooth_switcher);
+}
+
+auto PathFindManager::IsEnabled() const -> bool
+{
+    return _engine->Settings.AsyncPathFind && _engine->WorldSnapshotMngr.IsEnabled();
+}
+
+auto PathFindManager::TakeResult(Critter* cr, const FindPathInput& input, FindPathOutput& output) -> RequestState
+{
+    const auto state = _queue.TakeResult(cr->GetId(), input, output);
+    if (state != RequestState::Ready || output.Result != FindPathResult::Ok) {
+        return state;
+    }
+
+    // Entity related checks use actual map state
+    auto* map = _engine->MapMngr.GetMap(input.MapId);
+    if (map == nullptr) {
+        output = FindPathOutput();
+        output.Result = FindPathResult::MapNotFound;
+        return RequestState::Ready;
+    }
+
+    _engine->MapMngr.FinishFindPath(input, map, output);
+    return RequestState::Ready;
+}
+
+void PathFindManager::RequestPath(Critter* cr, const FindPathInput& input)
+{
+    RUNTIME_ASSERT(IsEnabled());
+
+    // Fail early on same checks as synchronous search
+    auto* map = _engine->MapMngr.GetMap(input.MapId);
+    if (map == nullptr) {
+        _queue.Reject(cr->GetId(), input, FindPathResult::MapNotFound);
+        return;
+    }
+    if (input.Trace != 0u && input.TraceCr == nullptr) {
+        _queue.Reject(cr->GetId(), input, FindPathResult::TraceTargetNullptr);
+        return;
+    }
+
+    // Map created after last publish, request again on next tick
+    if (!_engine->WorldSnapshotMngr.IsMapPublished(input.MapId)) {
+        return;
+    }
+
+    // Hex offsets tables are built lazily, make sure it happened before workers use them
+    UNUSED_VARIABLE(_engine->GeomHelper.GetHexOffsets(false));
+
+    _queue.Request(cr->GetId(), input);
+}
+
+void PathFindManager::Process()
+{
+    _queue.Process([this](uint cr_id) {
+        const auto* cr = _engine->EntityMngr.GetCritter(cr_id);
+        return cr != nullptr && cr->Moving.State == MovingState::InProgress;
+    });
+}
+
+void PathFindManager::Stop()
+{
+    _queue.Stop();
+}
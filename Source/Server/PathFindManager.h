@@ -0,0 +1,146 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "MapManager.h"
+#include "WorldSnapshotManager.h"
+
+class FOServer;
+class ThreadPool;
+
+// Path searches on worker threads, engine independent part of PathFindManager
+// Search function provides map state itself, requests are keyed by requester id, same searches are shared until finished
+class PathSearchQueue final
+{
+public:
+    enum class RequestState
+    {
+        None,
+        Pending,
+        Ready,
+    };
+
+    struct Statistics
+    {
+        size_t Requests {};
+        size_t Searches {};
+        size_t Deduplicated {};
+        size_t Stale {};
+        size_t Pending {};
+    };
+
+    using SearchFunc = std::function<FindPathOutput(const FindPathInput& input, bool& smooth_switcher)>;
+    using ActiveChecker = std::function<bool(uint requester_id)>;
+
+    PathSearchQueue() = delete;
+    PathSearchQueue(size_t threads_count, SearchFunc search_func);
+    PathSearchQueue(const PathSearchQueue&) = delete;
+    PathSearchQueue(PathSearchQueue&&) noexcept = delete;
+    auto operator=(const PathSearchQueue&) = delete;
+    auto operator=(PathSearchQueue&&) noexcept = delete;
+    ~PathSearchQueue();
+
+    [[nodiscard]] auto GetStatistics() const -> const Statistics& { return _stats; }
+
+    // Returns Ready and fills output only if result matches input, otherwise request must be repeated
+    auto TakeResult(uint requester_id, const FindPathInput& input, FindPathOutput& output) -> RequestState;
+    void Request(uint requester_id, const FindPathInput& input);
+    // Request failed before search, result is ready immediately
+    void Reject(uint requester_id, const FindPathInput& input, FindPathResult result);
+    void Process(const ActiveChecker& is_active);
+    // Waits running searches and drops all others, queue may be used again after it
+    void Stop();
+
+private:
+    using SearchKey = tuple<uint, ushort, ushort, ushort, ushort, uint, uint, bool, bool>;
+
+    struct SearchJob
+    {
+        FindPathInput Input {};
+        bool SmoothSwitcher {};
+        FindPathOutput Output {};
+        std::atomic_bool Done {};
+    };
+
+    struct PendingRequest
+    {
+        FindPathInput Input {};
+        shared_ptr<SearchJob> Search {};
+    };
+
+    [[nodiscard]] static auto MakeSearchKey(const FindPathInput& input) -> SearchKey;
+    [[nodiscard]] static auto IsSameRequest(const FindPathInput& a, const FindPathInput& b) -> bool;
+
+    size_t _threadsCount;
+    SearchFunc _searchFunc;
+    map<SearchKey, shared_ptr<SearchJob>> _searches {};
+    unordered_map<uint, PendingRequest> _requests {};
+    Statistics _stats {};
+    unique_ptr<ThreadPool> _threadPool {};
+};
+
+// Runs path searches of critters on worker threads against last published world snapshot
+// Results are picked up by critters on later ticks and dropped if request conditions changed meanwhile
+class PathFindManager final
+{
+public:
+    using RequestState = PathSearchQueue::RequestState;
+    using Statistics = PathSearchQueue::Statistics;
+
+    PathFindManager() = delete;
+    explicit PathFindManager(FOServer* engine);
+    PathFindManager(const PathFindManager&) = delete;
+    PathFindManager(PathFindManager&&) noexcept = delete;
+    auto operator=(const PathFindManager&) = delete;
+    auto operator=(PathFindManager&&) noexcept = delete;
+    ~PathFindManager() = default;
+
+    // Grid search on map state of world snapshot, any thread
+    [[nodiscard]] static auto SearchOnSnapshot(const WorldSnapshot* world, const FindPathInput& input, const GeometrySettings& settings, const GeometryHelper& geom_helper, bool& smooth_switcher) -> FindPathOutput;
+
+    [[nodiscard]] auto IsEnabled() const -> bool;
+    [[nodiscard]] auto GetStatistics() const -> const Statistics& { return _queue.GetStatistics(); }
+
+    // Returns Ready and fills output only if result matches input, otherwise request must be repeated
+    auto TakeResult(Critter* cr, const FindPathInput& input, FindPathOutput& output) -> RequestState;
+    void RequestPath(Critter* cr, const FindPathInput& input);
+    void Process();
+    void Stop();
+
+private:
+    FOServer* _engine;
+    PathSearchQueue _queue;
+};
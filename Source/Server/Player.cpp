@@ -233,6 +233,10 @@ void Player::Send_Property(NetProperty type, const Property* prop, Entity* entit
     uint data_size = 0;
     const void* data = entity->GetProperties().GetRawData(prop, data_size);
 
+    // Newer value of same property replaces unsent one
+    const auto entity_id = additional_args != 0u ? dynamic_cast<ServerEntity*>(entity)->GetId() : 0u;
+    const auto coalesce_key = OutgoingScheduler::MakeCoalesceKey(3, static_cast<uchar>(type), prop->GetRegIndex(), entity_id);
+
     CONNECTION_OUTPUT_BEGIN(Connection);
 
     const auto is_pod = prop->IsPlainData();
@@ -277,7 +281,7 @@ void Player::Send_Property(NetProperty type, const Property* prop, Entity* entit
         }
     }
 
-    CONNECTION_OUTPUT_END(Connection);
+    CONNECTION_OUTPUT_END_COALESCED(Connection, coalesce_key);
 }
 
 void Player::Send_Move(Critter* from_cr, uint move_params)
@@ -309,7 +313,7 @@ void Player::Send_Dir(Critter* from_cr)
     Connection->Bout << NETMSG_CRITTER_DIR;
     Connection->Bout << from_cr->GetId();
     Connection->Bout << from_cr->GetDir();
-    CONNECTION_OUTPUT_END(Connection);
+    CONNECTION_OUTPUT_END_COALESCED(Connection, OutgoingScheduler::MakeCoalesceKey(2, 0, 0, from_cr->GetId()));
 }
 
 void Player::Send_Action(Critter* from_cr, int action, int action_ext, Item* item)
@@ -669,7 +673,7 @@ void Player::Send_Position(Critter* cr)
     Connection->Bout << cr->GetHexX();
     Connection->Bout << cr->GetHexY();
     Connection->Bout << cr->GetDir();
-    CONNECTION_OUTPUT_END(Connection);
+    CONNECTION_OUTPUT_END_COALESCED(Connection, OutgoingScheduler::MakeCoalesceKey(1, 0, 0, cr->GetId()));
 }
 
 void Player::Send_AllProperties()
@@ -35,6 +35,7 @@
 #include "AdminPanel.h"
 #include "AnyData.h"
 #include "GenericUtils.h"
+#include "NetCodec.h"
 #include "Networking.h"
 #include "PropertiesSerializator.h"
 #include "ServerScripting.h"
@@ -51,9 +52,13 @@ FOServer::FOServer(GlobalSettings& settings, ScriptSystem* script_sys) :
     DeferredCallMngr(this),
     EntityMngr(this),
     MapMngr(this),
+    WorldSnapshotMngr(this),
+    PathFindMngr(this),
+    FlowFieldMngr(this),
     CrMngr(this),
     ItemMngr(this),
-    DlgMngr(this)
+    DlgMngr(this),
+    _tickScheduler(Settings.ServerTickRate, Settings.ServerTickCatchUp, Settings.ServerTickMinInterval)
 // clang-format on
 {
     WriteLog("Start server");
@@ -83,10 +88,10 @@ FOServer::FOServer(GlobalSettings& settings, ScriptSystem* script_sys) :
 
     // Network
     WriteLog("Starting server on ports {} and {}", Settings.ServerPort, Settings.ServerPort + 1);
-    if ((_tcpServer = NetServerBase::StartTcpServer(Settings, std::bind(&FOServer::OnNewConnection, this, std::placeholders::_1))) == nullptr) {
+    if ((_tcpServer = NetServerBase::StartTcpServer(Settings, std::bind(&FOServer::OnNewConnection, this, std::placeholders::_1), [this] { _tickScheduler.Notify(); })) == nullptr) {
         throw ServerInitException("Can't listen TCP server ports", Settings.ServerPort);
     }
-    if ((_webSocketsServer = NetServerBase::StartWebSocketsServer(Settings, std::bind(&FOServer::OnNewConnection, this, std::placeholders::_1))) == nullptr) {
+    if ((_webSocketsServer = NetServerBase::StartWebSocketsServer(Settings, std::bind(&FOServer::OnNewConnection, this, std::placeholders::_1), [this] { _tickScheduler.Notify(); })) == nullptr) {
         throw ServerInitException("Can't listen TCP server ports", Settings.ServerPort + 1);
     }
 
@@ -194,6 +199,14 @@ FOServer::FOServer(GlobalSettings& settings, ScriptSystem* script_sys) :
         set_callback(GetPropertyRegistrator(ItemProperties::ENTITY_CLASS_NAME), Item::IsGeck_RegIndex, std::bind(&FOServer::OnSetItemIsGeck, this, _1, _2, _3, _4));
         set_callback(GetPropertyRegistrator(ItemProperties::ENTITY_CLASS_NAME), Item::IsRadio_RegIndex, std::bind(&FOServer::OnSetItemIsRadio, this, _1, _2, _3, _4));
         set_callback(GetPropertyRegistrator(ItemProperties::ENTITY_CLASS_NAME), Item::Opened_RegIndex, std::bind(&FOServer::OnSetItemOpened, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::WorldX_RegIndex, std::bind(&FOServer::OnSetCritterWorldPos, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::WorldY_RegIndex, std::bind(&FOServer::OnSetCritterWorldPos, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::HexX_RegIndex, std::bind(&FOServer::OnSetCritterMapState, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::HexY_RegIndex, std::bind(&FOServer::OnSetCritterMapState, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::Dir_RegIndex, std::bind(&FOServer::OnSetCritterMapState, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::Multihex_RegIndex, std::bind(&FOServer::OnSetCritterMapState, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::Cond_RegIndex, std::bind(&FOServer::OnSetCritterMapState, this, _1, _2, _3, _4));
+        set_callback(GetPropertyRegistrator(CritterProperties::ENTITY_CLASS_NAME), Critter::IsHide_RegIndex, std::bind(&FOServer::OnSetCritterMapState, this, _1, _2, _3, _4));
     }
 
     // Dialogs
@@ -223,8 +236,9 @@ FOServer::FOServer(GlobalSettings& settings, ScriptSystem* script_sys) :
     }
 
     // Deferred calls
-    // if (!ScriptSys.LoadDeferredCalls())
-    //    return false;
+    if (!DeferredCallMngr.LoadDeferredCalls()) {
+        throw ServerInitException("Failed to load deferred calls");
+    }
 
     // Resource packs for client
     {
@@ -287,9 +301,14 @@ FOServer::FOServer(GlobalSettings& settings, ScriptSystem* script_sys) :
         const auto item_fabric = [this](uint id, const ProtoItem* proto) { return new Item(this, id, proto); };
         EntityMngr.LoadEntities(loc_fabric, map_fabric, cr_fabric, item_fabric);
 
+        const auto link_time = Timer::RealtimeTick();
         MapMngr.LinkMaps();
+        const auto link_maps_time = Timer::RealtimeTick();
         CrMngr.LinkCritters();
+        const auto link_critters_time = Timer::RealtimeTick();
         ItemMngr.LinkItems();
+        const auto link_items_time = Timer::RealtimeTick();
+        WriteLog("Link entities complete (maps {:.0f}ms, critters {:.0f}ms, items {:.0f}ms)", link_maps_time - link_time, link_critters_time - link_maps_time, link_items_time - link_critters_time);
 
         EntityMngr.InitAfterLoad();
 
@@ -342,6 +361,10 @@ void FOServer::Shutdown()
 {
     _willFinishDispatcher();
 
+    // Background map workers
+    PathFindMngr.Stop();
+    FlowFieldMngr.Stop();
+
     // Finish logic
     DbStorage.StartChanges();
     if (DbHistory) {
@@ -403,6 +426,24 @@ void FOServer::Shutdown()
     WriteLog("Min cycle period: {}", _stats.LoopMin);
     WriteLog("Max cycle period: {}", _stats.LoopMax);
     WriteLog("Count of lags (>100ms): {}", _stats.LagsCount);
+    const auto& tick_stats = _tickScheduler.GetStatistics();
+    WriteLog("Tick overruns: {} (max {:.2f} ms)", tick_stats.Overruns, tick_stats.MaxOverrun);
+    WriteLog("Catch up ticks: {}, dropped ticks: {}", tick_stats.CatchUpTicks, tick_stats.DroppedTicks);
+    for (uint i = 0; i < static_cast<uint>(NetCodecType::Count); i++) {
+        const auto codec_stats = NetCodec::GetStatistics(static_cast<NetCodecType>(i));
+        if (codec_stats.EncodeCalls != 0u) {
+            WriteLog("Net codec {}: {} bytes to {} bytes in {} sends, encode time {} us", NetCodec::GetTypeName(static_cast<NetCodecType>(i)), codec_stats.EncodeInBytes, codec_stats.EncodeOutBytes, codec_stats.EncodeCalls, codec_stats.EncodeTime);
+        }
+    }
+    for (uint i = 0; i < static_cast<uint>(AllocationSubsystem::Count); i++) {
+        const auto alloc_stats = AllocationCounters::GetStatistics(static_cast<AllocationSubsystem>(i));
+        WriteLog("Memory {}: {} allocations ({} reused), {} frees, peak {} bytes", AllocationCounters::GetSubsystemName(static_cast<AllocationSubsystem>(i)), alloc_stats.Allocations, alloc_stats.PoolReuses, alloc_stats.Deallocations, alloc_stats.PeakBytes);
+    }
+    const auto& output_stats = OutgoingScheduler::GetStatistics();
+    for (uint i = 0; i < static_cast<uint>(OutgoingLane::Count); i++) {
+        WriteLog("Output {}: {} messages, {} bytes", OutgoingScheduler::GetLaneName(static_cast<OutgoingLane>(i)), output_stats.LaneMessages[i], output_stats.LaneBytes[i]);
+    }
+    WriteLog("Output coalesced: {}, shaped flushes: {}, slow clients: {}, overflows: {}", output_stats.Coalesced, output_stats.ShapedFlushes, output_stats.SlowConsumers, output_stats.Overflows);
 
     _didFinishDispatcher();
 }
@@ -411,6 +452,15 @@ void FOServer::MainLoop()
 {
     // Todo: move server loop to async processing
 
+    // Embedded servers poll loop every frame, dedicated ones sleep in WaitTick
+    const auto frame_begin = Timer::RealtimeTick();
+    if (!_tickScheduler.IsTickDue(frame_begin)) {
+        return;
+    }
+
+    _tickScheduler.BeginTick(frame_begin);
+    _frameArena.Reset();
+
     if (GameTime.FrameAdvance()) {
         const auto st = GameTime.GetGameTime(GameTime.GetFullSecond());
         SetYear(st.Year);
@@ -421,9 +471,6 @@ void FOServer::MainLoop()
         SetSecond(st.Second);
     }
 
-    // Cycle time
-    const auto frame_begin = Timer::RealtimeTick();
-
     // Begin data base changes
     DbStorage.StartChanges();
     if (DbHistory) {
@@ -432,11 +479,11 @@ void FOServer::MainLoop()
 
     // Process free connections
     {
-        vector<ClientConnection*> free_connections;
+        frame_vector<ClientConnection*> free_connections {FrameArenaAllocator<ClientConnection*>(_frameArena)};
 
         {
             std::lock_guard locker(_freeConnectionsLocker);
-            free_connections = copy(_freeConnections);
+            free_connections.assign(_freeConnections.begin(), _freeConnections.end());
         }
 
         for (auto* free_connection : free_connections) {
@@ -447,7 +494,7 @@ void FOServer::MainLoop()
 
     // Process players
     {
-        const auto players = copy(EntityMngr.GetPlayers());
+        const auto players = EntityMngr.GetPlayers(_frameArena);
 
         for (const auto* player : players) {
             player->AddRef();
@@ -470,12 +517,40 @@ void FOServer::MainLoop()
         }
     }
 
-    // Process critters
-    for (auto* cr : copy(EntityMngr.GetCritters())) {
+    // Path finding results
+    try {
+        PathFindMngr.Process();
+        FlowFieldMngr.Process();
+    }
+    catch (const std::exception& ex) {
+        ReportExceptionAndContinue(ex);
+    }
+
+    // Dormancy tiers, maps without players processed at low frequency
+    const auto dormant_process_period = Settings.DormantProcessPeriod;
+    const auto game_tick = GameTime.GameTick();
+
+    _stats.ActiveMaps = 0;
+    _stats.DormantMaps = 0;
+    _stats.DormantMapsProcessed = 0;
+    _stats.ActiveCritters = 0;
+
+    for (auto* map : EntityMngr.GetMaps(_frameArena)) {
+        map->UpdateDormancy(dormant_process_period);
+    }
+
+    // Process critters, sleeping and dormant ones stay out of awake set until their wake up tick
+    EntityMngr.WakeDueCritters(game_tick);
+
+    for (auto* cr : EntityMngr.GetAwakeCritters(_frameArena)) {
         if (cr->IsDestroyed()) {
             continue;
         }
 
+        if (IsCritterDormant(cr, game_tick)) {
+            continue;
+        }
+
         try {
             ProcessCritter(cr);
         }
@@ -484,20 +559,43 @@ void FOServer::MainLoop()
         }
     }
 
+    _stats.SuspendedCritters = static_cast<uint>(EntityMngr.GetSuspendedCrittersCount());
+
     // Process maps
-    for (auto* map : copy(EntityMngr.GetMaps())) {
+    for (auto* map : EntityMngr.GetMaps(_frameArena)) {
         if (map->IsDestroyed()) {
             continue;
         }
 
         try {
-            map->Process();
+            if (map->IsDormant()) {
+                _stats.DormantMaps++;
+                if (map->ProcessDormant(game_tick, dormant_process_period)) {
+                    _stats.DormantMapsProcessed++;
+                }
+            }
+            else {
+                _stats.ActiveMaps++;
+                map->Process();
+            }
         }
         catch (const std::exception& ex) {
             ReportExceptionAndContinue(ex);
         }
     }
 
+    // Deferred calls
+    try {
+        DeferredCallMngr.Process();
+
+        if (uint delay = 0; DeferredCallMngr.GetNextCallDelay(delay)) {
+            _tickScheduler.SetTimer(Timer::RealtimeTick() + static_cast<double>(delay));
+        }
+    }
+    catch (const std::exception& ex) {
+        ReportExceptionAndContinue(ex);
+    }
+
     try {
         MapMngr.LocationGarbager();
     }
@@ -508,6 +606,14 @@ void FOServer::MainLoop()
     // Script game loop
     OnLoop.Fire();
 
+    // Publish maps state for readers on other threads
+    try {
+        WorldSnapshotMngr.Publish();
+    }
+    catch (const std::exception& ex) {
+        ReportExceptionAndContinue(ex);
+    }
+
     // Commit changed to data base
     DbStorage.CommitChanges();
     if (DbHistory) {
@@ -518,7 +624,10 @@ void FOServer::MainLoop()
     DispatchLogToClients();
 
     // Fill statistics
-    const auto frame_time = Timer::RealtimeTick() - frame_begin;
+    const auto frame_end = Timer::RealtimeTick();
+    const auto frame_time = frame_end - frame_begin;
+    _tickScheduler.EndTick(frame_end);
+
     const auto loop_tick = static_cast<uint>(frame_time);
     _stats.LoopTime += loop_tick;
     _stats.LoopCycles++;
@@ -543,11 +652,11 @@ void FOServer::MainLoop()
     else {
         _fpsCounter++;
     }
+}
 
-    // Sleep
-    if (Settings.GameSleep >= 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(Settings.GameSleep));
-    }
+void FOServer::WaitTick()
+{
+    _tickScheduler.WaitTick();
 }
 
 void FOServer::DrawGui(string_view server_name)
@@ -576,7 +685,39 @@ void FOServer::DrawGui(string_view server_name)
             buf += _str("Uptime: {:02}:{:02}:{:02}\n", seconds / 60 / 60, seconds / 60 % 60, seconds % 60);
             buf += _str("KBytes Send: {}\n", _stats.BytesSend / 1024);
             buf += _str("KBytes Recv: {}\n", _stats.BytesRecv / 1024);
-            buf += _str("Compress ratio: {}", static_cast<double>(_stats.DataReal) / (_stats.DataCompressed != 0 ? _stats.DataCompressed : 1));
+            for (uint i = 0; i < static_cast<uint>(NetCodecType::Count); i++) {
+                const auto codec_stats = NetCodec::GetStatistics(static_cast<NetCodecType>(i));
+                if (codec_stats.EncodeCalls != 0u) {
+                    buf += _str("Net codec {}: {} KB to {} KB, encode {} ms\n", NetCodec::GetTypeName(static_cast<NetCodecType>(i)), codec_stats.EncodeInBytes / 1024, codec_stats.EncodeOutBytes / 1024, codec_stats.EncodeTime / 1000);
+                }
+            }
+            for (uint i = 0; i < static_cast<uint>(AllocationSubsystem::Count); i++) {
+                const auto alloc_stats = AllocationCounters::GetStatistics(static_cast<AllocationSubsystem>(i));
+                buf += _str("Memory {}: {} KB (peak {} KB), allocations {}, reused {}\n", AllocationCounters::GetSubsystemName(static_cast<AllocationSubsystem>(i)), alloc_stats.LiveBytes / 1024, alloc_stats.PeakBytes / 1024, alloc_stats.Allocations, alloc_stats.PoolReuses);
+            }
+            const auto& output_stats = OutgoingScheduler::GetStatistics();
+            for (uint i = 0; i < static_cast<uint>(OutgoingLane::Count); i++) {
+                buf += _str("Output {}: {} messages, {} KB\n", OutgoingScheduler::GetLaneName(static_cast<OutgoingLane>(i)), output_stats.LaneMessages[i], output_stats.LaneBytes[i] / 1024);
+            }
+            buf += _str("Output coalesced {}, shaped {}, slow clients {} (now {}), overflows {}\n", output_stats.Coalesced, output_stats.ShapedFlushes, output_stats.SlowConsumers, output_stats.SlowConsumersNow, output_stats.Overflows);
+            const auto& trace_stats = MapMngr.GetBulletTracerStatistics();
+            buf += _str("Batched traces: {} in {} batches, {} hexes\n", trace_stats.Traces, trace_stats.Batches, trace_stats.Hexes);
+            const auto log_stats = GetLogStatistics();
+            buf += _str("Log messages: {} (dropped {}, rotations {})\n", log_stats.Written, log_stats.Dropped, log_stats.Rotations);
+            buf += _str("Critters active/suspended: {}/{}\n", _stats.ActiveCritters, _stats.SuspendedCritters);
+            buf += _str("Maps active/dormant: {}/{} (processed {})\n", _stats.ActiveMaps, _stats.DormantMaps, _stats.DormantMapsProcessed);
+            const auto& path_stats = PathFindMngr.GetStatistics();
+            buf += _str("Path finding: requests {}, searches {}, shared {}, stale {}, pending {}\n", path_stats.Requests, path_stats.Searches, path_stats.Deduplicated, path_stats.Stale, path_stats.Pending);
+            const auto& flow_stats = FlowFieldMngr.GetStatistics();
+            buf += _str("Flow fields: {} ({} KB), hits {}, misses {}, builds {} (pending {}), repairs {}, evictions {}\n", flow_stats.Fields, flow_stats.MemorySize / 1024, flow_stats.Hits, flow_stats.Misses, flow_stats.Builds, flow_stats.Pending, flow_stats.Repairs, flow_stats.Evictions);
+            if (WorldSnapshotMngr.IsEnabled()) {
+                const auto& snapshot_stats = WorldSnapshotMngr.GetStatistics();
+                buf += _str("World snapshots: {} (unchanged {}, retired {}), maps copied {}, shared {}, hex flags copied {} KB, critters copied {}\n", snapshot_stats.Publishes, snapshot_stats.Unchanged, snapshot_stats.Retired, snapshot_stats.MapsCopied, snapshot_stats.MapsShared, snapshot_stats.HexFlagsCopied / 1024, snapshot_stats.CrittersCopied);
+            }
+            const auto& tick_stats = _tickScheduler.GetStatistics();
+            buf += _str("Ticks: {} (input {}, timer {}), load {:.0f}%\n", tick_stats.Ticks, tick_stats.InputTicks, tick_stats.TimerTicks, tick_stats.Load * 100.0);
+            buf += _str("Tick time avg {:.2f} ms, max {:.2f} ms\n", tick_stats.AvgTickTime, tick_stats.MaxTickTime);
+            buf += _str("Tick overruns: {} (max {:.2f} ms), catch up {}, dropped {}", tick_stats.Overruns, tick_stats.MaxOverrun, tick_stats.CatchUpTicks, tick_stats.DroppedTicks);
             ImGui::TextUnformatted(buf.c_str(), buf.c_str() + buf.size());
             ImGui::TreePop();
         }
@@ -653,7 +794,16 @@ void FOServer::OnNewConnection(NetConnection* net_connection)
         return;
     }
 
-    auto* connection = new ClientConnection(net_connection);
+    OutgoingScheduler::Config output_config;
+    output_config.BytesPerSecond = Settings.ClientOutputBandwidth;
+    output_config.BurstBytes = Settings.ClientOutputBurst;
+    output_config.Watermark = Settings.ClientOutputWatermark;
+    output_config.SlowConsumerBytes = Settings.SlowClientOutputSize;
+    output_config.SlowConsumerTime = Settings.SlowClientOutputTime;
+    output_config.MaxQueuedBytes = Settings.MaxClientOutputSize;
+
+    auto* connection = new ClientConnection(net_connection, output_config);
+    _tickScheduler.Notify();
 
     // Add to free connections
     {
@@ -673,25 +823,18 @@ void FOServer::ProcessFreeConnection(ClientConnection* connection)
         return;
     }
 
-    std::lock_guard locker(connection->BinLocker);
-
     if (connection->IsGracefulDisconnected()) {
-        connection->Bin.ResetBuf();
+        connection->ClearInput();
         return;
     }
 
-    connection->Bin.ShrinkReadBuf();
-
-    if (connection->Bin.NeedProcess()) {
-        uint msg = 0;
-        connection->Bin >> msg;
-
+    if (uint msg = 0; connection->ReadMsg(msg)) {
         switch (msg) {
         case 0xFFFFFFFF: {
             // At least 16 bytes should be sent for backward compatibility,
             // even if answer data will change its meaning
+            // Goes raw, status requests come without handshake
             CONNECTION_OUTPUT_BEGIN(connection);
-            connection->DisableCompression();
             connection->Bout << _stats.CurOnline;
             connection->Bout << _stats.Uptime;
             connection->Bout << static_cast<uint>(0);
@@ -722,7 +865,6 @@ void FOServer::ProcessFreeConnection(ClientConnection* connection)
             Process_UpdateFileData(connection);
             break;
         default:
-            connection->Bin.SkipMsg(msg);
             break;
         }
 
@@ -768,25 +910,13 @@ void FOServer::ProcessPlayerConnection(Player* player)
     }
 
     if (player->Connection->IsGracefulDisconnected()) {
-        std::lock_guard locker(player->Connection->BinLocker);
-        player->Connection->Bin.ResetBuf();
+        player->Connection->ClearInput();
         return;
     }
 
     if (player->IsTransferring) {
-        while (!player->Connection->IsHardDisconnected() && !player->Connection->IsGracefulDisconnected()) {
-            std::lock_guard locker(player->Connection->BinLocker);
-
-            player->Connection->Bin.ShrinkReadBuf();
-
-            if (!player->Connection->Bin.NeedProcess()) {
-                CHECK_CLIENT_IN_BUF_ERROR(player->Connection);
-                break;
-            }
-
-            uint msg = 0;
-            player->Connection->Bin >> msg;
-
+        uint msg = 0;
+        while (!player->Connection->IsHardDisconnected() && !player->Connection->IsGracefulDisconnected() && player->Connection->ReadMsg(msg)) {
             switch (msg) {
             case NETMSG_PING:
                 Process_Ping(player->Connection);
@@ -798,7 +928,6 @@ void FOServer::ProcessPlayerConnection(Player* player)
                 Process_PlaceToGame(player);
                 break;
             default:
-                player->Connection->Bin.SkipMsg(msg);
                 break;
             }
 
@@ -808,19 +937,8 @@ void FOServer::ProcessPlayerConnection(Player* player)
         }
     }
     else {
-        while (!player->Connection->IsHardDisconnected() && !player->Connection->IsGracefulDisconnected()) {
-            std::lock_guard locker(player->Connection->BinLocker);
-
-            player->Connection->Bin.ShrinkReadBuf();
-
-            if (!player->Connection->Bin.NeedProcess()) {
-                CHECK_CLIENT_IN_BUF_ERROR(player->Connection);
-                break;
-            }
-
-            uint msg = 0;
-            player->Connection->Bin >> msg;
-
+        uint msg = 0;
+        while (!player->Connection->IsHardDisconnected() && !player->Connection->IsGracefulDisconnected() && player->Connection->ReadMsg(msg)) {
             switch (msg) {
             case NETMSG_PING:
                 Process_Ping(player->Connection);
@@ -880,7 +998,6 @@ void FOServer::ProcessPlayerConnection(Player* player)
                 Process_Property(player, 0);
                 break;
             default:
-                player->Connection->Bin.SkipMsg(msg);
                 break;
             }
 
@@ -929,6 +1046,9 @@ void FOServer::ProcessConnection(ClientConnection* connection)
         connection->PingNextTick = GameTime.FrameTick() + PING_CLIENT_LIFE_TIME;
         connection->PingOk = false;
     }
+
+    // Output held by shaping or watermark
+    connection->Dispatch();
 }
 
 void FOServer::Process_Text(Player* player)
@@ -1140,7 +1260,7 @@ void FOServer::Process_CommandReal(NetInBuffer& buf, const LogFunc& logcb, Playe
             result = MapMngr.GetLocationAndMapsStatistics();
             break;
         case 3:
-            // result = ScriptSys.GetDeferredCallsStatistics();
+            result = DeferredCallMngr.GetStatistics();
             break;
         case 4:
             result = "WIP";
@@ -1602,6 +1722,46 @@ void FOServer::DispatchLogToClients()
     _logLines.clear();
 }
 
+auto FOServer::IsCritterDormant(Critter* cr, uint tick) -> bool
+{
+    // Players and moving critters always processed, movement also wakes up sleeping critter
+    if (cr->IsPlayer() || cr->Moving.State == MovingState::InProgress) {
+        cr->DormantWakeTick = 0u;
+        _stats.ActiveCritters++;
+        return false;
+    }
+
+    // Sleep requested from scripts, leaves awake set until wake up tick
+    if (cr->DormantWakeTick != 0u) {
+        if (static_cast<int>(cr->DormantWakeTick - tick) > 0) {
+            EntityMngr.SuspendCritter(cr, cr->DormantWakeTick);
+            return true;
+        }
+
+        cr->DormantWakeTick = 0u;
+    }
+
+    // Npc on map without players follows map low frequency tier
+    const auto* map = cr->GetMapId() != 0u ? MapMngr.GetMap(cr->GetMapId()) : nullptr;
+    if (map == nullptr || !map->IsDormant()) {
+        _stats.ActiveCritters++;
+        return false;
+    }
+
+    const auto process_period = Settings.DormantProcessPeriod;
+
+    if (tick - cr->DormantProcessTick < process_period) {
+        EntityMngr.SuspendCritter(cr, cr->DormantProcessTick + process_period);
+        return true;
+    }
+
+    // Processed now and suspended for next period
+    cr->DormantProcessTick = tick;
+    EntityMngr.SuspendCritter(cr, tick + process_period);
+    _stats.ActiveCritters++;
+    return false;
+}
+
 void FOServer::ProcessCritter(Critter* cr)
 {
     if (GameTime.IsGamePaused()) {
@@ -1804,8 +1964,7 @@ void FOServer::Process_Update(ClientConnection* connection)
     // Begin data encrypting
     uint encrypt_key = 0;
     connection->Bin >> encrypt_key;
-    connection->Bin.SetEncryptKey(encrypt_key);
-    connection->Bout.SetEncryptKey(encrypt_key);
+    connection->SetOutputEncryptKey(encrypt_key);
 
     CHECK_CLIENT_IN_BUF_ERROR(connection);
 
@@ -1898,9 +2057,8 @@ void FOServer::Process_Register(ClientConnection* connection)
 
     CHECK_CLIENT_IN_BUF_ERROR(connection);
 
-    // Begin data encrypting
-    connection->Bin.SetEncryptKey(1234567890);
-    connection->Bout.SetEncryptKey(1234567890);
+    // Begin data encrypting, input is switched by network thread
+    connection->SetOutputEncryptKey(1234567890);
 
     // Check protocol
     if (proto_ver != static_cast<ushort>(FO_COMPATIBILITY_VERSION)) {
@@ -2005,9 +2163,8 @@ void FOServer::Process_LogIn(ClientConnection* connection)
 
     CHECK_CLIENT_IN_BUF_ERROR(connection);
 
-    // Begin data encrypting
-    connection->Bin.SetEncryptKey(12345);
-    connection->Bout.SetEncryptKey(12345);
+    // Begin data encrypting, input is switched by network thread
+    connection->SetOutputEncryptKey(12345);
 
     // Check protocol
     if (proto_ver != static_cast<ushort>(FO_COMPATIBILITY_VERSION)) {
@@ -2170,6 +2327,9 @@ void FOServer::Process_LogIn(ClientConnection* connection)
     const auto whole_player_data_size = StoreData(false, &player_data, &player_data_sizes);
     msg_len += sizeof(ushort) + whole_player_data_size;
 
+    // Client answers with new key right after receiving this message
+    connection->SetInputEncryptKey(bin_seed);
+
     CONNECTION_OUTPUT_BEGIN(connection);
     connection->Bout << NETMSG_LOGIN_SUCCESS;
     connection->Bout << msg_len;
@@ -2179,8 +2339,7 @@ void FOServer::Process_LogIn(ClientConnection* connection)
     NET_WRITE_PROPERTIES(connection->Bout, player_data, player_data_sizes);
     CONNECTION_OUTPUT_END(connection);
 
-    connection->Bin.SetEncryptKey(bin_seed);
-    connection->Bout.SetEncryptKey(bout_seed);
+    connection->SetOutputEncryptKey(bout_seed);
 
     player->Send_LoadMap(nullptr, MapMngr);
 }
@@ -2881,6 +3040,38 @@ void FOServer::OnSetItemOpened(Entity* entity, const Property* prop, const void*
     }
 }
 
+void FOServer::OnSetCritterWorldPos(Entity* entity, const Property* prop, const void* new_value, const void* old_value)
+{
+    UNUSED_VARIABLE(new_value);
+
+    // WorldX, WorldY
+    auto* cr = dynamic_cast<Critter*>(entity);
+
+    if (cr->GlobalMapGroup != nullptr) {
+        const auto old_pos = *static_cast<const ushort*>(old_value);
+        if (prop == cr->GetPropertyWorldX()) {
+            CrMngr.MoveInGlobalMapGrid(cr, old_pos, cr->GetWorldY());
+        }
+        else {
+            CrMngr.MoveInGlobalMapGrid(cr, cr->GetWorldX(), old_pos);
+        }
+    }
+}
+
+void FOServer::OnSetCritterMapState(Entity* entity, const Property* prop, const void* new_value, const void* old_value)
+{
+    UNUSED_VARIABLE(prop);
+    UNUSED_VARIABLE(new_value);
+    UNUSED_VARIABLE(old_value);
+
+    // HexX, HexY, Dir, Multihex, Cond, IsHide
+    const auto* cr = dynamic_cast<Critter*>(entity);
+
+    if (auto* map = MapMngr.GetMap(cr->GetMapId()); map != nullptr) {
+        map->MarkCrittersChanged();
+    }
+}
+
 void FOServer::ProcessCritterMoving(Critter* cr)
 {
     if (cr->Moving.State != MovingState::InProgress) {
@@ -2948,7 +3139,24 @@ void FOServer::ProcessCritterMoving(Critter* cr)
             return;
         }
 
-        auto output = MapMngr.FindPath(input);
+        FindPathOutput output;
+        if (cr->Moving.TargId != 0u && FlowFieldMngr.FindPath(input, output)) {
+            // Critters moving to same target share one flow field
+        }
+        else if (PathFindMngr.IsEnabled()) {
+            // Path is searched on worker threads, critter waits for result
+            const auto state = PathFindMngr.TakeResult(cr, input, output);
+            if (state != PathFindManager::RequestState::Ready) {
+                if (state == PathFindManager::RequestState::None) {
+                    PathFindMngr.RequestPath(cr, input);
+                }
+                return;
+            }
+        }
+        else {
+            output = MapMngr.FindPath(input);
+        }
+
         if (output.GagCritter != nullptr) {
             cr->Moving.State = MovingState::GagCritter;
             cr->Moving.GagEntityId = output.GagCritter->GetId();
@@ -47,6 +47,7 @@
 #include "EngineBase.h"
 #include "EntityManager.h"
 #include "FileSystem.h"
+#include "FlowFieldManager.h"
 #include "GeometryHelper.h"
 #include "Item.h"
 #include "ItemManager.h"
@@ -54,12 +55,16 @@
 #include "Log.h"
 #include "Map.h"
 #include "MapManager.h"
+#include "MemoryPool.h"
+#include "PathFindManager.h"
 #include "Player.h"
 #include "ProtoManager.h"
 #include "ScriptSystem.h"
 #include "Settings.h"
 #include "StringUtils.h"
+#include "TickScheduler.h"
 #include "Timer.h"
+#include "WorldSnapshotManager.h"
 #if FO_SINGLEPLAYER
 #include "Client.h"
 #endif
@@ -95,6 +100,7 @@ class FOServer final : public FOEngineBase
 
     void Shutdown();
     void MainLoop();
+    void WaitTick();
     void DrawGui(string_view server_name);
 
     void SetGameTime(int multiplier, int year, int month, int day, int hour, int minute, int second);
@@ -188,6 +194,9 @@ class FOServer final : public FOEngineBase
 
     EntityManager EntityMngr;
     MapManager MapMngr;
+    WorldSnapshotManager WorldSnapshotMngr; // Before workers which read snapshots, so destroyed after them
+    PathFindManager PathFindMngr;
+    FlowFieldManager FlowFieldMngr;
     CritterManager CrMngr;
     ItemManager ItemMngr;
     DialogManager DlgMngr;
@@ -202,8 +211,6 @@ class FOServer final : public FOEngineBase
         uint Uptime {};
         int64 BytesSend {};
         int64 BytesRecv {};
-        int64 DataReal {1};
-        int64 DataCompressed {1};
         float CompressRatio {};
         uint MaxOnline {};
         uint CurOnline {};
@@ -214,6 +221,11 @@ class FOServer final : public FOEngineBase
         uint LoopMin {};
         uint LoopMax {};
         uint LagsCount {};
+        uint ActiveCritters {};
+        uint SuspendedCritters {};
+        uint ActiveMaps {};
+        uint DormantMaps {};
+        uint DormantMapsProcessed {};
     };
 
     struct TextListener
@@ -264,7 +276,10 @@ class FOServer final : public FOEngineBase
     void OnSetItemIsGeck(Entity* entity, const Property* prop, const void* new_value, const void* old_value);
     void OnSetItemIsRadio(Entity* entity, const Property* prop, const void* new_value, const void* old_value);
     void OnSetItemOpened(Entity* entity, const Property* prop, const void* new_value, const void* old_value);
+    void OnSetCritterWorldPos(Entity* entity, const Property* prop, const void* new_value, const void* old_value);
+    void OnSetCritterMapState(Entity* entity, const Property* prop, const void* new_value, const void* old_value);
 
+    [[nodiscard]] auto IsCritterDormant(Critter* cr, uint tick) -> bool;
     void ProcessCritter(Critter* cr);
     void ProcessCritterMoving(Critter* cr);
     auto MoveCritter(Critter* cr, ushort hx, ushort hy, uint move_params) -> bool;
@@ -281,6 +296,8 @@ class FOServer final : public FOEngineBase
     std::atomic_bool _started {};
     vector<uchar> _restoreInfoBin {};
     ServerStats _stats {};
+    TickScheduler _tickScheduler;
+    FrameArena _frameArena {64 * 1024};
     map<uint, uint> _regIp {};
     uint _fpsTick {};
     uint _fpsCounter {};
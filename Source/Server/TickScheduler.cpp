@@ -0,0 +1,162 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "TickScheduler.h"
+#include "Timer.h"
+
+TickScheduler::TickScheduler(uint tick_rate, uint max_catch_up, uint min_tick_interval) : _tickPeriod {tick_rate != 0u ? 1000.0 / static_cast<double>(tick_rate) : 0.0}, _maxCatchUp {max_catch_up}, _minTickInterval {static_cast<double>(min_tick_interval)}
+{
+}
+
+auto TickScheduler::GetTickPeriod() const -> double
+{
+    return _tickPeriod;
+}
+
+auto TickScheduler::GetStatistics() const -> const Statistics&
+{
+    return _stats;
+}
+
+auto TickScheduler::IsTickDue(double time) const -> bool
+{
+    if (_tickPeriod == 0.0 || time >= _nextTickTime) {
+        return true;
+    }
+
+    // Early ticks are spaced by minimal interval to gather input from several clients
+    if (time < _tickBeginTime + _minTickInterval) {
+        return false;
+    }
+
+    return _inputPending || (_timerSet && time >= _timerTime);
+}
+
+void TickScheduler::Notify()
+{
+    if (!_inputPending.exchange(true)) {
+        std::lock_guard locker(_waitLocker);
+        _waitSignal.notify_one();
+    }
+}
+
+void TickScheduler::SetTimer(double fire_time)
+{
+    if (!_timerSet || fire_time < _timerTime) {
+        _timerTime = fire_time;
+        _timerSet = true;
+    }
+}
+
+void TickScheduler::BeginTick(double time)
+{
+    // Input received from now is processed by next tick
+    const auto input_pending = _inputPending.exchange(false);
+
+    _tickBeginTime = time;
+    _timerSet = false;
+    _stats.Ticks++;
+
+    if (_tickPeriod == 0.0) {
+        return;
+    }
+
+    if (_nextTickTime == 0.0) {
+        _nextTickTime = time + _tickPeriod;
+    }
+    else if (time >= _nextTickTime) {
+        const auto late_ticks = static_cast<uint64>((time - _nextTickTime) / _tickPeriod);
+
+        if (late_ticks == 0u) {
+            _nextTickTime += _tickPeriod;
+        }
+        else if (late_ticks <= _maxCatchUp && _stats.Load < 1.0) {
+            // Keep schedule and run missed ticks back to back
+            _stats.CatchUpTicks++;
+            _nextTickTime += _tickPeriod;
+        }
+        else {
+            // Server can't keep up, catching up only increases lag
+            _stats.DroppedTicks += late_ticks;
+            _nextTickTime = time + _tickPeriod;
+        }
+    }
+    else if (input_pending) {
+        _stats.InputTicks++;
+    }
+    else {
+        _stats.TimerTicks++;
+    }
+}
+
+void TickScheduler::EndTick(double time)
+{
+    const auto tick_time = time - _tickBeginTime;
+
+    _stats.LastTickTime = tick_time;
+    _stats.MaxTickTime = std::max(_stats.MaxTickTime, tick_time);
+    _stats.AvgTickTime = _stats.Ticks > 1u ? _stats.AvgTickTime * 0.95 + tick_time * 0.05 : tick_time;
+
+    if (_tickPeriod != 0.0) {
+        _stats.Load = _stats.Load * 0.95 + tick_time / _tickPeriod * 0.05;
+
+        if (tick_time > _tickPeriod) {
+            _stats.Overruns++;
+            _stats.MaxOverrun = std::max(_stats.MaxOverrun, tick_time - _tickPeriod);
+        }
+    }
+}
+
+void TickScheduler::WaitTick()
+{
+    while (true) {
+        const auto time = Timer::RealtimeTick();
+        if (IsTickDue(time)) {
+            break;
+        }
+
+        const auto early_time = _tickBeginTime + _minTickInterval;
+        auto wake_time = _nextTickTime;
+        if (_timerSet) {
+            wake_time = std::min(wake_time, std::max(_timerTime, early_time));
+        }
+
+        if (time < early_time) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(std::min(wake_time, early_time) - time));
+        }
+        else {
+            std::unique_lock locker(_waitLocker);
+            _waitSignal.wait_for(locker, std::chrono::duration<double, std::milli>(wake_time - time), [this] { return _inputPending.load(); });
+        }
+    }
+}
@@ -0,0 +1,91 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include <condition_variable>
+
+// Paces server loop to target tick rate
+// Sleeps only for remaining tick budget and wakes early on network input or due timer
+// Overrun ticks are caught up back to back while server keeps up on average, otherwise schedule is dropped
+class TickScheduler final
+{
+public:
+    struct Statistics
+    {
+        uint64 Ticks {};
+        uint64 InputTicks {};
+        uint64 TimerTicks {};
+        uint64 Overruns {};
+        uint64 CatchUpTicks {};
+        uint64 DroppedTicks {};
+        double LastTickTime {};
+        double MaxTickTime {};
+        double MaxOverrun {};
+        double AvgTickTime {};
+        double Load {};
+    };
+
+    TickScheduler() = delete;
+    TickScheduler(uint tick_rate, uint max_catch_up, uint min_tick_interval);
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler(TickScheduler&&) noexcept = delete;
+    auto operator=(const TickScheduler&) = delete;
+    auto operator=(TickScheduler&&) noexcept = delete;
+    ~TickScheduler() = default;
+
+    [[nodiscard]] auto GetTickPeriod() const -> double;
+    [[nodiscard]] auto GetStatistics() const -> const Statistics&;
+    [[nodiscard]] auto IsTickDue(double time) const -> bool;
+
+    void Notify();
+    void SetTimer(double fire_time);
+    void BeginTick(double time);
+    void EndTick(double time);
+    void WaitTick();
+
+private:
+    double _tickPeriod;
+    uint _maxCatchUp;
+    double _minTickInterval;
+    double _nextTickTime {};
+    double _tickBeginTime {};
+    double _timerTime {};
+    bool _timerSet {};
+    std::atomic_bool _inputPending {};
+    std::mutex _waitLocker {};
+    std::condition_variable _waitSignal {};
+    Statistics _stats {};
+};
@@ -0,0 +1,200 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "WorldSnapshotManager.h"
+#include "Critter.h"
+#include "Server.h"
+
+auto MapSnapshot::GetCritter(uint cr_id) const -> const CritterEntry*
+{
+    const auto it = std::lower_bound(Critters->begin(), Critters->end(), cr_id, [](const CritterEntry& entry, uint id) { return entry.Id < id; });
+    return it != Critters->end() && it->Id == cr_id ? &*it : nullptr;
+}
+
+auto WorldSnapshot::GetMap(uint map_id) const -> const MapSnapshot*
+{
+    const auto* map = FindMap(map_id);
+    return map != nullptr ? map->get() : nullptr;
+}
+
+auto WorldSnapshot::FindMap(uint map_id) const -> const shared_ptr<const MapSnapshot>*
+{
+    const auto it = std::lower_bound(Maps.begin(), Maps.end(), map_id, [](const shared_ptr<const MapSnapshot>& map, uint id) { return map->MapId < id; });
+    return it != Maps.end() && (*it)->MapId == map_id ? &*it : nullptr;
+}
+
+WorldSnapshotManager::WorldSnapshotManager(FOServer* engine) : _engine {engine}
+{
+}
+
+auto WorldSnapshotManager::IsEnabled() const -> bool
+{
+    return _engine->Settings.WorldSnapshots;
+}
+
+auto WorldSnapshotManager::Read() const -> ReadGuard
+{
+    return _publisher.Read();
+}
+
+auto WorldSnapshotManager::IsMapPublished(uint map_id) const -> bool
+{
+    const auto* world = _publisher.GetPublished();
+    return world != nullptr && world->GetMap(map_id) != nullptr;
+}
+
+auto WorldSnapshotManager::GetPublishedMap(uint map_id) const -> shared_ptr<const MapSnapshot>
+{
+    const auto* world = _publisher.GetPublished();
+    const auto* map = world != nullptr ? world->FindMap(map_id) : nullptr;
+    return map != nullptr ? *map : nullptr;
+}
+
+void WorldSnapshotManager::Publish()
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    const auto* prev_world = _publisher.GetPublished();
+    auto world = std::make_unique<WorldSnapshot>();
+    auto changed = prev_world == nullptr;
+    size_t prev_index = 0;
+
+    // Both lists are sorted by map id
+    for (auto* map : _engine->EntityMngr.GetMaps()) {
+        if (map->IsDestroyed()) {
+            continue;
+        }
+
+        const shared_ptr<const MapSnapshot>* prev_snapshot = nullptr;
+        if (prev_world != nullptr) {
+            while (prev_index < prev_world->Maps.size() && prev_world->Maps[prev_index]->MapId < map->GetId()) {
+                prev_index++;
+                changed = true;
+            }
+
+            if (prev_index < prev_world->Maps.size() && prev_world->Maps[prev_index]->MapId == map->GetId()) {
+                prev_snapshot = &prev_world->Maps[prev_index];
+                prev_index++;
+            }
+        }
+
+        auto snapshot = MakeMapSnapshot(map, prev_snapshot);
+        if (prev_snapshot == nullptr || snapshot != *prev_snapshot) {
+            changed = true;
+        }
+
+        world->Maps.emplace_back(std::move(snapshot));
+    }
+
+    if (prev_world != nullptr && prev_index != prev_world->Maps.size()) {
+        changed = true;
+    }
+
+    if (!changed) {
+        _stats.Unchanged++;
+        _publisher.Reclaim();
+        _stats.Retired = _publisher.GetRetiredCount();
+        return;
+    }
+
+    world->Version = ++_version;
+    world->GameTick = _engine->GameTime.GameTick();
+
+    _publisher.Publish(std::move(world));
+    _stats.Publishes++;
+    _stats.Retired = _publisher.GetRetiredCount();
+}
+
+auto WorldSnapshotManager::MakeMapSnapshot(Map* map, const shared_ptr<const MapSnapshot>* prev_snapshot) -> shared_ptr<const MapSnapshot>
+{
+    const auto* prev = prev_snapshot != nullptr ? prev_snapshot->get() : nullptr;
+    const auto hex_flags_changed = prev == nullptr || prev->HexFlagsVersion != map->GetHexFlagsVersion();
+    const auto critters_changed = prev == nullptr || prev->CrittersVersion != map->GetCrittersVersion();
+
+    if (!hex_flags_changed && !critters_changed) {
+        _stats.MapsShared++;
+        return *prev_snapshot;
+    }
+
+    const auto hex_flags = map->GetHexFlagsView();
+    const auto bands_count = static_cast<uint>((hex_flags.Height + Map::HEX_FLAGS_BAND_ROWS - 1) / Map::HEX_FLAGS_BAND_ROWS);
+
+    auto snapshot = std::make_shared<MapSnapshot>();
+    snapshot->MapId = map->GetId();
+    snapshot->HexFlagsVersion = map->GetHexFlagsVersion();
+    snapshot->CrittersVersion = map->GetCrittersVersion();
+
+    if (critters_changed) {
+        _critterEntries.clear();
+        for (const auto* cr : map->GetCrittersRaw()) {
+            _critterEntries.push_back({cr->GetId(), cr->GetHexX(), cr->GetHexY(), cr->GetDir(), cr->GetMultihex(), cr->IsDead(), cr->IsPlayer(), cr->GetIsHide()});
+        }
+        std::sort(_critterEntries.begin(), _critterEntries.end(), [](const auto& e1, const auto& e2) { return e1.Id < e2.Id; });
+
+        snapshot->Critters = std::make_shared<const vector<MapSnapshot::CritterEntry>>(_critterEntries);
+        _stats.CrittersCopied += _critterEntries.size();
+    }
+    else {
+        snapshot->Critters = prev->Critters;
+    }
+
+    snapshot->HexFlagsBands.reserve(bands_count);
+    snapshot->DynamicFlagsBands.reserve(bands_count);
+
+    for (uint band = 0; band < bands_count; band++) {
+        const auto version = map->GetHexFlagsBandVersion(band);
+        if (prev != nullptr && prev->HexFlagsBands[band]->Version == version) {
+            snapshot->HexFlagsBands.emplace_back(prev->HexFlagsBands[band]);
+        }
+        else {
+            const auto rows = std::min(static_cast<uint>(Map::HEX_FLAGS_BAND_ROWS), hex_flags.Height - band * Map::HEX_FLAGS_BAND_ROWS);
+
+            auto hex_flags_band = std::make_shared<MapSnapshot::HexFlagsBand>();
+            hex_flags_band->Version = version;
+            hex_flags_band->DynamicFlags.assign(hex_flags.DynamicFlagsBands[band], hex_flags.DynamicFlagsBands[band] + rows * hex_flags.Width);
+            _stats.HexFlagsCopied += hex_flags_band->DynamicFlags.size();
+
+            snapshot->HexFlagsBands.emplace_back(std::move(hex_flags_band));
+        }
+
+        snapshot->DynamicFlagsBands.emplace_back(snapshot->HexFlagsBands.back()->DynamicFlags.data());
+    }
+
+    snapshot->HexFlags = hex_flags;
+    snapshot->HexFlags.DynamicFlagsBands = snapshot->DynamicFlagsBands.data();
+
+    _stats.MapsCopied++;
+    return snapshot;
+}
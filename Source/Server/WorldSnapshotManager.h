@@ -0,0 +1,136 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "Map.h"
+#include "SnapshotPublisher.h"
+
+class FOServer;
+
+// Compact read only copy of map state for readers outside of main thread
+struct MapSnapshot
+{
+    struct CritterEntry
+    {
+        [[nodiscard]] auto operator==(const CritterEntry& other) const -> bool { return Id == other.Id && HexX == other.HexX && HexY == other.HexY && Dir == other.Dir && Multihex == other.Multihex && IsDead == other.IsDead && IsPlayer == other.IsPlayer && IsHide == other.IsHide; }
+        [[nodiscard]] auto operator!=(const CritterEntry& other) const -> bool { return !(*this == other); }
+
+        uint Id {};
+        ushort HexX {};
+        ushort HexY {};
+        uchar Dir {};
+        uint Multihex {};
+        bool IsDead {};
+        bool IsPlayer {};
+        bool IsHide {};
+    };
+
+    // Dynamic flags of Map::HEX_FLAGS_BAND_ROWS rows
+    struct HexFlagsBand
+    {
+        uint Version {};
+        vector<uchar> DynamicFlags {};
+    };
+
+    [[nodiscard]] auto GetCritter(uint cr_id) const -> const CritterEntry*;
+
+    uint MapId {};
+    uint HexFlagsVersion {};
+    uint CrittersVersion {};
+    vector<shared_ptr<const HexFlagsBand>> HexFlagsBands {};
+    vector<const uchar*> DynamicFlagsBands {};
+    MapHexFlagsView HexFlags {}; // Static flags of map live until server stop, dynamic flags point to bands
+    shared_ptr<const vector<CritterEntry>> Critters {}; // Sorted by id
+};
+
+struct WorldSnapshot
+{
+    [[nodiscard]] auto GetMap(uint map_id) const -> const MapSnapshot*;
+    // Reference is copied only by main thread
+    [[nodiscard]] auto FindMap(uint map_id) const -> const shared_ptr<const MapSnapshot>*;
+
+    uint Version {};
+    uint GameTick {};
+    vector<shared_ptr<const MapSnapshot>> Maps {}; // Sorted by id
+};
+
+// Publishes world snapshot at tick end, unchanged maps, hex flag bands and critter lists are shared with previous snapshot
+// Map is copied only when its hex flags or critters version changed since previous publish
+// Reference counters are touched only by main thread, readers see snapshot through epoch guard
+class WorldSnapshotManager final
+{
+public:
+    using ReadGuard = SnapshotPublisher<WorldSnapshot>::ReadGuard;
+
+    struct Statistics
+    {
+        size_t Publishes {};
+        size_t Unchanged {};
+        size_t MapsCopied {};
+        size_t MapsShared {};
+        size_t HexFlagsCopied {};
+        size_t CrittersCopied {};
+        size_t Retired {};
+    };
+
+    WorldSnapshotManager() = delete;
+    explicit WorldSnapshotManager(FOServer* engine);
+    WorldSnapshotManager(const WorldSnapshotManager&) = delete;
+    WorldSnapshotManager(WorldSnapshotManager&&) noexcept = delete;
+    auto operator=(const WorldSnapshotManager&) = delete;
+    auto operator=(WorldSnapshotManager&&) noexcept = delete;
+    ~WorldSnapshotManager() = default;
+
+    [[nodiscard]] auto IsEnabled() const -> bool;
+    [[nodiscard]] auto GetStatistics() const -> const Statistics& { return _stats; }
+
+    // Any thread, empty until first publish
+    [[nodiscard]] auto Read() const -> ReadGuard;
+    // Main thread
+    [[nodiscard]] auto IsMapPublished(uint map_id) const -> bool;
+    [[nodiscard]] auto GetPublishedMap(uint map_id) const -> shared_ptr<const MapSnapshot>;
+
+    void Publish();
+
+private:
+    [[nodiscard]] auto MakeMapSnapshot(Map* map, const shared_ptr<const MapSnapshot>* prev_snapshot) -> shared_ptr<const MapSnapshot>;
+
+    FOServer* _engine;
+    SnapshotPublisher<WorldSnapshot> _publisher {};
+    uint _version {};
+    vector<MapSnapshot::CritterEntry> _critterEntries {};
+    Statistics _stats {};
+};
@@ -0,0 +1,178 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "AtlasPacker.h"
+
+struct PackedRect
+{
+    int X {};
+    int Y {};
+    uint W {};
+    uint H {};
+};
+
+static auto CheckCoverage(const vector<PackedRect>& rects, uint width, uint height) -> bool
+{
+    vector<uchar> coverage(static_cast<size_t>(width) * height);
+    for (const auto& r : rects) {
+        if (r.X < 0 || r.Y < 0 || r.X + r.W > width || r.Y + r.H > height) {
+            return false;
+        }
+        for (uint y = 0; y < r.H; y++) {
+            for (uint x = 0; x < r.W; x++) {
+                auto& c = coverage[(r.Y + y) * width + r.X + x];
+                if (c != 0) {
+                    return false;
+                }
+                c = 1;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("AtlasPacker")
+{
+    AtlasPacker packer(256, 256);
+
+    SECTION("Exact fit")
+    {
+        auto x = -1;
+        auto y = -1;
+        REQUIRE(packer.Insert(256, 256, x, y));
+        REQUIRE(x == 0);
+        REQUIRE(y == 0);
+        REQUIRE(packer.GetOccupancy() == 1.0f);
+        REQUIRE_FALSE(packer.Insert(1, 1, x, y));
+        REQUIRE(packer.GetFreeRectsCount() == 0);
+    }
+
+    SECTION("No overlaps")
+    {
+        vector<PackedRect> rects;
+        size_t area = 0;
+        uint seed = 777;
+        for (auto i = 0; i < 1000; i++) {
+            seed = seed * 1103515245u + 12345u;
+            const auto w = 1 + (seed >> 8) % 40;
+            const auto h = 1 + (seed >> 16) % 40;
+            auto x = 0;
+            auto y = 0;
+            if (packer.Insert(w, h, x, y)) {
+                rects.push_back({x, y, w, h});
+                area += static_cast<size_t>(w) * h;
+            }
+        }
+
+        REQUIRE(CheckCoverage(rects, 256, 256));
+        REQUIRE(packer.GetUsedArea() == area);
+        REQUIRE(packer.GetOccupancy() > 0.8f);
+    }
+
+    SECTION("Free and reuse")
+    {
+        vector<PackedRect> rects;
+        for (auto i = 0; i < 64; i++) {
+            auto x = 0;
+            auto y = 0;
+            REQUIRE(packer.Insert(32, 32, x, y));
+            rects.push_back({x, y, 32, 32});
+        }
+        REQUIRE(packer.GetOccupancy() == 1.0f);
+
+        // Free two adjacent quarters, merged space fits wide rectangle
+        auto x = 0;
+        auto y = 0;
+        REQUIRE_FALSE(packer.Insert(64, 32, x, y));
+
+        vector<PackedRect> kept;
+        for (const auto& r : rects) {
+            if (r.Y == 64 && (r.X == 0 || r.X == 32)) {
+                packer.Free(r.X, r.Y, r.W, r.H);
+            }
+            else {
+                kept.push_back(r);
+            }
+        }
+        REQUIRE(packer.GetUsedArea() == kept.size() * 32 * 32);
+
+        REQUIRE(packer.Insert(64, 32, x, y));
+        REQUIRE(x == 0);
+        REQUIRE(y == 64);
+        kept.push_back({x, y, 64, 32});
+        REQUIRE(CheckCoverage(kept, 256, 256));
+
+        // Freeing everything restores whole space
+        for (const auto& r : kept) {
+            packer.Free(r.X, r.Y, r.W, r.H);
+        }
+        REQUIRE(packer.IsEmpty());
+        REQUIRE(packer.GetFreeRectsCount() == 1);
+        REQUIRE(packer.Insert(256, 256, x, y));
+    }
+
+    SECTION("Churn keeps free space consistent")
+    {
+        vector<PackedRect> rects;
+        uint seed = 4242;
+        for (auto i = 0; i < 3000; i++) {
+            seed = seed * 1103515245u + 12345u;
+            if (!rects.empty() && (seed >> 24) % 3 == 0) {
+                const auto index = (seed >> 4) % rects.size();
+                const auto r = rects[index];
+                packer.Free(r.X, r.Y, r.W, r.H);
+                rects[index] = rects.back();
+                rects.pop_back();
+            }
+            else {
+                const auto w = 1 + (seed >> 8) % 24;
+                const auto h = 1 + (seed >> 16) % 24;
+                auto x = 0;
+                auto y = 0;
+                if (packer.Insert(w, h, x, y)) {
+                    rects.push_back({x, y, w, h});
+                }
+            }
+        }
+
+        REQUIRE(CheckCoverage(rects, 256, 256));
+
+        size_t area = 0;
+        for (const auto& r : rects) {
+            area += static_cast<size_t>(r.W) * r.H;
+        }
+        REQUIRE(packer.GetUsedArea() == area);
+    }
+}
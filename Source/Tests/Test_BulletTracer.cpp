@@ -0,0 +1,238 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "BulletTracer.h"
+#include "GeometryHelper.h"
+#include "LineTracer.h"
+#include "Settings.h"
+#include "ThreadPool.h"
+
+// Same loop as MapManager::TraceBullet without critter checks, over bytes
+static auto TraceBulletBytes(GlobalSettings& settings, const GeometryHelper& geom_helper, const vector<uchar>& no_shoot, ushort width, ushort height, const BulletTraceRequest& request) -> BulletTraceResult
+{
+    auto dist = request.Dist;
+    if (dist == 0u) {
+        dist = geom_helper.DistGame(request.BeginHx, request.BeginHy, request.EndHx, request.EndHy);
+    }
+
+    auto cx = request.BeginHx;
+    auto cy = request.BeginHy;
+    auto old_cx = cx;
+    auto old_cy = cy;
+
+    LineTracer line_tracer(settings, request.BeginHx, request.BeginHy, request.EndHx, request.EndHy, width, height, request.Angle);
+
+    BulletTraceResult result;
+    uint i = 0;
+    for (;; i++) {
+        if (i >= dist) {
+            result.IsFullTrace = true;
+            break;
+        }
+
+        if (settings.MapHexagonal) {
+            line_tracer.GetNextHex(cx, cy);
+        }
+        else {
+            line_tracer.GetNextSquare(cx, cy);
+        }
+
+        if (no_shoot[cy * width + cx] != 0) {
+            break;
+        }
+
+        old_cx = cx;
+        old_cy = cy;
+    }
+
+    result.PreBlockHx = old_cx;
+    result.PreBlockHy = old_cy;
+    result.BlockHx = cx;
+    result.BlockHy = cy;
+    result.Steps = i;
+    return result;
+}
+
+static auto MakeRequests(ushort width, ushort height, size_t count, uint seed) -> vector<BulletTraceRequest>
+{
+    vector<BulletTraceRequest> requests;
+    for (size_t i = 0; i < count; i++) {
+        BulletTraceRequest request;
+        seed = seed * 1103515245u + 12345u;
+        request.BeginHx = static_cast<ushort>((seed >> 8) % width);
+        request.BeginHy = static_cast<ushort>((seed >> 20) % height);
+        seed = seed * 1103515245u + 12345u;
+        request.EndHx = static_cast<ushort>((seed >> 8) % width);
+        request.EndHy = static_cast<ushort>((seed >> 20) % height);
+        request.Dist = i % 3 == 0 ? (seed >> 4) % 100 : 0;
+        request.Angle = i % 5 == 0 ? static_cast<float>((seed >> 12) % 60) - 30.0f : 0.0f;
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+static void RequireSameResult(const BulletTraceResult& result, const BulletTraceResult& expected)
+{
+    REQUIRE(result.IsFullTrace == expected.IsFullTrace);
+    REQUIRE(result.Steps == expected.Steps);
+    REQUIRE(result.PreBlockHx == expected.PreBlockHx);
+    REQUIRE(result.PreBlockHy == expected.PreBlockHy);
+    REQUIRE(result.BlockHx == expected.BlockHx);
+    REQUIRE(result.BlockHy == expected.BlockHy);
+}
+
+TEST_CASE("BulletTracer")
+{
+    GlobalSettings settings(0, nullptr);
+    GeometryHelper geom_helper(settings);
+    BulletTracer tracer(settings);
+
+    const ushort width = 90;
+    const ushort height = 70;
+    vector<uchar> no_shoot(width * height);
+    HexBitPlane plane(width, height);
+
+    uint seed = 31337;
+    for (ushort hy = 0; hy < height; hy++) {
+        for (ushort hx = 0; hx < width; hx++) {
+            seed = seed * 1103515245u + 12345u;
+            const auto blocked = (seed >> 16) % 100 < 4;
+            no_shoot[hy * width + hx] = blocked ? 1 : 0;
+            plane.Set(hx, hy, blocked);
+        }
+    }
+
+    const auto requests = MakeRequests(width, height, 2000, 4242);
+
+    SECTION("Rasterization matches traced hexes")
+    {
+        vector<BulletTraceResult> results;
+        tracer.Trace(plane, width, height, requests, results, nullptr);
+
+        vector<pair<ushort, ushort>> hexes;
+        for (size_t i = 0; i < requests.size(); i++) {
+            const auto& request = requests[i];
+            tracer.Rasterize(request, width, height, hexes);
+
+            const auto dist = request.Dist != 0u ? request.Dist : geom_helper.DistGame(request.BeginHx, request.BeginHy, request.EndHx, request.EndHy);
+            REQUIRE(hexes.size() == dist);
+
+            for (uint j = 0; j < results[i].Steps; j++) {
+                REQUIRE_FALSE(plane.Get(hexes[j].first, hexes[j].second));
+            }
+            if (!results[i].IsFullTrace) {
+                REQUIRE(hexes[results[i].Steps] == pair {results[i].BlockHx, results[i].BlockHy});
+            }
+            if (results[i].Steps != 0u) {
+                REQUIRE(hexes[results[i].Steps - 1] == pair {results[i].PreBlockHx, results[i].PreBlockHy});
+            }
+        }
+    }
+
+    SECTION("Batch matches hex by hex trace")
+    {
+        vector<BulletTraceResult> results;
+        tracer.Trace(plane, width, height, requests, results, nullptr);
+        REQUIRE(results.size() == requests.size());
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            RequireSameResult(results[i], TraceBulletBytes(settings, geom_helper, no_shoot, width, height, requests[i]));
+        }
+    }
+
+    SECTION("Worker threads give same results")
+    {
+        ThreadPool pool {4};
+        vector<BulletTraceResult> results;
+        vector<BulletTraceResult> pool_results;
+        tracer.Trace(plane, width, height, requests, results, nullptr);
+        tracer.Trace(plane, width, height, requests, pool_results, &pool);
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            RequireSameResult(pool_results[i], results[i]);
+        }
+
+        REQUIRE(tracer.GetStatistics().Batches == 2);
+        REQUIRE(tracer.GetStatistics().Traces == requests.size() * 2);
+    }
+}
+
+TEST_CASE("BulletTracerBatch", "[.][benchmark]")
+{
+    GlobalSettings settings(0, nullptr);
+    GeometryHelper geom_helper(settings);
+    BulletTracer tracer(settings);
+
+    const ushort width = 200;
+    const ushort height = 200;
+    vector<uchar> no_shoot(width * height);
+    HexBitPlane plane(width, height);
+
+    uint seed = 99;
+    for (ushort hy = 0; hy < height; hy++) {
+        for (ushort hx = 0; hx < width; hx++) {
+            seed = seed * 1103515245u + 12345u;
+            const auto blocked = (seed >> 16) % 100 < 2;
+            no_shoot[hy * width + hx] = blocked ? 1 : 0;
+            plane.Set(hx, hy, blocked);
+        }
+    }
+
+    const auto requests = MakeRequests(width, height, 4000, 7);
+    ThreadPool pool {ThreadPool::GetDefaultThreadsCount()};
+
+    BENCHMARK("4000 traces, hex by hex")
+    {
+        size_t result = 0;
+        for (const auto& request : requests) {
+            result += TraceBulletBytes(settings, geom_helper, no_shoot, width, height, request).Steps;
+        }
+        return result;
+    };
+
+    BENCHMARK("4000 traces, batch")
+    {
+        vector<BulletTraceResult> results;
+        tracer.Trace(plane, width, height, requests, results, nullptr);
+        return results.size();
+    };
+
+    BENCHMARK("4000 traces, batch on worker threads")
+    {
+        vector<BulletTraceResult> results;
+        tracer.Trace(plane, width, height, requests, results, &pool);
+        return results.size();
+    };
+}
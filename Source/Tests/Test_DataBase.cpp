@@ -0,0 +1,172 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "DataBase.h"
+#include "DiskFileSystem.h"
+#include "StringUtils.h"
+
+static auto MakeTestDocument(int seed) -> AnyData::Document
+{
+    AnyData::Document doc;
+    doc["_Proto"] = string("Critter_Sample");
+    doc["HexX"] = 100 + seed % 50;
+    doc["HexY"] = 200 + seed % 70;
+    doc["Experience"] = static_cast<int64>(seed) * 1000000;
+    doc["Speed"] = 1.5 + seed;
+    doc["IsNoFlatten"] = (seed % 2) == 0;
+    doc["Name"] = _str("Critter {}", seed).str();
+    doc["Stats"] = AnyData::Array {5, 6, 7, static_cast<int64>(seed), 0.25, true, string("Str")};
+    doc["Counters"] = AnyData::Dict {{"Kills", seed}, {"Names", AnyData::Array {string("A"), string("B")}}};
+    return doc;
+}
+
+TEST_CASE("BinaryRecordSchema")
+{
+    BinaryRecordSchema schema;
+
+    SECTION("Round trip")
+    {
+        const auto doc = MakeTestDocument(7);
+        const auto data = schema.Encode(doc);
+        REQUIRE(BinaryRecordSchema::IsBinaryRecord(data.data(), data.size()));
+        REQUIRE(schema.IsChanged());
+        REQUIRE(schema.GetKeysCount() == doc.size());
+        REQUIRE(schema.Decode(data.data(), data.size()) == doc);
+    }
+
+    SECTION("Schema migration")
+    {
+        const auto data = schema.Encode(MakeTestDocument(1));
+        const auto schema_data = schema.Store();
+        REQUIRE(!schema.IsChanged());
+
+        // Record written with older schema still readable after new keys appended
+        BinaryRecordSchema schema2;
+        schema2.Restore(schema_data.data(), schema_data.size());
+        auto doc2 = MakeTestDocument(2);
+        doc2["NewProperty"] = 42;
+        const auto data2 = schema2.Encode(doc2);
+        REQUIRE(schema2.IsChanged());
+        REQUIRE(schema2.Decode(data.data(), data.size()) == MakeTestDocument(1));
+        REQUIRE(schema2.Decode(data2.data(), data2.size()) == doc2);
+    }
+
+    SECTION("Corrupted record")
+    {
+        auto data = schema.Encode(MakeTestDocument(3));
+        data.resize(data.size() - 1);
+        REQUIRE_THROWS_AS(schema.Decode(data.data(), data.size()), DataBaseException);
+
+        BinaryRecordSchema empty_schema;
+        const auto data2 = schema.Encode(MakeTestDocument(3));
+        REQUIRE_THROWS_AS(empty_schema.Decode(data2.data(), data2.size()), DataBaseException);
+    }
+}
+
+#if FO_HAVE_JSON
+TEST_CASE("DataBaseBinaryRecords")
+{
+    const string storage_dir = "DataBaseBinaryRecordsTest";
+    DiskFileSystem::DeleteDir(storage_dir);
+
+    // Legacy json records
+    {
+        auto db = ConnectToDataBase(_str("JSON {}", storage_dir));
+        db.StartChanges();
+        db.Insert("Critters", 1, MakeTestDocument(1));
+        db.Insert("Critters", 2, MakeTestDocument(2));
+        db.CommitChanges();
+    }
+
+    // Migrated to binary on update
+    {
+        auto db = ConnectToDataBase(_str("JSON {} Binary", storage_dir));
+        REQUIRE(db.GetAllIds("Critters") == vector<uint> {1, 2});
+        REQUIRE(db.Get("Critters", 1) == MakeTestDocument(1));
+
+        db.StartChanges();
+        db.Update("Critters", 1, "HexX", 7);
+        db.Insert("Critters", 3, MakeTestDocument(3));
+        db.Delete("Critters", 2);
+        db.CommitChanges();
+
+        REQUIRE(db.GetAllIds("Critters") == vector<uint> {1, 3});
+    }
+
+    {
+        auto db = ConnectToDataBase(_str("JSON {} Binary", storage_dir));
+        auto doc1 = MakeTestDocument(1);
+        doc1["HexX"] = 7;
+        REQUIRE(db.Get("Critters", 1) == doc1);
+        REQUIRE(db.Get("Critters", 3) == MakeTestDocument(3));
+        REQUIRE(db.Get("Critters", 2).empty());
+    }
+
+    DiskFileSystem::DeleteDir(storage_dir);
+}
+
+TEST_CASE("DataBaseBinaryRecordsThroughput", "[.][benchmark]")
+{
+    constexpr uint RECORDS_COUNT = 1000;
+
+    for (const auto* format : {"", " Binary"}) {
+        const string storage_dir = "DataBaseThroughputTest";
+        DiskFileSystem::DeleteDir(storage_dir);
+
+        auto db = ConnectToDataBase(_str("JSON {}{}", storage_dir, format));
+
+        BENCHMARK(_str("Save {} records (JSON{})", RECORDS_COUNT, format).str())
+        {
+            DiskFileSystem::DeleteDir(storage_dir);
+            db.StartChanges();
+            for (uint id = 1; id <= RECORDS_COUNT; id++) {
+                db.Insert("Critters", id, MakeTestDocument(static_cast<int>(id)));
+            }
+            db.CommitChanges();
+        };
+
+        BENCHMARK(_str("Load {} records (JSON{})", RECORDS_COUNT, format).str())
+        {
+            size_t keys = 0;
+            for (const auto id : db.GetAllIds("Critters")) {
+                keys += db.Get("Critters", id).size();
+            }
+            return keys;
+        };
+
+        DiskFileSystem::DeleteDir(storage_dir);
+    }
+}
+#endif
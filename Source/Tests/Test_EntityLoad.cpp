@@ -0,0 +1,220 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "DataBase.h"
+#include "DiskFileSystem.h"
+#include "EntityManager.h"
+#include "GenericUtils.h"
+#include "HashStorage.h"
+#include "Properties.h"
+#include "StringUtils.h"
+#include "ThreadPool.h"
+
+class LoadTestNameResolver final : public NameResolver
+{
+public:
+    [[nodiscard]] auto ResolveEnumValue(string_view /*enum_value_name*/, bool* /*failed*/) const -> int override { return 0; }
+    [[nodiscard]] auto ResolveEnumValue(string_view /*enum_name*/, string_view /*value_name*/, bool* /*failed*/) const -> int override { return 0; }
+    [[nodiscard]] auto ResolveEnumValueName(string_view /*enum_name*/, int /*value*/, bool* /*failed*/) const -> string override { return {}; }
+    [[nodiscard]] auto ResolveGenericValue(string_view /*str*/, bool* /*failed*/) -> int override { return 0; }
+
+    [[nodiscard]] auto ToHashedString(string_view s) const -> hstring override
+    {
+        const auto h = Hashing::MurmurHash2(s.data(), s.length());
+        auto* entry = Storage.Find(h);
+        return hstring(entry != nullptr ? entry : Storage.Add(h, s));
+    }
+
+    [[nodiscard]] auto ResolveHash(hstring::hash_t h, bool* /*failed*/) const -> hstring override
+    {
+        auto* entry = Storage.Find(h);
+        return entry != nullptr ? hstring(entry) : hstring();
+    }
+
+    mutable HashStorage Storage {};
+};
+
+class LoadTestProto final : public ProtoEntity
+{
+public:
+    LoadTestProto(hstring proto_id, const PropertyRegistrator* registrator) : ProtoEntity(proto_id, registrator) { }
+};
+
+static void FillLoadTestStorage(DataBase& db, uint count)
+{
+    db.StartChanges();
+    for (uint id = 1; id <= count; id++) {
+        AnyData::Document doc;
+        doc["_Proto"] = string(id % 2 == 0 ? "Even" : "Odd");
+        doc["HexX"] = static_cast<int>(id % 300);
+        doc["HexY"] = static_cast<int>(id % 200);
+        doc["Model"] = _str("Model{}", id % 16).str();
+        db.Insert("Critters", id, doc);
+    }
+    db.CommitChanges();
+}
+
+TEST_CASE("FetchEntities")
+{
+    LoadTestNameResolver resolver;
+    PropertyRegistrator registrator("Critter", true, resolver, resolver.Storage);
+    registrator.Register<int>(Property::AccessType::Public, "HexX", {});
+    registrator.Register<int>(Property::AccessType::Public, "HexY", {});
+    registrator.Register<hstring>(Property::AccessType::Public, "Model", {});
+    const auto* hex_x = registrator.Find("HexX");
+    const auto* model = registrator.Find("Model");
+
+    auto* even_proto = new LoadTestProto(resolver.ToHashedString("Even"), &registrator);
+    auto* odd_proto = new LoadTestProto(resolver.ToHashedString("Odd"), &registrator);
+    const auto proto_getter = [&](hstring pid) -> const ProtoEntity* { return pid == even_proto->GetProtoId() ? even_proto : pid == odd_proto->GetProtoId() ? odd_proto : nullptr; };
+
+    auto db = ConnectToDataBase("Memory");
+
+    SECTION("Restores in ids order")
+    {
+        constexpr uint entities_count = 1000;
+        FillLoadTestStorage(db, entities_count);
+
+        ThreadPool pool {4};
+        EntityManager::LoadTimings timings;
+        const auto entities = EntityManager::FetchEntities(pool, db, "Critters", resolver, proto_getter, timings);
+
+        REQUIRE(entities.size() == entities_count);
+        REQUIRE(timings.Entities == entities_count);
+        for (uint i = 0; i < entities_count; i++) {
+            const auto id = i + 1;
+            REQUIRE(entities[i].Id == id);
+            REQUIRE(entities[i].Proto == (id % 2 == 0 ? even_proto : odd_proto));
+            REQUIRE(entities[i].Props->GetValue<int>(hex_x) == static_cast<int>(id % 300));
+            REQUIRE(entities[i].Props->GetValue<hstring>(model).as_str() == _str("Model{}", id % 16).str());
+        }
+    }
+
+#if FO_HAVE_JSON
+    SECTION("Restores binary records in place")
+    {
+        const string storage_dir = "FetchEntitiesTest";
+        DiskFileSystem::DeleteDir(storage_dir);
+
+        {
+            auto binary_db = ConnectToDataBase(_str("JSON {} Binary", storage_dir));
+            constexpr uint entities_count = 200;
+            FillLoadTestStorage(binary_db, entities_count);
+
+            vector<uchar> record;
+            REQUIRE(binary_db.GetBinaryRecord("Critters", 1, record) != nullptr);
+
+            ThreadPool pool {4};
+            EntityManager::LoadTimings timings;
+            const auto entities = EntityManager::FetchEntities(pool, binary_db, "Critters", resolver, proto_getter, timings);
+
+            REQUIRE(entities.size() == entities_count);
+            for (uint i = 0; i < entities_count; i++) {
+                const auto id = i + 1;
+                REQUIRE(entities[i].Proto == (id % 2 == 0 ? even_proto : odd_proto));
+                REQUIRE(entities[i].Props->GetValue<int>(hex_x) == static_cast<int>(id % 300));
+                REQUIRE(entities[i].Props->GetValue<hstring>(model).as_str() == _str("Model{}", id % 16).str());
+            }
+
+            // Uncommitted changes are seen only through documents
+            binary_db.StartChanges();
+            binary_db.Update("Critters", 1, "HexX", 77);
+            REQUIRE(binary_db.GetBinaryRecord("Critters", 1, record) == nullptr);
+            binary_db.CommitChanges();
+        }
+
+        DiskFileSystem::DeleteDir(storage_dir);
+    }
+#endif
+
+    SECTION("Unknown proto")
+    {
+        db.StartChanges();
+        db.Insert("Critters", 1, {{"_Proto", string("Unknown")}});
+        db.CommitChanges();
+
+        ThreadPool pool {2};
+        EntityManager::LoadTimings timings;
+        REQUIRE_THROWS_AS(EntityManager::FetchEntities(pool, db, "Critters", resolver, proto_getter, timings), EntitiesLoadException);
+    }
+
+    even_proto->Release();
+    odd_proto->Release();
+}
+
+TEST_CASE("FetchEntitiesThroughput", "[.][benchmark]")
+{
+    LoadTestNameResolver resolver;
+    PropertyRegistrator registrator("Critter", true, resolver, resolver.Storage);
+    registrator.Register<int>(Property::AccessType::Public, "HexX", {});
+    registrator.Register<int>(Property::AccessType::Public, "HexY", {});
+    registrator.Register<hstring>(Property::AccessType::Public, "Model", {});
+
+    auto* even_proto = new LoadTestProto(resolver.ToHashedString("Even"), &registrator);
+    auto* odd_proto = new LoadTestProto(resolver.ToHashedString("Odd"), &registrator);
+    const auto proto_getter = [&](hstring pid) -> const ProtoEntity* { return pid == even_proto->GetProtoId() ? even_proto : odd_proto; };
+
+    const auto run_benchmarks = [&](DataBase& db, uint entities_count, string_view storage_name) {
+        FillLoadTestStorage(db, entities_count);
+
+        for (const auto threads_count : {size_t {1}, ThreadPool::GetDefaultThreadsCount()}) {
+            ThreadPool pool {threads_count};
+
+            BENCHMARK_ADVANCED(_str("Load {} entities from {} on {} threads", entities_count, storage_name, threads_count).str())(Catch::Benchmark::Chronometer meter)
+            {
+                EntityManager::LoadTimings timings;
+                meter.measure([&] { return EntityManager::FetchEntities(pool, db, "Critters", resolver, proto_getter, timings).size(); });
+            };
+        }
+    };
+
+    {
+        auto db = ConnectToDataBase("Memory");
+        run_benchmarks(db, 1000000, "memory");
+    }
+
+#if FO_HAVE_JSON
+    {
+        const string storage_dir = "FetchEntitiesThroughputTest";
+        DiskFileSystem::DeleteDir(storage_dir);
+        auto db = ConnectToDataBase(_str("JSON {} Binary", storage_dir));
+        run_benchmarks(db, 20000, "binary records");
+        DiskFileSystem::DeleteDir(storage_dir);
+    }
+#endif
+
+    even_proto->Release();
+    odd_proto->Release();
+}
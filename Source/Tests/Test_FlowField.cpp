@@ -0,0 +1,301 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "FlowFieldManager.h"
+#include "GeometryHelper.h"
+#include "Settings.h"
+#include "StringUtils.h"
+
+struct FlowFieldTestMap
+{
+    FlowFieldTestMap(ushort width, ushort height, uint seed) : Width {width}, Height {height}, StaticFlags(width * height), DynamicFlags(width * height), DynamicFlagsBands {MapHexFlagsView::MakeBands(DynamicFlags.data(), width, height)}
+    {
+        for (auto& flags : StaticFlags) {
+            seed = seed * 1103515245u + 12345u;
+            flags = (seed >> 16) % 100 < 20 ? FH_BLOCK : 0;
+        }
+    }
+
+    [[nodiscard]] auto GetView() const -> MapHexFlagsView { return {Width, Height, StaticFlags.data(), DynamicFlagsBands.data()}; }
+
+    ushort Width;
+    ushort Height;
+    vector<uchar> StaticFlags;
+    vector<uchar> DynamicFlags;
+    vector<const uchar*> DynamicFlagsBands;
+};
+
+// Plain forward search from critter hex as reference
+static auto SearchDistance(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, bool hexagonal, ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, uint multihex) -> ushort
+{
+    const auto field_view = FlowField::GetFieldView(hex_flags);
+    const auto dirs_count = hexagonal ? 6 : 8;
+
+    vector<ushort> dist(hex_flags.Width * hex_flags.Height, FlowField::UNREACHABLE);
+    vector<uint> queue;
+    dist[from_hy * hex_flags.Width + from_hx] = 0;
+    queue.push_back(from_hy * hex_flags.Width + from_hx);
+
+    for (size_t i = 0; i < queue.size(); i++) {
+        const auto hx = static_cast<int>(queue[i] % hex_flags.Width);
+        const auto hy = static_cast<int>(queue[i] / hex_flags.Width);
+        if (hx == to_hx && hy == to_hy) {
+            return dist[queue[i]];
+        }
+
+        const auto [sx, sy] = geom_helper.GetHexOffsets((hx & 1) != 0);
+        for (auto j = 0; j < dirs_count; j++) {
+            const auto nx = hx + sx[j];
+            const auto ny = hy + sy[j];
+            if (nx < 0 || ny < 0 || nx >= hex_flags.Width || ny >= hex_flags.Height || dist[ny * hex_flags.Width + nx] != FlowField::UNREACHABLE) {
+                continue;
+            }
+            if (!field_view.IsMovePassed(geom_helper, hexagonal, static_cast<ushort>(nx), static_cast<ushort>(ny), static_cast<uchar>(j), multihex)) {
+                continue;
+            }
+
+            dist[ny * hex_flags.Width + nx] = static_cast<ushort>(dist[queue[i]] + 1);
+            queue.push_back(ny * hex_flags.Width + nx);
+        }
+    }
+
+    return FlowField::UNREACHABLE;
+}
+
+TEST_CASE("FlowField")
+{
+    GlobalSettings settings(0, nullptr);
+    GeometryHelper geom_helper(settings);
+    const auto hexagonal = settings.MapHexagonal;
+
+    FlowFieldTestMap test_map(60, 50, 777);
+    const ushort target_hx = 30;
+    const ushort target_hy = 25;
+    test_map.StaticFlags[target_hy * test_map.Width + target_hx] = 0;
+
+    for (const uint multihex : {0u, 1u}) {
+        FlowField field(test_map.Width, test_map.Height, target_hx, target_hy, multihex, false, 400);
+        field.Compute(test_map.GetView(), geom_helper, hexagonal);
+
+        SECTION(_str("Distances match search for multihex {}", multihex).str())
+        {
+            for (ushort hy = 0; hy < test_map.Height; hy += 7) {
+                for (ushort hx = 0; hx < test_map.Width; hx += 5) {
+                    REQUIRE(field.GetDistance(hx, hy) == SearchDistance(test_map.GetView(), geom_helper, hexagonal, hx, hy, target_hx, target_hy, multihex));
+                }
+            }
+        }
+
+        SECTION(_str("Path follows distances for multihex {}", multihex).str())
+        {
+            vector<PathStep> steps;
+            for (ushort hy = 0; hy < test_map.Height; hy += 3) {
+                for (ushort hx = 0; hx < test_map.Width; hx += 3) {
+                    const auto dist = field.GetDistance(hx, hy);
+                    const auto built = field.BuildPath(test_map.GetView(), geom_helper, hexagonal, hx, hy, 0, steps);
+                    REQUIRE(built == (dist != FlowField::UNREACHABLE));
+                    if (built) {
+                        REQUIRE(steps.size() == dist);
+                        if (!steps.empty()) {
+                            REQUIRE(steps.back().HexX == target_hx);
+                            REQUIRE(steps.back().HexY == target_hy);
+                        }
+                    }
+                }
+            }
+        }
+
+        SECTION(_str("Repair matches full compute for multihex {}", multihex).str())
+        {
+            uint seed = 99;
+            for (auto round = 0; round < 20; round++) {
+                vector<uint> changed;
+                for (auto i = 0; i < 15; i++) {
+                    seed = seed * 1103515245u + 12345u;
+                    const auto index = (seed >> 8) % (test_map.Width * test_map.Height);
+                    if (index == static_cast<uint>(target_hy * test_map.Width + target_hx)) {
+                        continue;
+                    }
+                    test_map.DynamicFlags[index] ^= FH_BLOCK_ITEM;
+                    changed.push_back(index);
+                }
+
+                field.Repair(test_map.GetView(), geom_helper, hexagonal, changed);
+
+                FlowField reference(test_map.Width, test_map.Height, target_hx, target_hy, multihex, false, 400);
+                reference.Compute(test_map.GetView(), geom_helper, hexagonal);
+
+                for (ushort hy = 0; hy < test_map.Height; hy++) {
+                    for (ushort hx = 0; hx < test_map.Width; hx++) {
+                        REQUIRE(field.GetDistance(hx, hy) == reference.GetDistance(hx, hy));
+                    }
+                }
+            }
+        }
+    }
+
+    SECTION("Gag item passed only if way around is longer")
+    {
+        // Wall across whole map with door in it
+        FlowFieldTestMap wall_map(40, 40, 1);
+        std::fill(wall_map.StaticFlags.begin(), wall_map.StaticFlags.end(), static_cast<uchar>(0));
+        for (ushort hx = 0; hx < wall_map.Width; hx++) {
+            wall_map.StaticFlags[20 * wall_map.Width + hx] = FH_BLOCK;
+        }
+
+        const auto door_index = 20 * wall_map.Width + 10;
+        wall_map.StaticFlags[door_index] = 0;
+
+        // Same distance as through open door plus gag cost
+        const auto open_dist = SearchDistance(wall_map.GetView(), geom_helper, hexagonal, 10, 10, 10, 30, 0);
+        REQUIRE(open_dist != FlowField::UNREACHABLE);
+        wall_map.DynamicFlags[door_index] = FH_BLOCK_ITEM | FH_GAG_ITEM;
+
+        FlowField gag_field(wall_map.Width, wall_map.Height, 10, 30, 0, true, 400);
+        gag_field.Compute(wall_map.GetView(), geom_helper, hexagonal);
+        REQUIRE(gag_field.GetDistance(10, 10) == open_dist + FlowField::GAG_STEP_COST);
+
+        FlowField block_field(wall_map.Width, wall_map.Height, 10, 30, 0, false, 400);
+        block_field.Compute(wall_map.GetView(), geom_helper, hexagonal);
+        REQUIRE(block_field.GetDistance(10, 10) == FlowField::UNREACHABLE);
+
+        const auto is_door_step = [&](const PathStep& step) { return step.HexY * wall_map.Width + step.HexX == door_index; };
+
+        vector<PathStep> steps;
+        REQUIRE(gag_field.BuildPath(wall_map.GetView(), geom_helper, hexagonal, 10, 10, 0, steps));
+        REQUIRE(std::any_of(steps.begin(), steps.end(), is_door_step));
+
+        // Short way around through gap near door
+        wall_map.StaticFlags[door_index + 2] = 0;
+        gag_field.Repair(wall_map.GetView(), geom_helper, hexagonal, {static_cast<uint>(door_index + 2)});
+        REQUIRE(gag_field.GetDistance(10, 10) == SearchDistance(wall_map.GetView(), geom_helper, hexagonal, 10, 10, 10, 30, 0));
+        REQUIRE(gag_field.BuildPath(wall_map.GetView(), geom_helper, hexagonal, 10, 10, 0, steps));
+        REQUIRE(std::none_of(steps.begin(), steps.end(), is_door_step));
+    }
+
+    SECTION("Path is not built through critters")
+    {
+        FlowFieldTestMap open_map(40, 40, 1);
+        std::fill(open_map.StaticFlags.begin(), open_map.StaticFlags.end(), static_cast<uchar>(0));
+
+        FlowField open_field(open_map.Width, open_map.Height, 25, 30, 0, true, 400);
+        open_field.Compute(open_map.GetView(), geom_helper, hexagonal);
+
+        vector<PathStep> steps;
+        REQUIRE(open_field.BuildPath(open_map.GetView(), geom_helper, hexagonal, 10, 10, 0, steps));
+
+        // Critter on one of next hexes is passed by another equal step
+        const auto first_step_index = steps.front().HexY * open_map.Width + steps.front().HexX;
+        open_map.DynamicFlags[first_step_index] = FH_CRITTER;
+        REQUIRE(open_field.BuildPath(open_map.GetView(), geom_helper, hexagonal, 10, 10, 0, steps));
+        REQUIRE(steps.front().HexY * open_map.Width + steps.front().HexX != first_step_index);
+
+        // Surrounded by critters, regular search must handle it
+        const auto [sx, sy] = geom_helper.GetHexOffsets(false);
+        for (auto j = 0; j < (hexagonal ? 6 : 8); j++) {
+            open_map.DynamicFlags[(10 + sy[j]) * open_map.Width + 10 + sx[j]] = FH_CRITTER;
+        }
+        REQUIRE_FALSE(open_field.BuildPath(open_map.GetView(), geom_helper, hexagonal, 10, 10, 0, steps));
+    }
+}
+
+TEST_CASE("FlowFieldPursuers", "[.][benchmark]")
+{
+    GlobalSettings settings(0, nullptr);
+    GeometryHelper geom_helper(settings);
+    const auto hexagonal = settings.MapHexagonal;
+
+    FlowFieldTestMap test_map(200, 200, 4242);
+    const ushort target_hx = 100;
+    const ushort target_hy = 100;
+    test_map.StaticFlags[target_hy * test_map.Width + target_hx] = 0;
+
+    // Pursuers around target at different distances
+    vector<pair<ushort, ushort>> pursuers;
+    uint seed = 1;
+    while (pursuers.size() < 100) {
+        seed = seed * 1103515245u + 12345u;
+        const auto hx = static_cast<ushort>(40 + (seed >> 8) % 120);
+        const auto hy = static_cast<ushort>(40 + (seed >> 20) % 120);
+        if (test_map.StaticFlags[hy * test_map.Width + hx] == 0) {
+            pursuers.emplace_back(hx, hy);
+        }
+    }
+
+    BENCHMARK("100 pursuers, search per pursuer")
+    {
+        size_t result = 0;
+        for (const auto& [hx, hy] : pursuers) {
+            result += SearchDistance(test_map.GetView(), geom_helper, hexagonal, hx, hy, target_hx, target_hy, 0);
+        }
+        return result;
+    };
+
+    BENCHMARK("100 pursuers, shared flow field")
+    {
+        FlowField field(test_map.Width, test_map.Height, target_hx, target_hy, 0, false, 400);
+        field.Compute(test_map.GetView(), geom_helper, hexagonal);
+
+        size_t result = 0;
+        vector<PathStep> steps;
+        for (const auto& [hx, hy] : pursuers) {
+            if (field.BuildPath(test_map.GetView(), geom_helper, hexagonal, hx, hy, 0, steps)) {
+                result += steps.size();
+            }
+        }
+        return result;
+    };
+
+    BENCHMARK_ADVANCED("100 pursuers, repair after door toggle")(Catch::Benchmark::Chronometer meter)
+    {
+        FlowField field(test_map.Width, test_map.Height, target_hx, target_hy, 0, false, 400);
+        field.Compute(test_map.GetView(), geom_helper, hexagonal);
+        const vector<uint> changed = {static_cast<uint>(90 * test_map.Width + 95)};
+
+        meter.measure([&] {
+            test_map.DynamicFlags[changed.front()] ^= FH_BLOCK_ITEM;
+            field.Repair(test_map.GetView(), geom_helper, hexagonal, changed);
+
+            size_t result = 0;
+            vector<PathStep> steps;
+            for (const auto& [hx, hy] : pursuers) {
+                if (field.BuildPath(test_map.GetView(), geom_helper, hexagonal, hx, hy, 0, steps)) {
+                    result += steps.size();
+                }
+            }
+            return result;
+        });
+    };
+}
@@ -0,0 +1,192 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "GenericUtils.h"
+#include "HashStorage.h"
+#include "Properties.h"
+#include "StringUtils.h"
+
+class TestNameResolver final : public NameResolver
+{
+public:
+    [[nodiscard]] auto ResolveEnumValue(string_view /*enum_value_name*/, bool* /*failed*/) const -> int override { return 0; }
+    [[nodiscard]] auto ResolveEnumValue(string_view /*enum_name*/, string_view /*value_name*/, bool* /*failed*/) const -> int override { return 0; }
+    [[nodiscard]] auto ResolveEnumValueName(string_view /*enum_name*/, int /*value*/, bool* /*failed*/) const -> string override { return {}; }
+    [[nodiscard]] auto ResolveGenericValue(string_view /*str*/, bool* /*failed*/) -> int override { return 0; }
+
+    [[nodiscard]] auto ToHashedString(string_view s) const -> hstring override
+    {
+        const auto h = Hashing::MurmurHash2(s.data(), s.length());
+        auto* entry = Storage.Find(h);
+        return hstring(entry != nullptr ? entry : Storage.Add(h, s));
+    }
+
+    [[nodiscard]] auto ResolveHash(hstring::hash_t h, bool* /*failed*/) const -> hstring override
+    {
+        auto* entry = Storage.Find(h);
+        return entry != nullptr ? hstring(entry) : hstring();
+    }
+
+    mutable HashStorage Storage {};
+};
+
+TEST_CASE("HashStorage")
+{
+    HashStorage storage;
+
+    SECTION("Find and add")
+    {
+        REQUIRE(storage.Find(123) == nullptr);
+        auto* entry = storage.Add(123, "Abc");
+        REQUIRE(entry != nullptr);
+        REQUIRE(storage.Find(123) == entry);
+        REQUIRE(entry->Hash == 123);
+        REQUIRE(entry->Str == "Abc");
+        REQUIRE(storage.GetSize() == 1);
+    }
+
+    SECTION("Colliding slots")
+    {
+        const auto capacity = static_cast<hstring::hash_t>(storage.GetCapacity());
+        auto* entry1 = storage.Add(5, "A");
+        auto* entry2 = storage.Add(5 + capacity, "B");
+        auto* entry3 = storage.Add(5 + capacity * 2, "C");
+        REQUIRE(storage.Find(5) == entry1);
+        REQUIRE(storage.Find(5 + capacity) == entry2);
+        REQUIRE(storage.Find(5 + capacity * 2) == entry3);
+        REQUIRE(storage.Find(5 + capacity * 3) == nullptr);
+    }
+
+    SECTION("Growth keeps entries")
+    {
+        vector<hstring::entry*> entries;
+        for (auto i = 1; i <= 10000; i++) {
+            const auto str = _str("Entry{}", i).str();
+            entries.push_back(storage.Add(Hashing::MurmurHash2(str.data(), str.length()), str));
+        }
+
+        REQUIRE(storage.GetSize() == 10000);
+        REQUIRE(storage.GetCapacity() >= 20000);
+
+        for (auto i = 1; i <= 10000; i++) {
+            const auto str = _str("Entry{}", i).str();
+            auto* entry = storage.Find(Hashing::MurmurHash2(str.data(), str.length()));
+            REQUIRE(entry == entries[i - 1]);
+            REQUIRE(entry->Str == str);
+        }
+    }
+
+    SECTION("Find during concurrent adds")
+    {
+        constexpr auto entries_count = 20000;
+        vector<hstring::hash_t> hashes;
+        for (auto i = 1; i <= entries_count; i++) {
+            const auto str = _str("Entry{}", i).str();
+            hashes.push_back(Hashing::MurmurHash2(str.data(), str.length()));
+        }
+
+        std::atomic_int added = 0;
+        std::thread adder([&] {
+            for (auto i = 1; i <= entries_count; i++) {
+                storage.Add(hashes[i - 1], _str("Entry{}", i).str());
+                added.store(i, std::memory_order_release);
+            }
+        });
+
+        // Everything published before counter must be visible, including entries moved by growth
+        auto lost = 0;
+        while (added.load(std::memory_order_acquire) < entries_count) {
+            const auto published = added.load(std::memory_order_acquire);
+            for (auto i = std::max(published - 64, 0); i < published; i++) {
+                if (storage.Find(hashes[i]) == nullptr) {
+                    lost++;
+                }
+            }
+        }
+
+        adder.join();
+        REQUIRE(lost == 0);
+        REQUIRE(storage.GetSize() == entries_count);
+        REQUIRE(storage.Add(hashes[0], "Entry1") == storage.Find(hashes[0]));
+    }
+}
+
+TEST_CASE("HashPropertyRead", "[.][benchmark]")
+{
+    TestNameResolver resolver;
+    PropertyRegistrator registrator("Test", true, resolver, resolver.Storage);
+    registrator.Register<hstring>(Property::AccessType::Public, "ProtoId", {});
+    const auto* prop = registrator.Find("ProtoId");
+    REQUIRE(prop != nullptr);
+
+    constexpr auto entities_count = 4096;
+
+    vector<hstring> values;
+    unordered_map<hstring::hash_t, hstring::entry> map_storage;
+    for (auto i = 0; i < entities_count; i++) {
+        const auto value = resolver.ToHashedString(_str("Proto{}", i));
+        values.push_back(value);
+        map_storage.emplace(value.as_hash(), hstring::entry {value.as_hash(), string(value.as_str())});
+    }
+
+    vector<Properties> props;
+    props.reserve(entities_count);
+    for (auto i = 0; i < entities_count; i++) {
+        props.emplace_back(&registrator).SetValue<hstring>(prop, values[i]);
+    }
+
+    for (auto i = 0; i < entities_count; i++) {
+        REQUIRE(props[i].GetValue<hstring>(prop) == values[i]);
+        REQUIRE(props[i].GetValue<hstring>(prop).as_str() == values[i].as_str());
+    }
+
+    BENCHMARK("Properties::GetValue<hstring>")
+    {
+        size_t result = 0;
+        for (const auto& p : props) {
+            result += p.GetValue<hstring>(prop).as_str().length();
+        }
+        return result;
+    };
+
+    BENCHMARK("unordered_map resolve (previous storage)")
+    {
+        size_t result = 0;
+        for (const auto& value : values) {
+            result += map_storage.find(value.as_hash())->second.Str.length();
+        }
+        return result;
+    };
+}
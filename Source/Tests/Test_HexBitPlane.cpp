@@ -0,0 +1,209 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "GenericUtils.h"
+#include "GeometryHelper.h"
+#include "HexBitPlane.h"
+#include "Map.h"
+#include "Settings.h"
+#include "StringUtils.h"
+
+// Same walk as Map::IsHexesPassed over bytes
+static auto IsHexesPassedBytes(const MapHexFlagsView& hex_flags, const GeometryHelper& geom_helper, uint dir_count, ushort hx, ushort hy, uint radius) -> bool
+{
+    if (!hex_flags.IsHexPassed(hx, hy)) {
+        return false;
+    }
+
+    const auto [sx, sy] = geom_helper.GetHexOffsets((hx % 2) != 0);
+    const auto count = GenericUtils::NumericalNumber(radius) * dir_count;
+    for (uint i = 0; i < count; i++) {
+        const auto nx = static_cast<int>(hx) + sx[i];
+        const auto ny = static_cast<int>(hy) + sy[i];
+        if (nx >= 0 && ny >= 0 && nx < hex_flags.Width && ny < hex_flags.Height && !hex_flags.IsHexPassed(static_cast<ushort>(nx), static_cast<ushort>(ny))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("HexBitPlane")
+{
+    GlobalSettings settings(0, nullptr);
+    GeometryHelper geom_helper(settings);
+    const auto hexagonal = settings.MapHexagonal;
+    const auto dir_count = settings.MapDirCount;
+
+    const HexFootprints footprints(geom_helper, hexagonal, dir_count);
+
+    for (const auto& [width, height] : {tuple<ushort, ushort> {70, 60}, tuple<ushort, ushort> {128, 33}}) {
+        vector<uchar> static_flags(width * height);
+        vector<uchar> dynamic_flags(width * height);
+        const auto dynamic_flags_bands = MapHexFlagsView::MakeBands(dynamic_flags.data(), width, height);
+        const MapHexFlagsView view {width, height, static_flags.data(), dynamic_flags_bands.data()};
+        HexBitPlane plane(width, height);
+
+        uint seed = 4242;
+        for (ushort hy = 0; hy < height; hy++) {
+            for (ushort hx = 0; hx < width; hx++) {
+                seed = seed * 1103515245u + 12345u;
+                const auto roll = (seed >> 16) % 100;
+                if (roll < 3) {
+                    static_flags[hy * width + hx] = FH_BLOCK;
+                }
+                else if (roll < 6) {
+                    dynamic_flags[hy * width + hx] = FH_CRITTER;
+                }
+                plane.Set(hx, hy, !view.IsHexPassed(hx, hy));
+            }
+        }
+
+        SECTION(_str("Row bits match hexes on {}x{}", width, height).str())
+        {
+            for (auto hy = -1; hy <= height; hy++) {
+                for (auto hx = -70; hx < width + 5; hx += 3) {
+                    const auto bits = plane.GetRowBits(hx, hy, 64);
+                    for (auto i = 0; i < 64; i++) {
+                        const auto x = hx + i;
+                        const auto expected = x >= 0 && x < width && hy >= 0 && hy < height && !view.IsHexPassed(static_cast<ushort>(x), static_cast<ushort>(hy));
+                        REQUIRE(((bits >> i) & 1u) == (expected ? 1u : 0u));
+                    }
+                }
+            }
+        }
+
+        SECTION(_str("Radius checks match bytes on {}x{}", width, height).str())
+        {
+            for (const uint radius : {0u, 1u, 2u, 3u, 7u, HexFootprints::MAX_RADIUS}) {
+                for (ushort hy = 0; hy < height; hy++) {
+                    for (ushort hx = 0; hx < width; hx++) {
+                        const auto* footprint = footprints.GetRadius((hx % 2) != 0, radius);
+                        REQUIRE(footprint != nullptr);
+                        REQUIRE(footprint->IsFree(plane, hx, hy) == IsHexesPassedBytes(view, geom_helper, dir_count, hx, hy, radius));
+                    }
+                }
+            }
+        }
+
+        SECTION(_str("Move checks match bytes on {}x{}", width, height).str())
+        {
+            for (const uint multihex : {1u, 2u, 3u, 5u, HexFootprints::MAX_MULTIHEX}) {
+                for (uchar dir = 0; dir < dir_count; dir++) {
+                    for (ushort hy = 0; hy < height; hy++) {
+                        for (ushort hx = 0; hx < width; hx++) {
+                            const auto* footprint = footprints.GetMove((hx % 2) != 0, dir, multihex);
+                            const auto expected = view.IsMovePassed(geom_helper, hexagonal, hx, hy, dir, multihex);
+                            if (footprint != nullptr) {
+                                REQUIRE(footprint->IsFreeInside(plane, hx, hy, width, height) == expected);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("HexBitPlaneChecks", "[.][benchmark]")
+{
+    GlobalSettings settings(0, nullptr);
+    GeometryHelper geom_helper(settings);
+    const auto hexagonal = settings.MapHexagonal;
+    const auto dir_count = settings.MapDirCount;
+    const HexFootprints footprints(geom_helper, hexagonal, dir_count);
+
+    constexpr ushort width = 200;
+    constexpr ushort height = 200;
+    vector<uchar> static_flags(width * height);
+    vector<uchar> dynamic_flags(width * height);
+    const auto dynamic_flags_bands = MapHexFlagsView::MakeBands(dynamic_flags.data(), width, height);
+    const MapHexFlagsView view {width, height, static_flags.data(), dynamic_flags_bands.data()};
+    HexBitPlane plane(width, height);
+
+    uint seed = 1;
+    for (ushort hy = 0; hy < height; hy++) {
+        for (ushort hx = 0; hx < width; hx++) {
+            seed = seed * 1103515245u + 12345u;
+            if ((seed >> 16) % 100 < 2) {
+                static_flags[hy * width + hx] = FH_BLOCK;
+                plane.Set(hx, hy, true);
+            }
+        }
+    }
+
+    BENCHMARK("Radius 3 by bytes")
+    {
+        size_t result = 0;
+        for (ushort hy = 0; hy < height; hy += 2) {
+            for (ushort hx = 0; hx < width; hx += 2) {
+                result += IsHexesPassedBytes(view, geom_helper, dir_count, hx, hy, 3) ? 1 : 0;
+            }
+        }
+        return result;
+    };
+
+    BENCHMARK("Radius 3 by words")
+    {
+        size_t result = 0;
+        for (ushort hy = 0; hy < height; hy += 2) {
+            for (ushort hx = 0; hx < width; hx += 2) {
+                result += footprints.GetRadius((hx % 2) != 0, 3)->IsFree(plane, hx, hy) ? 1 : 0;
+            }
+        }
+        return result;
+    };
+
+    BENCHMARK("Multihex 3 moves by bytes")
+    {
+        size_t result = 0;
+        for (ushort hy = 0; hy < height; hy += 2) {
+            for (ushort hx = 0; hx < width; hx += 2) {
+                result += view.IsMovePassed(geom_helper, hexagonal, hx, hy, static_cast<uchar>(hx % dir_count), 3) ? 1 : 0;
+            }
+        }
+        return result;
+    };
+
+    BENCHMARK("Multihex 3 moves by words")
+    {
+        size_t result = 0;
+        for (ushort hy = 0; hy < height; hy += 2) {
+            for (ushort hx = 0; hx < width; hx += 2) {
+                result += footprints.GetMove((hx % 2) != 0, static_cast<uchar>(hx % dir_count), 3)->IsFreeInside(plane, hx, hy, width, height) ? 1 : 0;
+            }
+        }
+        return result;
+    };
+}
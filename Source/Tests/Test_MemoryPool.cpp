@@ -0,0 +1,112 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "MemoryPool.h"
+
+TEST_CASE("MemoryPool")
+{
+    SECTION("Fixed size pool reuses freed blocks")
+    {
+        FixedSizePool pool(40, 8, AllocationSubsystem::Items);
+        const auto stats_before = AllocationCounters::GetStatistics(AllocationSubsystem::Items);
+
+        vector<void*> blocks;
+        for (auto i = 0; i < 20; i++) {
+            blocks.push_back(pool.Allocate());
+            REQUIRE(reinterpret_cast<uintptr_t>(blocks.back()) % alignof(std::max_align_t) == 0);
+            std::memset(blocks.back(), i, 40);
+        }
+        REQUIRE(std::set<void*>(blocks.begin(), blocks.end()).size() == blocks.size());
+
+        auto* freed = blocks[5];
+        pool.Free(freed);
+        REQUIRE(pool.Allocate() == freed);
+
+        for (auto* block : blocks) {
+            pool.Free(block);
+        }
+
+        const auto stats = AllocationCounters::GetStatistics(AllocationSubsystem::Items);
+        REQUIRE(stats.Allocations - stats_before.Allocations == 21);
+        REQUIRE(stats.Deallocations - stats_before.Deallocations == 21);
+        REQUIRE(stats.LiveBytes == stats_before.LiveBytes);
+    }
+
+    SECTION("Size classes keep data")
+    {
+        SizeClassAllocator allocator(AllocationSubsystem::Properties);
+
+        vector<pair<uchar*, size_t>> buffers;
+        for (size_t size = 1; size < 3000; size += 37) {
+            auto* buf = allocator.Allocate(size);
+            std::memset(buf, static_cast<int>(size & 0xFF), size);
+            buffers.emplace_back(buf, size);
+        }
+
+        for (const auto& [buf, size] : buffers) {
+            REQUIRE(std::all_of(buf, buf + size, [size = size](uchar b) { return b == static_cast<uchar>(size & 0xFF); }));
+            allocator.Free(buf, size);
+        }
+    }
+
+    SECTION("Frame arena merges blocks on reset")
+    {
+        FrameArena arena(256);
+
+        for (auto tick = 0; tick < 3; tick++) {
+            frame_vector<uint> values {FrameArenaAllocator<uint>(arena)};
+            for (uint i = 0; i < 1000; i++) {
+                values.push_back(i);
+            }
+            REQUIRE(values[999] == 999);
+
+            auto* ptr = arena.Allocate(3, 1);
+            auto* aligned_ptr = arena.Allocate(sizeof(double), alignof(double));
+            REQUIRE(ptr != nullptr);
+            REQUIRE(reinterpret_cast<uintptr_t>(aligned_ptr) % alignof(double) == 0);
+            REQUIRE(arena.GetUsedSize() != 0);
+
+            values.clear();
+            arena.Reset();
+            REQUIRE(arena.GetUsedSize() == 0);
+        }
+
+        // Grown capacity kept in one block after first tick
+        const auto capacity = arena.GetCapacity();
+        frame_vector<uint> values {FrameArenaAllocator<uint>(arena)};
+        values.resize(1000);
+        REQUIRE(arena.GetCapacity() == capacity);
+    }
+}
@@ -0,0 +1,274 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "3dAnimation.h"
+#include "GenericUtils.h"
+#include "HashStorage.h"
+#include "StringUtils.h"
+
+#if FO_ENABLE_3D
+
+struct AnimationTestChannel
+{
+    vector<float> Times {};
+    vector<vec3> Values {};
+    vector<quaternion> Rotations {};
+};
+
+struct AnimationTestBone
+{
+    AnimationTestChannel Scale {};
+    AnimationTestChannel Rotation {};
+    AnimationTestChannel Translation {};
+};
+
+struct AnimationTestSet
+{
+    AnimationTestSet(uint bones_count, uint max_keys, uint seed)
+    {
+        const auto next_float = [&seed](float from, float to) {
+            seed = seed * 1103515245u + 12345u;
+            return from + (to - from) * static_cast<float>((seed >> 8) & 0xFFFF) / 65535.0f;
+        };
+        const auto fill_times = [&](AnimationTestChannel& channel) {
+            const auto count = 1 + static_cast<uint>(next_float(0.0f, static_cast<float>(max_keys)));
+            auto time = next_float(0.0f, 10.0f);
+            for (uint i = 0; i < count; i++) {
+                channel.Times.push_back(time);
+                time += next_float(0.1f, DURATION_TICKS * 1.2f / static_cast<float>(count));
+            }
+        };
+
+        for (uint b = 0; b < bones_count; b++) {
+            const auto name = _str("Bone{}", b).str();
+            Names.emplace_back(Storage.Add(Hashing::MurmurHash2(name.data(), name.length()), name));
+
+            auto& bone = Bones.emplace_back();
+            fill_times(bone.Scale);
+            for (size_t i = 0; i < bone.Scale.Times.size(); i++) {
+                bone.Scale.Values.emplace_back(next_float(0.5f, 2.0f), next_float(0.5f, 2.0f), next_float(0.5f, 2.0f));
+            }
+            fill_times(bone.Rotation);
+            for (size_t i = 0; i < bone.Rotation.Times.size(); i++) {
+                quaternion q(next_float(-1.0f, 1.0f), next_float(-1.0f, 1.0f), next_float(-1.0f, 1.0f), next_float(-1.0f, 1.0f));
+                bone.Rotation.Rotations.emplace_back(q.Normalize());
+            }
+            fill_times(bone.Translation);
+            for (size_t i = 0; i < bone.Translation.Times.size(); i++) {
+                bone.Translation.Values.emplace_back(next_float(-10.0f, 10.0f), next_float(-10.0f, 10.0f), next_float(-10.0f, 10.0f));
+            }
+        }
+
+        for (uint a = 0; a < 2; a++) {
+            Anims[a].SetData("Test", _str("Anim{}", a).str(), DURATION_TICKS, TICKS_PER_SECOND);
+        }
+        for (uint b = 0; b < bones_count; b++) {
+            const auto& bone = Bones[b];
+            Anims[b % 2 == 0 ? 0 : 1].AddBoneOutput({Names[b]}, bone.Scale.Times, bone.Scale.Values, bone.Rotation.Times, bone.Rotation.Rotations, bone.Translation.Times, bone.Translation.Values);
+            // Both animations animate all bones, with shifted keys in second one
+            auto& other = Anims[b % 2 == 0 ? 1 : 0];
+            auto shifted = bone.Rotation.Times;
+            for (auto& t : shifted) {
+                t *= 0.5f;
+            }
+            other.AddBoneOutput({Names[b]}, bone.Scale.Times, bone.Scale.Values, shifted, bone.Rotation.Rotations, bone.Translation.Times, bone.Translation.Values);
+        }
+    }
+
+    static constexpr float DURATION_TICKS = 100.0f;
+    static constexpr float TICKS_PER_SECOND = 25.0f;
+
+    HashStorage Storage {};
+    vector<hstring> Names {};
+    vector<AnimationTestBone> Bones {};
+    ModelAnimation Anims[2] {};
+};
+
+struct AnimationTestController
+{
+    AnimationTestController(AnimationTestSet& set, bool key_cursors, float weight) : Controller(2), Matrices(set.Names.size())
+    {
+        for (size_t b = 0; b < set.Names.size(); b++) {
+            Controller.RegisterAnimationOutput(set.Names[b], Matrices[b]);
+        }
+        Controller.RegisterAnimationSet(&set.Anims[0]);
+        Controller.RegisterAnimationSet(&set.Anims[1]);
+        Controller.SetKeyCursors(key_cursors);
+        for (uint track = 0; track < 2; track++) {
+            Controller.SetTrackAnimationSet(track, &set.Anims[track]);
+            Controller.SetTrackEnable(track, true);
+            Controller.AddEventSpeed(track, track == 0 ? 1.0f : 0.7f, 0.0f, 0.0f);
+            Controller.AddEventWeight(track, track == 0 ? 1.0f : weight, 0.0f, 0.0f);
+        }
+    }
+
+    ModelAnimationController Controller;
+    vector<mat44> Matrices;
+};
+
+// Plain linear key search and scalar blend as reference
+template<class T>
+static auto SampleReference(float time, const vector<float>& times, const vector<T>& values) -> T
+{
+    for (size_t n = 0; n + 1 < times.size(); n++) {
+        if (time >= times[n] && time < times[n + 1]) {
+            auto result = values[n];
+            const auto factor = (time - times[n]) / (times[n + 1] - times[n]);
+            if constexpr (std::is_same_v<T, quaternion>) {
+                quaternion::Interpolate(result, result, values[n + 1], factor);
+            }
+            else {
+                result = result + (values[n + 1] - result) * factor;
+            }
+            return result;
+        }
+    }
+    return values.back();
+}
+
+static auto ReferenceMatrix(const AnimationTestSet& set, const ModelAnimationController& controller, size_t bone_index, float weight) -> mat44
+{
+    vec3 scale[2];
+    quaternion rotation[2];
+    vec3 translation[2];
+
+    for (uint track = 0; track < 2; track++) {
+        const auto t = fmod(controller.GetTrackPosition(track) * AnimationTestSet::TICKS_PER_SECOND, AnimationTestSet::DURATION_TICKS);
+        const auto& bone = set.Bones[bone_index];
+        const auto shift = (bone_index % 2 == 0) == (track == 0) ? 1.0f : 0.5f;
+        auto rotation_times = bone.Rotation.Times;
+        for (auto& rt : rotation_times) {
+            rt *= shift;
+        }
+
+        scale[track] = SampleReference(t, bone.Scale.Times, bone.Scale.Values);
+        rotation[track] = SampleReference(t, rotation_times, bone.Rotation.Rotations);
+        translation[track] = SampleReference(t, bone.Translation.Times, bone.Translation.Values);
+    }
+
+    scale[0] = scale[0] + (scale[1] - scale[0]) * weight;
+    quaternion::Interpolate(rotation[0], rotation[0], rotation[1], weight);
+    translation[0] = translation[0] + (translation[1] - translation[0]) * weight;
+
+    mat44 ms;
+    mat44 mt;
+    mat44::Scaling(scale[0], ms);
+    const auto mr = mat44(rotation[0].GetMatrix());
+    mat44::Translation(translation[0], mt);
+    return mt * mr * ms;
+}
+
+static auto MatricesEqual(const mat44& m1, const mat44& m2, float epsilon) -> bool
+{
+    for (uint r = 0; r < 4; r++) {
+        for (uint c = 0; c < 4; c++) {
+            if (std::fabs(m1[r][c] - m2[r][c]) > epsilon) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("ModelAnimationController")
+{
+    constexpr auto weight = 0.35f;
+
+    AnimationTestSet set(40, 30, 777);
+    AnimationTestController cached(set, true, weight);
+    AnimationTestController linear(set, false, weight);
+
+    SECTION("Key cursors match linear search")
+    {
+        uint seed = 4242;
+        auto mismatches = 0;
+        for (uint frame = 0; frame < 600; frame++) {
+            seed = seed * 1103515245u + 12345u;
+            const auto dt = static_cast<float>((seed >> 8) % 200) / 1000.0f;
+
+            // Occasional seek back and far forward jumps
+            if (frame % 97 == 50) {
+                cached.Controller.SetTrackPosition(0, cached.Controller.GetTrackPosition(0) * 0.3f);
+                linear.Controller.SetTrackPosition(0, linear.Controller.GetTrackPosition(0) * 0.3f);
+            }
+            if (frame % 131 == 70) {
+                cached.Controller.SetTrackPosition(1, cached.Controller.GetTrackPosition(1) + 1.7f);
+                linear.Controller.SetTrackPosition(1, linear.Controller.GetTrackPosition(1) + 1.7f);
+            }
+
+            cached.Controller.AdvanceTime(dt);
+            linear.Controller.AdvanceTime(dt);
+
+            for (size_t b = 0; b < set.Names.size(); b++) {
+                if (!MatricesEqual(cached.Matrices[b], linear.Matrices[b], 0.0f)) {
+                    mismatches++;
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    SECTION("Batched blend matches scalar blend")
+    {
+        auto mismatches = 0;
+        for (uint frame = 0; frame < 300; frame++) {
+            cached.Controller.AdvanceTime(0.037f);
+
+            for (size_t b = 0; b < set.Names.size(); b++) {
+                if (!MatricesEqual(cached.Matrices[b], ReferenceMatrix(set, cached.Controller, b, weight), 0.0001f)) {
+                    mismatches++;
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+TEST_CASE("ModelAnimationControllerThroughput", "[.][benchmark]")
+{
+    AnimationTestSet set(100, 500, 777);
+
+    for (const auto key_cursors : {false, true}) {
+        AnimationTestController controller(set, key_cursors, 0.5f);
+
+        BENCHMARK(_str("Advance 100 bones with 500 keys{}", key_cursors ? " (key cursors)" : "").str())
+        {
+            controller.Controller.AdvanceTime(0.016f);
+            return controller.Matrices[0].a1;
+        };
+    }
+}
+
+#endif
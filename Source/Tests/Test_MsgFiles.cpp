@@ -0,0 +1,220 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "DiskFileSystem.h"
+#include "MsgFiles.h"
+#include "StringUtils.h"
+
+static void CheckSameTexts(const FOMsg& msg, const multimap<uint, string>& reference)
+{
+    REQUIRE(msg.GetSize() == reference.size());
+
+    for (auto it = reference.begin(); it != reference.end(); it = reference.upper_bound(it->first)) {
+        const auto num = it->first;
+        const auto count = static_cast<uint>(reference.count(num));
+        REQUIRE(msg.Count(num) == count);
+
+        auto ref_it = it;
+        for (uint i = 0; i < count; i++, ++ref_it) {
+            REQUIRE(msg.GetStr(num, i) == ref_it->second);
+        }
+        REQUIRE(msg.GetStr(num, count).empty());
+
+        const auto random_str = msg.GetStr(num);
+        REQUIRE(std::any_of(it, ref_it, [&random_str](const auto& kv) { return kv.second == random_str; }));
+
+        const auto upper_it = reference.upper_bound(num);
+        REQUIRE(msg.GetStrNumUpper(num) == (upper_it != reference.end() ? upper_it->first : 0u));
+        REQUIRE(msg.GetStrNumLower(num) == num);
+    }
+}
+
+static auto MakeRandomTexts(uint seed, size_t count, uint max_num, FOMsg& msg, multimap<uint, string>& reference) -> uint
+{
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        const auto num = 1 + (seed >> 8) % max_num;
+        const auto str = _str("Text {} {}", num, string((seed >> 4) % 13, 'x')).str();
+        msg.AddStr(num, str);
+        reference.emplace(num, str);
+    }
+    return seed;
+}
+
+TEST_CASE("MsgFiles")
+{
+    FOMsg msg;
+    multimap<uint, string> reference;
+    auto seed = MakeRandomTexts(777, 3000, 1000, msg, reference);
+
+    SECTION("Flat table matches multimap")
+    {
+        CheckSameTexts(msg, reference);
+        REQUIRE(msg.Count(5000) == 0);
+        REQUIRE(msg.GetStr(5000).empty());
+        REQUIRE(msg.GetInt(5000) == -1);
+        REQUIRE(msg.GetStrNumUpper(1000) == 0);
+    }
+
+    SECTION("Erase keeps other texts")
+    {
+        for (uint num = 1; num <= 1000; num += 3) {
+            msg.EraseStr(num);
+            reference.erase(num);
+        }
+        CheckSameTexts(msg, reference);
+    }
+
+    SECTION("Merge replaces same numbers")
+    {
+        FOMsg other;
+        multimap<uint, string> other_reference;
+        MakeRandomTexts(seed, 500, 2000, other, other_reference);
+
+        REQUIRE(msg.IsIntersects(other));
+
+        for (const auto& [num, str] : other_reference) {
+            reference.erase(num);
+        }
+        for (auto it = other_reference.begin(); it != other_reference.end(); it = other_reference.upper_bound(it->first)) {
+            reference.emplace(it->first, std::prev(other_reference.upper_bound(it->first))->second);
+        }
+
+        msg += other;
+        CheckSameTexts(msg, reference);
+
+        FOMsg high;
+        high.AddStr(5000, "High");
+        REQUIRE_FALSE(msg.IsIntersects(high));
+    }
+
+    SECTION("Binary data round trip")
+    {
+        FOMsg loaded;
+        REQUIRE(loaded.LoadFromBinaryData(msg.GetBinaryData()));
+        CheckSameTexts(loaded, reference);
+        REQUIRE(loaded.GetBinaryData() == msg.GetBinaryData());
+
+        auto broken_data = msg.GetBinaryData();
+        broken_data.resize(broken_data.size() / 2);
+        REQUIRE_FALSE(loaded.LoadFromBinaryData(broken_data));
+        REQUIRE_FALSE(loaded.LoadFromBinaryData({}));
+
+        // Count which overflows arrays size on 32 bit platforms
+        auto huge_count_data = msg.GetBinaryData();
+        const auto huge_count = 0x80000001u;
+        std::memcpy(huge_count_data.data() + sizeof(uint), &huge_count, sizeof(huge_count));
+        REQUIRE_FALSE(loaded.LoadFromBinaryData(huge_count_data));
+    }
+
+    SECTION("Mapped file copied on change")
+    {
+        const string fname = "MsgFilesTest.fotxtb";
+        {
+            auto file = DiskFileSystem::OpenFile(fname, true);
+            REQUIRE(file);
+            REQUIRE(file.Write(msg.GetBinaryData()));
+        }
+
+        FOMsg mapped;
+        REQUIRE(mapped.LoadFromMappedFile(fname));
+        CheckSameTexts(mapped, reference);
+
+        // Copies share mapping
+        const auto mapped_copy = mapped;
+
+        seed = MakeRandomTexts(seed, 100, 1500, mapped, reference);
+        mapped.EraseStr(10);
+        reference.erase(10);
+        CheckSameTexts(mapped, reference);
+        REQUIRE(mapped_copy.GetBinaryData() == msg.GetBinaryData());
+
+        REQUIRE_FALSE(mapped.LoadFromMappedFile("MsgFilesTestNotExists.fotxtb"));
+        REQUIRE(DiskFileSystem::DeleteFile(fname));
+    }
+}
+
+TEST_CASE("MsgFilesLoad", "[.][benchmark]")
+{
+    FOMsg msg;
+    multimap<uint, string> reference;
+    MakeRandomTexts(4242, 200000, 1000000, msg, reference);
+
+    const string fname = "MsgFilesBenchmark.fotxtb";
+    {
+        auto file = DiskFileSystem::OpenFile(fname, true);
+        REQUIRE(file);
+        REQUIRE(file.Write(msg.GetBinaryData()));
+    }
+
+    BENCHMARK("Read and copy table")
+    {
+        auto file = DiskFileSystem::OpenFile(fname, false);
+        vector<uchar> data(file.GetSize());
+        const auto read_ok = file.Read(data.data(), data.size());
+        FOMsg loaded;
+        return read_ok && loaded.LoadFromBinaryData(data) ? loaded.GetSize() : 0;
+    };
+
+    BENCHMARK("Map table")
+    {
+        FOMsg loaded;
+        return loaded.LoadFromMappedFile(fname) ? loaded.GetSize() : 0;
+    };
+
+    FOMsg mapped;
+    REQUIRE(mapped.LoadFromMappedFile(fname));
+
+    BENCHMARK("Lookups in mapped table")
+    {
+        size_t result = 0;
+        for (uint num = 1; num < 1000000; num += 7) {
+            result += mapped.GetStr(num, 0).length();
+        }
+        return result;
+    };
+
+    BENCHMARK("Lookups in multimap")
+    {
+        size_t result = 0;
+        for (uint num = 1; num < 1000000; num += 7) {
+            const auto it = reference.find(num);
+            result += it != reference.end() ? it->second.length() : 0;
+        }
+        return result;
+    };
+
+    REQUIRE(DiskFileSystem::DeleteFile(fname));
+}
@@ -0,0 +1,129 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "NetBuffer.h"
+
+TEST_CASE("NetInBufferCutMsg")
+{
+    NetOutBuffer out_buf;
+    out_buf.SetEncryptKey(777);
+
+    vector<string> texts = {"Hello", "", string(300, 'x')};
+    for (const auto& text : texts) {
+        const uint msg_len = sizeof(uint) + sizeof(uint) + sizeof(uchar) + NetBuffer::STRING_LEN_SIZE + static_cast<uint>(text.length());
+        out_buf << NETMSG_SEND_TEXT;
+        out_buf << msg_len;
+        out_buf << static_cast<uchar>(1);
+        out_buf << text;
+        out_buf << NETMSG_DIR;
+        out_buf << static_cast<uchar>(3);
+    }
+
+    NetInBuffer in_buf;
+    in_buf.SetEncryptKey(777);
+
+    SECTION("Messages are cut from partial input and decoded by field")
+    {
+        vector<NetInMessage> messages;
+        NetInMessage message;
+
+        // Deliver stream in small chunks like socket does
+        const auto* data = out_buf.GetData();
+        for (uint pos = 0; pos < out_buf.GetEndPos(); pos += 7) {
+            in_buf.AddData(data + pos, std::min(7u, out_buf.GetEndPos() - pos));
+            while (in_buf.CutMsg(message)) {
+                messages.push_back(std::move(message));
+            }
+            REQUIRE_FALSE(in_buf.IsError());
+            in_buf.ShrinkReadBuf();
+        }
+
+        REQUIRE(messages.size() == texts.size() * 2);
+
+        NetInBuffer msg_buf;
+        for (size_t i = 0; i < texts.size(); i++) {
+            uint msg = 0;
+            uint msg_len = 0;
+            uchar how_say = 0;
+            string text;
+            REQUIRE(messages[i * 2].Msg == NETMSG_SEND_TEXT);
+            msg_buf.SetMsg(messages[i * 2]);
+            msg_buf >> msg;
+            msg_buf >> msg_len;
+            msg_buf >> how_say;
+            msg_buf >> text;
+            REQUIRE(msg == NETMSG_SEND_TEXT);
+            REQUIRE(how_say == 1);
+            REQUIRE(text == texts[i]);
+
+            uchar dir = 0;
+            REQUIRE(messages[i * 2 + 1].Msg == NETMSG_DIR);
+            msg_buf.SetMsg(messages[i * 2 + 1]);
+            msg_buf >> msg;
+            msg_buf >> dir;
+            REQUIRE(msg == NETMSG_DIR);
+            REQUIRE(dir == 3);
+            REQUIRE_FALSE(msg_buf.IsError());
+        }
+    }
+
+    SECTION("Unknown message is error")
+    {
+        NetOutBuffer bad_buf;
+        bad_buf << static_cast<uint>(0x12345678);
+        bad_buf << static_cast<uint>(0);
+
+        NetInBuffer bad_in_buf;
+        bad_in_buf.AddData(bad_buf.GetData(), bad_buf.GetEndPos());
+
+        NetInMessage message;
+        REQUIRE_FALSE(bad_in_buf.CutMsg(message));
+        REQUIRE(bad_in_buf.IsError());
+    }
+
+    SECTION("Too short message length is error")
+    {
+        NetOutBuffer bad_buf;
+        bad_buf << NETMSG_SEND_TEXT;
+        bad_buf << static_cast<uint>(2);
+
+        NetInBuffer bad_in_buf;
+        bad_in_buf.AddData(bad_buf.GetData(), bad_buf.GetEndPos());
+
+        NetInMessage message;
+        REQUIRE_FALSE(bad_in_buf.CutMsg(message));
+        REQUIRE(bad_in_buf.IsError());
+    }
+}
@@ -0,0 +1,258 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "Log.h"
+#include "NetBuffer.h"
+#include "NetCodec.h"
+#include "Settings.h"
+#include "StringUtils.h"
+
+static auto NextRandom(uint& seed) -> uint
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+// Server output like message mix, mostly small property updates with some pings and texts
+static auto MakeTraffic(uint connections, uint chunks_per_connection, uint seed) -> vector<NetTrafficCapture::Chunk>
+{
+    const vector<string> texts = {"Hello", "You see a rusty knife", "Not enough action points", "Critter is too far", "The door is locked"};
+
+    vector<NetTrafficCapture::Chunk> chunks;
+    for (uint i = 0; i < chunks_per_connection; i++) {
+        for (uint connection_id = 1; connection_id <= connections; connection_id++) {
+            NetOutBuffer out_buf;
+            const auto messages = 1 + NextRandom(seed) % 8;
+            for (uint j = 0; j < messages; j++) {
+                const auto kind = NextRandom(seed) % 10;
+                if (kind < 6) {
+                    out_buf << NETMSG_POD_PROPERTY(4, 1);
+                    out_buf << static_cast<uchar>(2);
+                    out_buf << static_cast<uint>(1000 + NextRandom(seed) % 20);
+                    out_buf << static_cast<ushort>(NextRandom(seed) % 30);
+                    out_buf << static_cast<int>(NextRandom(seed) % 200);
+                }
+                else if (kind < 9) {
+                    out_buf << NETMSG_PING;
+                    out_buf << PING_CLIENT;
+                }
+                else {
+                    const auto& text = texts[NextRandom(seed) % texts.size()];
+                    out_buf << NETMSG_SEND_TEXT;
+                    out_buf << static_cast<uint>(sizeof(uint) + sizeof(uint) + sizeof(uchar) + NetBuffer::STRING_LEN_SIZE + text.length());
+                    out_buf << static_cast<uchar>(1);
+                    out_buf << text;
+                }
+            }
+
+            chunks.push_back({connection_id, vector<uchar>(out_buf.GetData(), out_buf.GetData() + out_buf.GetEndPos())});
+        }
+    }
+    return chunks;
+}
+
+static auto GetSamples(const vector<NetTrafficCapture::Chunk>& chunks) -> vector<vector<uchar>>
+{
+    vector<vector<uchar>> samples;
+    for (const auto& chunk : chunks) {
+        samples.push_back(chunk.Data);
+    }
+    return samples;
+}
+
+TEST_CASE("NetCodec")
+{
+    const auto chunks = MakeTraffic(1, 300, 42);
+    const auto dictionary = NetCodec::TrainDictionary(GetSamples(MakeTraffic(10, 50, 7)), 4096);
+    REQUIRE(!dictionary.empty());
+    REQUIRE(dictionary.size() <= 4096);
+
+    vector<uchar> raw;
+    for (const auto& chunk : chunks) {
+        raw.insert(raw.end(), chunk.Data.begin(), chunk.Data.end());
+    }
+
+    for (const auto type : {NetCodecType::None, NetCodecType::Zlib, NetCodecType::ZlibDictionary}) {
+        SECTION(_str("Stream decoded from arbitrary pieces by {}", NetCodec::GetTypeName(type)).str())
+        {
+            auto encoder = NetCodec::Create(type, dictionary);
+            auto decoder = NetCodec::Create(type, dictionary);
+
+            vector<uchar> encoded;
+            for (const auto& chunk : chunks) {
+                encoder->Encode(chunk.Data.data(), static_cast<uint>(chunk.Data.size()), encoded);
+            }
+
+            vector<uchar> decoded;
+            uint seed = 5;
+            for (size_t pos = 0; pos < encoded.size();) {
+                const auto len = std::min(static_cast<size_t>(1 + NextRandom(seed) % 300), encoded.size() - pos);
+                REQUIRE(decoder->Decode(encoded.data() + pos, static_cast<uint>(len), decoded));
+                pos += len;
+            }
+
+            REQUIRE(decoded == raw);
+        }
+
+        SECTION(_str("Each encode is flushed by {}", NetCodec::GetTypeName(type)).str())
+        {
+            auto encoder = NetCodec::Create(type, dictionary);
+            auto decoder = NetCodec::Create(type, dictionary);
+
+            for (const auto& chunk : chunks) {
+                vector<uchar> encoded;
+                encoder->Encode(chunk.Data.data(), static_cast<uint>(chunk.Data.size()), encoded);
+                vector<uchar> decoded;
+                REQUIRE(decoder->Decode(encoded.data(), static_cast<uint>(encoded.size()), decoded));
+                REQUIRE(decoded == chunk.Data);
+            }
+        }
+    }
+
+    SECTION("Dictionary helps first messages")
+    {
+        auto zlib = NetCodec::Create(NetCodecType::Zlib, {});
+        auto zlib_dictionary = NetCodec::Create(NetCodecType::ZlibDictionary, dictionary);
+
+        vector<uchar> zlib_encoded;
+        vector<uchar> zlib_dictionary_encoded;
+        for (size_t i = 0; i < 20; i++) {
+            zlib->Encode(chunks[i].Data.data(), static_cast<uint>(chunks[i].Data.size()), zlib_encoded);
+            zlib_dictionary->Encode(chunks[i].Data.data(), static_cast<uint>(chunks[i].Data.size()), zlib_dictionary_encoded);
+        }
+
+        REQUIRE(zlib_dictionary_encoded.size() < zlib_encoded.size());
+    }
+
+    SECTION("Other dictionary fails decoding")
+    {
+        auto encoder = NetCodec::Create(NetCodecType::ZlibDictionary, dictionary);
+        auto other_dictionary = dictionary;
+        other_dictionary.front() ^= 1;
+        auto decoder = NetCodec::Create(NetCodecType::ZlibDictionary, other_dictionary);
+
+        vector<uchar> encoded;
+        encoder->Encode(chunks.front().Data.data(), static_cast<uint>(chunks.front().Data.size()), encoded);
+        vector<uchar> decoded;
+        REQUIRE_FALSE(decoder->Decode(encoded.data(), static_cast<uint>(encoded.size()), decoded));
+        REQUIRE(decoded.empty());
+    }
+
+    SECTION("Counters track bytes")
+    {
+        NetCodec::ResetStatistics();
+
+        auto encoder = NetCodec::Create(NetCodecType::Zlib, {});
+        vector<uchar> encoded;
+        for (const auto& chunk : chunks) {
+            encoder->Encode(chunk.Data.data(), static_cast<uint>(chunk.Data.size()), encoded);
+        }
+
+        const auto stats = NetCodec::GetStatistics(NetCodecType::Zlib);
+        REQUIRE(stats.EncodeCalls == chunks.size());
+        REQUIRE(stats.EncodeInBytes == raw.size());
+        REQUIRE(stats.EncodeOutBytes == encoded.size());
+        REQUIRE(NetCodec::GetStatistics(NetCodecType::None).EncodeCalls == 0u);
+    }
+}
+
+TEST_CASE("NetCodecReplay", "[.][benchmark]")
+{
+    GlobalSettings settings(0, nullptr);
+
+    // Captured server output if there is one, otherwise synthetic message mix
+    // Chunks of first half of connections train dictionary, rest is replayed
+    vector<NetTrafficCapture::Chunk> chunks;
+    if (!settings.NetTrafficCapture.empty() && DiskFileSystem::OpenFile(settings.NetTrafficCapture, false)) {
+        chunks = NetTrafficCapture::Read(settings.NetTrafficCapture);
+    }
+    else {
+        chunks = MakeTraffic(100, 100, 1);
+    }
+
+    uint max_connection_id = 0;
+    for (const auto& chunk : chunks) {
+        max_connection_id = std::max(max_connection_id, chunk.ConnectionId);
+    }
+
+    vector<vector<uchar>> samples;
+    vector<const NetTrafficCapture::Chunk*> replay_chunks;
+    for (const auto& chunk : chunks) {
+        if (chunk.ConnectionId <= max_connection_id / 2) {
+            samples.push_back(chunk.Data);
+        }
+        else {
+            replay_chunks.push_back(&chunk);
+        }
+    }
+
+    const auto dictionary = NetCodec::TrainDictionary(samples, 16384);
+
+    if (!settings.NetTrafficCapture.empty() && !chunks.empty()) {
+        const auto dictionary_path = _str("{}.dict", settings.NetTrafficCapture).str();
+        if (auto file = DiskFileSystem::OpenFile(dictionary_path, true); file && file.Write(dictionary.data(), dictionary.size())) {
+            WriteLog("Trained dictionary written to {}", dictionary_path);
+        }
+    }
+
+    const auto replay = [&](NetCodecType type) {
+        unordered_map<uint, unique_ptr<NetCodec>> encoders;
+        vector<uchar> encoded;
+        size_t encoded_size = 0;
+        for (const auto* chunk : replay_chunks) {
+            auto& encoder = encoders[chunk->ConnectionId];
+            if (!encoder) {
+                encoder = NetCodec::Create(type, dictionary);
+            }
+
+            encoded.clear();
+            encoder->Encode(chunk->Data.data(), static_cast<uint>(chunk->Data.size()), encoded);
+            encoded_size += encoded.size();
+        }
+        return encoded_size;
+    };
+
+    for (const auto type : {NetCodecType::None, NetCodecType::Zlib, NetCodecType::ZlibDictionary}) {
+        NetCodec::ResetStatistics();
+        replay(type);
+        const auto stats = NetCodec::GetStatistics(type);
+        WriteLog("Replay {}: {} chunks, {} bytes to {} bytes ({:.3f}), encode {} us", NetCodec::GetTypeName(type), stats.EncodeCalls, stats.EncodeInBytes, stats.EncodeOutBytes, static_cast<double>(stats.EncodeOutBytes) / static_cast<double>(std::max(stats.EncodeInBytes, uint64 {1})), stats.EncodeTime);
+
+        BENCHMARK(_str("Replay {}", NetCodec::GetTypeName(type)).str())
+        {
+            return replay(type);
+        };
+    }
+}
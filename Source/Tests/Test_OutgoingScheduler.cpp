@@ -0,0 +1,214 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "OutgoingScheduler.h"
+
+struct OutgoingTestConnection
+{
+    explicit OutgoingTestConnection(const OutgoingScheduler::Config& config) : Scheduler(config) { Staging.SetPartsTracking(true); }
+
+    void Send(uint msg, uint value, uint64 coalesce_key = 0)
+    {
+        Staging << msg;
+        Staging << value;
+        Scheduler.Enqueue(Staging, coalesce_key);
+    }
+
+    // Pairs of message and value from unencrypted wire
+    auto TakeWire() -> vector<pair<uint, uint>>
+    {
+        vector<pair<uint, uint>> result;
+        for (uint pos = 0; pos + sizeof(uint) * 2 <= Wire.GetEndPos(); pos += sizeof(uint) * 2) {
+            uint msg = 0;
+            uint value = 0;
+            std::memcpy(&msg, Wire.GetData() + pos, sizeof(msg));
+            std::memcpy(&value, Wire.GetData() + pos + sizeof(msg), sizeof(value));
+            result.emplace_back(msg, value);
+        }
+        Wire.Cut(Wire.GetEndPos());
+        return result;
+    }
+
+    OutgoingScheduler Scheduler;
+    NetOutBuffer Staging {};
+    NetOutBuffer Wire {};
+};
+
+TEST_CASE("OutgoingScheduler")
+{
+    const uint gameplay_msg = NETMSG_MSG;
+    const uint critical_msg = NETMSG_CRITTER_MOVE;
+    const uint bulk_msg = NETMSG_UPDATE_FILE_DATA;
+    const uint barrier_msg = NETMSG_LOADMAP;
+
+    OutgoingScheduler::Config config;
+
+    SECTION("Encrypted output same as direct writes")
+    {
+        OutgoingScheduler scheduler(config);
+        NetOutBuffer staging;
+        staging.SetPartsTracking(true);
+        NetOutBuffer wire;
+        wire.SetEncryptKey(987654);
+        NetOutBuffer direct;
+        direct.SetEncryptKey(987654);
+
+        for (uint i = 0; i < 100; i++) {
+            const string text = string(i % 13, 'x');
+            for (auto* buf : {&staging, &direct}) {
+                *buf << gameplay_msg;
+                *buf << static_cast<uchar>(i);
+                *buf << text;
+                *buf << static_cast<ushort>(i * 7);
+            }
+            scheduler.Enqueue(staging, 0);
+        }
+        scheduler.Flush(wire, 0.0);
+
+        REQUIRE(scheduler.GetQueuedBytes() == 0);
+        REQUIRE(wire.GetEndPos() == direct.GetEndPos());
+        REQUIRE(std::memcmp(wire.GetData(), direct.GetData(), wire.GetEndPos()) == 0);
+    }
+
+    SECTION("Lanes by priority")
+    {
+        config.Watermark = 1;
+        OutgoingTestConnection conn(config);
+        conn.Send(bulk_msg, 1);
+        conn.Send(gameplay_msg, 2);
+        conn.Send(gameplay_msg, 3);
+        conn.Send(critical_msg, 4);
+        conn.Send(critical_msg, 5);
+
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{critical_msg, 4}, {critical_msg, 5}});
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{gameplay_msg, 2}});
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{gameplay_msg, 3}});
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{bulk_msg, 1}});
+    }
+
+    SECTION("Critical waits for barrier")
+    {
+        config.Watermark = 1;
+        OutgoingTestConnection conn(config);
+        conn.Send(gameplay_msg, 1);
+        conn.Send(barrier_msg, 2);
+        conn.Send(critical_msg, 3);
+
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{gameplay_msg, 1}});
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{barrier_msg, 2}, {critical_msg, 3}});
+    }
+
+    SECTION("Superseded messages are dropped")
+    {
+        OutgoingTestConnection conn(config);
+        const auto key = OutgoingScheduler::MakeCoalesceKey(1, 0, 0, 77);
+        const auto coalesced = OutgoingScheduler::GetStatistics().Coalesced;
+        conn.Send(gameplay_msg, 1, key);
+        conn.Send(gameplay_msg, 2);
+        conn.Send(gameplay_msg, 3, key);
+        conn.Send(gameplay_msg, 4, OutgoingScheduler::MakeCoalesceKey(1, 0, 0, 78));
+
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{gameplay_msg, 2}, {gameplay_msg, 3}, {gameplay_msg, 4}});
+        REQUIRE(OutgoingScheduler::GetStatistics().Coalesced == coalesced + 1);
+
+        // Sent message is not replaced
+        conn.Send(gameplay_msg, 5, key);
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{gameplay_msg, 5}});
+    }
+
+    SECTION("Bandwidth shaping")
+    {
+        config.BytesPerSecond = 1000;
+        config.BurstBytes = 16;
+        config.Watermark = 1000000;
+        OutgoingTestConnection conn(config);
+        for (uint i = 0; i < 6; i++) {
+            conn.Send(gameplay_msg, i);
+        }
+        conn.Send(critical_msg, 100);
+
+        conn.Scheduler.Flush(conn.Wire, 0.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{critical_msg, 100}, {gameplay_msg, 0}, {gameplay_msg, 1}});
+        conn.Scheduler.Flush(conn.Wire, 8.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{gameplay_msg, 2}});
+        conn.Scheduler.Flush(conn.Wire, 1000.0);
+        REQUIRE(conn.TakeWire() == vector<pair<uint, uint>> {{gameplay_msg, 3}, {gameplay_msg, 4}});
+    }
+
+    SECTION("Slow consumer and overflow")
+    {
+        config.BytesPerSecond = 1;
+        config.Watermark = 1000000;
+        config.SlowConsumerBytes = 40;
+        config.SlowConsumerTime = 1000;
+        config.MaxQueuedBytes = 80;
+        const auto slow_now = OutgoingScheduler::GetStatistics().SlowConsumersNow;
+
+        {
+            OutgoingTestConnection conn(config);
+            for (uint i = 0; i < 8; i++) {
+                conn.Send(gameplay_msg, i);
+            }
+
+            conn.Scheduler.Flush(conn.Wire, 0.0);
+            REQUIRE_FALSE(conn.Scheduler.IsSlowConsumer());
+            conn.Scheduler.Flush(conn.Wire, 1500.0);
+            REQUIRE(conn.Scheduler.IsSlowConsumer());
+            REQUIRE(OutgoingScheduler::GetStatistics().SlowConsumersNow == slow_now + 1);
+            REQUIRE_FALSE(conn.Scheduler.IsOverflowed());
+
+            for (uint i = 0; i < 8; i++) {
+                conn.Send(gameplay_msg, i);
+            }
+            conn.Scheduler.Flush(conn.Wire, 1600.0);
+            REQUIRE(conn.Scheduler.IsOverflowed());
+
+            conn.Scheduler.FlushAll(conn.Wire);
+            conn.TakeWire();
+            conn.Scheduler.Flush(conn.Wire, 1700.0);
+            REQUIRE_FALSE(conn.Scheduler.IsSlowConsumer());
+        }
+
+        REQUIRE(OutgoingScheduler::GetStatistics().SlowConsumersNow == slow_now);
+    }
+}
@@ -0,0 +1,329 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "GeometryHelper.h"
+#include "PathFindManager.h"
+#include "Settings.h"
+#include "SnapshotPublisher.h"
+#include "WorldSnapshotManager.h"
+
+struct PathFindTestMap
+{
+    PathFindTestMap(ushort width, ushort height, uint seed) : Width {width}, Height {height}, StaticFlags(width * height), DynamicFlags(width * height)
+    {
+        for (auto& flags : StaticFlags) {
+            seed = seed * 1103515245u + 12345u;
+            flags = (seed >> 16) % 100 < 20 ? FH_BLOCK : 0;
+        }
+    }
+
+    [[nodiscard]] auto MakeSnapshot(uint map_id) const -> shared_ptr<const MapSnapshot>
+    {
+        auto snapshot = std::make_shared<MapSnapshot>();
+        snapshot->MapId = map_id;
+        snapshot->Critters = std::make_shared<const vector<MapSnapshot::CritterEntry>>();
+
+        for (uint hy = 0; hy < Height; hy += MapHexFlagsView::BAND_ROWS) {
+            const auto rows = std::min(static_cast<uint>(MapHexFlagsView::BAND_ROWS), Height - hy);
+            auto band = std::make_shared<MapSnapshot::HexFlagsBand>();
+            band->DynamicFlags.assign(DynamicFlags.begin() + hy * Width, DynamicFlags.begin() + (hy + rows) * Width);
+            snapshot->DynamicFlagsBands.emplace_back(band->DynamicFlags.data());
+            snapshot->HexFlagsBands.emplace_back(std::move(band));
+        }
+
+        snapshot->HexFlags = {Width, Height, StaticFlags.data(), snapshot->DynamicFlagsBands.data()};
+        return snapshot;
+    }
+
+    void Publish(SnapshotPublisher<WorldSnapshot>& publisher, uint map_id) const
+    {
+        auto world = std::make_unique<WorldSnapshot>();
+        world->Maps.emplace_back(MakeSnapshot(map_id));
+        publisher.Publish(std::move(world));
+    }
+
+    ushort Width;
+    ushort Height;
+    vector<uchar> StaticFlags;
+    vector<uchar> DynamicFlags;
+};
+
+static auto MakeInput(ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy) -> FindPathInput
+{
+    FindPathInput input;
+    input.MapId = 1;
+    input.FromX = from_hx;
+    input.FromY = from_hy;
+    input.ToX = to_hx;
+    input.ToY = to_hy;
+    input.Cut = 1;
+    return input;
+}
+
+// Results are picked up on later ticks in server, here just poll until search is done
+static auto WaitResult(PathSearchQueue& queue, uint requester_id, const FindPathInput& input, FindPathOutput& output) -> PathSearchQueue::RequestState
+{
+    while (true) {
+        const auto state = queue.TakeResult(requester_id, input, output);
+        if (state != PathSearchQueue::RequestState::Pending) {
+            return state;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+static void CheckSameOutput(const FindPathOutput& output, const FindPathOutput& reference)
+{
+    REQUIRE(output.Result == reference.Result);
+    REQUIRE(output.Steps.size() == reference.Steps.size());
+
+    for (size_t i = 0; i < output.Steps.size(); i++) {
+        REQUIRE(output.Steps[i].HexX == reference.Steps[i].HexX);
+        REQUIRE(output.Steps[i].HexY == reference.Steps[i].HexY);
+        REQUIRE(output.Steps[i].Dir == reference.Steps[i].Dir);
+    }
+}
+
+TEST_CASE("PathFind")
+{
+    GlobalSettings settings(0, nullptr);
+    GeometryHelper geom_helper(settings);
+
+    PathFindTestMap test_map(120, 120, 4242);
+    const auto snapshot = test_map.MakeSnapshot(1);
+
+    // Searches read published world like in server
+    SnapshotPublisher<WorldSnapshot> publisher;
+    test_map.Publish(publisher, 1);
+
+    std::atomic_size_t searches_done {};
+    const auto search_func = [&](const FindPathInput& input, bool& smooth_switcher) {
+        searches_done++;
+        const auto world = publisher.Read();
+        return PathFindManager::SearchOnSnapshot(world.Get(), input, settings, geom_helper, smooth_switcher);
+    };
+
+    PathSearchQueue queue(2, search_func);
+    const auto& stats = queue.GetStatistics();
+
+    // Same search on caller thread, smooth switcher alternates between searches like in queue
+    const auto find_path_sync = [&](const FindPathInput& input, size_t search_index) {
+        auto smooth_switcher = (search_index % 2) != 0;
+        return MapManager::FindPathSteps(input, snapshot->HexFlags, settings, geom_helper, smooth_switcher);
+    };
+
+    SECTION("Async results match synchronous search")
+    {
+        vector<FindPathInput> inputs;
+        uint seed = 777;
+        for (uint i = 0; i < 200; i++) {
+            seed = seed * 1103515245u + 12345u;
+            const auto from_hx = static_cast<ushort>((seed >> 8) % test_map.Width);
+            const auto from_hy = static_cast<ushort>((seed >> 16) % test_map.Height);
+            seed = seed * 1103515245u + 12345u;
+            const auto to_hx = static_cast<ushort>((seed >> 8) % test_map.Width);
+            const auto to_hy = static_cast<ushort>((seed >> 16) % test_map.Height);
+            inputs.emplace_back(MakeInput(from_hx, from_hy, to_hx, to_hy));
+        }
+
+        // All requests queued before any result is taken
+        for (uint i = 0; i < inputs.size(); i++) {
+            queue.Request(i + 1, inputs[i]);
+        }
+
+        size_t found = 0;
+        for (uint i = 0; i < inputs.size(); i++) {
+            FindPathOutput output;
+            REQUIRE(WaitResult(queue, i + 1, inputs[i], output) == PathSearchQueue::RequestState::Ready);
+            CheckSameOutput(output, find_path_sync(inputs[i], i));
+
+            if (output.Result == FindPathResult::Ok) {
+                found++;
+            }
+        }
+
+        REQUIRE(found > 0);
+        REQUIRE(stats.Requests == inputs.size());
+        REQUIRE(stats.Searches == inputs.size());
+        REQUIRE(stats.Deduplicated == 0);
+
+        // Taken results are not repeated
+        FindPathOutput output;
+        REQUIRE(queue.TakeResult(1, inputs[0], output) == PathSearchQueue::RequestState::None);
+    }
+
+    SECTION("Same search shared by several requesters")
+    {
+        const auto input = MakeInput(10, 10, 100, 100);
+        const auto reference = find_path_sync(input, 0);
+
+        for (uint id = 1; id <= 5; id++) {
+            queue.Request(id, input);
+        }
+
+        REQUIRE(stats.Searches == 1);
+        REQUIRE(stats.Deduplicated == 4);
+
+        for (uint id = 1; id <= 5; id++) {
+            FindPathOutput output;
+            REQUIRE(WaitResult(queue, id, input, output) == PathSearchQueue::RequestState::Ready);
+            CheckSameOutput(output, reference);
+        }
+
+        REQUIRE(searches_done == 1);
+
+        // Finished search is not shared anymore, new request must see newer map state
+        queue.Process([](uint) { return true; });
+        REQUIRE(stats.Pending == 0);
+
+        queue.Request(6, input);
+        REQUIRE(stats.Searches == 2);
+
+        FindPathOutput output;
+        REQUIRE(WaitResult(queue, 6, input, output) == PathSearchQueue::RequestState::Ready);
+    }
+
+    SECTION("Changed request is stale")
+    {
+        const auto input = MakeInput(10, 10, 100, 100);
+        queue.Request(1, input);
+
+        // Critter or target moved meanwhile
+        auto moved_input = input;
+        moved_input.FromX = 11;
+
+        FindPathOutput output;
+        REQUIRE(queue.TakeResult(1, moved_input, output) == PathSearchQueue::RequestState::None);
+        REQUIRE(stats.Stale == 1);
+        REQUIRE(output.Result == FindPathResult::Unknown);
+
+        // Stale request is dropped and must be repeated
+        REQUIRE(queue.TakeResult(1, input, output) == PathSearchQueue::RequestState::None);
+
+        queue.Request(1, moved_input);
+        REQUIRE(WaitResult(queue, 1, moved_input, output) == PathSearchQueue::RequestState::Ready);
+        CheckSameOutput(output, find_path_sync(moved_input, 1));
+
+        // Request flags which are not part of search key also make request stale
+        queue.Request(2, input);
+        auto run_input = input;
+        run_input.IsRun = true;
+        REQUIRE(queue.TakeResult(2, run_input, output) == PathSearchQueue::RequestState::None);
+        REQUIRE(stats.Stale == 2);
+    }
+
+    SECTION("Requests of inactive requesters dropped")
+    {
+        const auto input1 = MakeInput(10, 10, 100, 100);
+        const auto input2 = MakeInput(20, 20, 90, 90);
+        queue.Request(1, input1);
+        queue.Request(2, input2);
+
+        queue.Process([](uint requester_id) { return requester_id != 1; });
+
+        FindPathOutput output;
+        REQUIRE(queue.TakeResult(1, input1, output) == PathSearchQueue::RequestState::None);
+        REQUIRE(WaitResult(queue, 2, input2, output) == PathSearchQueue::RequestState::Ready);
+        CheckSameOutput(output, find_path_sync(input2, 1));
+    }
+
+    SECTION("Rejected request")
+    {
+        const auto input = MakeInput(10, 10, 100, 100);
+        queue.Reject(1, input, FindPathResult::MapNotFound);
+
+        FindPathOutput output;
+        REQUIRE(queue.TakeResult(1, input, output) == PathSearchQueue::RequestState::Ready);
+        REQUIRE(output.Result == FindPathResult::MapNotFound);
+        REQUIRE(stats.Searches == 0);
+        REQUIRE(searches_done == 0);
+    }
+
+    SECTION("Stopped queue drops not finished searches")
+    {
+        for (uint i = 0; i < 100; i++) {
+            queue.Request(i + 1, MakeInput(10, 10, static_cast<ushort>(10 + i), 100));
+        }
+
+        queue.Stop();
+
+        // Queued searches are discarded and nothing runs after stop
+        const size_t stopped_searches_done = searches_done;
+        REQUIRE(stats.Pending == 0);
+
+        FindPathOutput output;
+        for (uint i = 0; i < 100; i++) {
+            REQUIRE(queue.TakeResult(i + 1, MakeInput(10, 10, static_cast<ushort>(10 + i), 100), output) == PathSearchQueue::RequestState::None);
+        }
+        REQUIRE(searches_done == stopped_searches_done);
+
+        // Queue is usable again
+        const auto input = MakeInput(10, 10, 100, 100);
+        queue.Request(1, input);
+        REQUIRE(WaitResult(queue, 1, input, output) == PathSearchQueue::RequestState::Ready);
+        REQUIRE(searches_done == stopped_searches_done + 1);
+    }
+
+    SECTION("Search sees last published world")
+    {
+        const auto input = MakeInput(10, 10, 12, 10);
+        const auto reference = find_path_sync(input, 0);
+        REQUIRE(reference.Result == FindPathResult::Ok);
+
+        // Map changes are not visible until publish
+        std::fill(test_map.DynamicFlags.begin(), test_map.DynamicFlags.end(), static_cast<uchar>(FH_CRITTER));
+
+        queue.Request(1, input);
+        FindPathOutput output;
+        REQUIRE(WaitResult(queue, 1, input, output) == PathSearchQueue::RequestState::Ready);
+        CheckSameOutput(output, reference);
+
+        // Whole map blocked in new world, new search sees it
+        test_map.Publish(publisher, 1);
+        queue.Process([](uint) { return true; });
+
+        queue.Request(1, input);
+        REQUIRE(WaitResult(queue, 1, input, output) == PathSearchQueue::RequestState::Ready);
+        REQUIRE(output.Result != FindPathResult::Ok);
+
+        // Map not present in published world
+        auto unknown_map_input = MakeInput(10, 10, 12, 10);
+        unknown_map_input.MapId = 2;
+        queue.Request(2, unknown_map_input);
+        REQUIRE(WaitResult(queue, 2, unknown_map_input, output) == PathSearchQueue::RequestState::Ready);
+        REQUIRE(output.Result == FindPathResult::MapNotFound);
+    }
+}
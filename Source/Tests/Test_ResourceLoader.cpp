@@ -0,0 +1,174 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "ResourceLoader.h"
+#include "StringUtils.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+// Stands for file reading and pixels decoding
+static auto DecodeResource(uint seed, size_t size) -> vector<uchar>
+{
+    vector<uchar> data(size);
+    for (auto& b : data) {
+        seed = seed * 1103515245u + 12345u;
+        b = static_cast<uchar>(seed >> 16);
+    }
+    return data;
+}
+
+TEST_CASE("ResourceLoader")
+{
+    ResourceLoader loader(2, 4);
+
+    SECTION("Completes in priority order")
+    {
+        vector<int> completed;
+        for (const auto priority : {5, 1, 3, 2, 4}) {
+            loader.AddRequest(
+                priority, [] {}, [&completed, priority] { completed.push_back(priority); });
+        }
+
+        loader.WaitAll();
+
+        REQUIRE(completed.size() == 5);
+        REQUIRE(loader.GetPendingCount() == 0);
+        REQUIRE(std::is_sorted(completed.begin(), completed.end()));
+    }
+
+    SECTION("Load and complete are paired")
+    {
+        vector<shared_ptr<vector<uchar>>> results;
+        vector<uint> completed;
+        for (uint i = 0; i < 20; i++) {
+            auto result = std::make_shared<vector<uchar>>();
+            results.push_back(result);
+            loader.AddRequest(
+                static_cast<int>(i), [result, i] { *result = DecodeResource(i, 1000); }, [result, i, &completed] {
+                    REQUIRE(*result == DecodeResource(i, 1000));
+                    completed.push_back(i);
+                });
+        }
+
+        loader.WaitAll();
+
+        REQUIRE(completed.size() == 20);
+    }
+
+    SECTION("Cancel")
+    {
+        auto completed = 0;
+        const auto id1 = loader.AddRequest(
+            0, [] {}, [&completed] { completed++; });
+        const auto id2 = loader.AddRequest(
+            0, [] {}, [&completed] { completed++; });
+        REQUIRE(loader.IsPending(id1));
+
+        loader.Process(0);
+        loader.Cancel(id1);
+        REQUIRE_FALSE(loader.IsPending(id1));
+
+        loader.WaitAll();
+
+        REQUIRE(completed == 1);
+        REQUIRE_FALSE(loader.IsPending(id2));
+        REQUIRE(loader.GetStatistics().Canceled == 1);
+    }
+
+    SECTION("Failed load still completes")
+    {
+        auto completed = false;
+        loader.AddRequest(
+            0, [] { throw GenericException("Broken resource"); }, [&completed] { completed = true; });
+
+        loader.WaitAll();
+
+        REQUIRE(completed);
+        REQUIRE(loader.GetStatistics().Failed == 1);
+    }
+}
+
+// Map entering, many resources are requested at once and frame time is measured with inline and background decoding
+TEST_CASE("ResourceLoaderFrameSpikes", "[.][benchmark]")
+{
+    constexpr uint RESOURCES_COUNT = 300;
+    constexpr size_t RESOURCE_SIZE = 256 * 1024;
+    constexpr uint FRAMES_COUNT = 100000;
+
+    const auto run_frames = [&](ResourceLoader* loader) -> tuple<double, double, uint> {
+        auto max_frame_time = 0.0;
+        auto total_time = 0.0;
+        uint frames = 0;
+        uint done = 0;
+
+        for (; frames < FRAMES_COUNT && done < RESOURCES_COUNT; frames++) {
+            const auto frame_start = Timer::RealtimeTick();
+
+            if (frames == 0) {
+                for (uint i = 0; i < RESOURCES_COUNT; i++) {
+                    auto result = std::make_shared<vector<uchar>>();
+                    if (loader != nullptr) {
+                        loader->AddRequest(
+                            static_cast<int>(i), [result, i] { *result = DecodeResource(i, RESOURCE_SIZE); }, [result, &done] { done += !result->empty() ? 1 : 0; });
+                    }
+                    else {
+                        *result = DecodeResource(i, RESOURCE_SIZE);
+                        done++;
+                    }
+                }
+            }
+
+            if (loader != nullptr) {
+                loader->Process(4);
+            }
+
+            const auto frame_time = Timer::RealtimeTick() - frame_start;
+            max_frame_time = std::max(max_frame_time, frame_time);
+            total_time += frame_time;
+
+            // Rendering
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return {max_frame_time, total_time, frames};
+    };
+
+    const auto [sync_max, sync_total, sync_frames] = run_frames(nullptr);
+    WARN(_str("Inline decoding: max frame {:.2f}ms, {} frames, {:.2f}ms in frames", sync_max, sync_frames, sync_total).str());
+
+    ResourceLoader loader(ThreadPool::GetDefaultThreadsCount(), ThreadPool::GetDefaultThreadsCount() * 2);
+    const auto [async_max, async_total, async_frames] = run_frames(&loader);
+    WARN(_str("Background decoding: max frame {:.2f}ms, {} frames, {:.2f}ms in frames", async_max, async_frames, async_total).str());
+}
@@ -0,0 +1,124 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "SnapshotPublisher.h"
+
+struct TestSnapshot
+{
+    explicit TestSnapshot(uint value) : Value {value}, Check {~value} { }
+    TestSnapshot(const TestSnapshot&) = delete;
+    TestSnapshot(TestSnapshot&&) noexcept = delete;
+    auto operator=(const TestSnapshot&) = delete;
+    auto operator=(TestSnapshot&&) noexcept = delete;
+    ~TestSnapshot()
+    {
+        // Freed snapshot seen by reader breaks check
+        Value = 0;
+        Check = 0;
+    }
+
+    uint Value;
+    uint Check;
+};
+
+TEST_CASE("SnapshotPublisher")
+{
+    SECTION("Retired values freed after readers leave")
+    {
+        SnapshotPublisher<TestSnapshot> publisher;
+        REQUIRE_FALSE(publisher.Read());
+
+        publisher.Publish(std::make_unique<TestSnapshot>(1));
+        REQUIRE(publisher.GetRetiredCount() == 0);
+
+        {
+            const auto guard = publisher.Read();
+            REQUIRE(guard->Value == 1);
+
+            publisher.Publish(std::make_unique<TestSnapshot>(2));
+            publisher.Publish(std::make_unique<TestSnapshot>(3));
+            REQUIRE(publisher.GetRetiredCount() == 2);
+            REQUIRE(guard->Value == 1);
+            REQUIRE(guard->Check == ~1u);
+
+            const auto new_guard = publisher.Read();
+            REQUIRE(new_guard->Value == 3);
+        }
+
+        publisher.Reclaim();
+        REQUIRE(publisher.GetRetiredCount() == 0);
+        REQUIRE(publisher.Read()->Value == 3);
+    }
+
+    SECTION("Readers on other threads see consistent values")
+    {
+        SnapshotPublisher<TestSnapshot> publisher;
+        publisher.Publish(std::make_unique<TestSnapshot>(1));
+
+        std::atomic_bool stop {};
+        std::atomic_size_t failures {};
+        std::atomic_size_t reads {};
+        vector<std::thread> readers;
+
+        for (auto i = 0; i < 4; i++) {
+            readers.emplace_back([&] {
+                uint last_value = 0;
+                while (!stop) {
+                    const auto guard = publisher.Read();
+                    const auto value = guard->Value;
+                    std::this_thread::yield();
+                    if (value < last_value || guard->Check != ~value) {
+                        ++failures;
+                    }
+                    last_value = value;
+                    ++reads;
+                }
+            });
+        }
+
+        for (uint value = 2; value < 20000 || reads < 1000; value++) {
+            publisher.Publish(std::make_unique<TestSnapshot>(value));
+        }
+
+        stop = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+
+        REQUIRE(failures == 0);
+        publisher.Reclaim();
+        REQUIRE(publisher.GetRetiredCount() == 0);
+    }
+}
@@ -0,0 +1,94 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "SpscQueue.h"
+
+TEST_CASE("SpscQueue")
+{
+    SECTION("Bounded capacity")
+    {
+        SpscQueue<uint> queue(5);
+        REQUIRE(queue.GetCapacity() == 8);
+
+        for (uint i = 0; i < 8; i++) {
+            REQUIRE(queue.Push(uint {i}));
+        }
+        REQUIRE_FALSE(queue.Push(8u));
+        REQUIRE(queue.GetCount() == 8);
+
+        uint value = 0;
+        REQUIRE(queue.Pop(value));
+        REQUIRE(value == 0);
+        REQUIRE(queue.Push(8u));
+
+        for (uint i = 1; i <= 8; i++) {
+            REQUIRE(queue.Pop(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE_FALSE(queue.Pop(value));
+    }
+
+    SECTION("Order between threads")
+    {
+        constexpr uint count = 200000;
+        SpscQueue<vector<uint>> queue(64);
+
+        std::thread producer([&queue] {
+            for (uint i = 0; i < count; i++) {
+                vector<uint> value {i, i * 3};
+                while (!queue.Push(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint next = 0;
+        auto ordered = true;
+        vector<uint> value;
+        while (next < count) {
+            if (queue.Pop(value)) {
+                ordered = ordered && value.size() == 2 && value[0] == next && value[1] == next * 3;
+                next++;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+
+        producer.join();
+        REQUIRE(ordered);
+        REQUIRE(queue.GetCount() == 0);
+    }
+}
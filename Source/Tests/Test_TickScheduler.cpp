@@ -0,0 +1,194 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "TickScheduler.h"
+
+TEST_CASE("TickScheduler")
+{
+    // 20 ms period, up to 3 missed ticks caught up, early ticks spaced by 2 ms
+    TickScheduler scheduler(50, 3, 2);
+    REQUIRE(scheduler.GetTickPeriod() == Approx(20.0));
+
+    REQUIRE(scheduler.IsTickDue(1000.0));
+    scheduler.BeginTick(1000.0);
+    scheduler.EndTick(1005.0);
+
+    const auto& stats = scheduler.GetStatistics();
+
+    SECTION("On time ticks")
+    {
+        REQUIRE_FALSE(scheduler.IsTickDue(1019.0));
+        REQUIRE(scheduler.IsTickDue(1020.0));
+        scheduler.BeginTick(1020.0);
+        scheduler.EndTick(1025.0);
+
+        REQUIRE_FALSE(scheduler.IsTickDue(1039.0));
+        REQUIRE(scheduler.IsTickDue(1040.5));
+        scheduler.BeginTick(1040.5);
+        scheduler.EndTick(1044.5);
+
+        // Schedule is not shifted by slightly late begin
+        REQUIRE_FALSE(scheduler.IsTickDue(1059.0));
+        REQUIRE(scheduler.IsTickDue(1060.0));
+
+        REQUIRE(stats.Ticks == 3);
+        REQUIRE(stats.CatchUpTicks == 0);
+        REQUIRE(stats.DroppedTicks == 0);
+        REQUIRE(stats.InputTicks == 0);
+        REQUIRE(stats.TimerTicks == 0);
+        REQUIRE(stats.Overruns == 0);
+        REQUIRE(stats.LastTickTime == Approx(4.0));
+        REQUIRE(stats.MaxTickTime == Approx(5.0));
+    }
+
+    SECTION("Late ticks within catch up limit keep schedule")
+    {
+        scheduler.BeginTick(1020.0);
+        scheduler.EndTick(1070.0);
+        REQUIRE(stats.Overruns == 1);
+        REQUIRE(stats.MaxOverrun == Approx(30.0));
+
+        // Missed tick at 1040 runs back to back
+        REQUIRE(scheduler.IsTickDue(1070.0));
+        scheduler.BeginTick(1070.0);
+        scheduler.EndTick(1071.0);
+        REQUIRE(stats.CatchUpTicks == 1);
+
+        REQUIRE(scheduler.IsTickDue(1071.0));
+        scheduler.BeginTick(1071.0);
+        scheduler.EndTick(1072.0);
+        REQUIRE(stats.CatchUpTicks == 1);
+
+        // Back on original schedule
+        REQUIRE_FALSE(scheduler.IsTickDue(1079.0));
+        REQUIRE(scheduler.IsTickDue(1080.0));
+        REQUIRE(stats.DroppedTicks == 0);
+    }
+
+    SECTION("Schedule dropped when too late")
+    {
+        scheduler.BeginTick(1020.0);
+        scheduler.EndTick(1025.0);
+
+        // Eight periods late is over catch up limit
+        REQUIRE(scheduler.IsTickDue(1200.0));
+        scheduler.BeginTick(1200.0);
+        scheduler.EndTick(1205.0);
+        REQUIRE(stats.DroppedTicks == 8);
+        REQUIRE(stats.CatchUpTicks == 0);
+
+        // New schedule starts from late tick
+        REQUIRE_FALSE(scheduler.IsTickDue(1219.0));
+        REQUIRE(scheduler.IsTickDue(1220.0));
+    }
+
+    SECTION("Schedule dropped when overloaded")
+    {
+        // Every tick takes two periods, catching up stops when load reaches whole period
+        auto time = 1020.0;
+        for (auto i = 0; i < 100; i++) {
+            REQUIRE(scheduler.IsTickDue(time));
+            scheduler.BeginTick(time);
+            time += 40.0;
+            scheduler.EndTick(time);
+        }
+
+        REQUIRE(stats.Load > 1.0);
+        REQUIRE(stats.Overruns == 100);
+        REQUIRE(stats.CatchUpTicks > 0);
+        REQUIRE(stats.DroppedTicks > 0);
+
+        const auto dropped_ticks = stats.DroppedTicks;
+        scheduler.BeginTick(time);
+        REQUIRE(stats.DroppedTicks == dropped_ticks + 1);
+    }
+
+    SECTION("Early tick on input")
+    {
+        REQUIRE_FALSE(scheduler.IsTickDue(1010.0));
+        scheduler.Notify();
+
+        // Not earlier than minimal interval from previous tick begin
+        REQUIRE_FALSE(scheduler.IsTickDue(1001.0));
+        REQUIRE(scheduler.IsTickDue(1002.0));
+        scheduler.BeginTick(1002.0);
+        scheduler.EndTick(1003.0);
+        REQUIRE(stats.InputTicks == 1);
+
+        // Input consumed and regular schedule kept
+        REQUIRE_FALSE(scheduler.IsTickDue(1010.0));
+        REQUIRE(scheduler.IsTickDue(1020.0));
+        scheduler.BeginTick(1020.0);
+        REQUIRE(stats.InputTicks == 1);
+        REQUIRE(stats.CatchUpTicks == 0);
+        REQUIRE(stats.DroppedTicks == 0);
+    }
+
+    SECTION("Early tick on timer")
+    {
+        scheduler.SetTimer(1015.0);
+        scheduler.SetTimer(1010.0);
+        scheduler.SetTimer(1012.0);
+
+        REQUIRE_FALSE(scheduler.IsTickDue(1009.0));
+        REQUIRE(scheduler.IsTickDue(1010.0));
+        scheduler.BeginTick(1010.0);
+        scheduler.EndTick(1011.0);
+        REQUIRE(stats.TimerTicks == 1);
+
+        // Timer is reset by tick, scripts set it again if needed
+        REQUIRE_FALSE(scheduler.IsTickDue(1015.0));
+        REQUIRE(scheduler.IsTickDue(1020.0));
+    }
+
+    SECTION("Timer not earlier than minimal interval")
+    {
+        scheduler.SetTimer(990.0);
+        REQUIRE_FALSE(scheduler.IsTickDue(1001.0));
+        REQUIRE(scheduler.IsTickDue(1002.0));
+    }
+}
+
+TEST_CASE("TickSchedulerUnlimited")
+{
+    TickScheduler scheduler(0, 3, 2);
+    REQUIRE(scheduler.GetTickPeriod() == Approx(0.0));
+
+    scheduler.BeginTick(1000.0);
+    scheduler.EndTick(1500.0);
+    REQUIRE(scheduler.IsTickDue(1500.0));
+    REQUIRE(scheduler.GetStatistics().Overruns == 0);
+    REQUIRE(scheduler.GetStatistics().Load == Approx(0.0));
+}
@@ -0,0 +1,258 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "catch.hpp"
+
+#include "StringUtils.h"
+#include "TimingWheel.h"
+
+static auto DrainReady(TimingWheel& wheel) -> vector<uint>
+{
+    vector<uint> result;
+    uint value = 0;
+    while (wheel.PopReady(value)) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+TEST_CASE("TimingWheel")
+{
+    TimingWheel wheel(1000);
+
+    SECTION("Fire in time order")
+    {
+        wheel.Add(1300, 3);
+        wheel.Add(1001, 1);
+        wheel.Add(1255, 2);
+        wheel.Add(1000 + 70000, 4);
+        wheel.Add(1000 + 20000000, 5);
+        REQUIRE(wheel.GetCount() == 5);
+
+        wheel.Advance(1000);
+        REQUIRE(DrainReady(wheel).empty());
+
+        wheel.Advance(1001);
+        REQUIRE(DrainReady(wheel) == vector<uint> {1});
+        wheel.Advance(1299);
+        REQUIRE(DrainReady(wheel) == vector<uint> {2});
+        wheel.Advance(1300);
+        REQUIRE(DrainReady(wheel) == vector<uint> {3});
+        wheel.Advance(1000 + 69999);
+        REQUIRE(DrainReady(wheel).empty());
+        wheel.Advance(1000 + 70000);
+        REQUIRE(DrainReady(wheel) == vector<uint> {4});
+        wheel.Advance(1000 + 20000000);
+        REQUIRE(DrainReady(wheel) == vector<uint> {5});
+        REQUIRE(wheel.GetCount() == 0);
+    }
+
+    SECTION("Past fire time is ready immediately")
+    {
+        wheel.Add(900, 1);
+        wheel.Add(1000, 2);
+        REQUIRE(wheel.GetReadyCount() == 2);
+        REQUIRE(DrainReady(wheel) == vector<uint> {1, 2});
+    }
+
+    SECTION("Cancel")
+    {
+        const auto h1 = wheel.Add(1010, 1);
+        const auto h2 = wheel.Add(1010, 2);
+        const auto h3 = wheel.Add(1000, 3);
+        REQUIRE(wheel.IsPending(h1));
+        REQUIRE(wheel.GetFireTime(h1) == 1010);
+
+        REQUIRE(wheel.Cancel(h1));
+        REQUIRE_FALSE(wheel.Cancel(h1));
+        REQUIRE_FALSE(wheel.IsPending(h1));
+        REQUIRE(wheel.Cancel(h3));
+        REQUIRE(wheel.GetReadyCount() == 0);
+
+        // Reused node must not be reachable by old handle
+        const auto h4 = wheel.Add(1020, 4);
+        REQUIRE(h4.Index == h3.Index);
+        REQUIRE_FALSE(wheel.Cancel(h3));
+        REQUIRE(wheel.IsPending(h4));
+
+        wheel.Advance(1100);
+        REQUIRE(DrainReady(wheel) == vector<uint> {2, 4});
+        REQUIRE_FALSE(wheel.IsPending(h2));
+    }
+
+    SECTION("Advance over long idle gaps")
+    {
+        // Cascade boundaries of every level are crossed by single advance
+        wheel.Add(1000 + 255, 1);
+        wheel.Add(1000 + 256, 2);
+        wheel.Add(1000 + 65535, 3);
+        wheel.Add(1000 + 65536, 4);
+        wheel.Add(1000 + 16777300, 5);
+
+        wheel.Advance(1000 + 65535);
+        REQUIRE(DrainReady(wheel) == vector<uint> {1, 2, 3});
+        REQUIRE(wheel.GetTime() == 1000 + 65535);
+
+        wheel.Advance(1000 + 16777299);
+        REQUIRE(DrainReady(wheel) == vector<uint> {4});
+
+        uint next_fire_time = 0;
+        REQUIRE(wheel.GetNextFireTime(next_fire_time));
+        REQUIRE(next_fire_time <= 1000 + 16777300);
+
+        wheel.Advance(1000 + 16777300);
+        REQUIRE(DrainReady(wheel) == vector<uint> {5});
+        REQUIRE(wheel.GetCount() == 0);
+    }
+
+    SECTION("Time wrap around")
+    {
+        TimingWheel wrap_wheel(std::numeric_limits<uint>::max() - 10);
+        wrap_wheel.Add(5, 2);
+        wrap_wheel.Add(std::numeric_limits<uint>::max(), 1);
+        wrap_wheel.Advance(std::numeric_limits<uint>::max());
+        REQUIRE(DrainReady(wrap_wheel) == vector<uint> {1});
+        wrap_wheel.Advance(5);
+        REQUIRE(DrainReady(wrap_wheel) == vector<uint> {2});
+    }
+
+    SECTION("Jump by next fire time hits every timer in time")
+    {
+        uint fire_time = 0;
+        REQUIRE_FALSE(wheel.GetNextFireTime(fire_time));
+
+        vector<uint> fire_times;
+        uint seed = 777;
+        for (uint i = 0; i < 2000; i++) {
+            seed = seed * 1103515245u + 12345u;
+            fire_times.push_back(1001 + (seed >> 8) % (i % 2 == 0 ? 300u : 5000000u));
+            wheel.Add(fire_times.back(), i);
+        }
+
+        size_t fired = 0;
+        size_t jumps = 0;
+        while (wheel.GetNextFireTime(fire_time)) {
+            REQUIRE(fire_time > wheel.GetTime());
+            REQUIRE(++jumps < fire_times.size() * 4);
+
+            wheel.Advance(fire_time);
+            for (const auto value : DrainReady(wheel)) {
+                REQUIRE(fire_times[value] == fire_time);
+                fired++;
+            }
+        }
+
+        REQUIRE(fired == fire_times.size());
+    }
+
+    SECTION("Matches sorted reference")
+    {
+        vector<uint> fire_times;
+        uint seed = 12345;
+        for (uint i = 0; i < 10000; i++) {
+            seed = seed * 1103515245u + 12345u;
+            fire_times.push_back(1001 + (seed >> 8) % 200000);
+            wheel.Add(fire_times.back(), i);
+        }
+
+        vector<uint> fired;
+        for (uint time = 1000; time <= 1000 + 200000; time += 97) {
+            wheel.Advance(time);
+            for (const auto value : DrainReady(wheel)) {
+                REQUIRE(fire_times[value] <= time);
+                REQUIRE(fire_times[value] > time - 97);
+                fired.push_back(value);
+            }
+        }
+        wheel.Advance(1000 + 200001);
+        for (const auto value : DrainReady(wheel)) {
+            fired.push_back(value);
+        }
+
+        REQUIRE(fired.size() == fire_times.size());
+        for (size_t i = 1; i < fired.size(); i++) {
+            REQUIRE(fire_times[fired[i - 1]] <= fire_times[fired[i]]);
+        }
+    }
+}
+
+TEST_CASE("TimingWheelThroughput", "[.][benchmark]")
+{
+    constexpr uint timers_count = 1000000;
+    constexpr uint time_range = 100000;
+
+    BENCHMARK_ADVANCED(_str("Add, cancel half and fire {} timers", timers_count).str())(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&] {
+            TimingWheel wheel(0);
+            vector<TimingWheel::Handle> handles;
+            handles.reserve(timers_count);
+
+            for (uint i = 0; i < timers_count; i++) {
+                handles.push_back(wheel.Add(1 + (i * 7919u) % time_range, i));
+            }
+            for (uint i = 0; i < timers_count; i += 2) {
+                wheel.Cancel(handles[i]);
+            }
+
+            size_t fired = 0;
+            uint value = 0;
+            for (uint time = 1; time <= time_range; time++) {
+                wheel.Advance(time);
+                while (wheel.PopReady(value)) {
+                    fired++;
+                }
+            }
+            return fired;
+        });
+    };
+
+    BENCHMARK_ADVANCED(_str("Scan {} pending timers (previous list storage)", timers_count).str())(Catch::Benchmark::Chronometer meter)
+    {
+        list<std::pair<uint, uint>> calls;
+        for (uint i = 0; i < timers_count; i++) {
+            calls.emplace_back(1 + (i * 7919u) % time_range, i);
+        }
+
+        // One pass of former Process over pending calls when nothing is due
+        meter.measure([&] {
+            size_t due = 0;
+            for (const auto& call : calls) {
+                if (call.first == 0) {
+                    due++;
+                }
+            }
+            return due;
+        });
+    };
+}
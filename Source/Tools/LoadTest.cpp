@@ -0,0 +1,627 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "LoadTest.h"
+#include "GenericUtils.h"
+#include "Log.h"
+#include "NetCommand.h"
+#include "StringUtils.h"
+#include "Timer.h"
+#include "Version-Include.h"
+
+static constexpr double STEP_TIME = 250.0;
+static constexpr double REQUEST_TIMEOUT = 5000.0;
+static constexpr double ENTER_TIMEOUT = 30000.0;
+static constexpr uint NO_PING = std::numeric_limits<uint>::max();
+
+static const array<string_view, LoadTestStats::METRICS_COUNT> METRIC_NAMES = {"Connect", "Register", "Login", "EnterGame", "Ping", "Say", "Dialog", "GameInfo", "ChangeMap"};
+
+auto LoadTestStats::GetCount(LoadTestMetric metric) const -> size_t
+{
+    return _samples[static_cast<size_t>(metric)].size();
+}
+
+auto LoadTestStats::GetPercentile(LoadTestMetric metric, double p) const -> double
+{
+    const auto index = static_cast<size_t>(metric);
+    auto& samples = const_cast<vector<double>&>(_samples[index]);
+    if (samples.empty()) {
+        return 0.0;
+    }
+
+    if (!_sorted[index]) {
+        std::sort(samples.begin(), samples.end());
+        _sorted[index] = true;
+    }
+
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(static_cast<double>(samples.size()) * p))];
+}
+
+auto LoadTestStats::GetMax(LoadTestMetric metric) const -> double
+{
+    return GetPercentile(metric, 1.0);
+}
+
+void LoadTestStats::AddSample(LoadTestMetric metric, double time)
+{
+    const auto index = static_cast<size_t>(metric);
+    _samples[index].emplace_back(time);
+    _sorted[index] = false;
+}
+
+LoadTestBot::LoadTestBot(GlobalSettings& settings, GeometryHelper& geom_helper, LoadTestStats& stats, const vector<LoadTestAction>& scenario, uint index, double start_time) :
+    _settings {settings}, //
+    _geomHelper {geom_helper},
+    _stats {stats},
+    _scenario {scenario},
+    _netSettings {settings},
+    _conn(_netSettings)
+{
+    _name = _str("{}{}", settings.LoadTestNamePrefix, index);
+    _nextConnectTime = start_time + static_cast<double>(index) * 1000.0 / static_cast<double>(std::max(settings.LoadTestConnectRate, 1u));
+    _scenarioIndex = index % _scenario.size();
+
+    _conn.AddConnectHandler([this](bool success) { OnConnect(success); });
+    _conn.AddDisconnectHandler([this] { OnDisconnect(); });
+
+    _conn.AddMessageHandler(NETMSG_REGISTER_SUCCESS, [this] { Net_OnRegisterSuccess(); });
+    _conn.AddMessageHandler(NETMSG_LOGIN_SUCCESS, [this] { Net_OnLoginSuccess(); });
+    _conn.AddMessageHandler(NETMSG_LOADMAP, [this] { Net_OnLoadMap(); });
+    _conn.AddMessageHandler(NETMSG_ADD_PLAYER, [this] { Net_OnAddCritter(false); });
+    _conn.AddMessageHandler(NETMSG_ADD_NPC, [this] { Net_OnAddCritter(true); });
+    _conn.AddMessageHandler(NETMSG_REMOVE_CRITTER, [this] { Net_OnRemoveCritter(); });
+    _conn.AddMessageHandler(NETMSG_CRITTER_XY, [this] { Net_OnCritterCoords(); });
+    _conn.AddMessageHandler(NETMSG_CRITTER_TEXT, [this] { Net_OnText(); });
+    _conn.AddMessageHandler(NETMSG_TALK_NPC, [this] { Net_OnChosenTalk(); });
+    _conn.AddMessageHandler(NETMSG_GAME_INFO, [this] { Net_OnGameInfo(); });
+    _conn.AddMessageHandler(NETMSG_END_PARSE_TO_GAME, [this] { Net_OnEndParseToGame(); });
+
+    // Everything else that server sends to players is not interesting for bots
+    for (const auto msg : {NETMSG_WRONG_NET_PROTO, NETMSG_SOME_ITEM, NETMSG_CRITTER_ACTION, NETMSG_CRITTER_MOVE_ITEM, NETMSG_CRITTER_ANIMATE, NETMSG_CRITTER_SET_ANIMS, NETMSG_CUSTOM_COMMAND, NETMSG_CRITTER_MOVE, NETMSG_CRITTER_DIR, //
+             NETMSG_POD_PROPERTY(1, 0), NETMSG_POD_PROPERTY(1, 1), NETMSG_POD_PROPERTY(1, 2), NETMSG_POD_PROPERTY(2, 0), NETMSG_POD_PROPERTY(2, 1), NETMSG_POD_PROPERTY(2, 2), //
+             NETMSG_POD_PROPERTY(4, 0), NETMSG_POD_PROPERTY(4, 1), NETMSG_POD_PROPERTY(4, 2), NETMSG_POD_PROPERTY(8, 0), NETMSG_POD_PROPERTY(8, 1), NETMSG_POD_PROPERTY(8, 2), //
+             NETMSG_COMPLEX_PROPERTY, NETMSG_MSG, NETMSG_MSG_LEX, NETMSG_MAP_TEXT, NETMSG_MAP_TEXT_MSG, NETMSG_MAP_TEXT_MSG_LEX, NETMSG_ALL_PROPERTIES, NETMSG_CLEAR_ITEMS, NETMSG_ADD_ITEM, NETMSG_REMOVE_ITEM, //
+             NETMSG_ALL_ITEMS_SEND, NETMSG_AUTOMAPS_INFO, NETMSG_VIEW_MAP, NETMSG_MAP, NETMSG_GLOBAL_INFO, NETMSG_SOME_ITEMS, NETMSG_ADD_ITEM_ON_MAP, NETMSG_ERASE_ITEM_FROM_MAP, NETMSG_ANIMATE_ITEM, //
+             NETMSG_COMBAT_RESULTS, NETMSG_EFFECT, NETMSG_FLY_EFFECT, NETMSG_PLAY_SOUND, NETMSG_UPDATE_FILES_LIST}) {
+        _conn.AddMessageHandler(msg, [this, msg] { _conn.InBuf.SkipMsg(msg); });
+    }
+}
+
+void LoadTestBot::Process(double time)
+{
+    _now = time;
+
+    if (_state == State::Idle) {
+        if (_stopped || time < _nextConnectTime || _conn.IsConnecting() || _conn.IsConnected()) {
+            return;
+        }
+
+        _state = _settings.LoadTestRegister && !_registered ? State::Registering : State::LoggingIn;
+        _stateTime = time;
+        _conn.Connect();
+    }
+
+    // Connection writes round trip of own pings to settings
+    _netSettings.Ping = NO_PING;
+    _conn.Process();
+    if (_netSettings.Ping != NO_PING) {
+        _stats.AddSample(LoadTestMetric::Ping, static_cast<double>(_netSettings.Ping));
+        if (_netSettings.Ping >= _settings.LoadTestStallTime) {
+            _stats.Count.Stalls++;
+        }
+    }
+
+    if (_state == State::InGame && _changeMapTime == 0.0) {
+        if (_walkSteps != 0u) {
+            ProcessStep(time);
+        }
+        else if (time >= _nextActionTime) {
+            ProcessAction(time);
+        }
+    }
+
+    CheckTimeouts(time);
+}
+
+void LoadTestBot::Stop()
+{
+    _stopped = true;
+    _conn.Disconnect();
+}
+
+void LoadTestBot::OnConnect(bool success)
+{
+    if (!success) {
+        _stats.Count.ConnectFails++;
+        _state = State::Idle;
+        _nextConnectTime = _now + static_cast<double>(GenericUtils::Random(1000u, 3000u));
+        return;
+    }
+
+    _stats.Count.Connects++;
+    _stats.AddSample(LoadTestMetric::Connect, _now - _stateTime);
+    _stateTime = _now;
+
+    if (_state == State::Registering) {
+        Net_SendCredentials(NETMSG_REGISTER, 1234567890);
+    }
+    else {
+        Net_SendCredentials(NETMSG_LOGIN, 12345);
+    }
+}
+
+void LoadTestBot::OnDisconnect()
+{
+    if (!_stopped) {
+        switch (_state) {
+        case State::Registering:
+            // Account may be registered by previous run
+            if (!_registerSucceeded) {
+                _stats.Count.RegisterFails++;
+            }
+            _registered = true;
+            break;
+        case State::LoggingIn:
+            _stats.Count.LoginFails++;
+            break;
+        default:
+            _stats.Count.Disconnects++;
+            break;
+        }
+    }
+
+    _nextConnectTime = _now + static_cast<double>(_state == State::Registering ? GenericUtils::Random(100u, 500u) : GenericUtils::Random(1000u, 3000u));
+    _state = State::Idle;
+    _chosenId = 0;
+    _npcs.clear();
+    _walkSteps = 0;
+    _sayTime = 0.0;
+    _dialogTime = 0.0;
+    _gameInfoTime = 0.0;
+    _changeMapTime = 0.0;
+}
+
+void LoadTestBot::ProcessAction(double time)
+{
+    auto action = _scenario[_scenarioIndex++ % _scenario.size()];
+
+    if (action == LoadTestAction::Talk && (_chosenId == 0u || _npcs.empty())) {
+        action = LoadTestAction::Info;
+    }
+    if (action == LoadTestAction::Walk && _chosenId == 0u) {
+        action = LoadTestAction::Info;
+    }
+
+    switch (action) {
+    case LoadTestAction::Walk:
+        _walkSteps = GenericUtils::Random(3u, 8u);
+        _walkDir = static_cast<uchar>(GenericUtils::Random(0, _settings.MapDirCount - 1));
+        _nextStepTime = time;
+        ProcessStep(time);
+        break;
+    case LoadTestAction::Say:
+        _sayTime = time;
+        Net_SendText(_str("{} action {}", _name, _scenarioIndex));
+        break;
+    case LoadTestAction::Talk: {
+        const auto it = std::min_element(_npcs.begin(), _npcs.end(), [this](const NpcInfo& a, const NpcInfo& b) { //
+            return _geomHelper.DistGame(_chosenHexX, _chosenHexY, a.HexX, a.HexY) < _geomHelper.DistGame(_chosenHexX, _chosenHexY, b.HexX, b.HexY);
+        });
+        _dialogTime = time;
+        _dialogNpcId = it->Id;
+        Net_SendTalk(_dialogNpcId, ANSWER_BEGIN);
+    } break;
+    case LoadTestAction::Info:
+        _gameInfoTime = time;
+        _conn.OutBuf << NETMSG_SEND_GET_INFO;
+        break;
+    case LoadTestAction::ChangeMap:
+        // Server replaces map view same way as on transit
+        _changeMapTime = time;
+        _conn.OutBuf << NETMSG_SEND_REFRESH_ME;
+        break;
+    }
+
+    const auto period = _settings.LoadTestActionPeriod;
+    _nextActionTime = time + static_cast<double>(GenericUtils::Random(period / 2u, period + period / 2u));
+}
+
+void LoadTestBot::ProcessStep(double time)
+{
+    if (time < _nextStepTime) {
+        return;
+    }
+
+    Net_SendStep();
+
+    _walkSteps--;
+    _nextStepTime = time + STEP_TIME;
+    if (_walkSteps == 0u) {
+        _nextActionTime = std::max(_nextActionTime, time + STEP_TIME);
+    }
+}
+
+void LoadTestBot::CheckTimeouts(double time)
+{
+    for (auto* request_time : {&_sayTime, &_dialogTime, &_gameInfoTime, &_changeMapTime}) {
+        if (*request_time != 0.0 && time - *request_time >= REQUEST_TIMEOUT) {
+            _stats.Count.Timeouts++;
+            *request_time = 0.0;
+        }
+    }
+
+    if ((_state == State::LoggingIn || _state == State::EnteringGame) && time - _stateTime >= ENTER_TIMEOUT) {
+        _stats.Count.Timeouts++;
+        _conn.Disconnect();
+    }
+}
+
+void LoadTestBot::SkipMessageRest(uint msg_len, uint read_len)
+{
+    const auto header_len = static_cast<uint>(sizeof(uint) + sizeof(msg_len));
+    if (msg_len < header_len + read_len) {
+        _conn.InBuf.SetError(true);
+        return;
+    }
+
+    const auto rest_len = msg_len - header_len - read_len;
+    if (rest_len != 0u) {
+        _skipBuf.resize(rest_len);
+        _conn.InBuf.Pop(_skipBuf.data(), rest_len);
+    }
+}
+
+void LoadTestBot::Net_SendCredentials(uint msg, uint encrypt_key)
+{
+    const auto& password = _settings.LoadTestPassword;
+    uint msg_len = sizeof(uint) + sizeof(msg_len) + sizeof(ushort) + NetBuffer::STRING_LEN_SIZE * 2u + static_cast<uint>(_name.length() + password.length());
+
+    _conn.OutBuf << msg;
+    _conn.OutBuf << msg_len;
+    _conn.OutBuf << FO_COMPATIBILITY_VERSION;
+
+    // Begin data encrypting
+    _conn.OutBuf.SetEncryptKey(encrypt_key);
+    _conn.InBuf.SetEncryptKey(encrypt_key);
+
+    _conn.OutBuf << _name;
+    _conn.OutBuf << password;
+}
+
+void LoadTestBot::Net_SendStep()
+{
+    // Walk forth until server corrects position, map bounds are checked by server
+    auto hx = static_cast<int>(_chosenHexX);
+    auto hy = static_cast<int>(_chosenHexY);
+    _geomHelper.MoveHexByDirUnsafe(hx, hy, _walkDir);
+    if (hx < 0 || hy < 0 || hx > std::numeric_limits<ushort>::max() || hy > std::numeric_limits<ushort>::max()) {
+        _walkDir = _geomHelper.ReverseDir(_walkDir);
+        return;
+    }
+
+    _chosenHexX = static_cast<ushort>(hx);
+    _chosenHexY = static_cast<ushort>(hy);
+    _stats.Count.Steps++;
+
+    _conn.OutBuf << NETMSG_SEND_MOVE_WALK;
+    _conn.OutBuf << static_cast<uint>(0);
+    _conn.OutBuf << _chosenHexX;
+    _conn.OutBuf << _chosenHexY;
+}
+
+void LoadTestBot::Net_SendText(string_view text)
+{
+    const uchar how_say = SAY_NORM;
+    uint msg_len = sizeof(uint) + sizeof(msg_len) + sizeof(how_say) + NetBuffer::STRING_LEN_SIZE + static_cast<uint>(text.length());
+
+    _conn.OutBuf << NETMSG_SEND_TEXT;
+    _conn.OutBuf << msg_len;
+    _conn.OutBuf << how_say;
+    _conn.OutBuf << text;
+}
+
+void LoadTestBot::Net_SendTalk(uint npc_id, uchar answer)
+{
+    _conn.OutBuf << NETMSG_SEND_TALK_NPC;
+    _conn.OutBuf << static_cast<uchar>(1);
+    _conn.OutBuf << npc_id;
+    _conn.OutBuf << answer;
+}
+
+void LoadTestBot::Net_OnRegisterSuccess()
+{
+    _registerSucceeded = true;
+    _stats.AddSample(LoadTestMetric::Register, _now - _stateTime);
+}
+
+void LoadTestBot::Net_OnLoginSuccess()
+{
+    uint msg_len;
+    uint bin_seed;
+    uint bout_seed;
+    uint player_id;
+    _conn.InBuf >> msg_len;
+    _conn.InBuf >> bin_seed;
+    _conn.InBuf >> bout_seed;
+    _conn.InBuf >> player_id;
+
+    // Globals and player properties
+    SkipMessageRest(msg_len, sizeof(uint) * 3u);
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    _conn.OutBuf.SetEncryptKey(bin_seed);
+    _conn.InBuf.SetEncryptKey(bout_seed);
+
+    _stats.AddSample(LoadTestMetric::Login, _now - _stateTime);
+    _state = State::EnteringGame;
+    _stateTime = _now;
+}
+
+void LoadTestBot::Net_OnLoadMap()
+{
+    _conn.InBuf.SkipMsg(NETMSG_LOADMAP);
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    _chosenId = 0;
+    _npcs.clear();
+    _walkSteps = 0;
+
+    _conn.OutBuf << NETMSG_SEND_LOAD_MAP_OK;
+}
+
+void LoadTestBot::Net_OnAddCritter(bool is_npc)
+{
+    uint msg_len;
+    uint crid;
+    ushort hx;
+    ushort hy;
+    uchar dir;
+    CritterCondition cond;
+    uint anims[6];
+    uint flags;
+    _conn.InBuf >> msg_len;
+    _conn.InBuf >> crid;
+    _conn.InBuf >> hx;
+    _conn.InBuf >> hy;
+    _conn.InBuf >> dir;
+    _conn.InBuf >> cond;
+    for (auto& anim : anims) {
+        _conn.InBuf >> anim;
+    }
+    _conn.InBuf >> flags;
+
+    // Pid or name and properties
+    SkipMessageRest(msg_len, static_cast<uint>(sizeof(crid) + sizeof(hx) + sizeof(hy) + sizeof(dir) + sizeof(cond) + sizeof(anims) + sizeof(flags)));
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    if (IsBitSet(flags, FCRIT_CHOSEN)) {
+        _chosenId = crid;
+        _chosenHexX = hx;
+        _chosenHexY = hy;
+    }
+    else if (is_npc) {
+        _npcs.push_back({crid, hx, hy});
+    }
+}
+
+void LoadTestBot::Net_OnRemoveCritter()
+{
+    uint crid;
+    _conn.InBuf >> crid;
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    _npcs.erase(std::remove_if(_npcs.begin(), _npcs.end(), [crid](const NpcInfo& npc) { return npc.Id == crid; }), _npcs.end());
+}
+
+void LoadTestBot::Net_OnCritterCoords()
+{
+    uint crid;
+    ushort hx;
+    ushort hy;
+    uchar dir;
+    _conn.InBuf >> crid;
+    _conn.InBuf >> hx;
+    _conn.InBuf >> hy;
+    _conn.InBuf >> dir;
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    if (crid == _chosenId) {
+        if (hx != _chosenHexX || hy != _chosenHexY) {
+            _stats.Count.StepCorrections++;
+            _walkDir = static_cast<uchar>(GenericUtils::Random(0, _settings.MapDirCount - 1));
+        }
+        _chosenHexX = hx;
+        _chosenHexY = hy;
+        return;
+    }
+
+    for (auto& npc : _npcs) {
+        if (npc.Id == crid) {
+            npc.HexX = hx;
+            npc.HexY = hy;
+            break;
+        }
+    }
+}
+
+void LoadTestBot::Net_OnText()
+{
+    uint msg_len;
+    uint crid;
+    _conn.InBuf >> msg_len;
+    _conn.InBuf >> crid;
+
+    SkipMessageRest(msg_len, sizeof(crid));
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    if (crid == _chosenId && _sayTime != 0.0) {
+        _stats.AddSample(LoadTestMetric::Say, _now - _sayTime);
+        _sayTime = 0.0;
+    }
+}
+
+void LoadTestBot::Net_OnChosenTalk()
+{
+    uint msg_len;
+    _conn.InBuf >> msg_len;
+
+    SkipMessageRest(msg_len, 0);
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    if (_dialogTime != 0.0) {
+        _stats.AddSample(LoadTestMetric::Dialog, _now - _dialogTime);
+        _dialogTime = 0.0;
+        Net_SendTalk(_dialogNpcId, ANSWER_END);
+    }
+}
+
+void LoadTestBot::Net_OnGameInfo()
+{
+    _conn.InBuf.SkipMsg(NETMSG_GAME_INFO);
+
+    CHECK_SERVER_IN_BUF_ERROR(_conn);
+
+    if (_gameInfoTime != 0.0) {
+        _stats.AddSample(LoadTestMetric::GameInfo, _now - _gameInfoTime);
+        _gameInfoTime = 0.0;
+    }
+}
+
+void LoadTestBot::Net_OnEndParseToGame()
+{
+    if (_state == State::EnteringGame) {
+        _stats.AddSample(LoadTestMetric::EnterGame, _now - _stateTime);
+        _state = State::InGame;
+        _nextActionTime = _now + static_cast<double>(GenericUtils::Random(0u, _settings.LoadTestActionPeriod));
+    }
+    else if (_changeMapTime != 0.0) {
+        _stats.AddSample(LoadTestMetric::ChangeMap, _now - _changeMapTime);
+        _changeMapTime = 0.0;
+    }
+}
+
+LoadTestSwarm::LoadTestSwarm(GlobalSettings& settings) : _settings {settings}, _geomHelper(settings)
+{
+    _scenario = ParseScenario(settings.LoadTestScenario);
+    _startTime = Timer::RealtimeTick();
+    _lastReportTime = _startTime;
+
+    WriteLog("Start load test with {} bots on {}:{}", settings.LoadTestBots, settings.ServerHost, settings.ServerPort);
+
+    _bots.reserve(settings.LoadTestBots);
+    for (uint i = 0; i < settings.LoadTestBots; i++) {
+        _bots.emplace_back(std::make_unique<LoadTestBot>(settings, _geomHelper, _stats, _scenario, i, _startTime));
+    }
+}
+
+auto LoadTestSwarm::ParseScenario(const vector<string>& scenario) -> vector<LoadTestAction>
+{
+    static const unordered_map<string, LoadTestAction> ACTIONS = {
+        {"Walk", LoadTestAction::Walk},
+        {"Say", LoadTestAction::Say},
+        {"Talk", LoadTestAction::Talk},
+        {"Info", LoadTestAction::Info},
+        {"ChangeMap", LoadTestAction::ChangeMap},
+    };
+
+    vector<LoadTestAction> actions;
+    for (const auto& name : scenario) {
+        const auto it = ACTIONS.find(name);
+        if (it == ACTIONS.end()) {
+            throw LoadTestException("Unknown load test action", name);
+        }
+        actions.push_back(it->second);
+    }
+
+    if (actions.empty()) {
+        throw LoadTestException("Empty load test scenario");
+    }
+
+    return actions;
+}
+
+auto LoadTestSwarm::IsFinished() const -> bool
+{
+    return _stopped || (_settings.LoadTestDuration != 0u && Timer::RealtimeTick() - _startTime >= static_cast<double>(_settings.LoadTestDuration) * 1000.0);
+}
+
+auto LoadTestSwarm::MakeReport() const -> string
+{
+    const auto in_game = std::count_if(_bots.begin(), _bots.end(), [](const unique_ptr<LoadTestBot>& bot) { return bot->IsInGame(); });
+    const auto& count = _stats.Count;
+
+    std::ostringstream str;
+    str << _str("Load test {:.1f} seconds, bots {}, in game {}\n", (Timer::RealtimeTick() - _startTime) / 1000.0, _bots.size(), in_game).str();
+    str << _str("{:<10} {:>8} {:>9} {:>9} {:>9} {:>9}\n", "Latency ms", "count", "p50", "p90", "p99", "max").str();
+    for (size_t i = 0; i < LoadTestStats::METRICS_COUNT; i++) {
+        const auto metric = static_cast<LoadTestMetric>(i);
+        str << _str("{:<10} {:>8} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f}\n", METRIC_NAMES[i], _stats.GetCount(metric), _stats.GetPercentile(metric, 0.5), _stats.GetPercentile(metric, 0.9), _stats.GetPercentile(metric, 0.99), _stats.GetMax(metric)).str();
+    }
+
+    // Server processes player messages once per loop cycle so ping round trip follows its tick time
+    str << _str("Server loop: ping p50 {:.1f} ms, p99 {:.1f} ms, stalls over {} ms {}\n", _stats.GetPercentile(LoadTestMetric::Ping, 0.5), _stats.GetPercentile(LoadTestMetric::Ping, 0.99), _settings.LoadTestStallTime, count.Stalls).str();
+    str << _str("Connects {}, connect fails {}, disconnects {}, register fails {}, login fails {}, timeouts {}\n", count.Connects, count.ConnectFails, count.Disconnects, count.RegisterFails, count.LoginFails, count.Timeouts).str();
+    str << _str("Steps {}, step corrections {}", count.Steps, count.StepCorrections).str();
+
+    return str.str();
+}
+
+void LoadTestSwarm::Process()
+{
+    const auto time = Timer::RealtimeTick();
+
+    for (auto& bot : _bots) {
+        bot->Process(time);
+    }
+
+    if (_settings.LoadTestReportPeriod != 0u && time - _lastReportTime >= static_cast<double>(_settings.LoadTestReportPeriod) * 1000.0) {
+        _lastReportTime = time;
+        WriteLog("{}", MakeReport());
+    }
+}
+
+void LoadTestSwarm::Stop()
+{
+    _stopped = true;
+
+    for (auto& bot : _bots) {
+        bot->Stop();
+    }
+}
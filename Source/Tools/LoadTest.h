@@ -0,0 +1,223 @@
+//      __________        ___               ______            _
+//     / ____/ __ \____  / (_)___  ___     / ____/___  ____ _(_)___  ___
+//    / /_  / / / / __ \/ / / __ \/ _ \   / __/ / __ \/ __ `/ / __ \/ _ `
+//   / __/ / /_/ / / / / / / / / /  __/  / /___/ / / / /_/ / / / / /  __/
+//  /_/    \____/_/ /_/_/_/_/ /_/\___/  /_____/_/ /_/\__, /_/_/ /_/\___/
+//                                                  /____/
+// FOnline Engine
+// https://fonline.ru
+// https://github.com/cvet/fonline
+//
+// MIT License
+//
+// Copyright (c) 2006 - 2022, Anton Tsvetinskiy aka cvet <cvet@tut.by>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+
+#include "Common.h"
+
+#include "GeometryHelper.h"
+#include "ServerConnection.h"
+#include "Settings.h"
+
+DECLARE_EXCEPTION(LoadTestException);
+
+enum class LoadTestMetric
+{
+    Connect,
+    Register,
+    Login,
+    EnterGame,
+    Ping,
+    Say,
+    Dialog,
+    GameInfo,
+    ChangeMap,
+    Count,
+};
+
+enum class LoadTestAction
+{
+    Walk,
+    Say,
+    Talk,
+    Info,
+    ChangeMap,
+};
+
+// Shared between all bots of process
+class LoadTestStats final
+{
+public:
+    static constexpr auto METRICS_COUNT = static_cast<size_t>(LoadTestMetric::Count);
+
+    struct Counters
+    {
+        size_t Connects {};
+        size_t ConnectFails {};
+        size_t Disconnects {};
+        size_t RegisterFails {};
+        size_t LoginFails {};
+        size_t Steps {};
+        size_t StepCorrections {};
+        size_t Timeouts {};
+        size_t Stalls {};
+    };
+
+    LoadTestStats() = default;
+    LoadTestStats(const LoadTestStats&) = delete;
+    LoadTestStats(LoadTestStats&&) noexcept = delete;
+    auto operator=(const LoadTestStats&) = delete;
+    auto operator=(LoadTestStats&&) noexcept = delete;
+    ~LoadTestStats() = default;
+
+    [[nodiscard]] auto GetCount(LoadTestMetric metric) const -> size_t;
+    // Nearest rank, zero if no samples
+    [[nodiscard]] auto GetPercentile(LoadTestMetric metric, double p) const -> double;
+    [[nodiscard]] auto GetMax(LoadTestMetric metric) const -> double;
+
+    void AddSample(LoadTestMetric metric, double time);
+
+    Counters Count {};
+
+private:
+    array<vector<double>, METRICS_COUNT> _samples {};
+    mutable array<bool, METRICS_COUNT> _sorted {};
+    bool _nonConstHelper {};
+};
+
+// Simulated player driven by scenario, works on client connection without client engine
+class LoadTestBot final
+{
+public:
+    LoadTestBot() = delete;
+    LoadTestBot(GlobalSettings& settings, GeometryHelper& geom_helper, LoadTestStats& stats, const vector<LoadTestAction>& scenario, uint index, double start_time);
+    LoadTestBot(const LoadTestBot&) = delete;
+    LoadTestBot(LoadTestBot&&) noexcept = delete;
+    auto operator=(const LoadTestBot&) = delete;
+    auto operator=(LoadTestBot&&) noexcept = delete;
+    ~LoadTestBot() = default;
+
+    [[nodiscard]] auto IsInGame() const -> bool { return _state == State::InGame; }
+
+    void Process(double time);
+    void Stop();
+
+private:
+    enum class State
+    {
+        Idle,
+        Registering,
+        LoggingIn,
+        EnteringGame,
+        InGame,
+    };
+
+    struct NpcInfo
+    {
+        uint Id {};
+        ushort HexX {};
+        ushort HexY {};
+    };
+
+    void OnConnect(bool success);
+    void OnDisconnect();
+    void ProcessAction(double time);
+    void ProcessStep(double time);
+    void CheckTimeouts(double time);
+    void SkipMessageRest(uint msg_len, uint read_len);
+
+    void Net_SendCredentials(uint msg, uint encrypt_key);
+    void Net_SendStep();
+    void Net_SendText(string_view text);
+    void Net_SendTalk(uint npc_id, uchar answer);
+    void Net_OnRegisterSuccess();
+    void Net_OnLoginSuccess();
+    void Net_OnLoadMap();
+    void Net_OnAddCritter(bool is_npc);
+    void Net_OnRemoveCritter();
+    void Net_OnCritterCoords();
+    void Net_OnText();
+    void Net_OnChosenTalk();
+    void Net_OnGameInfo();
+    void Net_OnEndParseToGame();
+
+    GlobalSettings& _settings;
+    GeometryHelper& _geomHelper;
+    LoadTestStats& _stats;
+    const vector<LoadTestAction>& _scenario;
+    ClientNetworkSettings _netSettings;
+    ServerConnection _conn;
+    string _name {};
+    State _state {};
+    bool _stopped {};
+    bool _registered {};
+    bool _registerSucceeded {};
+    double _now {};
+    double _stateTime {};
+    double _nextConnectTime {};
+    double _nextActionTime {};
+    size_t _scenarioIndex {};
+    uint _chosenId {};
+    ushort _chosenHexX {};
+    ushort _chosenHexY {};
+    vector<NpcInfo> _npcs {};
+    uint _walkSteps {};
+    uchar _walkDir {};
+    double _nextStepTime {};
+    double _sayTime {};
+    double _dialogTime {};
+    uint _dialogNpcId {};
+    double _gameInfoTime {};
+    double _changeMapTime {};
+    vector<vector<uchar>> _tempPropertiesData {};
+    vector<uchar> _skipBuf {};
+};
+
+class LoadTestSwarm final
+{
+public:
+    LoadTestSwarm() = delete;
+    explicit LoadTestSwarm(GlobalSettings& settings);
+    LoadTestSwarm(const LoadTestSwarm&) = delete;
+    LoadTestSwarm(LoadTestSwarm&&) noexcept = delete;
+    auto operator=(const LoadTestSwarm&) = delete;
+    auto operator=(LoadTestSwarm&&) noexcept = delete;
+    ~LoadTestSwarm() = default;
+
+    [[nodiscard]] static auto ParseScenario(const vector<string>& scenario) -> vector<LoadTestAction>;
+    [[nodiscard]] auto IsFinished() const -> bool;
+    [[nodiscard]] auto MakeReport() const -> string;
+
+    void Process();
+    void Stop();
+
+private:
+    GlobalSettings& _settings;
+    GeometryHelper _geomHelper;
+    vector<LoadTestAction> _scenario {};
+    LoadTestStats _stats {};
+    vector<unique_ptr<LoadTestBot>> _bots {};
+    double _startTime {};
+    double _lastReportTime {};
+    bool _stopped {};
+};